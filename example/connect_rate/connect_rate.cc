@@ -0,0 +1,132 @@
+// Measures how many short-lived connections (connect, send a request,
+// read the reply, close) per second TcpServer serves:
+//  - with the single acceptor accepting one connection per wakeup,
+//  - with the single acceptor draining the backlog in batches,
+//  - with one SO_REUSEPORT acceptor per io loop.
+//
+// Batching and per-loop acceptors take the accept work off the base loop,
+// which pays off when that loop is the bottleneck with cores to spare for
+// the io loops. When the clients, the io loops and the kernel handshakes
+// share too few cores, the client side connect/close syscalls dominate
+// and the gain stays well below 2x: 1.0x to 1.3x on one CPU. Give the
+// server more cores than io threads and run the clients elsewhere (or on
+// other cores) to see the base loop bound case.
+//
+// Usage: tcp_connect_rate_bench [io_threads] [client_threads] [seconds]
+
+#include "net/tcp/TcpServer.h"
+#include "net/base/Logging.h"
+#include "net/EventLoop.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace var;
+using namespace var::net;
+
+static void runClient(uint16_t port, std::atomic<bool>* stop, std::atomic<int64_t>* connects)
+{
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  while (!stop->load(std::memory_order_relaxed))
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+      break;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) == 0 &&
+        ::write(fd, "ping", 4) == 4)
+    {
+      // The server closes first, so TIME_WAIT doesn't run out of local ports.
+      // Connections left in the backlog are never served after the stop.
+      struct timeval tv = { 1, 0 };
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+      char buf[16];
+      ssize_t n = 0;
+      size_t total = 0;
+      while ((n = ::read(fd, buf, sizeof buf)) > 0)
+      {
+        total += n;
+      }
+      if (n == 0 && total == 4)
+      {
+        connects->fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    ::close(fd);
+  }
+}
+
+static double measure(TcpServer::Option option, int maxAcceptsPerRead, uint16_t port,
+                      int ioThreads, int clientThreads, int seconds)
+{
+  EventLoop loop;
+  TcpServer server(&loop, InetAddress(port), "ConnectRate", option);
+  server.setThreadNum(ioThreads);
+  server.setMaxAcceptsPerRead(maxAcceptsPerRead);
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+  {
+    conn->send(buf);
+    conn->shutdown();
+  });
+  server.start();
+
+  std::atomic<bool> stop(false);
+  std::atomic<int64_t> connects(0);
+  std::vector<std::thread> clients;
+  // Lets the acceptors listen before connecting.
+  loop.runAfter(0.2, [&]()
+  {
+    for (int i = 0; i < clientThreads; ++i)
+    {
+      clients.emplace_back(runClient, port, &stop, &connects);
+    }
+  });
+  loop.runAfter(0.2 + seconds, [&]()
+  {
+    stop = true;
+    loop.quit();
+  });
+  loop.loop();
+  for (auto& t : clients)
+  {
+    t.join();
+  }
+  return static_cast<double>(connects.load()) / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+  int ioThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int clientThreads = argc > 2 ? atoi(argv[2]) : 8;
+  int seconds = argc > 3 ? atoi(argv[3]) : 5;
+  Logger::setLogLevel(Logger::WARN);
+
+  printf("io threads %d, client threads %d, %d seconds\n",
+         ioThreads, clientThreads, seconds);
+  double single = measure(TcpServer::kNoReusePort, 1, 2031,
+                          ioThreads, clientThreads, seconds);
+  printf("single acceptor, 1 accept:  %10.0f connections/s\n", single);
+  double batched = measure(TcpServer::kNoReusePort, 64, 2032,
+                           ioThreads, clientThreads, seconds);
+  printf("single acceptor, batched:   %10.0f connections/s (%.2fx)\n",
+         batched, single > 0 ? batched / single : 0);
+  double perLoop = measure(TcpServer::kReusePortPerLoop, 64, 2033,
+                           ioThreads, clientThreads, seconds);
+  printf("acceptor per loop, batched: %10.0f connections/s (%.2fx)\n",
+         perLoop, single > 0 ? perLoop / single : 0);
+}
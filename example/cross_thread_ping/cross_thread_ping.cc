@@ -0,0 +1,102 @@
+// Measures EventLoop::queueInLoop() across threads:
+//  - fan-in: producer threads queue functors into one loop as fast as
+//    they can, like worker threads calling TcpConnection::send().
+//  - ping-pong: a functor bounces between two loops, each hop queued
+//    from the other loop's thread, which is all wakeup latency.
+//
+// Usage: cross_thread_ping_bench [producers] [functors_per_producer] [round_trips]
+
+#include "net/EventLoop.h"
+#include "net/EventLoopThread.h"
+#include "net/base/CountDownLatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace var;
+using namespace var::net;
+
+static void fanIn(int producers, int functorsPerProducer)
+{
+  EventLoopThread loopThread;
+  EventLoop* loop = loopThread.startLoop();
+  const int64_t total = static_cast<int64_t>(producers) * functorsPerProducer;
+  int64_t done = 0;  // only touched in the loop
+  CountDownLatch allDone(1);
+
+  Timestamp start(Timestamp::now());
+  std::vector<std::thread> threads;
+  for (int i = 0; i < producers; ++i)
+  {
+    threads.emplace_back([&]()
+    {
+      for (int j = 0; j < functorsPerProducer; ++j)
+      {
+        loop->queueInLoop([&]()
+        {
+          if (++done == total)
+          {
+            allDone.countDown();
+          }
+        });
+      }
+    });
+  }
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+  allDone.wait();
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("fan-in    %d producers: %10.0f functors/s\n",
+         producers, static_cast<double>(total) / seconds);
+}
+
+struct PingPong
+{
+  EventLoop* loops[2];
+  int remaining;
+  CountDownLatch done{1};
+
+  void hop(int side)
+  {
+    if (--remaining == 0)
+    {
+      done.countDown();
+      return;
+    }
+    loops[1 - side]->queueInLoop([this, side]() { hop(1 - side); });
+  }
+};
+
+static void pingPong(int roundTrips)
+{
+  EventLoopThread ping(EventLoopThread::ThreadInitCallback(), "ping");
+  EventLoopThread pong(EventLoopThread::ThreadInitCallback(), "pong");
+  PingPong pp;
+  pp.loops[0] = ping.startLoop();
+  pp.loops[1] = pong.startLoop();
+  pp.remaining = roundTrips * 2;
+
+  Timestamp start(Timestamp::now());
+  pp.loops[0]->queueInLoop([&pp]() { pp.hop(0); });
+  pp.done.wait();
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("ping-pong:            %10.0f round trips/s, %.2f us each\n",
+         roundTrips / seconds, seconds * 1e6 / roundTrips);
+}
+
+int main(int argc, char* argv[])
+{
+  int producers = argc > 1 ? atoi(argv[1]) : 4;
+  int functorsPerProducer = argc > 2 ? atoi(argv[2]) : 1000000;
+  int roundTrips = argc > 3 ? atoi(argv[3]) : 100000;
+
+  fanIn(1, functorsPerProducer);
+  fanIn(producers, functorsPerProducer);
+  pingPong(roundTrips);
+}
@@ -0,0 +1,151 @@
+// Requests per second HttpClient gets from HttpServer on keep-alive
+// connections, keeping `connections * depth' requests in flight:
+//  - one connection, a request at a time,
+//  - `connections' connections of the pool, a request at a time on each,
+//  - the same connections with `depth' requests pipelined on each.
+//
+// Usage: http_client_bench [io_threads] [seconds] [connections] [depth]
+
+#include "net/http/http_client.h"
+#include "net/http/http_server.h"
+#include "net/base/Logging.h"
+#include "net/EventLoop.h"
+#include "net/EventLoopThread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <functional>
+
+using namespace var;
+using namespace var::net;
+
+struct Result
+{
+  double requestsPerSecond;
+  double averageUs;
+  int64_t errors;
+};
+
+class Driver
+{
+ public:
+  Driver(HttpClient* client, const InetAddress& addr)
+    : client_(client), addr_(addr), stop_(false), requests_(0), errors_(0), totalUs_(0)
+  {
+    request_.header().set_method(HTTP_METHOD_GET);
+    request_.header().url().set_path("/ping");
+  }
+
+  // In the loop of the client.
+  void send()
+  {
+    Timestamp start = Timestamp::now();
+    client_->DoAsync(addr_, &request_, [this, start](int error, HttpResponse*)
+    {
+      if (stop_.load(std::memory_order_relaxed))
+      {
+        return;
+      }
+      if (error == 0)
+      {
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        totalUs_.fetch_add(Timestamp::now().microSecondsSinceEpoch() -
+                           start.microSecondsSinceEpoch(), std::memory_order_relaxed);
+      }
+      else
+      {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+      }
+      send();
+    });
+  }
+
+  void stop() { stop_ = true; }
+  int64_t requests() const { return requests_.load(); }
+  int64_t errors() const { return errors_.load(); }
+  int64_t totalUs() const { return totalUs_.load(); }
+
+ private:
+  HttpClient* client_;
+  InetAddress addr_;
+  HttpRequest request_;
+  std::atomic<bool> stop_;
+  std::atomic<int64_t> requests_;
+  std::atomic<int64_t> errors_;
+  std::atomic<int64_t> totalUs_;
+};
+
+static Result measure(uint16_t port, int ioThreads, int seconds, int connections, int depth)
+{
+  EventLoop loop;
+  InetAddress addr(port, true);
+  HttpServer server(&loop, addr, "Bench");
+  server.SetThreadNum(ioThreads);
+  server.SetHttpCallback([](HttpRequest*, HttpResponse* response)
+  {
+    response->set_body("pong");
+  });
+  server.Start();
+
+  EventLoopThread clientThread;
+  EventLoop* clientLoop = clientThread.startLoop();
+  HttpClientOptions options;
+  options.max_connections_per_host = connections;
+  options.max_pipeline_depth = depth;
+  HttpClient client(clientLoop, "Bench", options);
+  Driver driver(&client, addr);
+  loop.runAfter(0.2, [&]()
+  {
+    clientLoop->runInLoop([&]()
+    {
+      for (int i = 0; i < connections * depth; ++i)
+      {
+        driver.send();
+      }
+    });
+  });
+  loop.runAfter(0.2 + seconds, [&]()
+  {
+    driver.stop();
+  });
+  loop.runAfter(0.5 + seconds, [&]()
+  {
+    loop.quit();
+  });
+  loop.loop();
+
+  Result result;
+  result.requestsPerSecond = static_cast<double>(driver.requests()) / seconds;
+  result.averageUs = driver.requests() > 0 ?
+      static_cast<double>(driver.totalUs()) / driver.requests() : 0;
+  result.errors = driver.errors();
+  return result;
+}
+
+static void print(const char* name, const Result& result, double base)
+{
+  printf("%-28s %10.0f requests/s (%.2fx), %8.1f us average, %lld errors\n",
+         name, result.requestsPerSecond,
+         base > 0 ? result.requestsPerSecond / base : 0,
+         result.averageUs, static_cast<long long>(result.errors));
+}
+
+int main(int argc, char* argv[])
+{
+  int ioThreads = argc > 1 ? atoi(argv[1]) : 2;
+  int seconds = argc > 2 ? atoi(argv[2]) : 5;
+  int connections = argc > 3 ? atoi(argv[3]) : 4;
+  int depth = argc > 4 ? atoi(argv[4]) : 16;
+  Logger::setLogLevel(Logger::WARN);
+
+  printf("io threads %d, %d seconds\n", ioThreads, seconds);
+  Result single = measure(2036, ioThreads, seconds, 1, 1);
+  print("1 connection:", single, single.requestsPerSecond);
+  char name[64];
+  snprintf(name, sizeof name, "%d connections:", connections);
+  print(name, measure(2037, ioThreads, seconds, connections, 1), single.requestsPerSecond);
+  snprintf(name, sizeof name, "%d connections, depth %d:", connections, depth);
+  print(name, measure(2038, ioThreads, seconds, connections, depth), single.requestsPerSecond);
+}
@@ -0,0 +1,157 @@
+// Keep-alive requests per second HttpServer serves, each client holding
+// one connection and keeping `depth' requests in flight on it:
+//  - depth 1, a request is sent once the last response is read,
+//  - pipelined, the requests of a write are answered in one send.
+//
+// Usage: http_keepalive_bench [io_threads] [client_threads] [seconds] [depth]
+
+#include "net/http/http_server.h"
+#include "net/base/Logging.h"
+#include "net/EventLoop.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace var;
+using namespace var::net;
+
+static const char kRequest[] = "GET /ping HTTP/1.1\r\nHost: bench\r\n\r\n";
+
+// Length of the response to kRequest, every response is the same.
+static size_t responseLength(int fd)
+{
+  ::write(fd, kRequest, sizeof kRequest - 1);
+  std::string response;
+  char buf[4096];
+  while (true)
+  {
+    ssize_t n = ::read(fd, buf, sizeof buf);
+    if (n <= 0)
+    {
+      return 0;
+    }
+    response.append(buf, n);
+    size_t end = response.find("\r\n\r\n");
+    size_t length = response.find("Content-Length: ");
+    if (end != std::string::npos && length != std::string::npos)
+    {
+      size_t total = end + 4 + atoi(response.c_str() + length + 16);
+      if (response.size() >= total)
+      {
+        return total;
+      }
+    }
+  }
+}
+
+static void runClient(uint16_t port, int depth, std::atomic<bool>* stop,
+                      std::atomic<int64_t>* requests)
+{
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) != 0)
+  {
+    perror("connect");
+    return;
+  }
+  const size_t length = responseLength(fd);
+  std::string batch;
+  for (int i = 0; i < depth; ++i)
+  {
+    batch.append(kRequest, sizeof kRequest - 1);
+  }
+  std::vector<char> buf(65536);
+  while (length > 0 && !stop->load(std::memory_order_relaxed))
+  {
+    if (::write(fd, batch.data(), batch.size()) != static_cast<ssize_t>(batch.size()))
+    {
+      break;
+    }
+    size_t expected = length * depth;
+    while (expected > 0)
+    {
+      ssize_t n = ::read(fd, buf.data(), std::min(buf.size(), expected));
+      if (n <= 0)
+      {
+        expected = 1;
+        break;
+      }
+      expected -= n;
+    }
+    if (expected != 0)
+    {
+      break;
+    }
+    requests->fetch_add(depth, std::memory_order_relaxed);
+  }
+  ::close(fd);
+}
+
+static double measure(uint16_t port, int ioThreads, int clientThreads, int seconds, int depth)
+{
+  EventLoop loop;
+  HttpServer server(&loop, InetAddress(port), "KeepAlive");
+  server.SetThreadNum(ioThreads);
+  server.SetHttpCallback([](HttpRequest*, HttpResponse* response)
+  {
+    response->set_body("pong");
+  });
+  server.Start();
+
+  std::atomic<bool> stop(false);
+  std::atomic<int64_t> requests(0);
+  std::vector<std::thread> clients;
+  loop.runAfter(0.2, [&]()
+  {
+    for (int i = 0; i < clientThreads; ++i)
+    {
+      clients.emplace_back(runClient, port, depth, &stop, &requests);
+    }
+  });
+  loop.runAfter(0.2 + seconds, [&]()
+  {
+    stop = true;
+  });
+  // The clients finish their last batch before the server goes away.
+  loop.runAfter(0.5 + seconds, [&]()
+  {
+    loop.quit();
+  });
+  loop.loop();
+  for (auto& t : clients)
+  {
+    t.join();
+  }
+  return static_cast<double>(requests.load()) / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+  int ioThreads = argc > 1 ? atoi(argv[1]) : 2;
+  int clientThreads = argc > 2 ? atoi(argv[2]) : 4;
+  int seconds = argc > 3 ? atoi(argv[3]) : 5;
+  int depth = argc > 4 ? atoi(argv[4]) : 16;
+  Logger::setLogLevel(Logger::WARN);
+
+  printf("io threads %d, client threads %d, %d seconds\n",
+         ioThreads, clientThreads, seconds);
+  double single = measure(2034, ioThreads, clientThreads, seconds, 1);
+  printf("depth 1:  %10.0f requests/s\n", single);
+  double pipelined = measure(2035, ioThreads, clientThreads, seconds, depth);
+  printf("depth %-2d: %10.0f requests/s (%.2fx)\n",
+         depth, pipelined, single > 0 ? pipelined / single : 0);
+}
@@ -0,0 +1,190 @@
+// Skewed workload for EventLoopThreadPool::setLoadBalancing().
+//
+// Heavy connections (each request holds its loop for heavy_us, like
+// waiting for an FPGA DMA or writing an upload to disk; it sleeps so
+// that the result doesn't depend on the number of cpus) and light
+// ping-pong connections
+// arrive as heavy, light * (io_threads - 1), heavy, ..., which makes
+// round-robin put every heavy connection onto the same loop. Prints
+// the throughput of heavy requests, the latency of light requests and
+// the most heavy connections a loop got for each policy.
+//
+// Usage: loop_balance_bench [io_threads] [seconds] [heavy_us]
+
+#include "net/tcp/TcpServer.h"
+#include "net/base/Logging.h"
+#include "net/EventLoop.h"
+#include "net/EventLoopThreadPool.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+using namespace var;
+using namespace var::net;
+
+static int g_heavyUs = 200;
+
+static int connectTo(uint16_t port)
+{
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) != 0)
+  {
+    ::close(fd);
+    return -1;
+  }
+  int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+  return fd;
+}
+
+// Sends one byte and waits for it to come back until stopped,
+// recording the round trip time of each request in microseconds.
+static void runClient(int fd, char request, std::atomic<bool>* stop,
+                      std::vector<int64_t>* latencies)
+{
+  while (!stop->load(std::memory_order_relaxed))
+  {
+    Timestamp start = Timestamp::now();
+    char buf = request;
+    if (::write(fd, &buf, 1) != 1 || ::read(fd, &buf, 1) != 1)
+    {
+      break;
+    }
+    latencies->push_back(timeDifference(Timestamp::now(), start) * 1000000);
+  }
+  ::close(fd);
+}
+
+static void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+{
+  while (buf->readableBytes() > 0)
+  {
+    if (buf->peek()[0] == 'H')
+    {
+      ::usleep(g_heavyUs);
+    }
+    conn->send(buf->peek(), 1);
+    buf->retrieve(1);
+  }
+}
+
+static void measure(EventLoopThreadPool::LoadBalancing loadBalancing, const char* policy,
+                    uint16_t port, int ioThreads, int seconds)
+{
+  EventLoop loop;
+  TcpServer server(&loop, InetAddress(port), "LoopBalance");
+  server.setThreadNum(ioThreads);
+  server.setMessageCallback(onMessage);
+  std::map<EventLoop*, int> heavyLoops;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn)
+  {
+    // Heavy connections are the 1st, (io_threads+1)th, ... accepted.
+    int id = static_cast<int>(conn->id() >> 32);
+    if (conn->connected() && (id - 1) % ioThreads == 0)
+    {
+      EventLoop* ioLoop = conn->getLoop();
+      loop.runInLoop([&heavyLoops, ioLoop]() { ++heavyLoops[ioLoop]; });
+    }
+  });
+  server.start();
+  server.threadPool()->setLoadBalancing(loadBalancing);
+
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> clients;
+  std::vector<std::vector<int64_t>> latencies(ioThreads * ioThreads);
+  // Connects from another thread so that the server loop accepts, and
+  // gives the loops time to show their load between connections.
+  std::thread connector([&]()
+  {
+    for (int i = 0; i < ioThreads * ioThreads; ++i)
+    {
+      bool heavy = i % ioThreads == 0;
+      int fd = connectTo(port);
+      if (fd < 0)
+      {
+        continue;
+      }
+      clients.emplace_back(runClient, fd, heavy ? 'H' : 'L', &stop, &latencies[i]);
+      ::usleep(20 * 1000);
+    }
+  });
+  loop.runAfter(0.1 + 0.02 * ioThreads * ioThreads + seconds, [&]()
+  {
+    stop = true;
+    loop.quit();
+  });
+  loop.loop();
+  connector.join();
+  for (auto& t : clients)
+  {
+    t.join();
+  }
+
+  std::vector<int64_t> light;
+  size_t heavyRequests = 0;
+  for (size_t i = 0; i < latencies.size(); ++i)
+  {
+    if (i % ioThreads == 0)
+    {
+      heavyRequests += latencies[i].size();
+    }
+    else
+    {
+      light.insert(light.end(), latencies[i].begin(), latencies[i].end());
+    }
+  }
+  std::sort(light.begin(), light.end());
+  int maxHeavy = 0;
+  for (const auto& item : heavyLoops)
+  {
+    maxHeavy = std::max(maxHeavy, item.second);
+  }
+  if (light.empty())
+  {
+    printf("%-18s no light requests\n", policy);
+    return;
+  }
+  printf("%-18s heavy %6.0f req/s  light %7.0f req/s p50 %5ld us p99 %5ld us  "
+         "max heavy/loop %d\n",
+         policy, static_cast<double>(heavyRequests) / seconds,
+         static_cast<double>(light.size()) / seconds,
+         static_cast<long>(light[light.size() / 2]),
+         static_cast<long>(light[light.size() * 99 / 100]), maxHeavy);
+}
+
+int main(int argc, char* argv[])
+{
+  int ioThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int seconds = argc > 2 ? atoi(argv[2]) : 5;
+  g_heavyUs = argc > 3 ? atoi(argv[3]) : 200;
+  if (ioThreads < 2)
+  {
+    fprintf(stderr, "needs at least 2 io threads\n");
+    return 1;
+  }
+  Logger::setLogLevel(Logger::WARN);
+
+  printf("io threads %d, %d heavy and %d light connections, heavy request %d us, %d seconds\n",
+         ioThreads, ioThreads, ioThreads * (ioThreads - 1), g_heavyUs, seconds);
+  measure(EventLoopThreadPool::kRoundRobin, "round-robin", 2041, ioThreads, seconds);
+  measure(EventLoopThreadPool::kLeastConnections, "least-connections", 2042, ioThreads, seconds);
+  measure(EventLoopThreadPool::kLeastBusy, "least-busy", 2043, ioThreads, seconds);
+  measure(EventLoopThreadPool::kPowerOfTwoChoices, "power-of-two", 2044, ioThreads, seconds);
+}
@@ -2,6 +2,8 @@
 #include "net/base/Logging.h"
 #include "net/EventLoop.h"
 
+#include <string.h>
+
 using namespace var;
 using namespace var::net;
 
@@ -13,6 +15,12 @@ public:
             std::bind(&PingPongServer::onConnection, this, _1));
         server_.setMessageCallback(
             std::bind(&PingPongServer::onMessage, this, _1, _2, _3));
+        // Takes effect with VAR_USE_IO_URING.
+        server_.setReceiveInPoller(true);
+    }
+
+    inline void setEdgeTriggered(bool on) {
+        server_.setEdgeTriggered(on);
     }
 
     inline void start() {
@@ -34,10 +42,11 @@ private:
     var::net::TcpServer server_;
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     EventLoop loop;
     InetAddress addr("0.0.0.0", 1234);
     PingPongServer server(&loop, addr);
+    server.setEdgeTriggered(argc > 1 && strcmp(argv[1], "--edge-triggered") == 0);
     server.start();
     loop.loop();
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Timer churn of idle timeouts: every connection holds a timer which is
+// canceled and added again on each of its requests, as keep-alive and
+// idle timeouts do. Compares the timer backends of EventLoop.
+//
+// Usage: timer_churn_bench [connections] [requests]
+
+#include "net/EventLoop.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+using namespace var;
+using namespace var::net;
+
+static void measure(EventLoop::TimerBackend backend, const char* name,
+                    int connections, int requests)
+{
+  EventLoop loop;
+  loop.setTimerBackend(backend);
+  std::vector<TimerId> timers(connections);
+  int expired = 0;
+  // Idle timeouts of 10 to 70 seconds, none of them expires.
+  for (int i = 0; i < connections; ++i)
+  {
+    timers[i] = loop.runAfter(10 + i % 60, [&expired]() { ++expired; });
+  }
+
+  Timestamp start(Timestamp::now());
+  unsigned seed = 1;
+  for (int i = 0; i < requests; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    int conn = static_cast<int>((seed >> 8) % connections);
+    loop.cancel(timers[conn]);
+    timers[conn] = loop.runAfter(10 + conn % 60, [&expired]() { ++expired; });
+  }
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("%-12s %7d timers: %10.0f cancel+add/s\n",
+         name, connections, requests / seconds);
+}
+
+int main(int argc, char* argv[])
+{
+  int connections = argc > 1 ? atoi(argv[1]) : 100000;
+  int requests = argc > 2 ? atoi(argv[2]) : 2000000;
+
+  measure(EventLoop::kTimerSet, "set", connections, requests);
+  measure(EventLoop::kTimingWheel, "timing wheel", connections, requests);
+  measure(EventLoop::kTimerSet, "set", connections / 100, requests);
+  measure(EventLoop::kTimingWheel, "timing wheel", connections / 100, requests);
+}
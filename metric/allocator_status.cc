@@ -0,0 +1,50 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 16:20:05 CST 2026.
+
+#include "metric/allocator_status.h"
+#include <mutex>
+
+namespace var {
+
+AllocatorMetrics::AllocatorMetrics(const std::string& prefix)
+    : _live_blocks(prefix, "live_blocks")
+    , _live_bytes(prefix, "live_bytes")
+    , _free_blocks(prefix, "free_blocks")
+    , _free_bytes(prefix, "free_bytes") {
+}
+
+void AllocatorMetrics::onLive(int delta, int64_t bytes) {
+    _live_blocks << delta;
+    _live_bytes << bytes;
+}
+
+void AllocatorMetrics::onFree(int delta, int64_t bytes) {
+    _free_blocks << delta;
+    _free_bytes << bytes;
+}
+
+void EnableAllocatorMetrics(const std::string& prefix) {
+    static std::once_flag once;
+    std::call_once(once, [&prefix]() {
+        // Never destroyed, blocks move until the last thread exits.
+        BlockAllocator::setObserver(new AllocatorMetrics(prefix));
+    });
+}
+
+}  // namespace var
@@ -0,0 +1,55 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 16:20:05 CST 2026.
+
+#ifndef VAR_ALLOCATOR_STATUS_H
+#define VAR_ALLOCATOR_STATUS_H
+
+#include "metric/reducer.h"
+#include "net/base/BlockAllocator.h"
+#include <string>
+
+namespace var {
+
+// Counts the blocks of net::BlockAllocator, which backs Buffer and IOBuf
+// storage, TcpConnections, Channels and Sockets:
+//   <prefix>_live_blocks, <prefix>_live_bytes : handed out and in use.
+//   <prefix>_free_blocks, <prefix>_free_bytes : cached by the threads,
+//                                              return queues included.
+// Blocks already handed out or cached when it's installed are left out.
+class AllocatorMetrics : public BlockAllocatorObserver {
+public:
+    explicit AllocatorMetrics(const std::string& prefix);
+
+    void onLive(int delta, int64_t bytes) override;
+    void onFree(int delta, int64_t bytes) override;
+
+private:
+    Adder<int64_t> _live_blocks;
+    Adder<int64_t> _live_bytes;
+    Adder<int64_t> _free_blocks;
+    Adder<int64_t> _free_bytes;
+};
+
+// Installs an AllocatorMetrics named `prefix' for the whole process,
+// best called at startup. Only the first call has effect.
+void EnableAllocatorMetrics(const std::string& prefix = "block_allocator");
+
+}  // namespace var
+
+#endif  // VAR_ALLOCATOR_STATUS_H
@@ -6,7 +6,11 @@
 #include "net/base/FileUtil.h"
 #include "net/base/Timestamp.h"
 #include <fstream>
+#include <mutex>
 #include <cmath>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace var {
 
@@ -31,9 +35,36 @@ void get_all_file(const std::string& dir_path,
 
 const std::string FileTransferSaveDir = program_work_dir("bin") + "data/file_transfer/";
 
+namespace {
+
+class UploadFileReader : public net::ProgressiveReader {
+public:
+    explicit UploadFileReader(const std::string& file_path) : _file(file_path) {}
+
+    int OnReadOnePart(const char* data, size_t length) override {
+        _file.append(data, length);
+        return 0;
+    }
+
+    void OnEndOfMessage(bool ok) override {
+        _file.flush();
+    }
+
+private:
+    FileUtil::AppendFile _file;
+};
+
+} // namespace
+
 FileTransferService::FileTransferService() {
+    // Reads and writes files, walks directories.
+    set_blocking(true);
+    set_max_concurrency(4);
+    set_thread_safe(true);
     AddMethod("upload_file", std::bind(&FileTransferService::upload_file,
                 this, std::placeholders::_1, std::placeholders::_2));
+    AddBodyReader("upload_file", std::bind(&FileTransferService::upload_file_reader,
+                this, std::placeholders::_1));
     AddMethod("download_file", std::bind(&FileTransferService::download_file,
                 this, std::placeholders::_1, std::placeholders::_2));
 }
@@ -61,15 +92,18 @@ void FileTransferService::upload_file(net::HttpRequest* request,
     }
     std::string file_name = UrlDecode(*encode_file_name);
     std::string file_path = path + file_name;
-    if(std::stoi(*file_cur_chunk) == 1) {
-        // Clear old data.
-        FileReaderLinux file(file_path.c_str(), "w");
+    if(!request->progressive_reader()) {
+        if(std::stoi(*file_cur_chunk) == 1) {
+            // Clear old data.
+            FileReaderLinux file(file_path.c_str(), "w");
+        }
+        FileUtil::AppendFile file(file_path);
+        file.append(content.peek(), content.readableBytes());
+        file.flush();  
     }
-    FileUtil::AppendFile file(file_path);
-    file.append(content.peek(), content.readableBytes());
-    file.flush();  
     response->header().SetHeader("Recvied-Chunk", *file_cur_chunk);
     if(*file_cur_chunk == *file_total_chunks) {
+        std::lock_guard<std::mutex> guard(_meta_mutex);
         std::string meta_path = path + "meta";
         std::ifstream meta(meta_path, std::ios::in);
         net::BufferStream meta_os;
@@ -119,6 +153,22 @@ void FileTransferService::upload_file(net::HttpRequest* request,
     }
 }
 
+net::ProgressiveReader* FileTransferService::upload_file_reader(net::HttpRequest* request) {
+    const std::string* file_cur_chunk = request->header().GetHeader("File-CurChunk");
+    const std::string* encode_file_name = request->header().GetHeader("File-Name");
+    if(!file_cur_chunk || !encode_file_name ||
+       !DirReaderLinux::CreateDirectoryIfNotExists(FileTransferSaveDir.c_str())) {
+        // Stored as usual, upload_file() rejects it.
+        return nullptr;
+    }
+    std::string file_path = FileTransferSaveDir + UrlDecode(*encode_file_name);
+    if(std::stoi(*file_cur_chunk) == 1) {
+        // Clear old data.
+        FileReaderLinux file(file_path.c_str(), "w");
+    }
+    return new UploadFileReader(file_path);
+}
+
 void FileTransferService::download_file(net::HttpRequest* request,
                                         net::HttpResponse* response) {
     const std::string* decode_file_name = request->header().url().GetQuery("filename");
@@ -128,25 +178,23 @@ void FileTransferService::download_file(net::HttpRequest* request,
     }
     std::string file_name = UrlDecode(*decode_file_name);
     std::string file_path = FileTransferSaveDir + file_name;
-    std::ifstream file(file_path, std::ios::binary);
-    if(file) {
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if(fd >= 0 && (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))) {
+        ::close(fd);
+        fd = -1;
+    }
+    if(fd >= 0) {
         response->header().set_content_type("application/octet-stream");
         response->header().SetHeader("Content-Disposition", 
         "attachment:filename=\"" + file_name + "\"; filename*=UTF-8''" + *decode_file_name);
 
-        file.seekg(0, std::ios::end);
-        size_t file_length = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        char* file_data = new char[file_length];
-        file.read(file_data, file_length);
-        net::BufferStream os;
-        os.append(file_data, file_length);
-        delete[] file_data;
-        response->set_body(os);
+        // Sent with sendfile(2) as it's read, Range requests included.
+        response->set_body_file(fd, 0, static_cast<size_t>(st.st_size));
         LOG_INFO << "Sucess download file: " << file_name;
 
         // Change meta log.
+        std::lock_guard<std::mutex> guard(_meta_mutex);
         std::string meta_path = FileTransferSaveDir + "meta";
         std::ifstream meta(meta_path, std::ios::in);
         net::BufferStream meta_os;
@@ -185,7 +233,6 @@ void FileTransferService::download_file(net::HttpRequest* request,
         }
         meta.close();
     }
-    file.close();
 }
 
 void FileTransferService::default_method(net::HttpRequest* request,
@@ -334,6 +381,7 @@ void FileTransferService::default_method(net::HttpRequest* request,
         "   <th>上传时间</th>\n"
         "   <th>下载次数</th>\n"
         "</tr>\n";
+        std::lock_guard<std::mutex> guard(_meta_mutex);
         std::string meta_path = FileTransferSaveDir + "meta";
         std::ifstream meta(meta_path, std::ios::in);
         if(meta) {
@@ -22,6 +22,7 @@
 
 #include "metric/builtin/service.h"
 #include "metric/builtin/inside_cmd_status_user.h"
+#include <mutex>
 
 namespace var {
 
@@ -32,6 +33,9 @@ public:
     void upload_file(net::HttpRequest* request,
                      net::HttpResponse* response);
 
+    // Writes the chunk of upload_file to the file as it's received.
+    net::ProgressiveReader* upload_file_reader(net::HttpRequest* request);
+
     void download_file(net::HttpRequest* request,
                        net::HttpResponse* response);
 
@@ -39,6 +43,11 @@ public:
                         net::HttpResponse* response) override;
 
     void GetTabInfo(TabInfoList*) const override;
+
+private:
+    // The methods run on several workers at once, the meta file is
+    // read and rewritten under this lock.
+    std::mutex _meta_mutex;
 };
 
 } // end namespace var
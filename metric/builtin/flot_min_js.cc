@@ -2,11 +2,15 @@
 
 namespace var {
 
-static net::Buffer* g_flot_min_buf = nullptr;
+static net::Buffer* NewFlotMinJsBuf() {
+    net::Buffer* buf = new net::Buffer;
+    buf->append(flot_min_js());
+    return buf;
+}
 
 const net::Buffer& flot_min_js_buf() {
-    g_flot_min_buf = new net::Buffer;
-    g_flot_min_buf->append(flot_min_js());
+    // Made once, never deleted.
+    static const net::Buffer* g_flot_min_buf = NewFlotMinJsBuf();
     return *g_flot_min_buf;
 }
 
@@ -2,6 +2,9 @@
 #include "metric/builtin/jquery_min_js.h"
 #include "metric/builtin/viz_min_js.h"
 #include "metric/builtin/flot_min_js.h"
+#include "net/http/http_compress.h"
+#include <stdio.h>
+#include <zlib.h>
 
 namespace var {
 
@@ -22,7 +25,84 @@ static void SetExpires(net::HttpHeader* header, time_t seconds) {
     header->SetHeader("Expires", buf);
 }
 
+// True if `if_none_match' has `etag', compared weakly as rfc7232 says.
+static bool MatchesETag(const std::string& if_none_match, const std::string& etag) {
+    size_t begin = 0;
+    while(begin < if_none_match.size()) {
+        size_t end = if_none_match.find(',', begin);
+        if(end == std::string::npos) {
+            end = if_none_match.size();
+        }
+        size_t first = if_none_match.find_first_not_of(" \t", begin);
+        size_t last = if_none_match.find_last_not_of(" \t", end - 1);
+        if(first < end && last != std::string::npos && last >= first) {
+            if(if_none_match.compare(first, 2, "W/") == 0) {
+                first += 2;
+            }
+            const size_t len = last + 1 - first;
+            if((len == 1 && if_none_match[first] == '*') ||
+                    if_none_match.compare(first, len, etag) == 0) {
+                return true;
+            }
+        }
+        begin = end + 1;
+    }
+    return false;
+}
+
+void GetJsService::InitJsFile(const net::Buffer& plain, JsFile* file) {
+    // The builtin js buffers are never freed.
+    file->plain.appendUserData(plain.peek(), plain.readableBytes(), []() {});
+    const uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(plain.peek()),
+                            static_cast<uInt>(plain.readableBytes()));
+    char etag[64];
+    snprintf(etag, sizeof(etag), "\"%08lx-%zx\"", crc, plain.readableBytes());
+    file->etag = etag;
+    snprintf(etag, sizeof(etag), "\"%08lx-%zx-gz\"", crc, plain.readableBytes());
+    file->gzip_etag = etag;
+    net::Buffer gzip;
+    if(!net::HttpCompress(net::HTTP_COMPRESS_GZIP, plain.peek(), plain.readableBytes(),
+                          9, &gzip)) {
+        LOG_WARN << "Fail to gzip a builtin js, sent as it is";
+        return;
+    }
+    file->gzip.append(std::move(gzip));
+}
+
+void GetJsService::SendJsFile(const JsFile& file, time_t max_age,
+                              net::HttpRequest* request, net::HttpResponse* response) {
+    net::HttpHeader& request_header = request->header();
+    net::HttpHeader& response_header = response->header();
+    const bool gzip = !file.gzip.empty() &&
+        net::NegotiateHttpCompressType(request_header.GetHeader("Accept-Encoding")) ==
+            net::HTTP_COMPRESS_GZIP;
+    const std::string& etag = gzip ? file.gzip_etag : file.etag;
+    response_header.set_content_type("application/javascript");
+    SetExpires(&response_header, max_age);
+    response_header.SetHeader("ETag", etag);
+    response_header.SetHeader("Vary", "Accept-Encoding");
+    // If-Modified-Since is ignored when If-None-Match is there.
+    const std::string* inm = request_header.GetHeader("If-None-Match");
+    const std::string* ims = request_header.GetHeader("If-Modified-Since");
+    if(inm ? MatchesETag(*inm, etag) : (ims && *ims == g_last_modified)) {
+        response_header.set_status_code(net::HTTP_STATUS_NOT_MODIFIED);
+        return;
+    }
+    response_header.SetHeader("Last-Modified", g_last_modified);
+    if(gzip) {
+        response_header.SetHeader("Content-Encoding", "gzip");
+        response->set_body(file.gzip);
+    }
+    else {
+        response->set_body(file.plain);
+    }
+}
+
 GetJsService::GetJsService() {
+    set_thread_safe(true);
+    InitJsFile(jquery_min_js_buf(), &_jquery_min);
+    InitJsFile(viz_min_js_buf(), &_viz_min);
+    InitJsFile(flot_min_js_buf(), &_flot_min);
     AddMethod("jquery_min", std::bind(&GetJsService::jquery_min,
                 this, std::placeholders::_1, std::placeholders::_2));
     AddMethod("viz_min", std::bind(&GetJsService::viz_min,
@@ -32,42 +112,15 @@ GetJsService::GetJsService() {
 }
 
 void GetJsService::jquery_min(net::HttpRequest* request, net::HttpResponse* response) {
-    response->header().set_content_type("application/javascript");
-    SetExpires(&response->header(), 600);
-    net::HttpHeader& request_header = request->header();
-    const std::string* ims = request_header.GetHeader("If-Modified-Since");
-    if(ims && *ims == g_last_modified) {
-        response->header().set_status_code(net::HTTP_STATUS_NOT_MODIFIED);
-        return;
-    }
-    response->header().SetHeader("Last-Modified", g_last_modified);
-    response->set_body(jquery_min_js_buf());
+    SendJsFile(_jquery_min, 600, request, response);
 }
 
 void GetJsService::viz_min(net::HttpRequest* request, net::HttpResponse* response) {
-    response->header().set_content_type("application/javascript");
-    SetExpires(&response->header(), 80000);
-    net::HttpHeader& request_header = request->header();
-    const std::string* ims = request_header.GetHeader("If-Modified-Since");
-    if(ims && *ims == g_last_modified) {
-        response->header().set_status_code(net::HTTP_STATUS_NOT_MODIFIED);
-        return;
-    }
-    response->header().SetHeader("Last-Modified", g_last_modified);
-    response->set_body(viz_min_js_buf());
+    SendJsFile(_viz_min, 80000, request, response);
 }
 
 void GetJsService::flot_min(net::HttpRequest* request, net::HttpResponse* response) {
-    response->header().set_content_type("application/javascript");
-    SetExpires(&response->header(), 80000);
-    net::HttpHeader& request_header = request->header();
-    const std::string* ims = request_header.GetHeader("If-Modified-Since");
-    if(ims && *ims == g_last_modified) {
-        response->header().set_status_code(net::HTTP_STATUS_NOT_MODIFIED);
-        return;
-    }
-    response->header().SetHeader("Last-Modified", g_last_modified);
-    response->set_body(flot_min_js_buf());
+    SendJsFile(_flot_min, 80000, request, response);
 }
 
 } // end namespace var
\ No newline at end of file
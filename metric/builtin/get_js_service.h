@@ -19,6 +19,7 @@
 #define VAR_BUILTIN_GET_JS_SERVICE_H
 
 #include "metric/builtin/service.h"
+#include "net/IOBuf.h"
 
 namespace var {
 
@@ -28,6 +29,25 @@ public:
     void jquery_min(net::HttpRequest* request, net::HttpResponse* response);
     void viz_min(net::HttpRequest* request, net::HttpResponse* response);
     void flot_min(net::HttpRequest* request, net::HttpResponse* response);
+
+private:
+    // A builtin js and its gzip form, compressed once when the service
+    // is created, with the ETags of both. Responses share their blocks.
+    struct JsFile {
+        net::IOBuf plain;
+        net::IOBuf gzip;
+        std::string etag;
+        std::string gzip_etag;
+    };
+    static void InitJsFile(const net::Buffer& plain, JsFile* file);
+    // Answers 304 if the client has the file, otherwise sends it, gzipped
+    // if the client takes that.
+    static void SendJsFile(const JsFile& file, time_t max_age,
+                           net::HttpRequest* request, net::HttpResponse* response);
+
+    JsFile _jquery_min;
+    JsFile _viz_min;
+    JsFile _flot_min;
 };
 
 } // end namespace var
@@ -5,6 +5,10 @@
 
 namespace var {
 
+IndexService::IndexService() {
+    set_thread_safe(true);
+}
+
 struct Path {
     Path(const std::string& url_str, const std::string& html_addr_str)
         : url(url_str), html_addr(html_addr_str) {}
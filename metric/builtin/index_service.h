@@ -24,6 +24,8 @@ namespace var {
 
 class IndexService : public Service {
 public:
+    IndexService();
+
     void default_method(net::HttpRequest* request,
                         net::HttpResponse* response) override;
 
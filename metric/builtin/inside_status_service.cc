@@ -13,6 +13,9 @@ const std::string InsideStatusXMLFileSaveDir = program_work_dir("bin") + "data/i
 
 InsideStatusService::InsideStatusService() 
     : _data(std::make_shared<net::Buffer>()) {
+    // Renders the status xml of every user.
+    set_blocking(true);
+    set_max_concurrency(16);
     AddMethod("add_user", std::bind(&InsideStatusService::add_user,
                 this, std::placeholders::_1, std::placeholders::_2));
     AddMethod("add_user_internal", std::bind(&InsideStatusService::add_user_internal,
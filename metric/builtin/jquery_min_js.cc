@@ -2,11 +2,15 @@
 
 namespace var {
 
-static net::Buffer* g_jquery_min_js_buf = nullptr;
+static net::Buffer* NewJqueryMinJsBuf() {
+    net::Buffer* buf = new net::Buffer;
+    buf->append(jquery_min_js());
+    return buf;
+}
 
 const net::Buffer& jquery_min_js_buf() {
-    g_jquery_min_js_buf = new net::Buffer;
-    g_jquery_min_js_buf->append(jquery_min_js());
+    // Made once, never deleted.
+    static const net::Buffer* g_jquery_min_js_buf = NewJqueryMinJsBuf();
     return *g_jquery_min_js_buf;
 }
 
@@ -2,7 +2,11 @@
 #include "metric/builtin/common.h"
 #include "metric/util/dir_reader_linux.h"
 #include "metric/server.h"
+#include "metric/detail/sampler.h"
+#include "net/http/server_sent_events.h"
 #include <deque>
+#include <mutex>
+#include <vector>
 
 namespace var {
 
@@ -32,52 +36,96 @@ void PutLogLevelSelect(std::ostream& os, const std::string& level) {
        << "</script>\n";
 }
 
-class LogFilter {
+size_t LogFilter::_limit = 1024;
+std::mutex LogFilter::_mutex;
+std::deque<std::string> LogFilter::_logs;
+uint64_t LogFilter::_seq = 0;
+LogFile* LogFilter::_file = nullptr;
+
+// Pushes the lines LogFilter receives to the log pages each second, instead
+// of having them fetch all lines kept once a second. A stream gets the lines
+// kept first, then only those logged since as "log" events.
+class LogPusher : public detail::Sampler {
 public:
-    static void log_to_stdout(const char* msg, int len) {
-        std::string tmp(msg, len);
-        if(_logs.size() >= _limit) {
-            size_t num = _logs.size() - _limit;
-            for(size_t i = 0; i <= num; ++i) {
-                _logs.pop_front();
-            }
-        }
-        _logs.push_back(tmp);
-        fwrite(msg, 1, len, stdout);
+    static LogPusher* GetInstance() {
+        static LogPusher* pusher = Create();
+        return pusher;
+    }
+
+    void Subscribe(const std::shared_ptr<net::ProgressiveAttachment>& attachment) {
+        Stream stream;
+        stream.attachment = attachment;
+        stream.seq = 0;
+        std::string events;
+        AppendLogEvent(&stream.seq, &events);
+        attachment->Write(events.data(), events.size());
+        std::lock_guard<std::mutex> guard(_mutex);
+        _streams.push_back(stream);
     }
 
-    static void log_to_browser(const char* msg, int len) {
-        std::string tmp(msg, len);
-        if(_logs.size() >= _limit) {
-            size_t num = _logs.size() - _limit;
-            for(size_t i = 0; i <= num; ++i) {
-                _logs.pop_front();
+    void take_sample() override {
+        const bool heartbeat = (++_ticks % kHeartbeatTicks == 0);
+        for(size_t i = 0; i < _streams.size();) {
+            Stream& stream = _streams[i];
+            uint64_t seq = stream.seq;
+            std::string events;
+            AppendLogEvent(&seq, &events);
+            if(events.empty() && heartbeat) {
+                net::AppendServerSentComment("", &events);
+            }
+            // Empty writes still fail once the page is gone.
+            if(stream.attachment->Write(events.data(), events.size()) == 0) {
+                stream.seq = seq;
+                ++i;
+            }
+            else if(errno == EAGAIN) {
+                // Sent again once drained, less the lines dropped meanwhile.
+                ++i;
+            }
+            else {
+                _streams[i] = _streams.back();
+                _streams.pop_back();
             }
-        }
-        _logs.push_back(tmp);
-        if(_file) {
-            _file->append(msg, len);
         }
     }
 
-    static void list_logs(std::deque<std::string>& out) {
-        out = _logs;
+private:
+    // About the interval proxies time idle connections out at.
+    static const int kHeartbeatTicks = 15;
+
+    struct Stream {
+        std::shared_ptr<net::ProgressiveAttachment> attachment;
+        // Lines logged before those to send next.
+        uint64_t seq;
+    };
+
+    LogPusher() : _ticks(0) {}
+
+    static LogPusher* Create() {
+        LogPusher* pusher = new LogPusher;
+        pusher->schedule();
+        return pusher;
     }
 
-    static void set_log_file(LogFile* file) {
-        _file = file;
+    // Appends the lines logged after `seq' as an event, if any, and moves
+    // `seq' past them.
+    static void AppendLogEvent(uint64_t* seq, std::string* out) {
+        std::vector<std::string> lines;
+        *seq = LogFilter::list_logs_since(*seq, &lines);
+        if(lines.empty()) {
+            return;
+        }
+        std::string data;
+        for(size_t i = 0; i < lines.size(); ++i) {
+            data += lines[i];
+        }
+        net::AppendServerSentEvent("log", data, out);
     }
 
-private:
-    static size_t _limit;
-    static std::deque<std::string> _logs;
-    static LogFile* _file;
+    std::vector<Stream> _streams;
+    int _ticks;
 };
 
-size_t LogFilter::_limit = 1024;
-std::deque<std::string> LogFilter::_logs;
-LogFile* LogFilter::_file = nullptr;
-
 const std::string LogFileSaveDir = program_work_dir("bin") + "data/log/";
 const size_t LogFileLimitSize = 64 * 1024 * 1024;
 const size_t LogFlushTimeInterval = 3;
@@ -95,6 +143,8 @@ LogService::LogService()
                 this, std::placeholders::_1, std::placeholders::_2));
     AddMethod("update", std::bind(&LogService::update,
                 this, std::placeholders::_1, std::placeholders::_2));
+    AddMethod("stream", std::bind(&LogService::stream,
+                this, std::placeholders::_1, std::placeholders::_2));
     if(FLAGS_enable_log) {
         std::string path = LogFileSaveDir;
         if(!DirReaderLinux::CreateDirectoryIfNotExists(path.c_str())) {
@@ -223,6 +273,11 @@ void LogService::update(net::HttpRequest* request,
     response->set_body(os);
 }
 
+void LogService::stream(net::HttpRequest* request,
+                        net::HttpResponse* response) {
+    LogPusher::GetInstance()->Subscribe(net::StartEventStream(response));
+}
+
 void LogService::default_method(net::HttpRequest* request,
                                 net::HttpResponse* response) {
     const Server* server = static_cast<Server*>(_owner);
@@ -288,19 +343,29 @@ void LogService::default_method(net::HttpRequest* request,
     }
 
     if(use_html) {
-        os << "<script>\n"
-            "function fetchData() {\n"
-                "$.ajax({\n"
-                "url: \"/log/update\",\n"
-                "type: \"GET\",\n"
-                "dataType: \"html\",\n"
-                "success: function(data) {\n"
-                "    $('#logs-content').html(data);\n"
-                "}\n"
+        // The lines pushed by /log/stream go on top, newest first, as many
+        // kept as LogFilter keeps.
+        os << "<pre id = \"logs-content\"></pre>\n"
+            "<script>\n"
+            "var logLines = 0;\n"
+            "var eventSource = new EventSource(\"/log/stream\");\n"
+            "eventSource.addEventListener('log', function(e) {\n"
+            "    var lines = e.data.split('\\n');\n"
+            "    var text = '';\n"
+            "    for (var i = lines.length - 1; i >= 0; --i) {\n"
+            "        text += lines[i] + '\\n';\n"
+            "    }\n"
+            "    var pre = document.getElementById('logs-content');\n"
+            "    var node = document.createTextNode(text);\n"
+            "    node.lines = lines.length;\n"
+            "    pre.insertBefore(node, pre.firstChild);\n"
+            "    logLines += node.lines;\n"
+            "    while (logLines > " << LogFilter::limit() << " && pre.lastChild != node) {\n"
+            "        logLines -= pre.lastChild.lines;\n"
+            "        pre.removeChild(pre.lastChild);\n"
+            "    }\n"
             "});\n"
-        "}\n"
-        "setInterval(fetchData, 1000);\n"
-        "</script>\n";
+            "</script>\n";
     }
     else {
         std::deque<std::string> logs;
@@ -317,11 +382,7 @@ void LogService::default_method(net::HttpRequest* request,
     }
 
     if(use_html) {
-        os << "<pre id = \"logs-content\">\n";
-    }
-
-    if(use_html) {
-        os << "</pre></body></html>";
+        os << "</body></html>";
     }
     response->set_body(os);
 }
@@ -22,9 +22,70 @@
 
 #include "metric/builtin/service.h"
 #include "net/base/LogFile.h"
+#include <stdio.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace var {
 
+// Keeps the last lines logged, called by Logger from any thread.
+class LogFilter {
+public:
+    static void log_to_stdout(const char* msg, int len) {
+        append(msg, len);
+        fwrite(msg, 1, len, stdout);
+    }
+
+    static void log_to_browser(const char* msg, int len) {
+        append(msg, len);
+        if(_file) {
+            _file->append(msg, len);
+        }
+    }
+
+    static void list_logs(std::deque<std::string>& out) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        out = _logs;
+    }
+
+    // Appends the lines kept that were logged after the first `seq' lines
+    // to `out', oldest first. Returns the number of lines logged so far,
+    // the `seq' to go on from.
+    static uint64_t list_logs_since(uint64_t seq, std::vector<std::string>* out) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        const uint64_t first = _seq - _logs.size();
+        for(size_t i = (seq > first ? seq - first : 0); i < _logs.size(); ++i) {
+            out->push_back(_logs[i]);
+        }
+        return _seq;
+    }
+
+    static void set_log_file(LogFile* file) {
+        _file = file;
+    }
+
+    static size_t limit() { return _limit; }
+
+private:
+    static void append(const char* msg, int len) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        if(_logs.size() >= _limit) {
+            _logs.pop_front();
+        }
+        _logs.emplace_back(msg, len);
+        ++_seq;
+    }
+
+    static size_t _limit;
+    static std::mutex _mutex;
+    static std::deque<std::string> _logs;
+    // Lines logged since start.
+    static uint64_t _seq;
+    static LogFile* _file;
+};
+
 class LogService : public Service {
 public:
     LogService();
@@ -42,6 +103,10 @@ public:
     void update(net::HttpRequest* request,
                 net::HttpResponse* response);
 
+    // Pushes the lines logged as Server-Sent Events, see LogPusher.
+    void stream(net::HttpRequest* request,
+                net::HttpResponse* response);
+
     void default_method(net::HttpRequest* request,
                         net::HttpResponse* response) override;
 
@@ -32,6 +32,7 @@ static void get_tcmalloc_memory_info(net::BufferStream& os) {
 }
 
 MemoryService::MemoryService() {
+    set_thread_safe(true);
     AddMethod("/memory", std::bind(&MemoryService::default_method,
         this, std::placeholders::_1, std::placeholders::_2));
 }
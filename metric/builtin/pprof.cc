@@ -0,0 +1,754 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include "metric/builtin/pprof.h"
+#include "metric/util/symbolizer.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+namespace var {
+
+// Same defaults as pprof.pl.
+static const size_t DOT_MAX_NODES = 80;
+static const double DOT_NODE_FRACTION = 0.005;
+static const double DOT_EDGE_FRACTION = 0.001;
+
+static const int FLAMEGRAPH_FRAME_HEIGHT = 16;
+static const int FLAMEGRAPH_FONT_SIZE = 12;
+static const int FLAMEGRAPH_PAD = 10;
+static const double FLAMEGRAPH_MIN_WIDTH = 0.1;
+
+typedef std::vector<std::pair<std::vector<uint64_t>, double> > RawSamples;
+
+static bool NoSkippedFrame(const std::string&) {
+    return false;
+}
+
+static bool IsAllocatorFrame(const std::string& name) {
+    static const char* const ALLOCATORS[] = {
+        "malloc", "calloc", "realloc", "free", "memalign", "posix_memalign",
+        "aligned_alloc", "valloc", "pvalloc", "operator new", "operator new[]",
+        "operator delete", "operator delete[]", "__libc_malloc", "__libc_calloc",
+        "__libc_realloc", "__libc_memalign"
+    };
+    for(size_t i = 0; i < sizeof(ALLOCATORS) / sizeof(ALLOCATORS[0]); ++i) {
+        if(name == ALLOCATORS[i]) {
+            return true;
+        }
+    }
+    return name.compare(0, 3, "tc_") == 0 ||
+           name.compare(0, 10, "tcmalloc::") == 0 ||
+           name.find("MallocHook") != std::string::npos;
+}
+
+static bool IsContentionFrame(const std::string& name) {
+    return name.compare(0, 16, "var::MutexLock::") == 0 ||
+           name.compare(0, 21, "var::MutexLockGuard::") == 0 ||
+           name.compare(0, 25, "var::ContentionProfiler::") == 0;
+}
+
+static bool StartsWith(const std::string& s, size_t pos, const char* prefix) {
+    return s.compare(pos, strlen(prefix), prefix) == 0;
+}
+
+// "00400000-00452000 r-xp ..."
+static bool IsMapsLine(const char* line) {
+    const char* p = line;
+    while(isxdigit(*p)) {
+        ++p;
+    }
+    return p != line && *p == '-';
+}
+
+// Splits "... @ 0x1 0x2 0x3" into the addresses after '@'.
+static bool ParseAddresses(const char* at, std::vector<uint64_t>* pcs) {
+    pcs->clear();
+    const char* p = at + 1;
+    while(*p) {
+        char* end = NULL;
+        const unsigned long long pc = strtoull(p, &end, 16);
+        if(end == p) {
+            break;
+        }
+        pcs->push_back(pc);
+        p = end;
+    }
+    return !pcs->empty();
+}
+
+Profile::Profile()
+    : _unit("samples")
+    , _is_skipped_frame(NoSkippedFrame) {
+}
+
+int Profile::Intern(const std::string& name) {
+    auto it = _ids.find(name);
+    if(it != _ids.end()) {
+        return it->second;
+    }
+    const int id = (int)_names.size();
+    _names.push_back(name);
+    _ids[name] = id;
+    return id;
+}
+
+void Profile::AddSample(const Stack& stack, double value) {
+    if(stack.empty()) {
+        return;
+    }
+    double& v = _stacks[stack];
+    v += value;
+}
+
+int Profile::Parse(const std::string& data, bool use_count, std::string* error) {
+    _stacks.clear();
+    if(StartsWith(data, 0, "heap profile:")) {
+        return ParseHeap(data, error);
+    }
+    if(StartsWith(data, 0, "--- contention")) {
+        return ParseContention(data, use_count, error);
+    }
+    return ParseCpu(data, error);
+}
+
+int Profile::ParseCpu(const std::string& data, std::string* error) {
+    // Header: 0, 3 (header words), 0 (version), sampling period, 0.
+    // Each record: count, depth, pc[depth]. Ends with 0, 1, 0.
+    const size_t nwords = data.size() / sizeof(uintptr_t);
+    std::vector<uintptr_t> words(nwords);
+    if(nwords > 0) {
+        memcpy(&words[0], data.data(), nwords * sizeof(uintptr_t));
+    }
+    if(nwords < 5 || words[0] != 0 || words[1] != 3) {
+        *error = "Unknown profile format";
+        return -1;
+    }
+    _unit = "samples";
+    _is_skipped_frame = NoSkippedFrame;
+    RawSamples samples;
+    size_t i = 2 + words[1];
+    bool finished = false;
+    while(i + 2 <= nwords) {
+        const uintptr_t count = words[i];
+        const uintptr_t depth = words[i + 1];
+        if(i + 2 + depth > nwords) {
+            break;
+        }
+        if(count == 0 && depth == 1 && words[i + 2] == 0) {
+            i += 3;
+            finished = true;
+            break;
+        }
+        samples.push_back(std::make_pair(
+            std::vector<uint64_t>(&words[i + 2], &words[i + 2] + depth), (double)count));
+        i += 2 + depth;
+    }
+    if(!finished) {
+        *error = "Truncated CPU profile";
+        return -1;
+    }
+    AddRawSamples(samples, data.substr(i * sizeof(uintptr_t)));
+    return 0;
+}
+
+int Profile::ParseHeap(const std::string& data, std::string* error) {
+    // heap profile:   10:  1048576 [   20:  2097152] @ heap_v2/524288
+    //      1:   524288 [    2:  1048576] @ 0x4005d6 0x400a1b
+    // MAPPED_LIBRARIES:
+    // 00400000-00452000 r-xp ...
+    _unit = "MB";
+    _is_skipped_frame = IsAllocatorFrame;
+    double sample_rate = 0;
+    const size_t first_end = data.find('\n');
+    const std::string header = data.substr(0, first_end);
+    const size_t v2 = header.find("@ heap_v2/");
+    if(v2 != std::string::npos) {
+        sample_rate = atof(header.c_str() + v2 + 10);
+    }
+    RawSamples samples;
+    std::string maps;
+    std::vector<uint64_t> pcs;
+    size_t pos = (first_end == std::string::npos ? data.size() : first_end + 1);
+    while(pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if(end == std::string::npos) {
+            end = data.size();
+        }
+        const std::string line(data, pos, end - pos);
+        pos = end + 1;
+        if(IsMapsLine(line.c_str())) {
+            maps.append(line).push_back('\n');
+            continue;
+        }
+        long long count = 0;
+        long long bytes = 0;
+        const char* at = strchr(line.c_str(), '@');
+        if(!at || sscanf(line.c_str(), " %lld: %lld", &count, &bytes) != 2 ||
+           !ParseAddresses(at, &pcs)) {
+            continue;
+        }
+        double value = (double)bytes;
+        if(sample_rate > 0 && count > 0 && bytes > 0) {
+            // Allocations are sampled with probability 1-exp(-size/rate).
+            const double ratio = ((double)bytes / count) / sample_rate;
+            value /= (1 - exp(-ratio));
+        }
+        samples.push_back(std::make_pair(pcs, value / (1024.0 * 1024.0)));
+    }
+    if(maps.empty()) {
+        *error = "No memory map in heap profile";
+        return -1;
+    }
+    AddRawSamples(samples, maps);
+    return 0;
+}
+
+int Profile::ParseContention(const std::string& data, bool use_count, std::string* error) {
+    // --- contention
+    // cycles/second=1000000000
+    // sampling period=1
+    // 123456 3 @ 0x4005d6 0x400a1b
+    // 00400000-00452000 r-xp ...
+    _unit = (use_count ? "contentions" : "seconds");
+    _is_skipped_frame = IsContentionFrame;
+    double cycles_per_second = 1;
+    // Only one in sampling_period waits was recorded.
+    double sampling_period = 1;
+    RawSamples samples;
+    std::string maps;
+    std::vector<uint64_t> pcs;
+    size_t pos = 0;
+    while(pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if(end == std::string::npos) {
+            end = data.size();
+        }
+        const std::string line(data, pos, end - pos);
+        pos = end + 1;
+        if(StartsWith(line, 0, "cycles/second=")) {
+            cycles_per_second = atof(line.c_str() + 14);
+            if(cycles_per_second <= 0) {
+                cycles_per_second = 1;
+            }
+            continue;
+        }
+        if(StartsWith(line, 0, "sampling period=")) {
+            sampling_period = atof(line.c_str() + 16);
+            if(sampling_period < 1) {
+                sampling_period = 1;
+            }
+            continue;
+        }
+        if(IsMapsLine(line.c_str())) {
+            maps.append(line).push_back('\n');
+            continue;
+        }
+        long long delay = 0;
+        long long count = 0;
+        const char* at = strchr(line.c_str(), '@');
+        if(!at || sscanf(line.c_str(), "%lld %lld", &delay, &count) != 2 ||
+           !ParseAddresses(at, &pcs)) {
+            continue;
+        }
+        samples.push_back(std::make_pair(
+            pcs, sampling_period * (use_count ? (double)count : delay / cycles_per_second)));
+    }
+    if(maps.empty()) {
+        *error = "No memory map in contention profile";
+        return -1;
+    }
+    AddRawSamples(samples, maps);
+    return 0;
+}
+
+void Profile::AddRawSamples(const RawSamples& samples, const std::string& maps) {
+    Symbolizer symbolizer(maps);
+    Stack stack;
+    for(size_t i = 0; i < samples.size(); ++i) {
+        const std::vector<uint64_t>& pcs = samples[i].first;
+        stack.clear();
+        for(size_t j = 0; j < pcs.size(); ++j) {
+            // Callers are return addresses, which may belong to the next
+            // line or even the next function.
+            const std::string& name = symbolizer.Symbolize(j == 0 ? pcs[j] : pcs[j] - 1);
+            if(stack.empty() && j + 1 < pcs.size() && _is_skipped_frame(name)) {
+                continue;
+            }
+            stack.push_back(Intern(name));
+        }
+        AddSample(stack, samples[i].second);
+    }
+}
+
+void Profile::Subtract(const Profile& base) {
+    Stack stack;
+    for(auto it = base._stacks.begin(); it != base._stacks.end(); ++it) {
+        stack.clear();
+        for(size_t i = 0; i < it->first.size(); ++i) {
+            stack.push_back(Intern(base._names[it->first[i]]));
+        }
+        AddSample(stack, -it->second);
+    }
+}
+
+double Profile::total() const {
+    double total = 0;
+    for(auto it = _stacks.begin(); it != _stacks.end(); ++it) {
+        total += it->second;
+    }
+    return total;
+}
+
+std::string Profile::FormatValue(double value) const {
+    char buf[32];
+    if(_unit == "MB") {
+        snprintf(buf, sizeof(buf), "%.1f", value);
+    }
+    else if(_unit == "seconds") {
+        snprintf(buf, sizeof(buf), "%.3f", value);
+    }
+    else {
+        snprintf(buf, sizeof(buf), "%.0f", value);
+    }
+    return buf;
+}
+
+static double Percent(double value, double total) {
+    return total == 0 ? 0 : value * 100 / total;
+}
+
+void Profile::WriteText(net::Buffer* out) const {
+    std::vector<double> flat(_names.size(), 0);
+    std::vector<double> cum(_names.size(), 0);
+    // Recursive functions count once per stack.
+    std::vector<const Stack*> seen(_names.size(), NULL);
+    for(auto it = _stacks.begin(); it != _stacks.end(); ++it) {
+        const Stack& stack = it->first;
+        flat[stack[0]] += it->second;
+        for(size_t i = 0; i < stack.size(); ++i) {
+            if(seen[stack[i]] != &stack) {
+                seen[stack[i]] = &stack;
+                cum[stack[i]] += it->second;
+            }
+        }
+    }
+    std::vector<int> ids;
+    for(size_t i = 0; i < _names.size(); ++i) {
+        if(flat[i] != 0 || cum[i] != 0) {
+            ids.push_back((int)i);
+        }
+    }
+    std::sort(ids.begin(), ids.end(), [&](int lhs, int rhs) {
+        if(fabs(flat[lhs]) != fabs(flat[rhs])) {
+            return fabs(flat[lhs]) > fabs(flat[rhs]);
+        }
+        if(fabs(cum[lhs]) != fabs(cum[rhs])) {
+            return fabs(cum[lhs]) > fabs(cum[rhs]);
+        }
+        return _names[lhs] < _names[rhs];
+    });
+    const double total = this->total();
+    std::string line = "Total: " + FormatValue(total) + " " + _unit + "\n";
+    out->append(line);
+    double sum = 0;
+    char buf[128];
+    for(size_t i = 0; i < ids.size(); ++i) {
+        const int id = ids[i];
+        sum += flat[id];
+        snprintf(buf, sizeof(buf), "%8s %5.1f%% %5.1f%% %8s %5.1f%% ",
+                 FormatValue(flat[id]).c_str(), Percent(flat[id], total),
+                 Percent(sum, total), FormatValue(cum[id]).c_str(),
+                 Percent(cum[id], total));
+        out->append(buf);
+        out->append(_names[id]);
+        out->append("\n");
+    }
+}
+
+static std::string DotEscape(const std::string& s) {
+    std::string escaped;
+    escaped.reserve(s.size());
+    for(size_t i = 0; i < s.size(); ++i) {
+        if(s[i] == '"' || s[i] == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(s[i]);
+    }
+    return escaped;
+}
+
+void Profile::WriteDot(const std::string& title, net::Buffer* out) const {
+    std::vector<double> flat(_names.size(), 0);
+    std::vector<double> cum(_names.size(), 0);
+    std::vector<const Stack*> seen(_names.size(), NULL);
+    double total_abs = 0;
+    for(auto it = _stacks.begin(); it != _stacks.end(); ++it) {
+        const Stack& stack = it->first;
+        total_abs += fabs(it->second);
+        flat[stack[0]] += it->second;
+        for(size_t i = 0; i < stack.size(); ++i) {
+            if(seen[stack[i]] != &stack) {
+                seen[stack[i]] = &stack;
+                cum[stack[i]] += it->second;
+            }
+        }
+    }
+
+    // Keeps the heaviest functions.
+    const double node_limit = total_abs * DOT_NODE_FRACTION;
+    std::vector<int> nodes;
+    for(size_t i = 0; i < _names.size(); ++i) {
+        if(fabs(cum[i]) > node_limit) {
+            nodes.push_back((int)i);
+        }
+    }
+    std::sort(nodes.begin(), nodes.end(), [&](int lhs, int rhs) {
+        return fabs(cum[lhs]) > fabs(cum[rhs]);
+    });
+    if(nodes.size() > DOT_MAX_NODES) {
+        nodes.resize(DOT_MAX_NODES);
+    }
+    std::vector<int> node_index(_names.size(), 0);
+    double max_flat = 0;
+    for(size_t i = 0; i < nodes.size(); ++i) {
+        node_index[nodes[i]] = (int)i + 1;
+        max_flat = std::max(max_flat, fabs(flat[nodes[i]]));
+    }
+
+    // Edges skip the dropped functions between two kept ones.
+    std::map<std::pair<int, int>, double> edges;
+    std::vector<int> kept;
+    std::vector<std::pair<int, int> > stack_edges;
+    for(auto it = _stacks.begin(); it != _stacks.end(); ++it) {
+        kept.clear();
+        for(size_t i = 0; i < it->first.size(); ++i) {
+            const int index = node_index[it->first[i]];
+            if(index != 0 && (kept.empty() || kept.back() != index)) {
+                kept.push_back(index);
+            }
+        }
+        stack_edges.clear();
+        for(size_t i = 0; i + 1 < kept.size(); ++i) {
+            stack_edges.push_back(std::make_pair(kept[i + 1], kept[i]));
+        }
+        std::sort(stack_edges.begin(), stack_edges.end());
+        stack_edges.erase(std::unique(stack_edges.begin(), stack_edges.end()),
+                          stack_edges.end());
+        for(size_t i = 0; i < stack_edges.size(); ++i) {
+            edges[stack_edges[i]] += it->second;
+        }
+    }
+
+    const double total = this->total();
+    const double edge_limit = total_abs * DOT_EDGE_FRACTION;
+    const std::string escaped_title = DotEscape(title);
+    std::string dot;
+    dot.append("digraph \"").append(escaped_title).append("; ")
+       .append(FormatValue(total)).append(" ").append(_unit).append("\" {\n");
+    dot.append("node [width=0.375,height=0.25];\n");
+    dot.append("Legend [shape=box,fontsize=24,shape=plaintext,label=\"")
+       .append(escaped_title).append("\\lTotal ").append(_unit).append(": ")
+       .append(FormatValue(total)).append("\\lDropped nodes with <= ")
+       .append(FormatValue(node_limit)).append(" abs(").append(_unit)
+       .append(")\\lDropped edges with <= ").append(FormatValue(edge_limit))
+       .append(" ").append(_unit).append("\\l\"];\n");
+    char buf[256];
+    for(size_t i = 0; i < nodes.size(); ++i) {
+        const int id = nodes[i];
+        std::string label = DotEscape(_names[id]);
+        size_t colons = 0;
+        while((colons = label.find("::", colons)) != std::string::npos) {
+            label.replace(colons, 2, "\\n");
+        }
+        snprintf(buf, sizeof(buf), "\\n%s (%.1f%%)\\r",
+                 FormatValue(flat[id]).c_str(), Percent(flat[id], total));
+        label.append(buf);
+        if(cum[id] != flat[id]) {
+            snprintf(buf, sizeof(buf), "of %s (%.1f%%)\\r",
+                     FormatValue(cum[id]).c_str(), Percent(cum[id], total));
+            label.append(buf);
+        }
+        const double font_size = 8 + (max_flat == 0 ? 0 : 50.0 * sqrt(fabs(flat[id]) / max_flat));
+        snprintf(buf, sizeof(buf), "N%d [label=\"", (int)i + 1);
+        dot.append(buf).append(label);
+        snprintf(buf, sizeof(buf), "\",shape=box,fontsize=%.1f];\n", font_size);
+        dot.append(buf);
+    }
+    for(auto it = edges.begin(); it != edges.end(); ++it) {
+        if(fabs(it->second) <= edge_limit) {
+            continue;
+        }
+        const double fraction = (total_abs == 0 ? 0 : fabs(it->second) / total_abs);
+        const double width = std::max(1.0, std::min(5.0, fraction * 10));
+        snprintf(buf, sizeof(buf),
+                 "N%d -> N%d [label=%s, weight=%d, style=\"setlinewidth(%.1f)\"];\n",
+                 it->first.first, it->first.second, FormatValue(it->second).c_str(),
+                 1 + (int)(fraction * 100), width);
+        dot.append(buf);
+    }
+    dot.append("}\n");
+    out->append(dot);
+}
+
+void Profile::WriteCollapsed(net::Buffer* out) const {
+    std::string line;
+    for(auto it = _stacks.begin(); it != _stacks.end(); ++it) {
+        const Stack& stack = it->first;
+        line.clear();
+        for(size_t i = stack.size(); i > 0; --i) {
+            line.append(_names[stack[i - 1]]);
+            line.push_back(i > 1 ? ';' : ' ');
+        }
+        line.append(FormatValue(it->second));
+        line.push_back('\n');
+        out->append(line);
+    }
+}
+
+void Profile::WriteFlameGraph(const std::string& title, int width, net::Buffer* out) const {
+    FlameGraph graph(title, _unit);
+    std::vector<const std::string*> frames;
+    for(auto it = _stacks.begin(); it != _stacks.end(); ++it) {
+        const Stack& stack = it->first;
+        frames.clear();
+        for(size_t i = stack.size(); i > 0; --i) {
+            frames.push_back(&_names[stack[i - 1]]);
+        }
+        graph.Add(frames, it->second);
+    }
+    graph.Write(width, out);
+}
+
+FlameGraph::FlameGraph(const std::string& title, const std::string& unit)
+    : _title(title)
+    , _unit(unit) {
+    Node root;
+    root.name = "all";
+    root.value = 0;
+    _nodes.push_back(root);
+}
+
+void FlameGraph::Add(const std::vector<const std::string*>& frames, double value) {
+    if(value <= 0) {
+        return;
+    }
+    size_t index = 0;
+    _nodes[0].value += value;
+    for(size_t i = 0; i < frames.size(); ++i) {
+        auto it = _nodes[index].children.find(*frames[i]);
+        if(it != _nodes[index].children.end()) {
+            index = it->second;
+        }
+        else {
+            const size_t child = _nodes.size();
+            _nodes[index].children[*frames[i]] = child;
+            Node node;
+            node.name = *frames[i];
+            node.value = 0;
+            _nodes.push_back(node);
+            index = child;
+        }
+        _nodes[index].value += value;
+    }
+}
+
+int FlameGraph::Depth(size_t index) const {
+    int depth = 0;
+    const Node& node = _nodes[index];
+    for(auto it = node.children.begin(); it != node.children.end(); ++it) {
+        depth = std::max(depth, Depth(it->second));
+    }
+    return depth + 1;
+}
+
+static void XmlEscape(const std::string& s, std::string* out) {
+    for(size_t i = 0; i < s.size(); ++i) {
+        switch(s[i]) {
+        case '<': out->append("&lt;"); break;
+        case '>': out->append("&gt;"); break;
+        case '&': out->append("&amp;"); break;
+        case '"': out->append("&quot;"); break;
+        default: out->push_back(s[i]); break;
+        }
+    }
+}
+
+// Same name, same color, in the "hot" palette of flamegraph.pl.
+static void FrameColor(const std::string& name, int* r, int* g, int* b) {
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < name.size(); ++i) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+    *r = 205 + (int)(50 * ((hash & 0xFF) / 255.0));
+    *g = (int)(230 * (((hash >> 8) & 0xFF) / 255.0));
+    *b = (int)(55 * (((hash >> 16) & 0xFF) / 255.0));
+}
+
+void FlameGraph::WriteNode(size_t index, int depth, double x, double scale,
+                           int height, net::Buffer* out) const {
+    const Node& node = _nodes[index];
+    const double width = node.value * scale;
+    if(width < FLAMEGRAPH_MIN_WIDTH) {
+        return;
+    }
+    const double y = height - FLAMEGRAPH_FONT_SIZE * 2 - FLAMEGRAPH_PAD -
+                     (depth + 1) * FLAMEGRAPH_FRAME_HEIGHT;
+    int r = 0;
+    int g = 0;
+    int b = 0;
+    FrameColor(node.name, &r, &g, &b);
+    std::string frame("<g class=\"func_g\" onmouseover=\"s(this)\" "
+                      "onmouseout=\"c()\" onclick=\"zoom(this)\">\n<title>");
+    XmlEscape(node.name, &frame);
+    char buf[256];
+    snprintf(buf, sizeof(buf), " (%.6g %s, %.2f%%)</title>",
+             node.value, _unit.c_str(), node.value * 100 / _nodes[0].value);
+    frame.append(buf);
+    snprintf(buf, sizeof(buf),
+             "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%d\" "
+             "data-x=\"%.1f\" data-w=\"%.1f\" fill=\"rgb(%d,%d,%d)\" rx=\"2\" ry=\"2\" />\n",
+             x, y, width, FLAMEGRAPH_FRAME_HEIGHT - 1, x, width, r, g, b);
+    frame.append(buf);
+    snprintf(buf, sizeof(buf), "<text x=\"%.1f\" y=\"%.1f\">", x + 3, y + 10.5);
+    frame.append(buf);
+    const size_t chars = (size_t)(width / (FLAMEGRAPH_FONT_SIZE * 0.59));
+    if(chars >= 3) {
+        if(node.name.size() > chars) {
+            XmlEscape(node.name.substr(0, chars - 2), &frame);
+            frame.append("..");
+        }
+        else {
+            XmlEscape(node.name, &frame);
+        }
+    }
+    frame.append("</text>\n</g>\n");
+    out->append(frame);
+
+    for(auto it = node.children.begin(); it != node.children.end(); ++it) {
+        WriteNode(it->second, depth + 1, x, scale, height, out);
+        x += _nodes[it->second].value * scale;
+    }
+}
+
+void FlameGraph::Write(int width, net::Buffer* out) const {
+    const int height = Depth(0) * FLAMEGRAPH_FRAME_HEIGHT +
+                       FLAMEGRAPH_FONT_SIZE * 5 + FLAMEGRAPH_PAD;
+    char buf[1024];
+    snprintf(buf, sizeof(buf),
+             "<svg version=\"1.1\" id=\"FlameGraph\" width=\"%d\" height=\"%d\" "
+             "viewBox=\"0 0 %d %d\" xmlns=\"http://www.w3.org/2000/svg\">\n"
+             "<style type=\"text/css\">\n"
+             "  .func_g:hover { stroke:black; stroke-width:0.5; cursor:pointer; }\n"
+             "  text { font-family:Verdana; font-size:%dpx; fill:rgb(0,0,0); }\n"
+             "</style>\n",
+             width, height, width, height, FLAMEGRAPH_FONT_SIZE);
+    out->append(buf);
+    snprintf(buf, sizeof(buf),
+             "<script type=\"text/ecmascript\">\n<![CDATA[\n"
+             "var fg_details, fg_unzoom;\n"
+             "var fg_width = %d, fg_pad = %d, fg_font = %d;\n",
+             width, FLAMEGRAPH_PAD, FLAMEGRAPH_FONT_SIZE);
+    out->append(buf);
+    out->append(
+        "function init(evt) {\n"
+        "  fg_details = document.getElementById(\"fg_details\").firstChild;\n"
+        "  fg_unzoom = document.getElementById(\"fg_unzoom\");\n"
+        "}\n"
+        "function s(node) {\n"
+        "  fg_details.nodeValue = \"Function: \" + node.getElementsByTagName(\"title\")[0].textContent;\n"
+        "}\n"
+        "function c() {\n"
+        "  fg_details.nodeValue = \" \";\n"
+        "}\n"
+        "function fg_attr(e, name) {\n"
+        "  return parseFloat(e.getAttribute(name));\n"
+        "}\n"
+        "function fg_place(g, x, w) {\n"
+        "  var r = g.getElementsByTagName(\"rect\")[0];\n"
+        "  var t = g.getElementsByTagName(\"text\")[0];\n"
+        "  var name = g.getElementsByTagName(\"title\")[0].textContent.replace(/ \\([^(]*\\)$/, \"\");\n"
+        "  var chars = Math.floor(w / (fg_font * 0.59));\n"
+        "  r.setAttribute(\"x\", x);\n"
+        "  r.setAttribute(\"width\", w);\n"
+        "  t.setAttribute(\"x\", x + 3);\n"
+        "  t.textContent = chars < 3 ? \"\" :\n"
+        "      (name.length > chars ? name.substring(0, chars - 2) + \"..\" : name);\n"
+        "  g.style.display = \"\";\n"
+        "}\n"
+        "function zoom(node) {\n"
+        "  var r = node.getElementsByTagName(\"rect\")[0];\n"
+        "  var x0 = fg_attr(r, \"data-x\"), w0 = fg_attr(r, \"data-w\"), y0 = fg_attr(r, \"y\");\n"
+        "  var ratio = (fg_width - 2 * fg_pad) / w0;\n"
+        "  var frames = document.getElementsByClassName(\"func_g\");\n"
+        "  for (var i = 0; i < frames.length; ++i) {\n"
+        "    var e = frames[i].getElementsByTagName(\"rect\")[0];\n"
+        "    var x = fg_attr(e, \"data-x\"), w = fg_attr(e, \"data-w\"), y = fg_attr(e, \"y\");\n"
+        "    if (y > y0) {\n"
+        "      // Callers of the zoomed frame fill the width.\n"
+        "      if (x <= x0 + 0.01 && x + w >= x0 + w0 - 0.01) {\n"
+        "        fg_place(frames[i], fg_pad, fg_width - 2 * fg_pad);\n"
+        "      } else {\n"
+        "        frames[i].style.display = \"none\";\n"
+        "      }\n"
+        "    } else if (x < x0 - 0.01 || x >= x0 + w0 - 0.01) {\n"
+        "      frames[i].style.display = \"none\";\n"
+        "    } else {\n"
+        "      fg_place(frames[i], fg_pad + (x - x0) * ratio, w * ratio);\n"
+        "    }\n"
+        "  }\n"
+        "  fg_unzoom.style.opacity = \"1.0\";\n"
+        "}\n"
+        "function unzoom() {\n"
+        "  var frames = document.getElementsByClassName(\"func_g\");\n"
+        "  for (var i = 0; i < frames.length; ++i) {\n"
+        "    var e = frames[i].getElementsByTagName(\"rect\")[0];\n"
+        "    fg_place(frames[i], fg_attr(e, \"data-x\"), fg_attr(e, \"data-w\"));\n"
+        "  }\n"
+        "  fg_unzoom.style.opacity = \"0.0\";\n"
+        "}\n"
+        "]]>\n</script>\n");
+    std::string title;
+    XmlEscape(_title, &title);
+    snprintf(buf, sizeof(buf),
+             "<rect x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" fill=\"rgb(245,245,220)\" />\n"
+             "<text text-anchor=\"middle\" x=\"%.1f\" y=\"%d\" style=\"font-size:%dpx\">",
+             width, height, width / 2.0, FLAMEGRAPH_FONT_SIZE * 2, FLAMEGRAPH_FONT_SIZE + 5);
+    out->append(buf);
+    out->append(title);
+    snprintf(buf, sizeof(buf),
+             "</text>\n"
+             "<text id=\"fg_unzoom\" x=\"%d\" y=\"%d\" onclick=\"unzoom()\" "
+             "style=\"opacity:0.0;cursor:pointer\">Reset Zoom</text>\n"
+             "<text id=\"fg_details\" x=\"%d\" y=\"%d\"> </text>\n",
+             FLAMEGRAPH_PAD, FLAMEGRAPH_FONT_SIZE * 2,
+             FLAMEGRAPH_PAD, height - FLAMEGRAPH_PAD);
+    out->append(buf);
+    if(_nodes[0].value > 0) {
+        const double scale = (width - 2 * FLAMEGRAPH_PAD) / _nodes[0].value;
+        WriteNode(0, 0, FLAMEGRAPH_PAD, scale, height, out);
+    }
+    out->append("</svg>\n");
+}
+
+}  // namespace var
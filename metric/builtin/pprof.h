@@ -0,0 +1,115 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#ifndef VAR_BUILTIN_PPROF_H
+#define VAR_BUILTIN_PPROF_H
+
+#include "net/Buffer.h"
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace var {
+
+// A symbolized profile, read from the formats pprof.pl understands:
+//   - binary CPU profiles of gperftools' ProfilerStart().
+//   - heap/growth profiles of MallocExtension (text, "heap profile: ...").
+//   - contention profiles of ContentionProfiler (text, "--- contention").
+// The memory map following the samples is used to symbolize the stacks
+// in-process, no perl or binutils is needed.
+class Profile {
+public:
+    Profile();
+
+    // Reads and symbolizes `data'. Contention profiles are weighted by
+    // the count of waits instead of the wait time if `use_count' is true.
+    // Returns 0 on success, -1 otherwise with the reason in `error'.
+    int Parse(const std::string& data, bool use_count, std::string* error);
+
+    // Subtracts the samples of `base' (like pprof --base).
+    void Subtract(const Profile& base);
+
+    // The unit of sample values, e.g. "samples" or "MB".
+    const std::string& unit() const { return _unit; }
+    double total() const;
+
+    // Like pprof --text: flat and cumulative value of each function.
+    void WriteText(net::Buffer* out) const;
+    // Like pprof --dot: the call graph in graphviz dot format.
+    void WriteDot(const std::string& title, net::Buffer* out) const;
+    // Like pprof --collapsed: "root;...;leaf value" per stack.
+    void WriteCollapsed(net::Buffer* out) const;
+    // SVG flame graph of `width' pixels.
+    void WriteFlameGraph(const std::string& title, int width, net::Buffer* out) const;
+
+private:
+    // Frames of the stack are function ids, leaf first.
+    typedef std::vector<int> Stack;
+
+    int Intern(const std::string& name);
+    void AddSample(const Stack& stack, double value);
+
+    int ParseCpu(const std::string& data, std::string* error);
+    int ParseHeap(const std::string& data, std::string* error);
+    int ParseContention(const std::string& data, bool use_count, std::string* error);
+    // Symbolizes the stacks of `samples' with the memory map in `maps'.
+    void AddRawSamples(const std::vector<std::pair<std::vector<uint64_t>, double> >& samples,
+                       const std::string& maps);
+    std::string FormatValue(double value) const;
+
+    std::string _unit;
+    // Leading frames of the profiler itself or the allocator are dropped.
+    bool (*_is_skipped_frame)(const std::string& name);
+    std::vector<std::string> _names;
+    std::unordered_map<std::string, int> _ids;
+    std::map<Stack, double> _stacks;
+};
+
+// Renders "root;...;leaf value" stacks as an SVG flame graph, a native
+// replacement of flamegraph.pl. The SVG has an init() to be called after
+// it's put in the page, frames are zoomed by clicking.
+class FlameGraph {
+public:
+    FlameGraph(const std::string& title, const std::string& unit);
+
+    // `frames' are root first, non-positive values are ignored.
+    void Add(const std::vector<const std::string*>& frames, double value);
+
+    void Write(int width, net::Buffer* out) const;
+
+private:
+    struct Node {
+        std::string name;
+        double value;
+        std::map<std::string, size_t> children;
+    };
+
+    void WriteNode(size_t index, int depth, double x, double scale,
+                   int height, net::Buffer* out) const;
+    int Depth(size_t index) const;
+
+    std::string _title;
+    std::string _unit;
+    std::vector<Node> _nodes;
+};
+
+}  // namespace var
+
+#endif  // VAR_BUILTIN_PPROF_H
@@ -1,13 +1,13 @@
 #include "metric/builtin/profiler_service.h"
 #include "metric/builtin/tcmalloc_extension.h"
-#include "metric/builtin/pprof_perl.h"
-#include "metric/builtin/flamegraph_perl.h"
+#include "metric/builtin/pprof.h"
 #include "metric/builtin/common.h"
 #include "metric/util/dir_reader_linux.h"
 #include "metric/util/file_reader_linux.h"
-#include "metric/util/cmd_reader_linux.h"
+#include "metric/util/time.h"
 #include "metric/server.h"
 #include "net/base/FileUtil.h"
+#include "net/base/ContentionProfiler.h"
 #include <stdlib.h>
 #include <unordered_map>
 #include <mutex>
@@ -20,13 +20,12 @@ extern "C" {
 namespace var {
 
 const std::string ProfilerFileSaveDir = program_work_dir("bin") + "data/profiler/";
-static const char* const PPROF_FILENAME = "pprof.pl";
-static const char* const FLAMEGRAPH_FILENAME = "flamegraph.pl";
-static std::once_flag g_written_pprof_perl;
-static std::once_flag g_written_flamegraph_perl;
 static int FLAMEGRAPH_DISPLAY_WIDTH = 1600;
 static int MAX_PROFILES_KEPT = 8;
 static int DEFAULT_PROFILING_SECONDS = 10;
+static int MAX_PROFILE_FILE_SIZE = 64 * 1024 * 1024;
+// Results of finished jobs can be polled within this time.
+static int64_t PROFILING_JOB_KEPT_US = 60 * 1000000L;
 
 // Set in ProfilerLinker.
 bool cpu_profiler_enabled = false;
@@ -68,7 +67,7 @@ static const char* ProfilingTypeNameToString(ProfilingType type) {
         case PROFILING_CPU: return "CPU性能分析";
         case PROFILING_HEAP: return "CPU内存分析";
         case PROFILING_GROWTH: return "CPU内存优化";
-        case PROFILING_CONTENTION: return "contention";
+        case PROFILING_CONTENTION: return "锁竞争分析";
         case PROFILING_IOBUF: return "iobuf";
     }
     return "unknown";
@@ -85,9 +84,8 @@ static const char* ProfilingTypePathToString(ProfilingType type) {
     return "unknown";
 }
 
-// NOTE: This function MUST be applied to all parameters finally passed to
-// system related functions (popen/system/exec ...) to avoid potential
-// injections from URL and other user inputs
+// NOTE: This function MUST be applied to all paths from URL and other
+// user inputs before they are opened.
 static bool VaildProfilePath(const std::string& path) {
     auto starts_with = [](const std::string& lhs, const std::string& rhs) -> bool {
         return ( lhs.length() >= rhs.length() && 
@@ -169,23 +167,6 @@ static bool WriteProfDataToFile(const char* file_path, const std::string& conten
     return true;
 }
 
-static std::string DisplayTypeToPProfArgument(DisplayType type) {
-    switch (type) {
-        case DisplayType::kDot: return " --dot ";
-        case DisplayType::kFlameGraph: return " --collapsed ";
-        case DisplayType::kText: return " --text ";
-        default: return " unknown type ";
-    }
-}
-
-static std::string GeneratePerlScriptPath(const std::string& filename) {
-    std::string path;
-    path.reserve(ProfilerFileSaveDir.size() + 1 + filename.size());
-    path += ProfilerFileSaveDir;
-    path += filename;
-    return path;
-}
-
 static const char* GetBaseName(const std::string* full_base_name) {
     if(!full_base_name) {
         return nullptr;
@@ -211,7 +192,11 @@ static const char* GetBaseName(const char* full_base_name) {
     return s.data() + offset;
 }
 
-ProfilerService::ProfilerService() {
+ProfilerService::ProfilerService() : _next_job_id(0) {
+    // Symbolizing and rendering profiles takes seconds.
+    set_blocking(true);
+    set_max_concurrency(4);
+    set_thread_safe(true);
     AddMethod("heap", std::bind(&ProfilerService::heap,
         this, std::placeholders::_1, std::placeholders::_2));
     AddMethod("heap_internal", std::bind(&ProfilerService::heap_internal,
@@ -224,9 +209,18 @@ ProfilerService::ProfilerService() {
         this, std::placeholders::_1, std::placeholders::_2));
     AddMethod("growth_internal", std::bind(&ProfilerService::growth_internal,
         this, std::placeholders::_1, std::placeholders::_2));
+    AddMethod("contention", std::bind(&ProfilerService::contention,
+        this, std::placeholders::_1, std::placeholders::_2));
+    AddMethod("contention_internal", std::bind(&ProfilerService::contention_internal,
+        this, std::placeholders::_1, std::placeholders::_2));
 }
 
 ProfilerService::~ProfilerService() {
+    if(_worker) {
+        // Empty job stops the worker.
+        _pending_jobs.put(ProfilingJobPtr());
+        _worker->join();
+    }
 }
 
 void ProfilerService::DisplayProfiling(net::HttpRequest* request,
@@ -283,41 +277,52 @@ void ProfilerService::DisplayProfiling(net::HttpRequest* request,
         return;
     }
 
-    // Build cmd sub process.
-    std::ostringstream cmd_builder;
-    std::string pprof_tool_path(GeneratePerlScriptPath(PPROF_FILENAME));
-    std::string flamegraph_tool_path(GeneratePerlScriptPath(FLAMEGRAPH_FILENAME));
-    cmd_builder << "perl " << pprof_tool_path
-                << DisplayTypeToPProfArgument(display_type)
-                << ((show_ccount || type == PROFILING_IOBUF) ? " --contention " : "");
+    std::string prof_data;
+    if(FileUtil::readFile<std::string>(prof_name, MAX_PROFILE_FILE_SIZE, &prof_data) != 0) {
+        os << "Fail to read " << prof_name << (use_html ? "</body></html>" : "\n");
+        response->header().set_status_code(net::HTTP_STATUS_INTERNAL_SERVER_ERROR);
+        response->set_body(os);
+        return;
+    }
+    // Symbolized in-process against the memory map saved in the profile.
+    const bool use_count = (show_ccount || type == PROFILING_IOBUF);
+    Profile profile;
+    std::string error;
+    if(profile.Parse(prof_data, use_count, &error) != 0) {
+        os << "Fail to parse " << prof_name << ": " << error
+           << (use_html ? "</body></html>" : "\n");
+        response->header().set_status_code(net::HTTP_STATUS_INTERNAL_SERVER_ERROR);
+        response->set_body(os);
+        return;
+    }
     if(base_name) {
-        cmd_builder << "--base " << *base_name << ' ';
-    }
-
-    cmd_builder << program_name() << " " << prof_name; 
-    if(display_type == DisplayType::kFlameGraph) {
-        // For flamegraph, we don't care about pprof error msg,
-        // which will cause confusing messages in the final result.
-        cmd_builder << " 2>/dev/null  | perl " <<  flamegraph_tool_path  << " --width " 
-                    << (FLAMEGRAPH_DISPLAY_WIDTH < 1200 ? 1200 : FLAMEGRAPH_DISPLAY_WIDTH);
-    }
-    cmd_builder << " 2>&1 ";
-    const std::string cmd = cmd_builder.str();
-
-    net::BufferStream pprof_output;
-    LOG_INFO << "Running cmd = " << cmd;
-    const int rc = ReadCommandOutput(pprof_output, cmd.c_str());
-    if(rc != 0) {
-        if(rc < 0) {
-            os << "Failed to execute '" << cmd << "',"
-                << (use_html ? "</body></html>" : "\n");
-            response->set_body(os);
+        std::string base_data;
+        Profile base;
+        if(FileUtil::readFile<std::string>(*base_name, MAX_PROFILE_FILE_SIZE, &base_data) != 0 ||
+           base.Parse(base_data, use_count, &error) != 0) {
+            os << "Fail to parse " << *base_name << ": " << error
+               << (use_html ? "</body></html>" : "\n");
             response->header().set_status_code(net::HTTP_STATUS_INTERNAL_SERVER_ERROR);
+            response->set_body(os);
             return;
         }
+        profile.Subtract(base);
     }
-    pprof_output.moveTo(prof_result);
-    
+    switch(display_type) {
+        case DisplayType::kDot:
+            profile.WriteDot(program_name(), &prof_result);
+            break;
+        case DisplayType::kFlameGraph:
+            profile.WriteFlameGraph(
+                ProfilingTypeNameToString(type),
+                FLAMEGRAPH_DISPLAY_WIDTH < 1200 ? 1200 : FLAMEGRAPH_DISPLAY_WIDTH,
+                &prof_result);
+            break;
+        default:
+            profile.WriteText(&prof_result);
+            break;
+    }
+
     // Cache result in file.
     char result_name[256];
     MakeCacheName(result_name, sizeof(result_name), prof_name,
@@ -359,6 +364,97 @@ void ProfilerService::DisplayProfiling(net::HttpRequest* request,
 void ProfilerService::DoProfiling(net::HttpRequest* request,
                                   net::HttpResponse* response,
                                   ProfilingType type) {
+    const std::string* job_id = request->header().url().GetQuery("job_id");
+    if(job_id) {
+        PollProfiling(strtoll(job_id->c_str(), NULL, 10), response, type);
+        return;
+    }
+    std::string key(ProfilingTypePathToString(type));
+    key.push_back('?');
+    key.append(request->header().url().query());
+
+    ProfilingJobPtr job;
+    bool created = false;
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        const int64_t now = gettimeofday_us();
+        for(auto it = _jobs.begin(); it != _jobs.end(); ) {
+            if(it->second->finished &&
+               now - it->second->finished_time_us > PROFILING_JOB_KEPT_US) {
+                it = _jobs.erase(it);
+                continue;
+            }
+            if(!it->second->finished && it->second->key == key) {
+                job = it->second;
+            }
+            ++it;
+        }
+        if(!job) {
+            job.reset(new ProfilingJob);
+            job->id = ++_next_job_id;
+            job->type = type;
+            job->key = key;
+            job->request = *request;
+            job->finished = false;
+            job->finished_time_us = 0;
+            _jobs[job->id] = job;
+            created = true;
+            if(!_worker) {
+                _worker.reset(new Thread(
+                    std::bind(&ProfilerService::RunProfilingJobs, this), "profiler"));
+                _worker->start();
+            }
+        }
+    }
+    if(created) {
+        _pending_jobs.put(job);
+    }
+    const std::string id = std::to_string(job->id);
+    response->header().set_status_code(net::HTTP_STATUS_ACCEPTED);
+    response->header().set_content_type("text/plain");
+    response->header().SetHeader("Location", std::string("/profiler/") +
+        ProfilingTypePathToString(type) + "_internal?job_id=" + id);
+    response->set_body(id);
+}
+
+void ProfilerService::PollProfiling(int64_t job_id,
+                                    net::HttpResponse* response,
+                                    ProfilingType type) {
+    response->header().set_content_type("text/plain");
+    std::lock_guard<std::mutex> guard(_mutex);
+    auto it = _jobs.find(job_id);
+    if(it == _jobs.end() || it->second->type != type) {
+        response->header().set_status_code(net::HTTP_STATUS_NOT_FOUND);
+        response->set_body("Unknown profiling job " + std::to_string(job_id));
+        return;
+    }
+    const ProfilingJob& job = *it->second;
+    if(!job.finished) {
+        response->header().set_status_code(net::HTTP_STATUS_ACCEPTED);
+        response->set_body(std::to_string(job_id));
+        return;
+    }
+    response->header().set_status_code(job.response.header().status_code());
+    response->header().set_content_type(job.response.header().content_type());
+    response->set_body(job.response.body());
+}
+
+void ProfilerService::RunProfilingJobs() {
+    while(true) {
+        ProfilingJobPtr job = _pending_jobs.take();
+        if(!job) {
+            break;
+        }
+        RunProfiling(&job->request, &job->response, job->type);
+        std::lock_guard<std::mutex> guard(_mutex);
+        job->finished = true;
+        job->finished_time_us = gettimeofday_us();
+    }
+}
+
+void ProfilerService::RunProfiling(net::HttpRequest* request,
+                                   net::HttpResponse* response,
+                                   ProfilingType type) {
     const Server* server = static_cast<Server*>(_owner);
     const bool use_html = UseHTML(request->header());
     response->header().set_content_type(use_html ? "text/html" : "text/plain");
@@ -456,6 +552,36 @@ void ProfilerService::DoProfiling(net::HttpRequest* request,
         usleep(seconds * 1000000L);
         ProfilerStop();
     }
+    else if(type == PROFILING_CONTENTION) {
+        // Waits shorter than min_wait_ns are not recorded, and only one in
+        // sampling_period contended locks of a thread is sampled.
+        int64_t min_wait_ns = 0;
+        const std::string* min_wait_str = request->header().url().GetQuery("min_wait_ns");
+        if(min_wait_str) {
+            min_wait_ns = strtoll(min_wait_str->c_str(), NULL, 10);
+        }
+        int sampling_period = 1;
+        const std::string* period_str = request->header().url().GetQuery("sampling_period");
+        if(period_str) {
+            sampling_period = atoi(period_str->c_str());
+        }
+        if(!ContentionProfiler::start(min_wait_ns, sampling_period)) {
+            os << "Another profiler (not via /profiler/contention) is running, try again later";
+            response->header().set_status_code(net::HTTP_STATUS_SERVICE_UNAVAILABLE);
+            response->set_body(os);
+            return;
+        }
+        usleep(seconds * 1000000L);
+        ContentionProfiler::stop();
+        std::string obj;
+        ContentionProfiler::dump(&obj);
+        if(!WriteProfDataToFile(prof_name.c_str(), obj)) {
+            os << "Fail to write " << prof_name;
+            response->header().set_status_code(net::HTTP_STATUS_FORBIDDEN);
+            response->set_body(os);
+            return;
+        }
+    }
     else {
         ///@todo other profiler type.
     }
@@ -490,6 +616,10 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
         // Default: export CPUPROFILE_FREQUENCY=100
         enabled = cpu_profiler_enabled;
     }
+    else if(type == PROFILING_CONTENTION) {
+        // Built in MutexLock, always available.
+        enabled = true;
+    }
     else {
         ///@todo other profiling type.
     }
@@ -548,41 +678,6 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
     }
     os << "</div>\n";
 
-    // Written pprof.pl and flamegraph.pl file into profiler.
-    bool pprof_tool_flag = true;
-    std::call_once(g_written_pprof_perl, [&pprof_tool_flag]() {
-        std::string pprof_tool_path = GeneratePerlScriptPath(PPROF_FILENAME);
-        FileReaderLinux pprof_file(pprof_tool_path.c_str(), "r");
-        if(pprof_file.get()) {
-            return;
-        }
-        if(!WriteProfDataToFile(pprof_tool_path.c_str(), pprof_perl())) {
-            pprof_tool_flag = false;
-        }
-    });
-    if(!pprof_tool_flag) {
-        os << "<pre>写入pprof.pl脚本文件失败</pre>\n";
-        response->set_body(os);
-        return;
-    }
-
-    bool flamegraph_tool_flag = true;
-    std::call_once(g_written_flamegraph_perl, [&flamegraph_tool_flag] () {
-        std::string flamegraph_tool_path = GeneratePerlScriptPath(FLAMEGRAPH_FILENAME);
-        FileReaderLinux flamegraph_file(flamegraph_tool_path.c_str(), "r");
-        if(flamegraph_file.get()) {
-            return;
-        }
-        if(!WriteProfDataToFile(flamegraph_tool_path.c_str(), flamegraph_perl())) {
-            flamegraph_tool_flag = false;
-        }
-    });
-    if(!flamegraph_tool_flag) {
-        os << "<pre>写入flamegraph.pl脚本文件失败</pre>\n";
-        response->set_body(os);
-        return;
-    }
-
     const char* type_path = ProfilingTypePathToString(type);
     const bool show_ccount = request->header().url().GetQuery("ccount");
     const std::string* view = request->header().url().GetQuery("view");
@@ -603,6 +698,11 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
     if(seconds_str) {
         seconds = std::stoi(*seconds_str);
     }
+    // Passed through to the contention profiling, printed as numbers only.
+    const std::string* min_wait_str = request->header().url().GetQuery("min_wait_ns");
+    const long long min_wait_ns = (min_wait_str ? strtoll(min_wait_str->c_str(), NULL, 10) : 0);
+    const std::string* period_str = request->header().url().GetQuery("sampling_period");
+    const int sampling_period = (period_str ? atoi(period_str->c_str()) : 0);
 
     ///@todo ProfilingClient used to cache ProfilingResult in multi-thread env.
     
@@ -617,7 +717,7 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
             "  var base_prof_el = document.getElementById('base_prof');\n"
             "  var base_prof = base_prof_el != null ? base_prof_el.value : '';\n"
             "  var display_type = document.getElementById('display_type').value;\n";
-        if(type == PROFILING_CPU) {
+        if(type == PROFILING_CPU || type == PROFILING_CONTENTION) {
             os << "  var seconds = document.getElementById('seconds').value;\n";
         }
         if(type == PROFILING_CONTENTION) {
@@ -631,7 +731,7 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
             "  if (base_prof != '') {\n"
             "    targetURL += '&base=' + base_prof;\n"
             "  }\n";
-        if(type == PROFILING_CPU) {
+        if(type == PROFILING_CPU || type == PROFILING_CONTENTION) {
             os <<
             " targetURL += '&seconds=' + seconds;\n";
         }
@@ -640,6 +740,12 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
             "  if (show_ccount) {\n"
             "    targetURL += '&ccount';\n"
             "  }\n";
+            if(min_wait_str) {
+                os << "  targetURL += '&min_wait_ns=" << min_wait_ns << "';\n";
+            }
+            if(period_str) {
+                os << "  targetURL += '&sampling_period=" << sampling_period << "';\n";
+            }
         }
         os << "  return targetURL;\n"
             "}\n"
@@ -689,8 +795,25 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
             "    $(\"#profiling-result\").html(xhr.responseText);\n"
             "    $(\"#profiling-prompt\").html('Profiling fail');\n"
             "  }\n"
+            // 202 carries the id of the running job, poll it until done.
+            "  function onJobReceived(data, textStatus, xhr) {\n"
+            "    if (xhr.status == 202) {\n"
+            "      setTimeout(function() { pollProfiling(data); }, 1000);\n"
+            "    } else {\n"
+            "      onDataReceived(data);\n"
+            "    }\n"
+            "  }\n"
+            "  function pollProfiling(job_id) {\n"
+            "    $.ajax({\n"
+            "      url: \"/profiler/" << type_path << "_internal?console=0&job_id=\" + job_id,\n"
+            "      type: \"GET\",\n"
+            "      dataType: \"html\",\n"
+            "      success: onJobReceived,\n"
+            "      error: onErrorReceived\n"
+            "    });\n"
+            "  }\n"
             "  $(\"#profiling-prompt\").html('Generating profile ";
-        if(type == PROFILING_CPU && !view) {
+        if((type == PROFILING_CPU || type == PROFILING_CONTENTION) && !view) {
             os << "for " << seconds << " seconds";
         }
         os << " ......');\n";
@@ -700,6 +823,12 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
         if(type == PROFILING_CPU || type == PROFILING_CONTENTION) {
             os << "&seconds=" << seconds;
         }
+        if(type == PROFILING_CONTENTION && min_wait_str) {
+            os << "&min_wait_ns=" << min_wait_ns;
+        }
+        if(type == PROFILING_CONTENTION && period_str) {
+            os << "&sampling_period=" << sampling_period;
+        }
         // if(profiling_client.id != 0) {
         //     os << "&profiling_id=" << profiling_client.id;
         // }
@@ -716,7 +845,7 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
         os << "\",\n"
             "    type: \"GET\",\n"
             "    dataType: \"html\",\n"
-            "    success: onDataReceived,\n"
+            "    success: onJobReceived,\n"
             "    error: onErrorReceived\n"
             "  });\n"
             // "});\n"
@@ -785,7 +914,14 @@ void ProfilerService::StartProfiling(net::HttpRequest* request,
     "<option value=text" << (display_type == DisplayType::kText ? " selected" : "") << ">文本</option>\n"
     "</select>\n";
 
-    if(type == PROFILING_CPU) {
+    if(type == PROFILING_CONTENTION) {
+        os << "<pre style='display:inline'>次数: </pre>"
+        "<input id='ccount_cb' type='checkbox'"
+        << (show_ccount ? " checked=''" : "") <<
+        " onclick='onChangedCB(this);'>\n";
+    }
+
+    if(type == PROFILING_CPU || type == PROFILING_CONTENTION) {
         std::vector<int> seconds_list = {10, 20, 30, 60};
         os << "<pre style='display:inline'>时长: </pre>"
         "<select id='seconds' onchange='onSelectProf()'>\n";
@@ -847,6 +983,16 @@ void ProfilerService::growth_internal(net::HttpRequest* request,
     return DoProfiling(request, response, PROFILING_GROWTH);
 }
 
+void ProfilerService::contention(net::HttpRequest* request,
+                                 net::HttpResponse* response) {
+    return StartProfiling(request, response, PROFILING_CONTENTION);
+}
+
+void ProfilerService::contention_internal(net::HttpRequest* request,
+                                          net::HttpResponse* response) {
+    return DoProfiling(request, response, PROFILING_CONTENTION);
+}
+
 void ProfilerService::GetTabInfo(TabInfoList* info_list) const {
     TabInfo* info = info_list->add();
     info->path = "/profiler/cpu";
@@ -859,6 +1005,10 @@ void ProfilerService::GetTabInfo(TabInfoList* info_list) const {
     info = info_list->add();
     info->path = "/profiler/growth";
     info->tab_name = ProfilingTypeNameToString(PROFILING_GROWTH);
+
+    info = info_list->add();
+    info->path = "/profiler/contention";
+    info->tab_name = ProfilingTypeNameToString(PROFILING_CONTENTION);
 }
 
 } // end namespace var
\ No newline at end of file
@@ -21,6 +21,11 @@
 #define VAR_BUILTIN_PROFILER_SERVICE_H
 
 #include "metric/builtin/service.h"
+#include "net/base/BlockingQueue.h"
+#include "net/base/Thread.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace var {
 
@@ -32,6 +37,10 @@ enum ProfilingType {
     PROFILING_IOBUF = 4,
 };
 
+// Profiling runs in a worker thread instead of the handler, the *_internal
+// methods return 202 with a job id at once and the result is polled by
+// /profiler/<type>_internal?job_id=<id>. Requests with the same query
+// share the running job.
 class ProfilerService : public Service {
 public:
     ProfilerService();
@@ -55,6 +64,12 @@ public:
     void growth_internal(net::HttpRequest* request,
                          net::HttpResponse* response);
 
+    void contention(net::HttpRequest* request,
+                    net::HttpResponse* response);
+
+    void contention_internal(net::HttpRequest* request,
+                             net::HttpResponse* response);
+
     void GetTabInfo(TabInfoList*) const override;
 
 private:
@@ -66,11 +81,39 @@ private:
                      net::HttpResponse* response,
                      ProfilingType type);
 
+    void RunProfiling(net::HttpRequest* request,
+                      net::HttpResponse* response,
+                      ProfilingType type);
+
     void DisplayProfiling(net::HttpRequest* request,
                           net::HttpResponse* response,
                           const char* prof_name,
                           net::Buffer& result_prefix,
                           ProfilingType type);
+
+    struct ProfilingJob {
+        int64_t id;
+        ProfilingType type;
+        // Type and query of the request, used to coalesce requests.
+        std::string key;
+        net::HttpRequest request;
+        net::HttpResponse response;
+        bool finished;
+        int64_t finished_time_us;
+    };
+    typedef std::shared_ptr<ProfilingJob> ProfilingJobPtr;
+
+    void PollProfiling(int64_t job_id,
+                       net::HttpResponse* response,
+                       ProfilingType type);
+
+    void RunProfilingJobs();
+
+    std::mutex _mutex;
+    int64_t _next_job_id;
+    std::unordered_map<int64_t, ProfilingJobPtr> _jobs;
+    BlockingQueue<ProfilingJobPtr> _pending_jobs;
+    std::unique_ptr<Thread> _worker;
 };
 
 } // end namespace var
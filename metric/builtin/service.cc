@@ -9,7 +9,10 @@ CommonStrings::CommonStrings()
 {}
 
 Service::Service() 
-    : _owner(nullptr) {
+    : _owner(nullptr)
+    , _blocking(false)
+    , _max_concurrency(0)
+    , _thread_safe(false) {
     AddMethod("default-method", std::bind(&Service::default_method,
                 this, std::placeholders::_1, std::placeholders::_2));
 }
@@ -34,6 +37,23 @@ Service::Method* Service::FindMethodByName(const std::string& method_name) const
     return const_cast<Method*>(&iter->second);
 }
 
+void Service::AddBodyReader(const std::string& method_name, const BodyReaderFactory& factory) {
+    if(method_name.empty()) return;
+    if(_body_reader_map.find(method_name) != _body_reader_map.end()) {
+        LOG_WARN << "Body reader of " << method_name << " has already add";
+        return;
+    }
+    _body_reader_map[method_name] = factory;
+}
+
+Service::BodyReaderFactory* Service::FindBodyReaderByName(const std::string& method_name) const {
+    BodyReaderMap::const_iterator iter = _body_reader_map.find(method_name);
+    if(iter == _body_reader_map.end()) {
+        return nullptr;
+    }
+    return const_cast<BodyReaderFactory*>(&iter->second);
+}
+
 void Service::default_method(net::HttpRequest* request, net::HttpResponse* response) {
     LOG_INFO << "wait for complete this func";
 }
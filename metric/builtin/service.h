@@ -40,11 +40,31 @@ class Service : public Tabbed {
 public:
     typedef std::function<void(net::HttpRequest*, net::HttpResponse*)> Method;
     typedef std::unordered_map<std::string, Method> MethodMap;
+    typedef std::function<net::ProgressiveReader*(net::HttpRequest*)> BodyReaderFactory;
+    typedef std::unordered_map<std::string, BodyReaderFactory> BodyReaderMap;
 
     explicit Service();
     virtual ~Service();
     void AddMethod(const std::string& method_name, const Method& method);
     Method* FindMethodByName(const std::string& method_name) const;
+    // Has the body of requests to `method_name' given to the reader returned
+    // by `factory' once the headers are parsed, rather than stored in the
+    // request. The method is called after the last part as usual.
+    void AddBodyReader(const std::string& method_name, const BodyReaderFactory& factory);
+    BodyReaderFactory* FindBodyReaderByName(const std::string& method_name) const;
+
+    // Has the methods run in the worker pool of the server rather than in
+    // the io loops, for methods that block or take long.
+    void set_blocking(bool blocking) { _blocking = blocking; }
+    bool blocking() const { return _blocking; }
+    // Requests to a blocking service beyond `max' queued or running are
+    // answered with 503, 0 for no limit.
+    void set_max_concurrency(int max) { _max_concurrency = max; }
+    int max_concurrency() const { return _max_concurrency; }
+    // Methods of a service that is not thread safe are never run at the
+    // same time, the server runs them one by one.
+    void set_thread_safe(bool thread_safe) { _thread_safe = thread_safe; }
+    bool thread_safe() const { return _thread_safe; }
     
     virtual void default_method(net::HttpRequest* request,
                                 net::HttpResponse* response);
@@ -55,6 +75,10 @@ public:
 
 private:
     MethodMap _method_map;
+    BodyReaderMap _body_reader_map;
+    bool _blocking;
+    int _max_concurrency;
+    bool _thread_safe;
 };
 
 } // end namespace var
@@ -2,9 +2,21 @@
 #include "metric/builtin/common.h"
 #include "metric/server.h"
 #include "metric/var.h"
+#include "metric/common.h"
+#include "metric/detail/sampler.h"
+#include "net/http/server_sent_events.h"
+#include "net/base/StringSplitter.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
 
 namespace var {
 
+VarsService::VarsService() {
+    set_thread_safe(true);
+}
+
 const bool FLAGS_quote_vector = true;
 
 // TODO(gejun): parameterize.
@@ -12,8 +24,9 @@ const bool FLAGS_quote_vector = true;
 // The idea: flot graphs were attached to plot-able bvar as the next <div>
 // when the html was generated. When user clicks a bvar, send a request to
 // server to get the value series of the bvar. When the response comes back,
-// plot and show the graph. Requests will be sent to server every 1 second
-// until user clicks the bvar and hide the graph.
+// plot and show the graph. The clicked bvars share one event stream, which
+// pushes the changes of their series every second until user clicks the
+// bvar and hide the graph, see VarsPusher.
 void PutVarsHeading(std::ostream& os, bool expand_all) {
     os << "<script language=\"javascript\" type=\"text/javascript\" src=\"/js/jquery_min\"></script>\n"
         "<script language=\"javascript\" type=\"text/javascript\" src=\"/js/flot_min\"></script>\n"
@@ -58,8 +71,10 @@ void PutVarsHeading(std::ostream& os, bool expand_all) {
         "var enabled = {}\n"
         // the bvar under cursor
         "var hovering_var = \"\"\n"
-        // timeout id of last server call.
-        "var timeoutId = {}\n"
+        // the stream of series of the enabled bvars.
+        "var eventSource = null\n"
+        // last series of the bvar, which the deltas are applied to.
+        "var lastSeries = {}\n"
         // last plot of the bvar.
         "var lastPlot = {}\n"
 
@@ -111,11 +126,10 @@ void PutVarsHeading(std::ostream& os, bool expand_all) {
         "    }\n"
         "    if (!enabled[var_name]) {\n"
         "      enabled[var_name] = true;\n"
-        "      fetchData(var_name);\n"
         "    } else {\n"
         "      enabled[var_name] = false;\n"
-        "      clearTimeout(timeoutId[var_name]);\n"
         "    }\n"
+        "    subscribe();\n"
         "  });\n"
        << (expand_all ?
         "  $(\".variable\").click();\n" :
@@ -184,43 +198,89 @@ void PutVarsHeading(std::ostream& os, bool expand_all) {
         "    return x;\n"
         "  }\n"
         "}\n"
-        // Get value series of bvar from server.
-        "function fetchData(var_name) {\n"
-        "  function onDataReceived(series) {\n"
-        "    if (hovering_var != var_name) {\n"
-        "      if (series.label == 'trend') {\n"
-        "        lastPlot[var_name] = $.plot(\"#\" + var_name, [series.data], trendOptions);\n"
-        "        $(\"#value-\" + var_name).html(series.data[series.data.length - 1][1]);\n"
-        "      } else if (series.label == 'cdf') {\n"
-        "        lastPlot[var_name] = $.plot(\"#\" + var_name, [series.data], cdfOptions);\n"
-        "        $(\"#value-\" + var_name).html(series.data[series.data.length - 1][1]);\n"
-        "      } else {\n"
-        "        lastPlot[var_name] = $.plot(\"#\" + var_name, series, trendOptions);\n"
+        // Plot the last series of bvar.
+        "function plotSeries(var_name) {\n"
+        "  var series = lastSeries[var_name];\n"
+        "  if (series == null || !enabled[var_name]) {\n"
+        "    return;\n"
+        "  }\n"
+        "  if (hovering_var != var_name) {\n"
+        "    if (series.label == 'trend') {\n"
+        "      lastPlot[var_name] = $.plot(\"#\" + var_name, [series.data], trendOptions);\n"
+        "      $(\"#value-\" + var_name).html(series.data[series.data.length - 1][1]);\n"
+        "    } else if (series.label == 'cdf') {\n"
+        "      lastPlot[var_name] = $.plot(\"#\" + var_name, [series.data], cdfOptions);\n"
+        "      $(\"#value-\" + var_name).html(series.data[series.data.length - 1][1]);\n"
+        "    } else {\n"
+        "      lastPlot[var_name] = $.plot(\"#\" + var_name, series, trendOptions);\n"
        << (var::FLAGS_quote_vector ?
-        "        var newValue = '\"[';\n" :
-        "        var newValue = '[';\n") <<
-        "        var i;\n"
-        "        for (i = 0; i < series.length; ++i) {\n"
-        "            if (i != 0) newValue += ',';\n"
-        "            var data = series[i].data;\n"
-        "            newValue += data[data.length - 1][1];\n"
-        "        }\n"
+        "      var newValue = '\"[';\n" :
+        "      var newValue = '[';\n") <<
+        "      var i;\n"
+        "      for (i = 0; i < series.length; ++i) {\n"
+        "          if (i != 0) newValue += ',';\n"
+        "          var data = series[i].data;\n"
+        "          newValue += data[data.length - 1][1];\n"
+        "      }\n"
        << (var::FLAGS_quote_vector ?
-        "        newValue += ']\"';\n" :
-        "        newValue += ']';\n") <<
-        "        $(\"#value-\" + var_name).html(newValue);\n"
+        "      newValue += ']\"';\n" :
+        "      newValue += ']';\n") <<
+        "      $(\"#value-\" + var_name).html(newValue);\n"
+        "    }\n"
+        "  }\n"
+        "}\n"
+        // Apply the ops of a delta event to the series, a section moved on
+        // by one point is [line,begin,length,point], other changed sections
+        // are [line,begin,[values]].
+        "function applyOps(series, ops) {\n"
+        "  var lines = $.isArray(series) ? series : [series];\n"
+        "  for (var i = 0; i < ops.length; ++i) {\n"
+        "    var op = ops[i];\n"
+        "    var data = lines[op[0]].data;\n"
+        "    var begin = op[1];\n"
+        "    var j;\n"
+        "    if (op.length == 4) {\n"
+        "      var last = begin + op[2] - 1;\n"
+        "      for (j = begin; j < last; ++j) {\n"
+        "        data[j][1] = data[j + 1][1];\n"
+        "      }\n"
+        "      data[last][1] = op[3];\n"
+        "    } else {\n"
+        "      for (j = 0; j < op[2].length; ++j) {\n"
+        "        data[begin + j][1] = op[2][j];\n"
         "      }\n"
         "    }\n"
         "  }\n"
-        "  $.ajax({\n"
-        "    url: \"/vars/\" + var_name + \"?series\",\n"
-        "    type: \"GET\",\n"
-        "    dataType: \"json\",\n"
-        "    success: onDataReceived\n"
-        "  });\n"
-        "  if (enabled[var_name]) {\n"
-        "    timeoutId[var_name] = setTimeout(function(){ fetchData(var_name); }, 1000);\n"
+        "}\n"
+        // Stream the series of the enabled bvars from server, reopened
+        // whenever the set of them changes.
+        "function subscribe() {\n"
+        "  if (eventSource != null) {\n"
+        "    eventSource.close();\n"
+        "    eventSource = null;\n"
         "  }\n"
+        "  var names = [];\n"
+        "  for (var var_name in enabled) {\n"
+        "    if (enabled[var_name]) {\n"
+        "      names.push(var_name);\n"
+        "    }\n"
+        "  }\n"
+        "  if (names.length == 0) {\n"
+        "    return;\n"
+        "  }\n"
+        "  eventSource = new EventSource(\"/vars/\" + names.join(';') + \"?stream\");\n"
+        "  eventSource.addEventListener('series', function(e) {\n"
+        "    var msg = JSON.parse(e.data);\n"
+        "    lastSeries[msg.name] = msg.series;\n"
+        "    plotSeries(msg.name);\n"
+        "  });\n"
+        "  eventSource.addEventListener('delta', function(e) {\n"
+        "    var msg = JSON.parse(e.data);\n"
+        "    if (lastSeries[msg.name] != null) {\n"
+        "      applyOps(lastSeries[msg.name], msg.ops);\n"
+        "      plotSeries(msg.name);\n"
+        "    }\n"
+        "  });\n"
         "}\n"
         "$(prepareGraphs);\n"
         "</script>\n";
@@ -275,8 +335,318 @@ private:
     bool _use_html;
 };
 
+// Describes the variables into the attachment a batch at a time, the next
+// batch once the previous one was taken, so a slow client holds the dump
+// back rather than having all of it queued.
+class VarsStreamer : public std::enable_shared_from_this<VarsStreamer> {
+public:
+    VarsStreamer(const std::shared_ptr<net::ProgressiveAttachment>& attachment,
+                 std::vector<std::string>* names, bool use_html,
+                 const var::DumpOptions& options, const std::string& tail)
+        : _attachment(attachment)
+        , _use_html(use_html)
+        , _options(options)
+        , _tail(tail)
+        , _index(0)
+        , _ndump(0) {
+        _names.swap(*names);
+    }
+
+    // Goes on in the loop thread once the headers are sent.
+    void Start() {
+        _attachment->set_writable_callback(
+            std::bind(&VarsStreamer::OnWritable, shared_from_this()));
+    }
+
+private:
+    static const size_t kBatchBytes = 64 * 1024;
+
+    void OnWritable() {
+        while(true) {
+            if(_batch.empty() && !NextBatch()) {
+                if(!_options.white_wildcards.empty() && _ndump == 0) {
+                    LOG_ERROR << "Failed to find any var by " << _options.white_wildcards;
+                }
+                // Drops the callback, and this with it.
+                _attachment->Close();
+                return;
+            }
+            if(_attachment->Write(std::move(_batch)) != 0) {
+                if(errno != EAGAIN) {
+                    _attachment->Close();
+                }
+                return;
+            }
+        }
+    }
+
+    bool NextBatch() {
+        net::BufferStream os;
+        VarsDumper dumper(os, _use_html);
+        std::ostringstream description;
+        while(_index < _names.size() && static_cast<size_t>(os.tellp()) < kBatchBytes) {
+            const std::string& name = _names[_index++];
+            description.str(std::string());
+            if(var::Variable::describe_exposed(name, description, _options.quote_string,
+                                                _options.display_filter) != 0) {
+                continue;
+            }
+            dumper.dump(name, description.str());
+            ++_ndump;
+        }
+        if(_index == _names.size() && !_tail.empty()) {
+            os << _tail;
+            _tail.clear();
+        }
+        net::Buffer buf;
+        os.moveTo(buf);
+        _batch.append(std::move(buf));
+        return !_batch.empty();
+    }
+
+    std::shared_ptr<net::ProgressiveAttachment> _attachment;
+    std::vector<std::string> _names;
+    bool _use_html;
+    var::DumpOptions _options;
+    std::string _tail;
+    size_t _index;
+    int _ndump;
+    net::IOBuf _batch;
+};
+
+void ParseSeriesValues(const std::string& series, SeriesValues* values) {
+    static const char kData[] = "\"data\":[";
+    size_t pos = 0;
+    while((pos = series.find(kData, pos)) != std::string::npos) {
+        pos += sizeof(kData) - 1;
+        values->emplace_back();
+        std::vector<std::string>& line = values->back();
+        while(pos < series.size() && series[pos] == '[') {
+            const size_t comma = series.find(',', pos);
+            const size_t end = series.find(']', pos);
+            if(comma == std::string::npos || end == std::string::npos || comma > end) {
+                values->clear();
+                return;
+            }
+            line.emplace_back(series, comma + 1, end - comma - 1);
+            pos = end + 1;
+            if(pos < series.size() && series[pos] == ',') {
+                ++pos;
+            }
+        }
+    }
+}
+
+bool DiffSeries(const SeriesValues& from, const SeriesValues& to,
+                std::string* ops) {
+    if(from.empty() || from.size() != to.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < to.size(); ++i) {
+        if(from[i].size() != to[i].size()) {
+            return false;
+        }
+    }
+    static const size_t kTrendSections[] = { 30, 24, 60, 60 };
+    static const size_t kTrendPoints = 174;
+    for(size_t i = 0; i < to.size(); ++i) {
+        const std::vector<std::string>& a = from[i];
+        const std::vector<std::string>& b = to[i];
+        std::vector<size_t> sections;
+        if(b.size() == kTrendPoints) {
+            sections.assign(kTrendSections, kTrendSections + 4);
+        }
+        else {
+            sections.push_back(b.size());
+        }
+        size_t begin = 0;
+        for(size_t j = 0; j < sections.size(); begin += sections[j++]) {
+            const size_t end = begin + sections[j];
+            if(std::equal(a.begin() + begin, a.begin() + end, b.begin() + begin)) {
+                continue;
+            }
+            if(!ops->empty()) {
+                ops->push_back(',');
+            }
+            *ops += '[' + std::to_string(i) + ',' + std::to_string(begin) + ',';
+            if(std::equal(a.begin() + begin + 1, a.begin() + end, b.begin() + begin)) {
+                *ops += std::to_string(sections[j]) + ',' + b[end - 1] + ']';
+                continue;
+            }
+            ops->push_back('[');
+            for(size_t k = begin; k < end; ++k) {
+                if(k != begin) {
+                    ops->push_back(',');
+                }
+                *ops += b[k];
+            }
+            *ops += "]]";
+        }
+    }
+    return true;
+}
+
+// Pushes the value series of the variables plotted by the vars page as the
+// sampler thread updates them, rather than having the page fetch every
+// series once a second. A stream gets the whole series of its variables
+// first, then each second only the sections that changed, as "delta"
+// events. Streams the page closed are dropped at the next tick.
+class VarsPusher : public detail::Sampler {
+public:
+    static VarsPusher* GetInstance() {
+        static VarsPusher* pusher = Create();
+        return pusher;
+    }
+
+    void Subscribe(const std::shared_ptr<net::ProgressiveAttachment>& attachment,
+                   const std::vector<std::string>& names) {
+        // Plotted at once, the series are sent again by the next tick which
+        // the deltas start from.
+        std::string events;
+        std::ostringstream os;
+        for(size_t i = 0; i < names.size(); ++i) {
+            os.str(std::string());
+            if(var::Variable::describe_series_exposed(names[i], os) == 0) {
+                AppendSeriesEvent("series", names[i], "series", os.str(), &events);
+            }
+        }
+        attachment->Write(events.data(), events.size());
+        Stream stream;
+        stream.attachment = attachment;
+        stream.names = names;
+        stream.synced = false;
+        std::lock_guard<std::mutex> guard(_mutex);
+        _streams.push_back(stream);
+    }
+
+    void take_sample() override {
+        if(_streams.empty()) {
+            _last.clear();
+            return;
+        }
+        // A series is described once however many streams show it.
+        std::map<std::string, Update> updates;
+        for(size_t i = 0; i < _streams.size(); ++i) {
+            for(size_t j = 0; j < _streams[i].names.size(); ++j) {
+                updates[_streams[i].names[j]];
+            }
+        }
+        std::map<std::string, SeriesValues> last;
+        std::ostringstream os;
+        for(auto it = updates.begin(); it != updates.end(); ++it) {
+            os.str(std::string());
+            if(var::Variable::describe_series_exposed(it->first, os) != 0) {
+                continue;
+            }
+            Update& update = it->second;
+            update.series = os.str();
+            SeriesValues& values = last[it->first];
+            ParseSeriesValues(update.series, &values);
+            auto prev = _last.find(it->first);
+            update.has_delta = prev != _last.end() &&
+                DiffSeries(prev->second, values, &update.delta);
+        }
+        _last.swap(last);
+        const bool heartbeat = (++_ticks % kHeartbeatTicks == 0);
+        for(size_t i = 0; i < _streams.size();) {
+            Stream& stream = _streams[i];
+            std::string events;
+            for(size_t j = 0; j < stream.names.size(); ++j) {
+                const std::string& name = stream.names[j];
+                const Update& update = updates[name];
+                if(update.series.empty()) {
+                    continue;
+                }
+                if(!stream.synced || !update.has_delta) {
+                    AppendSeriesEvent("series", name, "series", update.series, &events);
+                }
+                else if(!update.delta.empty()) {
+                    AppendSeriesEvent("delta", name, "ops", '[' + update.delta + ']', &events);
+                }
+            }
+            if(events.empty() && heartbeat) {
+                net::AppendServerSentComment("", &events);
+            }
+            // Empty writes still fail once the page is gone.
+            if(stream.attachment->Write(events.data(), events.size()) == 0) {
+                stream.synced = true;
+                ++i;
+            }
+            else if(errno == EAGAIN) {
+                // The deltas refused are lost, starts over once drained.
+                stream.synced = false;
+                ++i;
+            }
+            else {
+                _streams[i] = _streams.back();
+                _streams.pop_back();
+            }
+        }
+    }
+
+private:
+    // About the interval proxies time idle connections out at.
+    static const int kHeartbeatTicks = 15;
+
+    struct Stream {
+        std::shared_ptr<net::ProgressiveAttachment> attachment;
+        std::vector<std::string> names;
+        // False until the whole series were written, and again once a
+        // write was refused.
+        bool synced;
+    };
+
+    struct Update {
+        Update() : has_delta(false) {}
+        std::string series;
+        bool has_delta;
+        std::string delta;
+    };
+
+    VarsPusher() : _ticks(0) {}
+
+    static VarsPusher* Create() {
+        VarsPusher* pusher = new VarsPusher;
+        pusher->schedule();
+        return pusher;
+    }
+
+    // {"name":<name>,<field>:<value>}
+    static void AppendSeriesEvent(const char* event, const std::string& name,
+                                  const char* field, const std::string& value,
+                                  std::string* out) {
+        std::string data;
+        data.reserve(name.size() + value.size() + 32);
+        data += "{\"name\":\"";
+        data += name;
+        data += "\",\"";
+        data += field;
+        data += "\":";
+        data += value;
+        data += '}';
+        net::AppendServerSentEvent(event, data, out);
+    }
+
+    std::vector<Stream> _streams;
+    std::map<std::string, SeriesValues> _last;
+    int _ticks;
+};
+
 void VarsService::default_method(net::HttpRequest* request, 
                                  net::HttpResponse* response) {
+    if(request->header().url().GetQuery("stream") != nullptr) {
+        // The exact names of the vars, separated by ';'.
+        std::vector<std::string> names;
+        for(StringSplitter sp(request->header().unresolved_path(), ';'); sp; ++sp) {
+            names.emplace_back(sp.field(), sp.length());
+        }
+        if(names.empty()) {
+            LOG_ERROR << "No var to stream";
+            return;
+        }
+        VarsPusher::GetInstance()->Subscribe(net::StartEventStream(response), names);
+        return;
+    }
     if(request->header().url().GetQuery("series") != nullptr) {
         net::BufferStream os;
         const int rc = var::Variable::describe_series_exposed
@@ -329,13 +699,10 @@ void VarsService::default_method(net::HttpRequest* request,
             "  return '/vars/*' + text + '*';\n"
             "}\n"
             "function onDataReceived(searchText, data) {\n"
-            "  for (var var_name in enabled) {\n"
-            "    if (enabled[var_name]) {\n"
-            "      clearTimeout(timeoutId[var_name]);\n"
-            "    }\n"
-            "    enabled = {};\n"
-            "    everEnabled = {};\n"
-            "  }\n"
+            "  enabled = {};\n"
+            "  everEnabled = {};\n"
+            "  lastSeries = {};\n"
+            "  subscribe();\n"
             "  $(\".detail\").hide();\n"
             "  $('#layer1').html(data);\n"
             "  prepareGraphs();\n"
@@ -380,6 +747,23 @@ void VarsService::default_method(net::HttpRequest* request,
     options.display_filter = 
         (use_html ? var::DISPLAY_ON_HTML : var::DISPLAY_ON_PLAIN_TEXT);
     options.white_wildcards = request->header().unresolved_path();
+    WildcardMatcher white_matcher(options.white_wildcards, options.question_mark, true);
+    if(!white_matcher.wildcards().empty() || white_matcher.exact_names().empty()) {
+        // Going through all variables, sent in chunks as they're described.
+        std::vector<std::string> names;
+        var::Variable::list_exposed(&names, options.display_filter);
+        std::sort(names.begin(), names.end());
+        names.erase(std::remove_if(names.begin(), names.end(),
+                        [&white_matcher](const std::string& name) {
+                            return !white_matcher.match(name);
+                        }), names.end());
+        response->set_body(os);
+        std::shared_ptr<VarsStreamer> streamer(new VarsStreamer(
+            response->CreateProgressiveAttachment(), &names, use_html, options,
+            with_tabs ? "</div></body></html>" : ""));
+        streamer->Start();
+        return;
+    }
     const int ndump = var::Variable::dump_exposed(&dumper, &options);
     if(ndump < 0) {
         LOG_ERROR << "Failed to dump vars";
@@ -19,11 +19,31 @@
 #define VARS_BUILTIN_VARS_SERVICE_H
 
 #include "metric/builtin/service.h"
+#include <string>
+#include <vector>
 
 namespace var {
 
+// y of the [x,y] points of each "data" in the value series of a variable,
+// a line per data. Empty when the series is not in that shape.
+typedef std::vector<std::vector<std::string> > SeriesValues;
+
+void ParseSeriesValues(const std::string& series, SeriesValues* values);
+
+// Appends to `ops' how the values of `from' become those of `to', section by
+// section: the day, hour, minute and second of a trend, the whole line
+// otherwise. A section moved on by one point is
+//   [line,begin,length,new_point]
+// other changed sections are
+//   [line,begin,[values...]]
+// Returns false if the series changed shape, the values do not tell then.
+bool DiffSeries(const SeriesValues& from, const SeriesValues& to,
+                std::string* ops);
+
 class VarsService : public Service {
 public:
+    VarsService();
+
     void default_method(net::HttpRequest* request,
                         net::HttpResponse* response) override;
 
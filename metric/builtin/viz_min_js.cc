@@ -2,11 +2,15 @@
 
 namespace var {
 
-static net::Buffer* g_viz_min_js_buf = nullptr;
+static net::Buffer* NewVizMinJsBuf() {
+    net::Buffer* buf = new net::Buffer;
+    buf->append(viz_min_js());
+    return buf;
+}
 
 const net::Buffer& viz_min_js_buf() {
-    g_viz_min_js_buf = new net::Buffer;
-    g_viz_min_js_buf->append(viz_min_js());
+    // Made once, never deleted.
+    static const net::Buffer* g_viz_min_js_buf = NewVizMinJsBuf();
     return *g_viz_min_js_buf;
 }
 
@@ -26,7 +26,10 @@
 #include "metric/util/dir_reader_linux.h"
 #include "metric/util/cmd_reader_linux.h"
 #include "metric/passive_status.h"
+#include "metric/status.h"
 #include "metric/window.h"
+#include "metric/perf_counter.h"
+#include "metric/detail/sampler.h"
 
 #include <unistd.h>                        // getpagesize
 #include <fcntl.h>
@@ -34,6 +37,11 @@
 #include <sys/resource.h>                  // getrusage
 #include <dirent.h>                        // dirent
 #include <iomanip>                         // setw
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 
 namespace var {
 
@@ -744,6 +752,274 @@ void get_work_dir(std::ostream& os, void*) {
 }
 PassiveStatus<std::string> g_work_dir("process_work_dir", get_work_dir, NULL);
 
+// =============================================
+// Per-thread cpu and scheduler statistics, labeled by the thread name
+// set via var::Thread or prctl(PR_SET_NAME).
+struct ThreadStat {
+    pid_t tid;
+    char name[16];          // TASK_COMM_LEN
+    unsigned long utime;    // in clock ticks
+    unsigned long stime;    // in clock ticks
+    int processor;          // cpu the thread ran on last
+    long nvcsw;             // voluntary context switches
+    long nivcsw;            // involuntary context switches
+};
+
+// Read /proc/self/task/<tid>/stat, the comm field is inside parentheses
+// and may contain spaces, so fields are located after the last ')'.
+static bool read_thread_stat(const char* tid, ThreadStat* s) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%s/stat", tid);
+    FileReaderLinux fp(path, "r");
+    if(fp == NULL) {
+        // The thread may have already exited.
+        return false;
+    }
+    char line[1024];
+    if(!fgets(line, sizeof(line), fp)) {
+        return false;
+    }
+    const char* lparen = strchr(line, '(');
+    const char* rparen = strrchr(line, ')');
+    if(!lparen || !rparen || rparen < lparen) {
+        return false;
+    }
+    const size_t name_len = std::min<size_t>(rparen - lparen - 1,
+                                             sizeof(s->name) - 1);
+    memcpy(s->name, lparen + 1, name_len);
+    s->name[name_len] = '\0';
+    s->tid = atoi(tid);
+    // The 3rd field(state) follows ") ".
+    const char* p = rparen + 2;
+    int field = 3;
+    for(; *p && field < 39; ++field) {
+        if(field == 14) {
+            s->utime = strtoul(p, NULL, 10);
+        }
+        else if(field == 15) {
+            s->stime = strtoul(p, NULL, 10);
+        }
+        p = strchr(p, ' ');
+        if(!p) {
+            return false;
+        }
+        ++p;
+    }
+    if(field != 39 || !*p) {
+        return false;
+    }
+    s->processor = atoi(p);
+    return true;
+}
+
+// Prefer /proc/self/task/<tid>/sched, which is only present when the kernel
+// is built with CONFIG_SCHED_DEBUG, fallback to /proc/self/task/<tid>/status.
+static bool read_thread_switches(const char* tid, ThreadStat* s) {
+    char path[64];
+    char line[256];
+    snprintf(path, sizeof(path), "/proc/self/task/%s/sched", tid);
+    FileReaderLinux fp(path, "r");
+    int found = 0;
+    if(fp != NULL) {
+        while(found < 2 && fgets(line, sizeof(line), fp)) {
+            const char* colon = strchr(line, ':');
+            if(!colon) {
+                continue;
+            }
+            if(strncmp(line, "nr_voluntary_switches", 21) == 0) {
+                s->nvcsw = strtol(colon + 1, NULL, 10);
+                ++found;
+            }
+            else if(strncmp(line, "nr_involuntary_switches", 23) == 0) {
+                s->nivcsw = strtol(colon + 1, NULL, 10);
+                ++found;
+            }
+        }
+        return found == 2;
+    }
+    snprintf(path, sizeof(path), "/proc/self/task/%s/status", tid);
+    fp.reset(path, "r");
+    if(fp == NULL) {
+        return false;
+    }
+    while(found < 2 && fgets(line, sizeof(line), fp)) {
+        if(strncmp(line, "voluntary_ctxt_switches:", 24) == 0) {
+            s->nvcsw = strtol(line + 24, NULL, 10);
+            ++found;
+        }
+        else if(strncmp(line, "nonvoluntary_ctxt_switches:", 27) == 0) {
+            s->nivcsw = strtol(line + 27, NULL, 10);
+            ++found;
+        }
+    }
+    return found == 2;
+}
+
+// Reads all threads of the process in one pass every second and keeps
+// the per-second usages in exposed variables named
+// "thread_<name>_cpu_usage" and so on. A thread named like one already
+// exposed is suffixed with its tid, "thread_<name>_<tid>_cpu_usage", and
+// exposed threads are never relabeled while their names don't change.
+class ThreadStatSampler : public detail::Sampler {
+public:
+    struct ThreadVars {
+        std::string label;
+        ThreadStat last;
+        Status<double> cpu_usage;
+        Status<double> cpu_usage_user;
+        Status<double> cpu_usage_system;
+        Status<long> context_switches_voluntary_second;
+        Status<long> context_switches_involuntary_second;
+        Status<int> last_cpu;
+
+        void expose(const std::string& prefix) {
+            cpu_usage.expose_as(prefix, "cpu_usage");
+            cpu_usage_user.expose_as(prefix, "cpu_usage_user");
+            cpu_usage_system.expose_as(prefix, "cpu_usage_system");
+            context_switches_voluntary_second.expose_as(
+                prefix, "context_switches_voluntary_second");
+            context_switches_involuntary_second.expose_as(
+                prefix, "context_switches_involuntary_second");
+            last_cpu.expose_as(prefix, "last_cpu");
+        }
+    };
+
+    ThreadStatSampler()
+        : _ticks_per_second(sysconf(_SC_CLK_TCK))
+        , _last_sample_us(0) {}
+
+    void take_sample() override {
+        const int64_t now = gettimeofday_us();
+        std::vector<ThreadStat> stats;
+        DirReaderLinux dr("/proc/self/task");
+        if(!dr.IsValid()) {
+            LOG_WARN << "Fail to open /proc/self/task";
+            return;
+        }
+        while(dr.Next()) {
+            const char* tid = dr.name();
+            if(tid[0] < '0' || tid[0] > '9') {
+                continue;
+            }
+            ThreadStat s{};
+            if(read_thread_stat(tid, &s) && read_thread_switches(tid, &s)) {
+                stats.push_back(s);
+            }
+        }
+        const double interval_s = _last_sample_us ?
+            (now - _last_sample_us) / 1000000.0 : 0;
+        // Threads keep their variables while their names don't change,
+        // the others are labeled after them.
+        std::map<pid_t, std::unique_ptr<ThreadVars> > threads;
+        std::set<std::string> labels;
+        for(size_t i = 0; i < stats.size(); ++i) {
+            const ThreadStat& s = stats[i];
+            auto it = _threads.find(s.tid);
+            if(it != _threads.end() && strcmp(it->second->last.name, s.name) == 0) {
+                labels.insert(it->second->label);
+                threads[s.tid] = std::move(it->second);
+            }
+        }
+        // Hides the variables of exited and renamed threads before their
+        // labels are taken again.
+        _threads.clear();
+        for(size_t i = 0; i < stats.size(); ++i) {
+            const ThreadStat& s = stats[i];
+            std::unique_ptr<ThreadVars>& vars = threads[s.tid];
+            if(!vars) {
+                // New thread, or renamed after the last sample.
+                std::string label(s.name);
+                if(labels.count(label)) {
+                    label.push_back('_');
+                    label.append(std::to_string(s.tid));
+                }
+                labels.insert(label);
+                vars.reset(new ThreadVars);
+                vars->label = label;
+                vars->last = s;
+                vars->expose("thread_" + label);
+            }
+            if(interval_s > 0) {
+                const double ticks = interval_s * _ticks_per_second;
+                const double utime = s.utime - vars->last.utime;
+                const double stime = s.stime - vars->last.stime;
+                vars->cpu_usage.set_value((utime + stime) / ticks);
+                vars->cpu_usage_user.set_value(utime / ticks);
+                vars->cpu_usage_system.set_value(stime / ticks);
+                vars->context_switches_voluntary_second.set_value(
+                    (s.nvcsw - vars->last.nvcsw) / interval_s);
+                vars->context_switches_involuntary_second.set_value(
+                    (s.nivcsw - vars->last.nivcsw) / interval_s);
+            }
+            vars->last_cpu.set_value(s.processor);
+            vars->last = s;
+        }
+        _threads.swap(threads);
+        _last_sample_us = now;
+        std::ostringstream table;
+        write_table(table);
+        std::lock_guard<std::mutex> guard(_table_mutex);
+        _table = table.str();
+    }
+
+    // Called with the lock of the var map held, which take_sample() takes
+    // in expose() and hide() under _mutex, so only the table is locked.
+    void describe(std::ostream& os) {
+        std::lock_guard<std::mutex> guard(_table_mutex);
+        os << _table;
+    }
+
+private:
+    void write_table(std::ostream& os) const {
+        os << std::left << std::setw(8) << "tid" << std::setw(20) << "name"
+           << std::setw(8) << "cpu" << std::setw(8) << "user"
+           << std::setw(8) << "system" << std::setw(10) << "nvcsw/s"
+           << std::setw(10) << "nivcsw/s" << "last_cpu\n";
+        for(auto it = _threads.begin(); it != _threads.end(); ++it) {
+            const ThreadVars& v = *it->second;
+            os << std::setw(8) << it->first << std::setw(20) << v.last.name
+               << std::fixed << std::setprecision(3)
+               << std::setw(8) << v.cpu_usage.get_value()
+               << std::setw(8) << v.cpu_usage_user.get_value()
+               << std::setw(8) << v.cpu_usage_system.get_value()
+               << std::setw(10) << v.context_switches_voluntary_second.get_value()
+               << std::setw(10) << v.context_switches_involuntary_second.get_value()
+               << v.last_cpu.get_value() << '\n';
+        }
+    }
+
+    const long _ticks_per_second;
+    int64_t _last_sample_us;
+    std::map<pid_t, std::unique_ptr<ThreadVars> > _threads;
+    // The threads as of the last sample, what describe() shows.
+    std::mutex _table_mutex;
+    std::string _table;
+};
+
+static ThreadStatSampler* create_thread_stat_sampler() {
+    ThreadStatSampler* sampler = new ThreadStatSampler;
+    sampler->schedule();
+    return sampler;
+}
+static ThreadStatSampler* s_thread_stat_sampler = create_thread_stat_sampler();
+
+static void get_thread_stats(std::ostream& os, void*) {
+    s_thread_stat_sampler->describe(os);
+}
+PassiveStatus<std::string> g_thread_stats(
+    "process_thread_stats", get_thread_stats, NULL);
+
+// Opened during static initialization so that threads created afterwards
+// are counted as well. Exposed only when perf events are available.
+static PerfCounter* create_process_perf_counter() {
+    PerfCounter* counter = new PerfCounter(PERF_SCOPE_PROCESS);
+    if(counter->available()) {
+        counter->expose("process_perf");
+    }
+    return counter;
+}
+static PerfCounter* s_process_perf_counter = create_process_perf_counter();
+
 #undef VAR_MEMBER_TYPE
 #undef VAR_DEFINE_PROC_STAT_FIELD
 #undef VAR_DEFINE_PROC_STAT_FIELD2
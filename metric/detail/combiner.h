@@ -23,8 +23,8 @@
 #include "metric/util/linked_list.h"
 #include "metric/util/type_traits.h"
 #include "net/base/Logging.h"
+#include "net/base/Mutex.h"
 #include <atomic>
-#include <mutex>
 
 namespace var {
 namespace detail {
@@ -69,24 +69,24 @@ class ElementContainer {
 template<typename> friend class GlobalValue;
 public:
     void load(T* out) {
-        std::lock_guard<std::mutex> guard(_mutex);
+        MutexLockGuard guard(_mutex);
         *out = _value;
     }
 
     void store(const T& new_value) {
-        std::lock_guard<std::mutex> guard(_mutex);
+        MutexLockGuard guard(_mutex);
         _value = new_value;
     }
 
     void exchange(T* prev, const T& new_value) {
-        std::lock_guard<std::mutex> guard(_mutex);
+        MutexLockGuard guard(_mutex);
         *prev = _value;
         _value = new_value;
     }
 
     template<typename Op, typename T1>
     void modify(const Op& op, const T1& value2) {
-        std::lock_guard<std::mutex> guard(_mutex);
+        MutexLockGuard guard(_mutex);
         call_or_returning_void(op, _value, value2);
     }
 
@@ -108,7 +108,8 @@ public:
 
 private:
     T _value;
-    std::mutex _mutex;
+    // MutexLock rather than std::mutex to show in contention profiles.
+    MutexLock _mutex;
 };
 
 template<typename T>
@@ -239,7 +240,7 @@ public:
     // [ThreadSafe] May be called from anywhere.
     ResultTp combine_agents() const {
         ElementTp tls_value;
-        std::lock_guard guard(_mutex);
+        MutexLockGuard guard(_mutex);
         ResultTp ret = _global_result;
         for(LinkNode<Agent>* node = _agents.head(); node != _agents.end(); node = node->next()) {
             node->value()->element.load(&tls_value);
@@ -251,7 +252,7 @@ public:
     // [ThreadSafe] May be called from anywhere.
     ResultTp reset_all_agents() {
         ElementTp prev;
-        std::lock_guard guard(_mutex);
+        MutexLockGuard guard(_mutex);
         ResultTp tmp = _global_result;
         _global_result = _result_identity;
         for(LinkNode<Agent>* node = _agents.head(); node != _agents.end(); node = node->next()) {
@@ -265,7 +266,7 @@ public:
     void commit_and_erase(Agent* agent) {
         if(!agent) return;
         ElementTp local;
-        std::lock_guard guard(_mutex);
+        MutexLockGuard guard(_mutex);
         agent->element.load(&local);
         call_or_returning_void(_op, _global_result, local);
         agent->RemoveFromList();
@@ -275,7 +276,7 @@ public:
     void commit_and_clear(Agent* agent) {
         if(!agent) return;
         ElementTp prev;
-        std::lock_guard guard(_mutex);
+        MutexLockGuard guard(_mutex);
         agent->element.exchange(&prev, _element_identity);
         call_or_returning_void(_op, _global_result, prev);
     }
@@ -296,7 +297,7 @@ public:
         }
         agent->reset(_element_identity, this);
         {
-            std::lock_guard guard(_mutex);
+            MutexLockGuard guard(_mutex);
             _agents.Append(agent);
         }
         return agent;
@@ -306,7 +307,7 @@ public:
     // Set element to be default-constructed so that if its' non-pod,
     // internal allocations should be released.
     void clear_all_agents() {
-        std::lock_guard guard(_mutex);
+        MutexLockGuard guard(_mutex);
         for(LinkNode<Agent>* node = _agents.head(); node != _agents.end(); ) {
             node->value()->reset(ElementTp(), nullptr);
             LinkNode<Agent>* const saved_next = node->next();
@@ -336,7 +337,7 @@ private:
     ResultTp                _global_result;
     ResultTp                _result_identity;
     ElementTp               _element_identity;
-    mutable std::mutex      _mutex;
+    mutable MutexLock       _mutex;
     LinkedList<Agent>       _agents;
 };
 
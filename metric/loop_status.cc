@@ -0,0 +1,122 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include "metric/loop_status.h"
+#include "metric/util/time.h"
+#include "net/Channel.h"
+#include "net/EventLoop.h"
+#include "net/base/CurrentThread.h"
+#include "net/base/Timestamp.h"
+#include <algorithm>
+
+namespace var {
+
+static int get_loop_connections(void* arg) {
+    return static_cast<net::EventLoop*>(arg)->connectionCount();
+}
+
+static double get_loop_busy_ratio(void* arg) {
+    return static_cast<net::EventLoop*>(arg)->busyRatio();
+}
+
+LoopStatus::LoopVars::LoopVars(const std::string& prefix,
+                               const std::string& name,
+                               net::EventLoop* loop)
+    : connections(prefix, name + "_connections", get_loop_connections, loop)
+    , busy_ratio(prefix, name + "_busy_ratio", get_loop_busy_ratio, loop) {
+}
+
+LoopStatus::LoopStatus(const std::string& prefix, net::EventLoopThreadPool* pool) {
+    const std::vector<net::EventLoop*> loops = pool->getAllLoops();
+    for (size_t i = 0; i < loops.size(); ++i) {
+        _loops.emplace_back(new LoopVars(prefix, "loop" + std::to_string(i), loops[i]));
+    }
+}
+
+// Enough to tell a handful of stalls apart.
+static const size_t MAX_SLOWEST_CALLBACKS = 8;
+
+LoopMetrics::LoopMetrics(const std::string& prefix)
+    : _wait(prefix, "loop_wait")
+    , _busy(prefix, "loop_busy")
+    , _events(prefix, "loop_events")
+    , _events_per_iteration(prefix, "loop_events_per_iteration")
+    , _functor_queue(prefix, "loop_functor_queue")
+    , _functors(prefix, "loop_functors")
+    , _timer_lateness(prefix, "loop_timer_lateness")
+    , _callback(prefix, "loop_callback")
+    , _slowest_threshold_us(0)
+    , _slowest_status(prefix, "loop_slowest_callbacks", describe_slowest, this) {
+}
+
+void LoopMetrics::onIteration(int64_t wait_us, int64_t busy_us, int num_events) {
+    _wait << wait_us;
+    _busy << busy_us;
+    _events << num_events;
+    _events_per_iteration << num_events;
+}
+
+void LoopMetrics::onChannelHandled(const net::Channel* channel, int64_t us) {
+    _callback << us;
+    if (us <= _slowest_threshold_us) {
+        return;
+    }
+    SlowCallback slow = { us, channel->reventsToString(), gettimeofday_us() };
+    MutexLockGuard guard(_slowest_mutex);
+    auto it = std::upper_bound(_slowest.begin(), _slowest.end(), slow,
+                               [](const SlowCallback& a, const SlowCallback& b) {
+                                   return a.us > b.us;
+                               });
+    _slowest.insert(it, slow);
+    if (_slowest.size() > MAX_SLOWEST_CALLBACKS) {
+        _slowest.pop_back();
+    }
+    if (_slowest.size() == MAX_SLOWEST_CALLBACKS) {
+        _slowest_threshold_us = _slowest.back().us;
+    }
+}
+
+void LoopMetrics::onPendingFunctors(size_t num_functors, int64_t us) {
+    _functor_queue << static_cast<int64_t>(num_functors);
+    _functors << us;
+}
+
+void LoopMetrics::onTimerExpired(int64_t lateness_us) {
+    _timer_lateness << lateness_us;
+}
+
+void LoopMetrics::describe_slowest(std::ostream& os, void* arg) {
+    LoopMetrics* m = static_cast<LoopMetrics*>(arg);
+    MutexLockGuard guard(m->_slowest_mutex);
+    for (size_t i = 0; i < m->_slowest.size(); ++i) {
+        const SlowCallback& slow = m->_slowest[i];
+        if (i != 0) {
+            os << ", ";
+        }
+        os << slow.us << "us fd " << slow.events << "at "
+           << Timestamp(slow.time_us).toFormattedString(false);
+    }
+}
+
+void EnableLoopMetrics(net::EventLoop* loop) {
+    loop->setObserver(std::unique_ptr<net::EventLoopObserver>(
+        new LoopMetrics(CurrentThread::name())));
+}
+
+}  // namespace var
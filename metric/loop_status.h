@@ -0,0 +1,118 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#ifndef VAR_LOOP_STATUS_H
+#define VAR_LOOP_STATUS_H
+
+#include "metric/passive_status.h"
+#include "metric/reducer.h"
+#include "metric/average_recorder.h"
+#include "metric/latency_recorder.h"
+#include "net/EventLoopObserver.h"
+#include "net/EventLoopThreadPool.h"
+#include "net/base/Mutex.h"
+#include <memory>
+#include <vector>
+
+namespace var {
+
+// Exposes the load of every loop of an EventLoopThreadPool, which is
+// what EventLoopThreadPool::setLoadBalancing() decides on:
+//   <prefix>_loop<i>_connections : TcpConnections in the i-th loop.
+//   <prefix>_loop<i>_busy_ratio  : fraction of the recent time the i-th
+//                                  loop spent handling instead of polling.
+// Example:
+//   server.start();
+//   var::LoopStatus loop_status("echo_server", get_pointer(server.threadPool()));
+// NOTE: Create it in the thread of the base loop after the pool is
+// started, the pool must outlive the LoopStatus.
+class LoopStatus {
+public:
+    LoopStatus(const std::string& prefix, net::EventLoopThreadPool* pool);
+
+private:
+    LoopStatus(const LoopStatus&) = delete;
+    void operator=(const LoopStatus&) = delete;
+
+    struct LoopVars {
+        LoopVars(const std::string& prefix, const std::string& name,
+                 net::EventLoop* loop);
+        PassiveStatus<int> connections;
+        PassiveStatus<double> busy_ratio;
+    };
+
+    std::vector<std::unique_ptr<LoopVars> > _loops;
+};
+
+// Opt-in instrumentation of one EventLoop, exposed under the name of the
+// loop thread (all times in microseconds):
+//   <thread>_loop_wait_*                : poll waits, a LatencyRecorder.
+//   <thread>_loop_busy_*                : handling time of each iteration.
+//   <thread>_loop_events                : active channels handled, an Adder.
+//   <thread>_loop_events_per_iteration  : active channels of each iteration.
+//   <thread>_loop_functor_queue         : functors run by each doPendingFunctors().
+//   <thread>_loop_functors_*            : time of running them.
+//   <thread>_loop_timer_lateness_*      : how late timers run.
+//   <thread>_loop_callback_*            : time of each channel callback.
+//   <thread>_loop_slowest_callbacks     : the slowest channel callbacks so far.
+// Enable it in the loop thread, e.g. for every io loop of a TcpServer:
+//   server.setThreadInitCallback([](net::EventLoop* loop) {
+//       var::EnableLoopMetrics(loop);
+//   });
+// A disabled loop only pays a branch per event.
+class LoopMetrics : public net::EventLoopObserver {
+public:
+    explicit LoopMetrics(const std::string& prefix);
+
+    void onIteration(int64_t wait_us, int64_t busy_us, int num_events) override;
+    void onChannelHandled(const net::Channel* channel, int64_t us) override;
+    void onPendingFunctors(size_t num_functors, int64_t us) override;
+    void onTimerExpired(int64_t lateness_us) override;
+
+private:
+    struct SlowCallback {
+        int64_t us;
+        std::string events;
+        int64_t time_us;
+    };
+    static void describe_slowest(std::ostream& os, void* arg);
+
+    LatencyRecorder _wait;
+    LatencyRecorder _busy;
+    Adder<int64_t> _events;
+    AverageRecorder _events_per_iteration;
+    AverageRecorder _functor_queue;
+    LatencyRecorder _functors;
+    LatencyRecorder _timer_lateness;
+    LatencyRecorder _callback;
+    // Sorted by us descending. Only the loop thread changes it, the
+    // threshold saves locking for fast callbacks.
+    int64_t _slowest_threshold_us;
+    mutable MutexLock _slowest_mutex;
+    std::vector<SlowCallback> _slowest;
+    PassiveStatus<std::string> _slowest_status;
+};
+
+// Instruments `loop' with a LoopMetrics named after the calling thread.
+// Must be called in the loop thread.
+void EnableLoopMetrics(net::EventLoop* loop);
+
+}  // namespace var
+
+#endif  // VAR_LOOP_STATUS_H
@@ -0,0 +1,281 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include "metric/perf_counter.h"
+#include "net/base/Logging.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#include <memory>
+
+namespace var {
+
+struct PerfEventAttrs {
+    uint32_t type;
+    uint64_t config;
+    const char* name;
+};
+
+static const PerfEventAttrs s_perf_events[PERF_EVENT_NUM] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache_misses" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context_switches" },
+};
+
+const char* PerfEventName(PerfEventType type) {
+    if(type < 0 || type >= PERF_EVENT_NUM) {
+        return "unknown";
+    }
+    return s_perf_events[type].name;
+}
+
+static int perf_event_open(perf_event_attr* attr, pid_t pid,
+                           int cpu, int group_fd, unsigned long flags) {
+    return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+namespace detail {
+
+PerfEventGroup::PerfEventGroup(PerfCounterScope scope)
+    : _scope(scope)
+    , _leader(-1)
+    , _nr(0) {
+    for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+        _fds[i] = -1;
+        _index[i] = -1;
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = s_perf_events[i].type;
+        attr.config = s_perf_events[i].config;
+        attr.disabled = 1;
+        // Counting user space only is allowed with perf_event_paranoid <= 2.
+        // Software events such as context switches happen in the kernel,
+        // they would always read 0 that way.
+        attr.exclude_kernel = (attr.type != PERF_TYPE_SOFTWARE);
+        attr.exclude_hv = 1;
+        int group_fd = -1;
+        if(scope == PERF_SCOPE_PROCESS) {
+            // Inherited counters can't be read as a group.
+            attr.inherit = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+        }
+        else {
+            attr.read_format = PERF_FORMAT_GROUP;
+            group_fd = _leader;
+        }
+        const int fd = perf_event_open(&attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+        if(fd < 0) {
+            LOG_DEBUG << "Fail to open perf event " << s_perf_events[i].name
+                      << ", errno=" << errno;
+            continue;
+        }
+        _fds[i] = fd;
+        _index[i] = _nr++;
+        if(scope == PERF_SCOPE_PROCESS) {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        else if(_leader < 0) {
+            _leader = fd;
+        }
+    }
+    if(_leader >= 0) {
+        ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfEventGroup::~PerfEventGroup() {
+    for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+        if(_fds[i] >= 0) {
+            close(_fds[i]);
+            _fds[i] = -1;
+        }
+    }
+}
+
+bool PerfEventGroup::available() const {
+    return _nr > 0;
+}
+
+void PerfEventGroup::read(int64_t* values) const {
+    memset(values, 0, sizeof(int64_t) * PERF_EVENT_NUM);
+    if(_scope == PERF_SCOPE_THREAD) {
+        if(_leader < 0) {
+            return;
+        }
+        // { u64 nr; u64 values[nr]; }
+        uint64_t buf[PERF_EVENT_NUM + 1];
+        const ssize_t nr = ::read(_leader, buf, sizeof(buf));
+        if(nr < (ssize_t)sizeof(uint64_t)) {
+            return;
+        }
+        for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+            if(_index[i] >= 0 && (uint64_t)_index[i] < buf[0]) {
+                values[i] = buf[_index[i] + 1];
+            }
+        }
+        return;
+    }
+    for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+        if(_fds[i] < 0) {
+            continue;
+        }
+        // { u64 value; u64 time_enabled; u64 time_running; }
+        uint64_t buf[3];
+        if(::read(_fds[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+            continue;
+        }
+        // Scale the value when the PMU was multiplexed between events.
+        if(buf[2] != 0 && buf[2] < buf[1]) {
+            values[i] = (int64_t)((double)buf[0] * buf[1] / buf[2]);
+        }
+        else {
+            values[i] = buf[0];
+        }
+    }
+}
+
+static thread_local std::unique_ptr<PerfEventGroup> tls_perf_event_group;
+
+PerfEventGroup* get_thread_perf_event_group() {
+    if(!tls_perf_event_group) {
+        tls_perf_event_group.reset(new PerfEventGroup(PERF_SCOPE_THREAD));
+    }
+    return tls_perf_event_group.get();
+}
+
+} // end namespace detail
+
+PerfCounter::PerfCounter(PerfCounterScope scope)
+    : _group(scope)
+    , _cycles(get_count<PERF_EVENT_CYCLES>, this)
+    , _instructions(get_count<PERF_EVENT_INSTRUCTIONS>, this)
+    , _cache_misses(get_count<PERF_EVENT_CACHE_MISSES>, this)
+    , _branch_misses(get_count<PERF_EVENT_BRANCH_MISSES>, this)
+    , _context_switches(get_count<PERF_EVENT_CONTEXT_SWITCHES>, this)
+    , _cycles_second(&_cycles)
+    , _instructions_second(&_instructions)
+    , _cache_misses_second(&_cache_misses)
+    , _branch_misses_second(&_branch_misses)
+    , _context_switches_second(&_context_switches)
+    , _ipc(get_ipc, this) {
+}
+
+PerfCounter::PerfCounter(const std::string& prefix, PerfCounterScope scope)
+    : PerfCounter(scope) {
+    expose(prefix);
+}
+
+int PerfCounter::expose(const std::string& prefix) {
+    if(!_group.available()) {
+        LOG_WARN << "Perf events are unavailable, " << prefix << " is not exposed";
+        return -1;
+    }
+    PerSecondCount* windows[PERF_EVENT_NUM] = {
+        &_cycles_second, &_instructions_second, &_cache_misses_second,
+        &_branch_misses_second, &_context_switches_second
+    };
+    for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+        if(!_group.available(static_cast<PerfEventType>(i))) {
+            continue;
+        }
+        const std::string name = std::string(s_perf_events[i].name) + "_second";
+        if(windows[i]->expose_as(prefix, name) != 0) {
+            return -1;
+        }
+    }
+    if(_group.available(PERF_EVENT_CYCLES) &&
+       _group.available(PERF_EVENT_INSTRUCTIONS)) {
+        if(_ipc.expose_as(prefix, "ipc") != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void PerfCounter::hide() {
+    _cycles_second.hide();
+    _instructions_second.hide();
+    _cache_misses_second.hide();
+    _branch_misses_second.hide();
+    _context_switches_second.hide();
+    _ipc.hide();
+}
+
+int64_t PerfCounter::get_value(PerfEventType type) const {
+    int64_t values[PERF_EVENT_NUM];
+    _group.read(values);
+    return values[type];
+}
+
+int64_t PerfCounter::get_value_per_second(PerfEventType type) const {
+    switch(type) {
+    case PERF_EVENT_CYCLES:
+        return _cycles_second.get_value(1);
+    case PERF_EVENT_INSTRUCTIONS:
+        return _instructions_second.get_value(1);
+    case PERF_EVENT_CACHE_MISSES:
+        return _cache_misses_second.get_value(1);
+    case PERF_EVENT_BRANCH_MISSES:
+        return _branch_misses_second.get_value(1);
+    case PERF_EVENT_CONTEXT_SWITCHES:
+        return _context_switches_second.get_value(1);
+    default:
+        return 0;
+    }
+}
+
+double PerfCounter::ipc() const {
+    const int64_t cycles = get_value_per_second(PERF_EVENT_CYCLES);
+    if(cycles <= 0) {
+        return 0;
+    }
+    return (double)get_value_per_second(PERF_EVENT_INSTRUCTIONS) / cycles;
+}
+
+int PerfScopeRecorder::expose(const std::string& prefix) {
+    detail::PerfEventGroup* group = detail::get_thread_perf_event_group();
+    if(!group->available()) {
+        LOG_WARN << "Perf events are unavailable, " << prefix << " is not exposed";
+        return -1;
+    }
+    for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+        if(!group->available(static_cast<PerfEventType>(i))) {
+            continue;
+        }
+        if(_recorders[i].expose(prefix, s_perf_events[i].name) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void PerfScopeRecorder::hide() {
+    for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+        _recorders[i].hide();
+    }
+}
+
+} // end namespace var
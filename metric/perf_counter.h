@@ -0,0 +1,222 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#ifndef VAR_PERF_COUNTER_H
+#define VAR_PERF_COUNTER_H
+
+#include "metric/passive_status.h"
+#include "metric/window.h"
+#include "metric/latency_recorder.h"
+
+namespace var {
+
+enum PerfEventType {
+    PERF_EVENT_CYCLES = 0,
+    PERF_EVENT_INSTRUCTIONS = 1,
+    PERF_EVENT_CACHE_MISSES = 2,
+    PERF_EVENT_BRANCH_MISSES = 3,
+    PERF_EVENT_CONTEXT_SWITCHES = 4,
+    PERF_EVENT_NUM = 5
+};
+
+// Name used as the suffix of exposed variables, e.g. "cache_misses".
+const char* PerfEventName(PerfEventType type);
+
+enum PerfCounterScope {
+    // Counts the thread which creates the counter and all threads created
+    // by it afterwards, create it before starting threads (e.g. as a global)
+    // to cover the whole process.
+    PERF_SCOPE_PROCESS = 0,
+    // Counts the thread which creates the counter only.
+    PERF_SCOPE_THREAD = 1
+};
+
+namespace detail {
+
+// Counters opened by perf_event_open(2). Events which can't be opened,
+// e.g. no PMU inside a vm or perf_event_paranoid forbids, are left closed
+// and always read as 0, so callers never need to check availability.
+class PerfEventGroup {
+public:
+    explicit PerfEventGroup(PerfCounterScope scope);
+    ~PerfEventGroup();
+
+    bool available(PerfEventType type) const { return _fds[type] >= 0; }
+    // True if at least one event was opened.
+    bool available() const;
+
+    // Fill |values| with PERF_EVENT_NUM accumulated counts. Thread scoped
+    // groups are read within one syscall.
+    void read(int64_t* values) const;
+
+private:
+    PerfEventGroup(const PerfEventGroup&) = delete;
+    void operator=(const PerfEventGroup&) = delete;
+
+    PerfCounterScope _scope;
+    int _leader;
+    int _fds[PERF_EVENT_NUM];
+    // Position of each event in the PERF_FORMAT_GROUP read buffer.
+    int _index[PERF_EVENT_NUM];
+    int _nr;
+};
+
+// Group of the calling thread, opened on first use and closed when
+// the thread exits. Never returns NULL.
+PerfEventGroup* get_thread_perf_event_group();
+
+} // end namespace detail
+
+// Expose hardware counters of the process or of the creating thread.
+// It's not a Variable, but it contains multiple var inside.
+// Example:
+//   PerfCounter counter("io_loop", PERF_SCOPE_THREAD);
+//   // io_loop_cycles_second
+//   // io_loop_instructions_second
+//   // io_loop_cache_misses_second
+//   // io_loop_branch_misses_second
+//   // io_loop_context_switches_second
+//   // io_loop_ipc
+// The counters are sampled by the sampler thread every second and plotted
+// like other PerSecond variables. Events not available are not exposed.
+class PerfCounter {
+public:
+    explicit PerfCounter(PerfCounterScope scope = PERF_SCOPE_PROCESS);
+    explicit PerfCounter(const std::string& prefix,
+                         PerfCounterScope scope = PERF_SCOPE_PROCESS);
+    ~PerfCounter() { hide(); }
+
+    // Returns 0 on success, -1 if no event is available or on name conflict.
+    int expose(const std::string& prefix);
+    void hide();
+
+    bool available() const { return _group.available(); }
+    bool available(PerfEventType type) const { return _group.available(type); }
+
+    // Accumulated count of |type| since the counter was created.
+    int64_t get_value(PerfEventType type) const;
+    // Count of |type| per second in last second.
+    int64_t get_value_per_second(PerfEventType type) const;
+    // Instructions per cycle in last second, 0 if cycles are not counted.
+    double ipc() const;
+
+private:
+    template <int type>
+    static int64_t get_count(void* arg) {
+        return static_cast<PerfCounter*>(arg)->get_value(
+            static_cast<PerfEventType>(type));
+    }
+    static double get_ipc(void* arg) {
+        return static_cast<PerfCounter*>(arg)->ipc();
+    }
+
+    typedef PerSecond<PassiveStatus<int64_t> > PerSecondCount;
+
+    detail::PerfEventGroup _group;
+    PassiveStatus<int64_t> _cycles;
+    PassiveStatus<int64_t> _instructions;
+    PassiveStatus<int64_t> _cache_misses;
+    PassiveStatus<int64_t> _branch_misses;
+    PassiveStatus<int64_t> _context_switches;
+    PerSecondCount _cycles_second;
+    PerSecondCount _instructions_second;
+    PerSecondCount _cache_misses_second;
+    PerSecondCount _branch_misses_second;
+    PerSecondCount _context_switches_second;
+    PassiveStatus<double> _ipc;
+};
+
+// Records counter deltas of every PerfScope into LatencyRecorders, one
+// recorder per event, so that average/max/percentiles of e.g. cache misses
+// per call are available.
+// Example:
+//   PerfScopeRecorder g_read_perf("tcp_connection_handle_read");
+//   // tcp_connection_handle_read_cache_misses_cur
+//   // tcp_connection_handle_read_cache_misses_max
+//   // tcp_connection_handle_read_cache_misses_99
+//   // ...
+//   void handleRead() {
+//       PerfScope scope(&g_read_perf);
+//       ...
+//   }
+class PerfScopeRecorder {
+public:
+    PerfScopeRecorder() {}
+    explicit PerfScopeRecorder(const std::string& prefix) {
+        expose(prefix);
+    }
+    ~PerfScopeRecorder() { hide(); }
+
+    // Returns 0 on success, -1 if no event is available or on name conflict.
+    int expose(const std::string& prefix);
+    void hide();
+
+    PerfScopeRecorder& operator<<(const int64_t* deltas) {
+        for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+            _recorders[i] << deltas[i];
+        }
+        return *this;
+    }
+
+    const LatencyRecorder& recorder(PerfEventType type) const {
+        return _recorders[type];
+    }
+
+private:
+    LatencyRecorder _recorders[PERF_EVENT_NUM];
+};
+
+// Read counters of the calling thread at construction and destruction and
+// put the deltas into |recorder|. Costs one read(2) at both ends, nothing is
+// done if perf events are unavailable.
+class PerfScope {
+public:
+    explicit PerfScope(PerfScopeRecorder* recorder)
+        : _recorder(recorder)
+        , _group(detail::get_thread_perf_event_group()) {
+        if(_group->available()) {
+            _group->read(_start);
+        }
+        else {
+            _recorder = nullptr;
+        }
+    }
+    ~PerfScope() {
+        if(_recorder) {
+            int64_t end[PERF_EVENT_NUM];
+            _group->read(end);
+            for(int i = 0; i < PERF_EVENT_NUM; ++i) {
+                end[i] -= _start[i];
+            }
+            *_recorder << end;
+        }
+    }
+
+private:
+    PerfScope(const PerfScope&) = delete;
+    void operator=(const PerfScope&) = delete;
+
+    PerfScopeRecorder* _recorder;
+    detail::PerfEventGroup* _group;
+    int64_t _start[PERF_EVENT_NUM];
+};
+
+} // end namespace var
+
+#endif // VAR_PERF_COUNTER_H
@@ -10,6 +10,7 @@
 #include "metric/builtin/remote_sampler_service.h"
 #include "metric/builtin/profiler_service.h"
 #include "metric/builtin/memory_service.h"
+#include <algorithm>
 
 namespace var {
 
@@ -17,20 +18,41 @@ static Server* g_dummy_server = nullptr;
 static Thread* g_thread = nullptr;
 static InsideCmdCallback g_inside_cmd_callback;
 
+namespace {
+// Gives back the concurrency counted in DispatchRequest() however the
+// method returns, nullptr if nothing was counted.
+class ConcurrencyGuard {
+public:
+    explicit ConcurrencyGuard(std::atomic<int>* concurrency)
+        : _concurrency(concurrency) {}
+    ~ConcurrencyGuard() {
+        if(_concurrency) {
+            _concurrency->fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+private:
+    std::atomic<int>* _concurrency;
+};
+} // namespace
+
 bool IsDummyServerRunning() {
     return g_dummy_server != nullptr;
 }
 
-bool StartDummyServerAt(int port, ProfilerLinker) {
+bool StartDummyServerAt(int port, ProfilerLinker linker) {
+    return StartDummyServerAt(port, ServerOptions(), linker);
+}
+
+bool StartDummyServerAt(int port, const ServerOptions& options, ProfilerLinker) {
     if(port < 0 || port >= 65536) {
         LOG_ERROR << "Invalid port=" << port;
         return false;
     }
 
     if(!g_dummy_server) {
-        g_thread = new Thread([port](){
+        g_thread = new Thread([port, options](){
             net::InetAddress addr(port);
-            g_dummy_server = new Server(addr);
+            g_dummy_server = new Server(addr, options);
             g_dummy_server->Start();
         }, "dummy_server");
         g_thread->start();
@@ -57,17 +79,55 @@ void RegisterInsideCmdCallback(const InsideCmdCallback& cb) {
     g_inside_cmd_callback = cb;
 }
 
-Server::Server(const net::InetAddress& addr) 
-    : _addr(addr)
+ServerOptions::ServerOptions()
+    : num_threads(0)
+    , num_workers(0)
+    , enable_compression(true) {
+}
+
+Server::ServiceStatus::ServiceStatus(const std::string& service_name, bool expose)
+    : concurrency(0)
+    , concurrency_status(get_concurrency, this) {
+    if(expose) {
+        const std::string prefix = "dummy_server_" + service_name;
+        queue_time.expose(prefix + "_queue_time");
+        rejected.expose(prefix + "_rejected");
+        concurrency_status.expose(prefix + "_concurrency");
+    }
+}
+
+int Server::ServiceStatus::get_concurrency(void* arg) {
+    return static_cast<ServiceStatus*>(arg)->concurrency.load(std::memory_order_relaxed);
+}
+
+Server::Server(const net::InetAddress& addr, const ServerOptions& options) 
+    : _options(options)
+    , _addr(addr)
     , _server(&_loop, _addr, std::string("DummyServer"))
     , _tab_info_list(nullptr) {
     _server.SetHttpCallback(std::bind(&Server::ProcessRequest, this, _1, _2));
+    _server.SetHeaderCallback(std::bind(&Server::ProcessHeaders, this, _1));
+    _server.SetThreadNum(std::max(_options.num_threads, 0));
+    if(_options.num_workers > 0) {
+        // Unbounded, max_concurrency of the services bounds what's queued.
+        _worker_pool.reset(new ThreadPool("dummy_worker"));
+        _server.SetWorkerPool(_worker_pool.get(),
+                              std::bind(&Server::DispatchRequest, this, _1),
+                              std::bind(&Server::RejectRequest, this, _1));
+    }
+    if(_options.enable_compression) {
+        _server.EnableCompression();
+    }
 }
 
 Server::~Server() {
     _loop.quit();
 }
 
+void Server::Stop() {
+    _loop.quit();
+}
+
 void Server::Start() {
     if(!AddBuiltinService("js", new (std::nothrow) GetJsService)) {
         LOG_ERROR << "Failed to add GetJsService";
@@ -104,7 +164,7 @@ void Server::Start() {
     }
 
     if(g_inside_cmd_callback) {
-        Service* service = g_dummy_server->FindServiceByName("inside_cmd");
+        Service* service = FindServiceByName("inside_cmd");
         if(!service) {
             LOG_ERROR << "Inside cmd service has not registered";
         }
@@ -116,6 +176,9 @@ void Server::Start() {
     
     LOG_INFO << "Server is serving on port: " << _addr.port();
     LOG_INFO << "Check out http://" << _addr.toIpPort() << " in web browser";
+    if(_worker_pool) {
+        _worker_pool->start(_options.num_workers);
+    }
     _server.Start();
     _loop.loop();
 }
@@ -132,6 +195,7 @@ bool Server::AddBuiltinService(const std::string& service_name, Service* service
     service->_name = service_name;
     service->_owner = this;
     _service_map[service_name] = service;
+    _status_map[service_name].reset(new ServiceStatus(service_name, service->blocking()));
 
     // tabbed.
     // must called with -rtti.
@@ -170,6 +234,7 @@ bool Server::RemoveService(Service* service) {
         return false;
     }
     _service_map.erase(service_name);
+    _status_map.erase(service_name);
     return true;
 }
 
@@ -178,6 +243,19 @@ Service* Server::FindServiceByName(const std::string& service_name) const {
     return iter != _service_map.end() ? iter->second : nullptr;
 }
 
+Service* Server::FindServiceByUrl(const std::string& url_path) const {
+    StringSplitter splitter(url_path.c_str(), '/');
+    if(!splitter) {
+        return FindServiceByName("index");
+    }
+    return FindServiceByName(std::string(splitter.field(), splitter.length()));
+}
+
+Server::ServiceStatus* Server::FindServiceStatus(const Service* service) const {
+    auto iter = _status_map.find(service->_name);
+    return iter != _status_map.end() ? iter->second.get() : nullptr;
+}
+
 Service::Method* Server::FindMethodByUrl(const std::string& url_path, std::string* unresolved_path) const {
     StringSplitter splitter(url_path.c_str(), '/');
     if(!splitter) {
@@ -219,12 +297,74 @@ void Server::ProcessRequest(net::HttpRequest* request, net::HttpResponse* respon
     const std::string url_path = header.url().path();
     std::string unresolved_path;
     const Service::Method* method = FindMethodByUrl(url_path, &unresolved_path);
-    if(method) {
-        header.set_unresolved_path(unresolved_path);
+    const Service* service = FindServiceByUrl(url_path);
+    ServiceStatus* status = service ? FindServiceStatus(service) : nullptr;
+    // Counted in DispatchRequest() when dispatched to the workers.
+    const bool dispatched = status && _worker_pool && service->blocking();
+    ConcurrencyGuard concurrency_guard(dispatched ? &status->concurrency : nullptr);
+    if(!method) {
+        return;
+    }
+    header.set_unresolved_path(unresolved_path);
+    if(!status) {
+        (*method)(request, response);
+        return;
+    }
+    if(dispatched) {
+        status->queue_time << (Timestamp::now().microSecondsSinceEpoch() -
+                               request->received_time().microSecondsSinceEpoch());
+    }
+    if(service->thread_safe()) {
+        (*method)(request, response);
+    }
+    else {
+        std::lock_guard<std::mutex> guard(status->mutex);
         (*method)(request, response);
     }
 } 
 
+net::HttpDispatch Server::DispatchRequest(net::HttpRequest* request) {
+    const Service* service = FindServiceByUrl(request->header().url().path());
+    if(!service || !service->blocking()) {
+        return net::HTTP_DISPATCH_IN_LOOP;
+    }
+    ServiceStatus* status = FindServiceStatus(service);
+    const int concurrency = status->concurrency.fetch_add(1, std::memory_order_relaxed);
+    if(service->max_concurrency() > 0 && concurrency >= service->max_concurrency()) {
+        status->concurrency.fetch_sub(1, std::memory_order_relaxed);
+        status->rejected << 1;
+        return net::HTTP_DISPATCH_REJECT;
+    }
+    return net::HTTP_DISPATCH_IN_WORKER;
+}
+
+void Server::RejectRequest(net::HttpRequest* request) {
+    const Service* service = FindServiceByUrl(request->header().url().path());
+    ServiceStatus* status = service ? FindServiceStatus(service) : nullptr;
+    if(status) {
+        status->concurrency.fetch_sub(1, std::memory_order_relaxed);
+        status->rejected << 1;
+    }
+}
+
+void Server::ProcessHeaders(net::HttpRequest* request) {
+    // Only [service_name]/[method_name] reads bodies progressively.
+    const std::string& url_path = request->header().url().path();
+    StringSplitter splitter(url_path.c_str(), '/');
+    if(!splitter) {
+        return;
+    }
+    const Service* service = FindServiceByName(std::string(splitter.field(), splitter.length()));
+    if(!service || !++splitter) {
+        return;
+    }
+    Service::BodyReaderFactory* factory = 
+        service->FindBodyReaderByName(std::string(splitter.field(), splitter.length()));
+    if(factory) {
+        request->ReadProgressivelyBy((*factory)(request));
+    }
+}
+
 inline void tabs_li(std::ostream& os, const char* link,
                     const char* tab_name, const char* current_tab_name) {
     os << "<li id='" << link << '\'';
@@ -21,43 +21,104 @@
 #include "metric/builtin/service.h"
 #include "metric/builtin/tabbed.h"
 #include "metric/builtin/profiler_linker.h"
+#include "metric/latency_recorder.h"
+#include "metric/passive_status.h"
+#include "metric/reducer.h"
 #include "net/http/http_server.h"
 #include "net/base/Thread.h"
+#include "net/base/ThreadPool.h"
 #include "net/EventLoop.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace var {
 
+struct ServerOptions {
+    ServerOptions();
+
+    // Io loops besides the loop accepting connections, 0 handles the
+    // connections in that loop as well. Default: 0
+    int num_threads;
+
+    // Threads running the methods of blocking services, see
+    // Service::set_blocking(). 0 runs them in the io loops. Default: 0
+    // Set both to keep /vars answering while a long /profiler or
+    // /file_transfer request runs.
+    int num_workers;
+
+    // Compresses the responses with gzip/deflate when the client accepts
+    // it, see HttpServer::EnableCompression().
+    bool enable_compression;
+};
+
 // Server dispatches requests from web browser clients to registered
 // services and sends responses back to clients.
 class Server : public noncopyable {
 public:
     typedef std::unordered_map<std::string, Service*> ServiceMap;
 
-    explicit Server(const net::InetAddress& addr);
+    explicit Server(const net::InetAddress& addr,
+                    const ServerOptions& options = ServerOptions());
     virtual ~Server();
     
+    // Serves in the calling thread until Stop().
     void Start();
 
+    // Makes Start() return, callable from any thread.
+    void Stop();
+
     bool AddBuiltinService(const std::string& service_name, Service* service);
 
     bool RemoveService(Service* service);
 
     Service* FindServiceByName(const std::string& service_name) const;
 
+    // The service of [service_name]/..., index for the empty path.
+    Service* FindServiceByUrl(const std::string& url_path) const;
+
     Service::Method* FindMethodByUrl(const std::string& url_path, 
                                      std::string* unresolved_path) const;
 
     void PrintTabsBody(std::ostream& os, const char* current_tab_name) const;
 
 private:
+    // Runtime status of a service. Those of blocking services are exposed:
+    //   dummy_server_<service>_queue_time_* : microseconds from receiving
+    //                                         a request to running it.
+    //   dummy_server_<service>_concurrency  : requests queued or running.
+    //   dummy_server_<service>_rejected     : requests answered with 503.
+    struct ServiceStatus {
+        explicit ServiceStatus(const std::string& service_name, bool expose);
+        static int get_concurrency(void* arg);
+
+        std::atomic<int> concurrency;
+        // Serializes the methods of a service that is not thread safe.
+        std::mutex mutex;
+        LatencyRecorder queue_time;
+        Adder<int64_t> rejected;
+        PassiveStatus<int> concurrency_status;
+    };
+    typedef std::unordered_map<std::string, std::unique_ptr<ServiceStatus> > ServiceStatusMap;
+
     void ProcessRequest(net::HttpRequest* request, 
                         net::HttpResponse* response);
+    void ProcessHeaders(net::HttpRequest* request);
+    net::HttpDispatch DispatchRequest(net::HttpRequest* request);
+    // Gives back what DispatchRequest() counted when the workers can't
+    // take the request.
+    void RejectRequest(net::HttpRequest* request);
+    ServiceStatus* FindServiceStatus(const Service* service) const;
 
 private:    
     ServiceMap _service_map;
+    // Filled along with _service_map before serving, read-only afterwards.
+    ServiceStatusMap _status_map;
+    ServerOptions _options;
     net::InetAddress _addr;
-    net::HttpServer _server;
     net::EventLoop _loop;
+    net::HttpServer _server;
+    std::unique_ptr<ThreadPool> _worker_pool;
 
     // Store TabInfo of services inheriting Tabbed.
     TabInfoList* _tab_info_list;
@@ -73,6 +134,10 @@ bool IsDummyServerRunning();
 // Return 0 on success, -1 otherwise.
 bool StartDummyServerAt(int port, ProfilerLinker = ProfilerLinker());
 
+// Start a dummy server with io loops and workers as `options' says.
+bool StartDummyServerAt(int port, const ServerOptions& options,
+                        ProfilerLinker = ProfilerLinker());
+
 // *Used to update inside status data in builtin services.
 void UpdateInsideStatusData(const char* data, size_t len);
 
@@ -0,0 +1,346 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include "metric/util/symbolizer.h"
+#include "metric/util/fd_guard.h"
+
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <mutex>
+
+namespace var {
+
+struct ElfSymbolIndexEntry {
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    std::shared_ptr<const ElfSymbolIndex> index;
+};
+
+// Indexes are kept for the whole process, a profile only refers to the
+// binary and the shared libraries it loaded.
+static std::mutex s_index_mutex;
+static std::unordered_map<std::string, ElfSymbolIndexEntry>* s_indexes = NULL;
+
+std::shared_ptr<const ElfSymbolIndex> ElfSymbolIndex::Get(const std::string& path) {
+    fd_guard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if(fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return NULL;
+    }
+    std::lock_guard<std::mutex> guard(s_index_mutex);
+    if(!s_indexes) {
+        s_indexes = new std::unordered_map<std::string, ElfSymbolIndexEntry>;
+    }
+    ElfSymbolIndexEntry& entry = (*s_indexes)[path];
+    if(entry.index && entry.dev == st.st_dev && entry.ino == st.st_ino &&
+       entry.mtime == st.st_mtime) {
+        return entry.index;
+    }
+    std::shared_ptr<ElfSymbolIndex> index(new ElfSymbolIndex);
+    if(!index->Load(fd, st.st_size)) {
+        s_indexes->erase(path);
+        return NULL;
+    }
+    entry.dev = st.st_dev;
+    entry.ino = st.st_ino;
+    entry.mtime = st.st_mtime;
+    entry.index = index;
+    return index;
+}
+
+ElfSymbolIndex::~ElfSymbolIndex() {
+    if(_data) {
+        munmap(_data, _size);
+        _data = NULL;
+    }
+}
+
+bool ElfSymbolIndex::Load(int fd, size_t size) {
+    if(size < sizeof(ElfW(Ehdr))) {
+        return false;
+    }
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED) {
+        return false;
+    }
+    _data = data;
+    _size = size;
+    const char* base = static_cast<const char*>(data);
+    const ElfW(Ehdr)* ehdr = reinterpret_cast<const ElfW(Ehdr)*>(base);
+    if(memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+       ehdr->e_ident[EI_CLASS] != (sizeof(void*) == 8 ? ELFCLASS64 : ELFCLASS32)) {
+        return false;
+    }
+    if(ehdr->e_phoff + (uint64_t)ehdr->e_phnum * sizeof(ElfW(Phdr)) > size ||
+       ehdr->e_shoff + (uint64_t)ehdr->e_shnum * sizeof(ElfW(Shdr)) > size) {
+        return false;
+    }
+    const ElfW(Phdr)* phdrs = reinterpret_cast<const ElfW(Phdr)*>(base + ehdr->e_phoff);
+    for(int i = 0; i < ehdr->e_phnum; ++i) {
+        if(phdrs[i].p_type == PT_LOAD) {
+            Segment segment = { phdrs[i].p_offset, phdrs[i].p_vaddr, phdrs[i].p_filesz };
+            _segments.push_back(segment);
+        }
+    }
+
+    // .symtab is a superset of .dynsym, which is all left in stripped files.
+    const ElfW(Shdr)* shdrs = reinterpret_cast<const ElfW(Shdr)*>(base + ehdr->e_shoff);
+    const ElfW(Shdr)* symtab = NULL;
+    for(int i = 0; i < ehdr->e_shnum; ++i) {
+        if(shdrs[i].sh_type == SHT_SYMTAB) {
+            symtab = &shdrs[i];
+            break;
+        }
+        if(shdrs[i].sh_type == SHT_DYNSYM) {
+            symtab = &shdrs[i];
+        }
+    }
+    if(!symtab || symtab->sh_link >= ehdr->e_shnum ||
+       symtab->sh_offset + symtab->sh_size > size) {
+        return true;
+    }
+    const ElfW(Shdr)* strtab = &shdrs[symtab->sh_link];
+    if(strtab->sh_offset + strtab->sh_size > size || strtab->sh_size == 0) {
+        return true;
+    }
+    const char* strs = base + strtab->sh_offset;
+    const ElfW(Sym)* syms = reinterpret_cast<const ElfW(Sym)*>(base + symtab->sh_offset);
+    const size_t nsyms = symtab->sh_size / sizeof(ElfW(Sym));
+    _symbols.reserve(nsyms);
+    for(size_t i = 0; i < nsyms; ++i) {
+        const ElfW(Sym)& sym = syms[i];
+        const int type = ELF64_ST_TYPE(sym.st_info);
+        if((type != STT_FUNC && type != STT_GNU_IFUNC) ||
+           sym.st_shndx == SHN_UNDEF || sym.st_value == 0 ||
+           sym.st_name >= strtab->sh_size) {
+            continue;
+        }
+        Symbol symbol = { sym.st_value, sym.st_size, strs + sym.st_name };
+        _symbols.push_back(symbol);
+    }
+    std::stable_sort(_symbols.begin(), _symbols.end());
+    // Aliases share the address, keep the first sized one.
+    size_t n = 0;
+    for(size_t i = 0; i < _symbols.size(); ++i) {
+        if(n > 0 && _symbols[n - 1].address == _symbols[i].address) {
+            if(_symbols[n - 1].size == 0) {
+                _symbols[n - 1] = _symbols[i];
+            }
+            continue;
+        }
+        _symbols[n++] = _symbols[i];
+    }
+    _symbols.resize(n);
+    return true;
+}
+
+bool ElfSymbolIndex::OffsetToAddress(uint64_t offset, uint64_t* address) const {
+    for(size_t i = 0; i < _segments.size(); ++i) {
+        const Segment& segment = _segments[i];
+        if(offset >= segment.offset && offset < segment.offset + segment.size) {
+            *address = offset - segment.offset + segment.address;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ElfSymbolIndex::Lookup(uint64_t address) const {
+    Symbol key = { address, 0, NULL };
+    auto it = std::upper_bound(_symbols.begin(), _symbols.end(), key);
+    if(it == _symbols.begin()) {
+        return NULL;
+    }
+    --it;
+    if(it->size != 0 && address >= it->address + it->size) {
+        return NULL;
+    }
+    return it->name;
+}
+
+Symbolizer::Symbolizer(const std::string& maps) {
+    size_t pos = 0;
+    while(pos < maps.size()) {
+        size_t end = maps.find('\n', pos);
+        if(end == std::string::npos) {
+            end = maps.size();
+        }
+        const std::string line(maps, pos, end - pos);
+        pos = end + 1;
+        // 00400000-00452000 r-xp 00000000 08:02 173521 /usr/bin/foo
+        unsigned long long start = 0;
+        unsigned long long stop = 0;
+        unsigned long long offset = 0;
+        char perms[8];
+        int path_pos = 0;
+        if(sscanf(line.c_str(), "%llx-%llx %7s %llx %*s %*s %n",
+                  &start, &stop, perms, &offset, &path_pos) < 4 ||
+           path_pos == 0 || strchr(perms, 'x') == NULL) {
+            continue;
+        }
+        Mapping mapping;
+        mapping.start = start;
+        mapping.end = stop;
+        mapping.offset = offset;
+        mapping.path = line.substr(path_pos);
+        const size_t deleted = mapping.path.find(" (deleted)");
+        if(deleted != std::string::npos) {
+            mapping.path.resize(deleted);
+        }
+        if(mapping.path.empty() || mapping.path[0] != '/') {
+            continue;
+        }
+        _mappings.push_back(mapping);
+    }
+    std::sort(_mappings.begin(), _mappings.end(),
+              [](const Mapping& lhs, const Mapping& rhs) { return lhs.start < rhs.start; });
+}
+
+Symbolizer::Mapping* Symbolizer::FindMapping(uint64_t address) {
+    auto it = std::upper_bound(_mappings.begin(), _mappings.end(), address,
+        [](uint64_t addr, const Mapping& mapping) { return addr < mapping.start; });
+    if(it == _mappings.begin()) {
+        return NULL;
+    }
+    --it;
+    return address < it->end ? &*it : NULL;
+}
+
+const std::string& Symbolizer::Symbolize(uint64_t address) {
+    auto it = _cache.find(address);
+    if(it != _cache.end()) {
+        return it->second;
+    }
+    std::string& name = _cache[address];
+    const char* mangled = NULL;
+    Mapping* mapping = FindMapping(address);
+    if(mapping) {
+        if(!mapping->index) {
+            mapping->index = ElfSymbolIndex::Get(mapping->path);
+        }
+        uint64_t elf_address = 0;
+        if(mapping->index && mapping->index->OffsetToAddress(
+               address - mapping->start + mapping->offset, &elf_address)) {
+            mangled = mapping->index->Lookup(elf_address);
+        }
+    }
+    if(!mangled) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "0x%016llx", (unsigned long long)address);
+        name = buf;
+        return name;
+    }
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled, NULL, NULL, &status);
+    if(demangled && status == 0) {
+        name = ShortFunctionName(demangled);
+    }
+    else {
+        name = mangled;
+    }
+    free(demangled);
+    return name;
+}
+
+std::string ShortFunctionName(const std::string& demangled) {
+    static const char ANONYMOUS[] = "(anonymous namespace)";
+    static const char OPERATOR[] = "operator";
+    std::string name;
+    name.reserve(demangled.size());
+    int depth = 0;
+    size_t i = 0;
+    while(i < demangled.size()) {
+        const char c = demangled[i];
+        if(demangled.compare(i, sizeof(ANONYMOUS) - 1, ANONYMOUS) == 0) {
+            if(depth == 0) {
+                // Without the space, which separates the return type.
+                name.append("(anonymous_namespace)");
+            }
+            i += sizeof(ANONYMOUS) - 1;
+            continue;
+        }
+        if(demangled.compare(i, sizeof(OPERATOR) - 1, OPERATOR) == 0) {
+            // Keep the symbols of the operator, e.g. operator<< or operator().
+            size_t j = i + sizeof(OPERATOR) - 1;
+            if(j < demangled.size() && demangled[j] == '(' &&
+               j + 1 < demangled.size() && demangled[j + 1] == ')') {
+                j += 2;
+            }
+            while(j < demangled.size() && strchr("<>=!+-*/%&|^~[],", demangled[j])) {
+                ++j;
+            }
+            if(depth == 0) {
+                name.append(demangled, i, j - i);
+            }
+            i = j;
+            continue;
+        }
+        if(c == '(' || c == '<') {
+            ++depth;
+        }
+        else if((c == ')' || c == '>') && depth > 0) {
+            --depth;
+        }
+        else if(depth == 0) {
+            if(c == '[') {
+                // [clone .constprop.0] and alike.
+                break;
+            }
+            name.push_back(c);
+        }
+        ++i;
+    }
+    while(!name.empty() && name.back() == ' ') {
+        name.pop_back();
+    }
+    static const char* const QUALIFIERS[] = { " const", " volatile", " &&", " &" };
+    for(size_t q = 0; q < sizeof(QUALIFIERS) / sizeof(QUALIFIERS[0]); ++q) {
+        const size_t len = strlen(QUALIFIERS[q]);
+        if(name.size() > len && name.compare(name.size() - len, len, QUALIFIERS[q]) == 0) {
+            name.resize(name.size() - len);
+        }
+    }
+    // The return type of function templates, the space in "operator new"
+    // is part of the name.
+    const size_t op = name.find(OPERATOR);
+    const size_t space = name.rfind(' ', op);
+    if(space != std::string::npos) {
+        name.erase(0, space + 1);
+    }
+    size_t anonymous = 0;
+    while((anonymous = name.find("(anonymous_namespace)", anonymous)) != std::string::npos) {
+        name[anonymous + 10] = ' ';
+        anonymous += sizeof(ANONYMOUS) - 1;
+    }
+    return name;
+}
+
+}  // namespace var
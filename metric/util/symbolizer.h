@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#ifndef VAR_UTIL_SYMBOLIZER_H
+#define VAR_UTIL_SYMBOLIZER_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace var {
+
+// Function symbols of an ELF file, read from .symtab (or .dynsym for
+// stripped files). The file stays mmap'd and the index is shared by all
+// symbolizers referring to the same file until the file changes.
+class ElfSymbolIndex {
+public:
+    // Returns NULL if `path' is not a readable ELF file.
+    static std::shared_ptr<const ElfSymbolIndex> Get(const std::string& path);
+
+    ~ElfSymbolIndex();
+
+    // Converts an offset in the file to the virtual address in the
+    // ELF image, returns false if the offset is not in a loadable segment.
+    bool OffsetToAddress(uint64_t offset, uint64_t* address) const;
+
+    // Returns the mangled name of the function containing `address',
+    // NULL if not found.
+    const char* Lookup(uint64_t address) const;
+
+    size_t symbol_count() const { return _symbols.size(); }
+
+private:
+    struct Symbol {
+        uint64_t address;
+        uint64_t size;
+        const char* name;
+        bool operator<(const Symbol& rhs) const { return address < rhs.address; }
+    };
+    struct Segment {
+        uint64_t offset;
+        uint64_t address;
+        uint64_t size;
+    };
+
+    ElfSymbolIndex() : _data(NULL), _size(0) {}
+    bool Load(int fd, size_t size);
+
+    void* _data;
+    size_t _size;
+    std::vector<Symbol> _symbols;
+    std::vector<Segment> _segments;
+};
+
+// Maps instruction addresses of a process to function names, with the
+// memory mappings of the process in /proc/<pid>/maps format, which
+// gperftools and ContentionProfiler append to the profiles.
+//
+// Example:
+//    Symbolizer symbolizer(maps);
+//    const std::string& name = symbolizer.Symbolize(pc);
+//
+// Not thread-safe.
+class Symbolizer {
+public:
+    explicit Symbolizer(const std::string& maps);
+
+    // Returns the demangled function name without argument and template
+    // lists, or the address in hex if it can't be resolved.
+    const std::string& Symbolize(uint64_t address);
+
+private:
+    struct Mapping {
+        uint64_t start;
+        uint64_t end;
+        uint64_t offset;
+        std::string path;
+        std::shared_ptr<const ElfSymbolIndex> index;
+    };
+
+    Mapping* FindMapping(uint64_t address);
+
+    std::vector<Mapping> _mappings;
+    std::unordered_map<uint64_t, std::string> _cache;
+};
+
+// Removes argument lists, template arguments and return types from a
+// demangled name, e.g. "void ns::f<int>(int) const" becomes "ns::f".
+std::string ShortFunctionName(const std::string& demangled);
+
+}  // namespace var
+
+#endif  // VAR_UTIL_SYMBOLIZER_H
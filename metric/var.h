@@ -25,6 +25,8 @@
 #include "status.h"
 #include "passive_status.h"
 #include "latency_recorder.h"
+#include "perf_counter.h"
+#include "loop_status.h"
 #include "window.h"
 #include "server.h"
 #include "util/time.h"
@@ -40,6 +40,14 @@ class Acceptor : noncopyable
 
   void listen();
 
+  /// Accepts up to n pending connections on each readable event,
+  /// defaults to 1.
+  void setMaxAcceptsPerRead(int n)
+  {
+    assert(n > 0);
+    maxAcceptsPerRead_ = n;
+  }
+
   bool listening() const { return listening_; }
 
   // Deprecated, use the correct spelling one above.
@@ -55,6 +63,7 @@ class Acceptor : noncopyable
   NewConnectionCallback newConnectionCallback_;
   bool listening_;
   int idleFd_;
+  int maxAcceptsPerRead_;
 };
 
 }  // namespace net
@@ -11,6 +11,7 @@
 #ifndef VAR_NET_BUFFER_H
 #define VAR_NET_BUFFER_H
 
+#include "base/BlockAllocator.h"
 #include "base/copyable.h"
 #include "base/StringPiece.h"
 #include "base/Types.h"
@@ -28,6 +29,8 @@
 namespace var {
 namespace net {
 
+class IOBuf;
+
 /// A buffer class modeled after org.jboss.netty.buffer.ChannelBuffer
 ///
 /// @code
@@ -417,7 +420,12 @@ class Buffer : public var::copyable
   }
 
  private:
-  std::vector<char> buffer_;
+  // IOBuf::append(Buffer&&) takes buffer_ over.
+  friend class IOBuf;
+  // From the BlockAllocator cache of the thread, rather than malloc.
+  typedef std::vector<char, PoolAllocator<char> > Storage;
+
+  Storage buffer_;
   size_t readerIndex_;
   size_t writerIndex_;
 
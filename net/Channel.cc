@@ -12,6 +12,7 @@
 
 #include <sstream>
 
+#include <errno.h>
 #include <poll.h>
 
 using namespace var;
@@ -28,6 +29,12 @@ Channel::Channel(EventLoop* loop, int fd__)
     revents_(0),
     index_(-1),
     logHup_(true),
+    edgeTriggered_(false),
+    receiveBuffer_(NULL),
+    receiving_(false),
+    receiveEnded_(false),
+    receiveErrno_(0),
+    received_(0),
     tied_(false),
     eventHandling_(false),
     addedToLoop_(false)
@@ -63,6 +70,31 @@ void Channel::remove()
   loop_->removeChannel(this);
 }
 
+ssize_t Channel::takeReceived(int* savedErrno)
+{
+  if (received_ > 0)
+  {
+    ssize_t n = static_cast<ssize_t>(received_);
+    received_ = 0;
+    return n;
+  }
+  if (!receiveEnded_)
+  {
+    *savedErrno = EAGAIN;
+    return -1;
+  }
+  // The end is told once, otherwise the Poller would find it ready
+  // again on every iteration.
+  receiveEnded_ = false;
+  if (receiveErrno_ == 0)
+  {
+    return 0;
+  }
+  *savedErrno = receiveErrno_;
+  receiveErrno_ = 0;
+  return -1;
+}
+
 void Channel::handleEvent(Timestamp receiveTime)
 {
   std::shared_ptr<void> guard;
@@ -11,17 +11,21 @@
 #ifndef VAR_NET_CHANNEL_H
 #define VAR_NET_CHANNEL_H
 
+#include "base/BlockAllocator.h"
 #include "base/noncopyable.h"
 #include "base/Timestamp.h"
 
 #include <functional>
 #include <memory>
 
+#include <sys/types.h>
+
 namespace var
 {
 namespace net
 {
 
+class Buffer;
 class EventLoop;
 
 ///
@@ -39,6 +43,10 @@ class Channel : noncopyable
   Channel(EventLoop* loop, int fd);
   ~Channel();
 
+  // One per connection, cached by the loop thread.
+  static void* operator new(size_t size) { return BlockAllocator::allocate(size); }
+  static void operator delete(void* p) { BlockAllocator::deallocate(p); }
+
   void handleEvent(Timestamp receiveTime);
   void setReadCallback(ReadEventCallback cb)
   { readCallback_ = std::move(cb); }
@@ -71,6 +79,35 @@ class Channel : noncopyable
   int index() { return index_; }
   void set_index(int idx) { index_ = idx; }
 
+  /// Asks EPollPoller for edge-triggered notification (EPOLLET), the
+  /// callbacks then must read and write until EAGAIN. The other pollers
+  /// stay level-triggered, which such callbacks handle as well.
+  /// Must be called before the channel is added to the loop.
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+  bool edgeTriggered() const { return edgeTriggered_; }
+
+  /// Asks a completion based Poller to receive into buf itself while
+  /// reading is enabled, instead of reporting the fd readable.
+  /// Pollers that can't ignore it, see receiving().
+  /// Must be called before the channel is added to the loop.
+  void receiveInto(Buffer* buf) { receiveBuffer_ = buf; }
+  Buffer* receiveBuffer() const { return receiveBuffer_; }
+  /// Whether the Poller took receiveInto(), the read callback then
+  /// gets the data with takeReceived().
+  bool receiving() const { return receiving_; }
+  /// What the Poller received since the last call, like read(2)
+  /// returns it: the number of bytes, 0 at EOF, or -1 with *savedErrno,
+  /// EAGAIN if nothing came. EOF and errors are returned once.
+  ssize_t takeReceived(int* savedErrno);
+
+  // for Poller
+  void set_receiving(bool on) { receiving_ = on; }
+  void addReceived(size_t n) { received_ += n; }
+  /// Ends receiving with EOF, or with an error if err != 0.
+  void endReceive(int err) { receiveEnded_ = true; receiveErrno_ = err; }
+  bool receiveEnded() const { return receiveEnded_; }
+  bool hasReceived() const { return received_ > 0 || receiveEnded_; }
+
   // for debug
   string reventsToString() const;
   string eventsToString() const;
@@ -96,6 +133,12 @@ class Channel : noncopyable
   int        revents_; // it's the received event types of epoll or poll
   int        index_; // used by Poller.
   bool       logHup_;
+  bool       edgeTriggered_;
+  Buffer*    receiveBuffer_;
+  bool       receiving_;
+  bool       receiveEnded_;
+  int        receiveErrno_;
+  size_t     received_;
 
   std::weak_ptr<void> tie_;
   bool tied_;
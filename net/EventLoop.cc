@@ -17,6 +17,7 @@
 
 #include <algorithm>
 
+#include <sched.h>
 #include <signal.h>
 #include <sys/eventfd.h>
 #include <unistd.h>
@@ -30,6 +31,10 @@ __thread EventLoop* t_loopInThisThread = 0;
 
 const int kPollTimeMs = 10000;
 
+// The busy ratio covers about the last second, older iterations
+// are halved away.
+const int64_t kBusyRatioWindowUs = 1000 * 1000;
+
 int createEventfd()
 {
   int evtfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
@@ -54,6 +59,19 @@ class IgnoreSigPipe
 #pragma GCC diagnostic error "-Wold-style-cast"
 
 IgnoreSigPipe initObj;
+
+struct FunctorNode : public MpscQueue::Node
+{
+  explicit FunctorNode(EventLoop::Functor&& cb)
+    : functor(std::move(cb))
+  {
+  }
+
+  // The callable is moved in, small ones live inside std::function
+  // and need no allocation besides the node.
+  EventLoop::Functor functor;
+};
+
 }  // namespace
 
 EventLoop* EventLoop::getEventLoopOfCurrentThread()
@@ -72,7 +90,15 @@ EventLoop::EventLoop()
     timerQueue_(new TimerQueue(this)),
     wakeupFd_(createEventfd()),
     wakeupChannel_(new Channel(this, wakeupFd_)),
-    currentActiveChannel_(NULL)
+    connectionCount_(0),
+    recentBusyUs_(0),
+    recentTotalUs_(0),
+    busyRatio_(0),
+    busyRatioTotalUs_(0),
+    idleSinceUs_(0),
+    currentActiveChannel_(NULL),
+    numPendingFunctors_(0),
+    wakeupPending_(false)
 {
   LOG_DEBUG << "EventLoop created " << this << " in thread " << threadId_;
   if (t_loopInThisThread)
@@ -97,6 +123,10 @@ EventLoop::~EventLoop()
   wakeupChannel_->disableAll();
   wakeupChannel_->remove();
   ::close(wakeupFd_);
+  while (MpscQueue::Node* node = pendingFunctors_.pop())
+  {
+    delete static_cast<FunctorNode*>(node);
+  }
   t_loopInThisThread = NULL;
 }
 
@@ -108,10 +138,12 @@ void EventLoop::loop()
   quit_ = false;  // FIXME: what if someone calls quit() before loop() ?
   LOG_TRACE << "EventLoop " << this << " start looping";
 
+  lastIterationEnd_ = Timestamp::now();
   while (!quit_)
   {
     activeChannels_.clear();
     pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
+    idleSinceUs_.store(0, std::memory_order_relaxed);
     ++iteration_;
     if (Logger::logLevel() <= Logger::TRACE)
     {
@@ -122,11 +154,30 @@ void EventLoop::loop()
     for (Channel* channel : activeChannels_)
     {
       currentActiveChannel_ = channel;
-      currentActiveChannel_->handleEvent(pollReturnTime_);
+      if (observer_)
+      {
+        Timestamp start(Timestamp::now());
+        currentActiveChannel_->handleEvent(pollReturnTime_);
+        observer_->onChannelHandled(channel, Timestamp::now().microSecondsSinceEpoch()
+                                             - start.microSecondsSinceEpoch());
+      }
+      else
+      {
+        currentActiveChannel_->handleEvent(pollReturnTime_);
+      }
     }
     currentActiveChannel_ = NULL;
     eventHandling_ = false;
     doPendingFunctors();
+    Timestamp iterationEnd(Timestamp::now());
+    if (observer_)
+    {
+      observer_->onIteration(
+          pollReturnTime_.microSecondsSinceEpoch() - lastIterationEnd_.microSecondsSinceEpoch(),
+          iterationEnd.microSecondsSinceEpoch() - pollReturnTime_.microSecondsSinceEpoch(),
+          static_cast<int>(activeChannels_.size()));
+    }
+    updateBusyRatio(pollReturnTime_, iterationEnd);
   }
 
   LOG_TRACE << "EventLoop " << this << " stop looping";
@@ -159,21 +210,25 @@ void EventLoop::runInLoop(Functor cb)
 
 void EventLoop::queueInLoop(Functor cb)
 {
-  {
-  MutexLockGuard lock(mutex_);
-  pendingFunctors_.push_back(std::move(cb));
-  }
+  numPendingFunctors_.fetch_add(1, std::memory_order_relaxed);
+  pendingFunctors_.push(new FunctorNode(std::move(cb)));
 
-  if (!isInLoopThread() || callingPendingFunctors_)
+  if ((!isInLoopThread() || callingPendingFunctors_) &&
+      !wakeupPending_.exchange(true))
   {
     wakeup();
   }
 }
 
+void EventLoop::setObserver(std::unique_ptr<EventLoopObserver> observer)
+{
+  assertInLoopThread();
+  observer_ = std::move(observer);
+}
+
 size_t EventLoop::queueSize() const
 {
-  MutexLockGuard lock(mutex_);
-  return pendingFunctors_.size();
+  return numPendingFunctors_.load(std::memory_order_relaxed);
 }
 
 TimerId EventLoop::runAt(Timestamp time, TimerCallback cb)
@@ -198,6 +253,12 @@ void EventLoop::cancel(TimerId timerId)
   return timerQueue_->cancel(timerId);
 }
 
+void EventLoop::setTimerBackend(TimerBackend backend)
+{
+  assertInLoopThread();
+  timerQueue_->setBackend(backend);
+}
+
 void EventLoop::updateChannel(Channel* channel)
 {
   assert(channel->ownerLoop() == this);
@@ -253,21 +314,83 @@ void EventLoop::handleRead()
 
 void EventLoop::doPendingFunctors()
 {
-  std::vector<Functor> functors;
   callingPendingFunctors_ = true;
-
+  // Functors queued from now on wake up the loop again, those queued by
+  // the functors below run in the next iteration.
+  wakeupPending_.exchange(false);
+  // Functors counted by now are pushed or about to be. pop() returns NULL
+  // while a push is half done, which is not the end of the queue then.
+  size_t numFunctors = numPendingFunctors_.load(std::memory_order_acquire);
+  if (numFunctors == 0)
   {
-  MutexLockGuard lock(mutex_);
-  functors.swap(pendingFunctors_);
+    callingPendingFunctors_ = false;
+    return;
   }
 
-  for (const Functor& functor : functors)
+  Timestamp start(observer_ ? Timestamp::now() : Timestamp());
+  for (size_t i = 0; i < numFunctors; )
+  {
+    MpscQueue::Node* node = pendingFunctors_.pop();
+    if (node == NULL)
+    {
+      sched_yield();
+      continue;
+    }
+    FunctorNode* functorNode = static_cast<FunctorNode*>(node);
+    numPendingFunctors_.fetch_sub(1, std::memory_order_relaxed);
+    ++i;
+    functorNode->functor();
+    delete functorNode;
+  }
+  if (observer_)
   {
-    functor();
+    observer_->onPendingFunctors(numFunctors, Timestamp::now().microSecondsSinceEpoch()
+                                              - start.microSecondsSinceEpoch());
   }
   callingPendingFunctors_ = false;
 }
 
+void EventLoop::updateBusyRatio(Timestamp iterationStart, Timestamp iterationEnd)
+{
+  recentBusyUs_ += iterationEnd.microSecondsSinceEpoch()
+                   - iterationStart.microSecondsSinceEpoch();
+  recentTotalUs_ += iterationEnd.microSecondsSinceEpoch()
+                    - lastIterationEnd_.microSecondsSinceEpoch();
+  lastIterationEnd_ = iterationEnd;
+  while (recentTotalUs_ > kBusyRatioWindowUs)
+  {
+    recentBusyUs_ /= 2;
+    recentTotalUs_ /= 2;
+  }
+  if (recentTotalUs_ > 0)
+  {
+    double ratio = static_cast<double>(recentBusyUs_) / static_cast<double>(recentTotalUs_);
+    busyRatio_.store(std::min(std::max(ratio, 0.0), 1.0), std::memory_order_relaxed);
+  }
+  busyRatioTotalUs_.store(recentTotalUs_, std::memory_order_relaxed);
+  idleSinceUs_.store(iterationEnd.microSecondsSinceEpoch(), std::memory_order_relaxed);
+}
+
+double EventLoop::busyRatio() const
+{
+  double ratio = busyRatio_.load(std::memory_order_relaxed);
+  int64_t idleSinceUs = idleSinceUs_.load(std::memory_order_relaxed);
+  if (idleSinceUs == 0)
+  {
+    return ratio;
+  }
+  // Counts the wait in poll so far as the next iteration would, so that
+  // a loop gone idle doesn't keep the ratio of its last busy iterations.
+  // Halving both sums doesn't change the ratio.
+  int64_t idleUs = Timestamp::now().microSecondsSinceEpoch() - idleSinceUs;
+  int64_t totalUs = busyRatioTotalUs_.load(std::memory_order_relaxed);
+  if (idleUs <= 0 || totalUs + idleUs <= 0)
+  {
+    return ratio;
+  }
+  return ratio * static_cast<double>(totalUs) / static_cast<double>(totalUs + idleUs);
+}
+
 void EventLoop::printActiveChannels() const
 {
   for (const Channel* channel : activeChannels_)
@@ -19,8 +19,10 @@
 
 #include "base/Mutex.h"
 #include "base/CurrentThread.h"
+#include "base/MpscQueue.h"
 #include "base/Timestamp.h"
 #include "Callbacks.h"
+#include "EventLoopObserver.h"
 #include "TimerId.h"
 
 namespace var
@@ -41,6 +43,17 @@ class EventLoop : noncopyable
  public:
   typedef std::function<void()> Functor;
 
+  /// Where the timers of a loop are kept.
+  enum TimerBackend
+  {
+    /// Ordered set, O(log n) add and cancel, runs timers on time.
+    kTimerSet,
+    /// Hierarchical timing wheel of 1ms ticks, O(1) add and cancel,
+    /// runs timers up to a tick late. For many short-lived timers,
+    /// e.g. idle timeouts.
+    kTimingWheel,
+  };
+
   EventLoop();
   ~EventLoop();  // force out-line dtor, for std::unique_ptr members.
 
@@ -64,6 +77,29 @@ class EventLoop : noncopyable
 
   int64_t iteration() const { return iteration_; }
 
+  ///
+  /// Measures poll waits, channel callbacks, functors and timers of this
+  /// loop into observer, which the loop owns. Off (NULL) by default,
+  /// costing a branch per event then.
+  /// Must be called in the loop thread, e.g. in a ThreadInitCallback.
+  ///
+  void setObserver(std::unique_ptr<EventLoopObserver> observer);
+  EventLoopObserver* observer() const { return observer_.get(); }
+
+  ///
+  /// Number of TcpConnections living in this loop.
+  /// Safe to call from other threads.
+  ///
+  int connectionCount() const
+  { return connectionCount_.load(std::memory_order_relaxed); }
+
+  ///
+  /// Fraction of the recent (about a second) wall time spent handling
+  /// events, timers and functors instead of waiting in poll, in [0, 1].
+  /// Safe to call from other threads.
+  ///
+  double busyRatio() const;
+
   /// Runs callback immediately in the loop thread.
   /// It wakes up the loop, and run the cb.
   /// If in the same loop thread, cb is run within the function.
@@ -71,7 +107,8 @@ class EventLoop : noncopyable
   void runInLoop(Functor cb);
   /// Queues callback in the loop thread.
   /// Runs after finish pooling.
-  /// Safe to call from other threads.
+  /// Safe to call from other threads, lock-free, and only the first
+  /// call after the loop started draining the queue wakes it up.
   void queueInLoop(Functor cb);
 
   size_t queueSize() const;
@@ -98,12 +135,22 @@ class EventLoop : noncopyable
   /// Safe to call from other threads.
   ///
   void cancel(TimerId timerId);
+  ///
+  /// Moves the timers to backend, kTimerSet by default or kTimingWheel
+  /// with the environment variable VAR_USE_TIMING_WHEEL.
+  /// Must be called in the loop thread, e.g. in a ThreadInitCallback.
+  ///
+  void setTimerBackend(TimerBackend backend);
 
   // internal usage
   void wakeup();
   void updateChannel(Channel* channel);
   void removeChannel(Channel* channel);
   bool hasChannel(Channel* channel);
+  void addConnection()
+  { connectionCount_.fetch_add(1, std::memory_order_relaxed); }
+  void removeConnection()
+  { connectionCount_.fetch_sub(1, std::memory_order_relaxed); }
 
   // pid_t threadId() const { return threadId_; }
   void assertInLoopThread()
@@ -132,6 +179,7 @@ class EventLoop : noncopyable
   void abortNotInLoopThread();
   void handleRead();  // waked up
   void doPendingFunctors();
+  void updateBusyRatio(Timestamp iterationStart, Timestamp iterationEnd);
 
   void printActiveChannels() const; // DEBUG
 
@@ -151,13 +199,27 @@ class EventLoop : noncopyable
   // we don't expose Channel to client.
   std::unique_ptr<Channel> wakeupChannel_;
   std::any context_;
+  std::atomic<int> connectionCount_;
+  // Decayed sums of the busy and the total time of iterations.
+  int64_t recentBusyUs_;
+  int64_t recentTotalUs_;
+  Timestamp lastIterationEnd_;
+  // What busyRatio() reads: the ratio and the total time as of the last
+  // iteration, and since when the loop waits in poll, 0 if it doesn't.
+  std::atomic<double> busyRatio_;
+  std::atomic<int64_t> busyRatioTotalUs_;
+  std::atomic<int64_t> idleSinceUs_;
+  std::unique_ptr<EventLoopObserver> observer_;
 
   // scratch variables
   ChannelList activeChannels_;
   Channel* currentActiveChannel_;
 
-  mutable MutexLock mutex_;
-  std::vector<Functor> pendingFunctors_ GUARDED_BY(mutex_);
+  MpscQueue pendingFunctors_;
+  std::atomic<size_t> numPendingFunctors_;
+  // Set by the first queueInLoop() which wakes up the loop, cleared
+  // when the loop starts draining pendingFunctors_.
+  std::atomic<bool> wakeupPending_;
 };
 
 }  // namespace net
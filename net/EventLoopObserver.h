@@ -0,0 +1,47 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef VAR_NET_EVENTLOOPOBSERVER_H
+#define VAR_NET_EVENTLOOPOBSERVER_H
+
+#include "base/noncopyable.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace var
+{
+namespace net
+{
+
+class Channel;
+
+///
+/// Receives the measurements of an EventLoop, see EventLoop::setObserver().
+/// All callbacks are called in the loop thread, times are in microseconds.
+///
+class EventLoopObserver : noncopyable
+{
+ public:
+  virtual ~EventLoopObserver() = default;
+
+  /// One iteration of the loop: waited in poll for waitUs, then handled
+  /// numEvents active channels, timers and functors in busyUs.
+  virtual void onIteration(int64_t waitUs, int64_t busyUs, int numEvents) = 0;
+
+  /// Channel::handleEvent() of an active channel took us.
+  virtual void onChannelHandled(const Channel* channel, int64_t us) = 0;
+
+  /// numFunctors queued by queueInLoop() ran in us.
+  virtual void onPendingFunctors(size_t numFunctors, int64_t us) = 0;
+
+  /// A timer ran latenessUs after its expiration.
+  virtual void onTimerExpired(int64_t latenessUs) = 0;
+};
+
+}  // namespace net
+}  // namespace var
+
+#endif  // VAR_NET_EVENTLOOPOBSERVER_H
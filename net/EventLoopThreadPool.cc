@@ -15,12 +15,36 @@
 using namespace var;
 using namespace var::net;
 
+namespace
+{
+
+// Busy ratios closer than this are taken as equal, so that noise
+// doesn't outweigh the connection count.
+const double kBusyRatioResolution = 0.02;
+
+int compareLoad(EventLoop* a, EventLoop* b, bool busyFirst)
+{
+  int connections = a->connectionCount() - b->connectionCount();
+  double busy = a->busyRatio() - b->busyRatio();
+  int busyOrder = busy < -kBusyRatioResolution ? -1 : (busy > kBusyRatioResolution ? 1 : 0);
+  int connectionOrder = connections < 0 ? -1 : (connections > 0 ? 1 : 0);
+  if (busyFirst)
+  {
+    return busyOrder != 0 ? busyOrder : connectionOrder;
+  }
+  return connectionOrder != 0 ? connectionOrder : busyOrder;
+}
+
+}  // namespace
+
 EventLoopThreadPool::EventLoopThreadPool(EventLoop* baseLoop, const string& nameArg)
   : baseLoop_(baseLoop),
     name_(nameArg),
     started_(false),
     numThreads_(0),
-    next_(0)
+    next_(0),
+    loadBalancing_(kRoundRobin),
+    randomState_(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)) | 1)
 {
 }
 
@@ -58,8 +82,25 @@ EventLoop* EventLoopThreadPool::getNextLoop()
 
   if (!loops_.empty())
   {
-    // round-robin
-    loop = loops_[next_];
+    size_t index = 0;
+    switch (loadBalancing_)
+    {
+      case kLeastConnections:
+        index = leastLoaded(false);
+        break;
+      case kLeastBusy:
+        index = leastLoaded(true);
+        break;
+      case kPowerOfTwoChoices:
+        index = powerOfTwoChoices();
+        break;
+      default:
+        index = next_;
+        break;
+    }
+    loop = loops_[index];
+    // round-robin, also where leastLoaded() starts scanning so that
+    // equally loaded loops take turns.
     ++next_;
     if (implicit_cast<size_t>(next_) >= loops_.size())
     {
@@ -69,6 +110,35 @@ EventLoop* EventLoopThreadPool::getNextLoop()
   return loop;
 }
 
+size_t EventLoopThreadPool::leastLoaded(bool busyFirst)
+{
+  size_t best = next_;
+  for (size_t i = 1; i < loops_.size(); ++i)
+  {
+    size_t index = (next_ + i) % loops_.size();
+    if (compareLoad(loops_[index], loops_[best], busyFirst) < 0)
+    {
+      best = index;
+    }
+  }
+  return best;
+}
+
+size_t EventLoopThreadPool::powerOfTwoChoices()
+{
+  if (loops_.size() == 1)
+  {
+    return 0;
+  }
+  // xorshift32, only touched in the base loop.
+  randomState_ ^= randomState_ << 13;
+  randomState_ ^= randomState_ >> 17;
+  randomState_ ^= randomState_ << 5;
+  size_t first = randomState_ % loops_.size();
+  size_t second = (first + 1 + (randomState_ >> 16) % (loops_.size() - 1)) % loops_.size();
+  return compareLoad(loops_[second], loops_[first], false) < 0 ? second : first;
+}
+
 EventLoop* EventLoopThreadPool::getLoopForHash(size_t hashCode)
 {
   baseLoop_->assertInLoopThread();
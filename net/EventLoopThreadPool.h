@@ -32,13 +32,30 @@ class EventLoopThreadPool : noncopyable
  public:
   typedef std::function<void(EventLoop*)> ThreadInitCallback;
 
+  /// How getNextLoop() places new work onto the loops.
+  enum LoadBalancing
+  {
+    /// Loops in turn.
+    kRoundRobin,
+    /// The loop with the fewest TcpConnections.
+    kLeastConnections,
+    /// The loop with the lowest EventLoop::busyRatio(), ties go to
+    /// the one with fewer connections.
+    kLeastBusy,
+    /// The less loaded of two random loops, by connections then by
+    /// busy ratio. Scales to many loops and avoids herding.
+    kPowerOfTwoChoices,
+  };
+
   EventLoopThreadPool(EventLoop* baseLoop, const string& nameArg);
   ~EventLoopThreadPool();
   void setThreadNum(int numThreads) { numThreads_ = numThreads; }
+  void setLoadBalancing(LoadBalancing loadBalancing) { loadBalancing_ = loadBalancing; }
+  LoadBalancing loadBalancing() const { return loadBalancing_; }
   void start(const ThreadInitCallback& cb = ThreadInitCallback());
 
   // valid after calling start()
-  /// round-robin
+  /// by loadBalancing(), round-robin by default
   EventLoop* getNextLoop();
 
   /// with the same hash code, it will always return the same EventLoop
@@ -53,12 +70,16 @@ class EventLoopThreadPool : noncopyable
   { return name_; }
 
  private:
+  size_t leastLoaded(bool busyFirst);
+  size_t powerOfTwoChoices();
 
   EventLoop* baseLoop_;
   string name_;
   bool started_;
   int numThreads_;
   int next_;
+  LoadBalancing loadBalancing_;
+  uint32_t randomState_;
   std::vector<std::unique_ptr<EventLoopThread>> threads_;
   std::vector<EventLoop*> loops_;
 };
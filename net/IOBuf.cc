@@ -0,0 +1,541 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include "IOBuf.h"
+
+#include "Buffer.h"
+#include "base/BlockAllocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace var;
+using namespace var::net;
+
+const size_t IOBuf::kBlockSize;
+const size_t IOBuf::kMinTakeSize;
+
+struct IOBuf::Block
+{
+  std::atomic<int> refs;
+  // Bytes filled, only the sole owner of a pooled block appends to it.
+  size_t size;
+  size_t capacity;
+  char* data;
+  // Set for user data, pooled blocks carry their data after the header.
+  std::function<void()> deleter;
+  bool pooled;
+  // File blocks have no data, refs to them are relative to fileOffset.
+  int fd;
+  int64_t fileOffset;
+};
+
+namespace
+{
+
+typedef IOBuf::Block Block;
+
+// writev(2) takes IOV_MAX at most, more don't fit in a socket buffer anyway.
+const int kMaxIovecs = 64;
+const size_t kMaxRefLength = 1U << 31;
+
+Block* newBlock()
+{
+  void* mem = BlockAllocator::allocate(IOBuf::kBlockSize);
+  Block* block = new (mem) Block;
+  block->refs.store(1, std::memory_order_relaxed);
+  block->size = 0;
+  block->capacity = IOBuf::kBlockSize - sizeof(Block);
+  block->data = static_cast<char*>(mem) + sizeof(Block);
+  block->pooled = true;
+  block->fd = -1;
+  block->fileOffset = 0;
+  return block;
+}
+
+// Closes the pipe of the thread when it exits.
+struct SplicePipe
+{
+  SplicePipe()
+  {
+    fds[0] = fds[1] = -1;
+  }
+
+  ~SplicePipe()
+  {
+    if (fds[0] >= 0)
+    {
+      ::close(fds[0]);
+      ::close(fds[1]);
+    }
+  }
+
+  int fds[2];
+};
+
+thread_local SplicePipe t_splicePipe;
+
+// Moves file bytes through a pipe for files sendfile(2) doesn't take.
+ssize_t spliceFile(int out, int in, int64_t offset, size_t len)
+{
+  int* fds = t_splicePipe.fds;
+  if (fds[0] < 0 && ::pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0)
+  {
+    fds[0] = fds[1] = -1;
+    return -1;
+  }
+  loff_t off = offset;
+  ssize_t in_pipe = ::splice(in, &off, fds[1], NULL, std::min<size_t>(len, 65536),
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (in_pipe <= 0)
+  {
+    return in_pipe;
+  }
+  ssize_t n = ::splice(fds[0], NULL, out, NULL, in_pipe,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (n < in_pipe)
+  {
+    // The socket is full, drops the rest to read them again later.
+    int savedErrno = errno;
+    char scratch[4096];
+    while (::read(fds[0], scratch, sizeof scratch) > 0)
+    {
+    }
+    errno = savedErrno;
+  }
+  return n;
+}
+
+// Returns 0 if the file ended.
+ssize_t sendFile(int out, const Block* block, uint32_t offset, size_t len)
+{
+  off_t off = static_cast<off_t>(block->fileOffset + offset);
+  ssize_t n = ::sendfile(out, block->fd, &off, len);
+  if (n < 0 && (errno == EINVAL || errno == ENOSYS))
+  {
+    n = spliceFile(out, block->fd, block->fileOffset + offset, len);
+  }
+  return n;
+}
+
+void ref(Block* block)
+{
+  block->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void unref(Block* block)
+{
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+  {
+    return;
+  }
+  if (block->deleter)
+  {
+    block->deleter();
+  }
+  block->~Block();
+  BlockAllocator::deallocate(block);
+}
+
+}  // namespace
+
+IOBuf::IOBuf()
+  : head_(0),
+    size_(0)
+{
+}
+
+IOBuf::IOBuf(const IOBuf& rhs)
+  : head_(0),
+    size_(0)
+{
+  append(rhs);
+}
+
+IOBuf::IOBuf(IOBuf&& rhs) noexcept
+  : refs_(std::move(rhs.refs_)),
+    head_(rhs.head_),
+    size_(rhs.size_)
+{
+  rhs.refs_.clear();
+  rhs.head_ = 0;
+  rhs.size_ = 0;
+}
+
+IOBuf& IOBuf::operator=(const IOBuf& rhs)
+{
+  if (this != &rhs)
+  {
+    IOBuf copy(rhs);
+    swap(copy);
+  }
+  return *this;
+}
+
+IOBuf& IOBuf::operator=(IOBuf&& rhs) noexcept
+{
+  IOBuf moved(std::move(rhs));
+  swap(moved);
+  return *this;
+}
+
+IOBuf::~IOBuf()
+{
+  clear();
+}
+
+void IOBuf::swap(IOBuf& rhs)
+{
+  refs_.swap(rhs.refs_);
+  std::swap(head_, rhs.head_);
+  std::swap(size_, rhs.size_);
+}
+
+void IOBuf::clear()
+{
+  for (size_t i = head_; i < refs_.size(); ++i)
+  {
+    unref(refs_[i].block);
+  }
+  refs_.clear();
+  head_ = 0;
+  size_ = 0;
+}
+
+void IOBuf::append(const void* data, size_t len)
+{
+  const char* p = static_cast<const char*>(data);
+  while (len > 0)
+  {
+    Block* tail = numBlocks() > 0 ? refs_.back().block : NULL;
+    // Fills the unused end of the last block if nobody else sees it.
+    if (tail == NULL
+        || !tail->pooled
+        || tail->refs.load(std::memory_order_acquire) != 1
+        || refs_.back().offset + refs_.back().length != tail->size
+        || tail->size == tail->capacity)
+    {
+      BlockRef fresh = { newBlock(), 0, 0 };
+      refs_.push_back(fresh);
+      tail = fresh.block;
+    }
+    size_t n = std::min(len, tail->capacity - tail->size);
+    memcpy(tail->data + tail->size, p, n);
+    tail->size += n;
+    refs_.back().length += static_cast<uint32_t>(n);
+    size_ += n;
+    p += n;
+    len -= n;
+  }
+}
+
+void IOBuf::append(const IOBuf& buf)
+{
+  if (&buf == this)
+  {
+    IOBuf copy(buf);
+    append(std::move(copy));
+    return;
+  }
+  refs_.reserve(numBlocks() + buf.numBlocks());
+  for (size_t i = buf.head_; i < buf.refs_.size(); ++i)
+  {
+    ref(buf.refs_[i].block);
+    push(buf.refs_[i]);
+  }
+}
+
+void IOBuf::append(IOBuf&& buf)
+{
+  if (&buf == this)
+  {
+    append(static_cast<const IOBuf&>(buf));
+    return;
+  }
+  if (empty())
+  {
+    swap(buf);
+    return;
+  }
+  for (size_t i = buf.head_; i < buf.refs_.size(); ++i)
+  {
+    push(buf.refs_[i]);
+  }
+  buf.refs_.clear();
+  buf.head_ = 0;
+  buf.size_ = 0;
+}
+
+void IOBuf::append(string&& str)
+{
+  if (str.size() < kMinTakeSize)
+  {
+    append(str.data(), str.size());
+    str.clear();
+    return;
+  }
+  string* storage = new string(std::move(str));
+  appendUserData(storage->data(), storage->size(), [storage]() { delete storage; });
+}
+
+void IOBuf::append(Buffer&& buf)
+{
+  if (buf.readableBytes() < kMinTakeSize)
+  {
+    append(buf.peek(), buf.readableBytes());
+    buf.retrieveAll();
+    return;
+  }
+  Buffer::Storage* storage = new Buffer::Storage;
+  storage->swap(buf.buffer_);
+  appendUserData(storage->data() + buf.readerIndex_, buf.readableBytes(),
+                 [storage]() { delete storage; });
+  Buffer empty;
+  buf.swap(empty);
+}
+
+void IOBuf::appendUserData(const void* data, size_t len,
+                           std::function<void()> deleter)
+{
+  Block* block = new (BlockAllocator::allocate(sizeof(Block))) Block;
+  block->refs.store(1, std::memory_order_relaxed);
+  block->size = len;
+  block->capacity = len;
+  block->data = static_cast<char*>(const_cast<void*>(data));
+  block->deleter = std::move(deleter);
+  block->pooled = false;
+  block->fd = -1;
+  block->fileOffset = 0;
+  if (len == 0)
+  {
+    unref(block);
+    return;
+  }
+  // A ref covers 2 GiB at most.
+  for (size_t offset = 0; offset < len; offset += kMaxRefLength)
+  {
+    if (offset > 0)
+    {
+      ref(block);
+    }
+    BlockRef r = { block, static_cast<uint32_t>(offset),
+                   static_cast<uint32_t>(std::min(len - offset, kMaxRefLength)) };
+    push(r);
+  }
+}
+
+void IOBuf::appendFile(int fd, int64_t offset, size_t len,
+                       std::function<void()> deleter)
+{
+  // Blocks of 2 GiB at most share the deleter.
+  std::shared_ptr<void> guard(nullptr, [deleter](void*)
+  {
+    if (deleter)
+    {
+      deleter();
+    }
+  });
+  size_t done = 0;
+  do
+  {
+    Block* block = new (BlockAllocator::allocate(sizeof(Block))) Block;
+    size_t part = std::min(len - done, kMaxRefLength);
+    block->refs.store(1, std::memory_order_relaxed);
+    block->size = part;
+    block->capacity = part;
+    block->data = NULL;
+    block->deleter = [guard]() {};
+    block->pooled = false;
+    block->fd = fd;
+    block->fileOffset = offset + static_cast<int64_t>(done);
+    if (part == 0)
+    {
+      unref(block);
+      break;
+    }
+    BlockRef r = { block, 0, static_cast<uint32_t>(part) };
+    push(r);
+    done += part;
+  } while (done < len);
+}
+
+void IOBuf::pop_front(size_t n)
+{
+  assert(n <= size_);
+  while (n > 0)
+  {
+    BlockRef& front = refs_[head_];
+    if (n < front.length)
+    {
+      front.offset += static_cast<uint32_t>(n);
+      front.length -= static_cast<uint32_t>(n);
+      size_ -= n;
+      break;
+    }
+    n -= front.length;
+    size_ -= front.length;
+    unref(front.block);
+    ++head_;
+  }
+  compact();
+}
+
+size_t IOBuf::cutn(IOBuf* out, size_t n)
+{
+  assert(out != this);
+  n = std::min(n, size_);
+  size_t left = n;
+  while (left > 0)
+  {
+    BlockRef& front = refs_[head_];
+    if (left < front.length)
+    {
+      BlockRef part = { front.block, front.offset, static_cast<uint32_t>(left) };
+      ref(front.block);
+      out->push(part);
+      front.offset += static_cast<uint32_t>(left);
+      front.length -= static_cast<uint32_t>(left);
+      size_ -= left;
+      break;
+    }
+    left -= front.length;
+    size_ -= front.length;
+    out->push(front);
+    ++head_;
+  }
+  compact();
+  return n;
+}
+
+size_t IOBuf::copyTo(void* buf, size_t n, size_t pos) const
+{
+  char* out = static_cast<char*>(buf);
+  size_t copied = 0;
+  for (size_t i = head_; i < refs_.size() && copied < n; ++i)
+  {
+    const BlockRef& r = refs_[i];
+    if (pos >= r.length)
+    {
+      pos -= r.length;
+      continue;
+    }
+    size_t len = std::min(static_cast<size_t>(r.length) - pos, n - copied);
+    if (r.block->fd >= 0)
+    {
+      ssize_t nr = ::pread(r.block->fd, out + copied, len,
+                           static_cast<off_t>(r.block->fileOffset + r.offset + pos));
+      if (nr < static_cast<ssize_t>(len))
+      {
+        // The file ended.
+        copied += nr > 0 ? nr : 0;
+        break;
+      }
+    }
+    else
+    {
+      memcpy(out + copied, r.block->data + r.offset + pos, len);
+    }
+    copied += len;
+    pos = 0;
+  }
+  return copied;
+}
+
+string IOBuf::toString() const
+{
+  string result(size_, '\0');
+  result.resize(copyTo(&result[0], size_));
+  return result;
+}
+
+ssize_t IOBuf::cutIntoFd(int fd)
+{
+  ssize_t total = 0;
+  while (!empty())
+  {
+    const BlockRef& front = refs_[head_];
+    size_t expected = 0;
+    ssize_t n = 0;
+    if (front.block->fd >= 0)
+    {
+      expected = front.length;
+      n = sendFile(fd, front.block, front.offset, expected);
+      if (n == 0)
+      {
+        errno = EIO;
+        n = -1;
+      }
+    }
+    else
+    {
+      struct iovec vec[kMaxIovecs];
+      int iovcnt = 0;
+      for (size_t i = head_;
+           i < refs_.size() && iovcnt < kMaxIovecs && refs_[i].block->fd < 0;
+           ++i, ++iovcnt)
+      {
+        vec[iovcnt].iov_base = refs_[i].block->data + refs_[i].offset;
+        vec[iovcnt].iov_len = refs_[i].length;
+        expected += refs_[i].length;
+      }
+      n = ::writev(fd, vec, iovcnt);
+    }
+    if (n < 0)
+    {
+      return total > 0 ? total : -1;
+    }
+    pop_front(n);
+    total += n;
+    if (static_cast<size_t>(n) < expected)
+    {
+      // The kernel buffer is full.
+      break;
+    }
+  }
+  return total;
+}
+
+void IOBuf::push(const BlockRef& r)
+{
+  if (numBlocks() > 0)
+  {
+    // Merges with the last ref if it continues it, e.g. after cutn().
+    BlockRef& back = refs_.back();
+    if (back.block == r.block
+        && back.offset + back.length == r.offset
+        && static_cast<size_t>(back.length) + r.length <= kMaxRefLength)
+    {
+      back.length += r.length;
+      size_ += r.length;
+      unref(r.block);
+      return;
+    }
+  }
+  refs_.push_back(r);
+  size_ += r.length;
+}
+
+void IOBuf::compact()
+{
+  if (head_ == refs_.size())
+  {
+    refs_.clear();
+    head_ = 0;
+  }
+  else if (head_ >= 16 && head_ * 2 >= refs_.size())
+  {
+    refs_.erase(refs_.begin(), refs_.begin() + head_);
+    head_ = 0;
+  }
+}
@@ -0,0 +1,119 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef VAR_NET_IOBUF_H
+#define VAR_NET_IOBUF_H
+
+#include "base/copyable.h"
+#include "base/StringPiece.h"
+#include "base/Types.h"
+
+#include <functional>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace var {
+namespace net {
+
+class Buffer;
+
+///
+/// A chain of refcounted blocks, for data on its way out.
+///
+/// Small appends are copied into blocks of kBlockSize bytes, header
+/// included, from the BlockAllocator cache of the thread. Large strings
+/// and Buffers are taken over without copying. Copies of an IOBuf,
+/// append(const IOBuf&) and cutn() share the blocks instead of copying
+/// bytes, and cutIntoFd() writes many blocks with one writev(2).
+///
+/// The bytes are not contiguous, parsers keep using Buffer. They may
+/// be in files, see appendFile().
+/// Blocks are shared read-only, so IOBufs sharing them may live in
+/// different threads; a single IOBuf is not thread safe.
+///
+class IOBuf : public var::copyable
+{
+ public:
+  static const size_t kBlockSize = 8192;
+  /// Shorter strings and Buffers are copied rather than taken over.
+  static const size_t kMinTakeSize = 512;
+
+  IOBuf();
+  IOBuf(const IOBuf& rhs);
+  IOBuf(IOBuf&& rhs) noexcept;
+  IOBuf& operator=(const IOBuf& rhs);
+  IOBuf& operator=(IOBuf&& rhs) noexcept;
+  ~IOBuf();
+
+  void swap(IOBuf& rhs);
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t numBlocks() const { return refs_.size() - head_; }
+  void clear();
+
+  void append(const void* data, size_t len);
+  void append(const StringPiece& str)
+  { append(str.data(), str.size()); }
+  /// Shares the blocks of buf.
+  void append(const IOBuf& buf);
+  void append(IOBuf&& buf);
+  /// Takes the storage of str.
+  void append(string&& str);
+  /// Takes the storage of buf, which is left empty.
+  void append(Buffer&& buf);
+  /// Refers to data until the last IOBuf sharing it releases it,
+  /// then calls deleter, in whatever thread that happens.
+  void appendUserData(const void* data, size_t len,
+                      std::function<void()> deleter);
+  /// Refers to len bytes of the file fd from offset on, which
+  /// cutIntoFd() sends with sendfile(2) without reading them in.
+  /// deleter, usually closing fd, is called as with appendUserData().
+  void appendFile(int fd, int64_t offset, size_t len,
+                  std::function<void()> deleter);
+
+  /// Removes the first n bytes.
+  void pop_front(size_t n);
+  /// Moves the first n bytes to the end of out, returns the number moved.
+  size_t cutn(IOBuf* out, size_t n);
+  /// Copies up to n bytes from pos on, returns the number copied.
+  /// File bytes are read with pread(2).
+  size_t copyTo(void* buf, size_t n, size_t pos = 0) const;
+  string toString() const;
+
+  ///
+  /// Writes with writev(2) until the kernel buffer is full or this is
+  /// empty, and pops what was written. Files go with sendfile(2), or
+  /// splice(2) through a pipe where sendfile(2) doesn't support them.
+  /// Returns the number of bytes written, or -1 with errno set if none;
+  /// EIO if a file ended before its bytes were sent.
+  ssize_t cutIntoFd(int fd);
+
+  // Opaque, defined in IOBuf.cc.
+  struct Block;
+
+ private:
+  struct BlockRef
+  {
+    Block* block;
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  void push(const BlockRef& ref);
+  void compact();
+
+  // refs_[head_, end) are the content, so that popping is cheap.
+  std::vector<BlockRef> refs_;
+  size_t head_;
+  size_t size_;
+};
+
+}  // namespace net
+}  // namespace var
+
+#endif  // VAR_NET_IOBUF_H
@@ -11,6 +11,7 @@
 #ifndef VAR_NET_SOCKET_H
 #define VAR_NET_SOCKET_H
 
+#include "base/BlockAllocator.h"
 #include "base/noncopyable.h"
 
 // struct tcp_info is in <netinet/tcp.h>
@@ -41,6 +42,10 @@ class Socket : noncopyable
   // Socket(Socket&&) // move constructor in C++11
   ~Socket();
 
+  // One per connection, cached by the loop thread.
+  static void* operator new(size_t size) { return BlockAllocator::allocate(size); }
+  static void operator delete(void* p) { BlockAllocator::deallocate(p); }
+
   int fd() const { return sockfd_; }
   // return true if success.
   bool getTcpInfo(struct tcp_info*) const;
@@ -31,7 +31,10 @@ class Timer : noncopyable
       expiration_(when),
       interval_(interval),
       repeat_(interval > 0.0),
-      sequence_(s_numCreated_.incrementAndGet())
+      sequence_(s_numCreated_.incrementAndGet()),
+      wheelPrev_(nullptr),
+      wheelNext_(nullptr),
+      wheelSlot_(nullptr)
   { }
 
   void run() const
@@ -54,6 +57,12 @@ class Timer : noncopyable
   const bool repeat_;
   const int64_t sequence_;
 
+  // Links in a slot of TimingWheel.
+  friend class TimingWheel;
+  Timer* wheelPrev_;
+  Timer* wheelNext_;
+  Timer** wheelSlot_;
+
   static AtomicInt64 s_numCreated_;
 };
 
@@ -16,7 +16,9 @@
 #include "EventLoop.h"
 #include "Timer.h"
 #include "TimerId.h"
+#include "TimingWheel.h"
 
+#include <stdlib.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
 
@@ -99,6 +101,10 @@ TimerQueue::TimerQueue(EventLoop* loop)
       std::bind(&TimerQueue::handleRead, this));
   // we are always reading the timerfd, we disarm it with timerfd_settime.
   timerfdChannel_.enableReading();
+  if (::getenv("VAR_USE_TIMING_WHEEL"))
+  {
+    wheel_.reset(new TimingWheel(Timestamp::now()));
+  }
 }
 
 TimerQueue::~TimerQueue()
@@ -111,6 +117,59 @@ TimerQueue::~TimerQueue()
   {
     delete timer.second;
   }
+  if (wheel_)
+  {
+    std::vector<Timer*> timers;
+    wheel_->takeAll(&timers);
+    for (Timer* timer : timers)
+    {
+      delete timer;
+    }
+  }
+}
+
+void TimerQueue::setBackend(EventLoop::TimerBackend backend)
+{
+  loop_->assertInLoopThread();
+  assert(!callingExpiredTimers_);
+  if ((backend == EventLoop::kTimingWheel) == static_cast<bool>(wheel_))
+  {
+    return;
+  }
+  std::vector<Timer*> timers;
+  if (wheel_)
+  {
+    wheel_->takeAll(&timers);
+    wheel_.reset();
+  }
+  else
+  {
+    for (const Entry& timer : timers_)
+    {
+      timers.push_back(timer.second);
+    }
+    timers_.clear();
+    activeTimers_.clear();
+    wheel_.reset(new TimingWheel(Timestamp::now()));
+    wheelArmed_ = Timestamp::invalid();
+  }
+  Timestamp nextExpire;
+  for (Timer* timer : timers)
+  {
+    insert(timer);
+  }
+  if (wheel_)
+  {
+    nextExpire = wheelArmed_ = wheel_->nextTick();
+  }
+  else if (!timers_.empty())
+  {
+    nextExpire = timers_.begin()->first;
+  }
+  if (nextExpire.valid())
+  {
+    resetTimerfd(timerfd_, nextExpire);
+  }
 }
 
 TimerId TimerQueue::addTimer(TimerCallback cb,
@@ -136,15 +195,27 @@ void TimerQueue::addTimerInLoop(Timer* timer)
 
   if (earliestChanged)
   {
-    resetTimerfd(timerfd_, timer->expiration());
+    resetTimerfd(timerfd_, wheel_ ? wheelArmed_ : timer->expiration());
   }
 }
 
 void TimerQueue::cancelInLoop(TimerId timerId)
 {
   loop_->assertInLoopThread();
-  assert(timers_.size() == activeTimers_.size());
   ActiveTimer timer(timerId.timer_, timerId.sequence_);
+  if (wheel_)
+  {
+    if (wheel_->remove(timerId.timer_, timerId.sequence_))
+    {
+      delete timerId.timer_;
+    }
+    else if (callingExpiredTimers_)
+    {
+      cancelingTimers_.insert(timer);
+    }
+    return;
+  }
+  assert(timers_.size() == activeTimers_.size());
   ActiveTimerSet::iterator it = activeTimers_.find(timer);
   if (it != activeTimers_.end())
   {
@@ -171,8 +242,14 @@ void TimerQueue::handleRead()
   callingExpiredTimers_ = true;
   cancelingTimers_.clear();
   // safe to callback outside critical section
+  EventLoopObserver* observer = loop_->observer();
   for (const Entry& it : expired)
   {
+    if (observer)
+    {
+      observer->onTimerExpired(now.microSecondsSinceEpoch()
+                               - it.first.microSecondsSinceEpoch());
+    }
     it.second->run();
   }
   callingExpiredTimers_ = false;
@@ -182,8 +259,13 @@ void TimerQueue::handleRead()
 
 std::vector<TimerQueue::Entry> TimerQueue::getExpired(Timestamp now)
 {
-  assert(timers_.size() == activeTimers_.size());
   std::vector<Entry> expired;
+  if (wheel_)
+  {
+    wheel_->getExpired(now, &expired);
+    return expired;
+  }
+  assert(timers_.size() == activeTimers_.size());
   Entry sentry(now, reinterpret_cast<Timer*>(UINTPTR_MAX));
   TimerList::iterator end = timers_.lower_bound(sentry);
   assert(end == timers_.end() || now < end->first);
@@ -221,7 +303,11 @@ void TimerQueue::reset(const std::vector<Entry>& expired, Timestamp now)
     }
   }
 
-  if (!timers_.empty())
+  if (wheel_)
+  {
+    nextExpire = wheelArmed_ = wheel_->nextTick();
+  }
+  else if (!timers_.empty())
   {
     nextExpire = timers_.begin()->second->expiration();
   }
@@ -235,6 +321,18 @@ void TimerQueue::reset(const std::vector<Entry>& expired, Timestamp now)
 bool TimerQueue::insert(Timer* timer)
 {
   loop_->assertInLoopThread();
+  if (wheel_)
+  {
+    wheel_->insert(timer);
+    // The wheel runs timers on ticks, arm the timerfd for the tick.
+    Timestamp tick = TimingWheel::tickOf(timer->expiration());
+    if (!wheelArmed_.valid() || tick < wheelArmed_)
+    {
+      wheelArmed_ = tick;
+      return true;
+    }
+    return false;
+  }
   assert(timers_.size() == activeTimers_.size());
   bool earliestChanged = false;
   Timestamp when = timer->expiration();
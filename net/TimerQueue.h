@@ -11,6 +11,7 @@
 #ifndef VAR_NET_TIMERQUEUE_H
 #define VAR_NET_TIMERQUEUE_H
 
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -18,15 +19,16 @@
 #include "base/Timestamp.h"
 #include "Callbacks.h"
 #include "Channel.h"
+#include "EventLoop.h"
 
 namespace var
 {
 namespace net
 {
 
-class EventLoop;
 class Timer;
 class TimerId;
+class TimingWheel;
 
 ///
 /// A best efforts timer queue.
@@ -38,6 +40,10 @@ class TimerQueue : noncopyable
   explicit TimerQueue(EventLoop* loop);
   ~TimerQueue();
 
+  /// Moves the timers into the storage of backend.
+  /// Must be called in the loop thread.
+  void setBackend(EventLoop::TimerBackend backend);
+
   ///
   /// Schedules the callback to be run at given time,
   /// repeats if @c interval > 0.0.
@@ -70,6 +76,10 @@ class TimerQueue : noncopyable
   bool insert(Timer* timer);
 
   EventLoop* loop_;
+  // Set with kTimingWheel, the wheel replaces timers_ and activeTimers_.
+  std::unique_ptr<TimingWheel> wheel_;
+  // When timerfd_ is armed for with the wheel.
+  Timestamp wheelArmed_;
   const int timerfd_;
   Channel timerfdChannel_;
   // Timer list sorted by expiration
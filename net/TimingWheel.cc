@@ -0,0 +1,222 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include "TimingWheel.h"
+
+#include "Timer.h"
+
+#include <algorithm>
+#include <assert.h>
+
+using namespace var;
+using namespace var::net;
+
+namespace
+{
+
+const int64_t kTickUs = 1000;
+
+int64_t tickCeil(Timestamp time)
+{
+  return (time.microSecondsSinceEpoch() + kTickUs - 1) / kTickUs;
+}
+
+}  // namespace
+
+TimingWheel::TimingWheel(Timestamp now)
+  : currentTick_(now.microSecondsSinceEpoch() / kTickUs)
+{
+  std::fill(slots_, slots_ + kNumSlots, nullptr);
+  std::fill(levelSizes_, levelSizes_ + kLevels, 0);
+}
+
+Timestamp TimingWheel::tickOf(Timestamp expiration)
+{
+  return Timestamp(tickCeil(expiration) * kTickUs);
+}
+
+void TimingWheel::insert(Timer* timer)
+{
+  if (timers_.empty())
+  {
+    // Don't walk the ticks the wheel slept through.
+    currentTick_ = std::max(currentTick_,
+                            Timestamp::now().microSecondsSinceEpoch() / kTickUs);
+  }
+  bool inserted = timers_.insert(std::make_pair(timer->sequence(), timer)).second;
+  assert(inserted); (void)inserted;
+  link(timer);
+}
+
+bool TimingWheel::remove(Timer* timer, int64_t sequence)
+{
+  std::unordered_map<int64_t, Timer*>::iterator it = timers_.find(sequence);
+  if (it == timers_.end() || it->second != timer)
+  {
+    return false;
+  }
+  timers_.erase(it);
+  unlink(timer);
+  return true;
+}
+
+void TimingWheel::getExpired(Timestamp now, std::vector<Entry>* expired)
+{
+  const int64_t nowTick = now.microSecondsSinceEpoch() / kTickUs;
+  while (currentTick_ <= nowTick)
+  {
+    if (timers_.empty())
+    {
+      currentTick_ = nowTick + 1;
+      break;
+    }
+    const int index = static_cast<int>(currentTick_ & (kLevel0Slots - 1));
+    if (index == 0)
+    {
+      // Spreads the next slot of level 1 onto level 0, and of level 2
+      // onto level 1 every time level 1 wraps around, and so on.
+      for (int level = 1; level < kLevels; ++level)
+      {
+        int shift = kLevel0Bits + (level - 1) * kLevelBits;
+        int levelIndex = static_cast<int>((currentTick_ >> shift) & (kLevelSlots - 1));
+        cascade(level, levelIndex);
+        if (levelIndex != 0)
+        {
+          break;
+        }
+      }
+    }
+    if (levelSizes_[0] == 0)
+    {
+      // Nothing to run before the next cascade.
+      currentTick_ = std::min((currentTick_ | (kLevel0Slots - 1)) + 1, nowTick + 1);
+      continue;
+    }
+    Timer* timer = slots_[index];
+    while (timer)
+    {
+      Timer* next = timer->wheelNext_;
+      unlink(timer);
+      timers_.erase(timer->sequence());
+      expired->push_back(Entry(timer->expiration(), timer));
+      timer = next;
+    }
+    ++currentTick_;
+  }
+}
+
+void TimingWheel::takeAll(std::vector<Timer*>* timers)
+{
+  for (int i = 0; i < kNumSlots; ++i)
+  {
+    for (Timer* timer = slots_[i]; timer; timer = timer->wheelNext_)
+    {
+      timer->wheelSlot_ = nullptr;
+      timers->push_back(timer);
+    }
+    slots_[i] = nullptr;
+  }
+  std::fill(levelSizes_, levelSizes_ + kLevels, 0);
+  timers_.clear();
+}
+
+Timestamp TimingWheel::nextTick() const
+{
+  if (timers_.empty())
+  {
+    return Timestamp();
+  }
+  const int index = static_cast<int>(currentTick_ & (kLevel0Slots - 1));
+  if (levelSizes_[0] > 0)
+  {
+    for (int i = index; i < kLevel0Slots; ++i)
+    {
+      if (slots_[i])
+      {
+        return Timestamp((currentTick_ + i - index) * kTickUs);
+      }
+    }
+  }
+  return Timestamp(((currentTick_ | (kLevel0Slots - 1)) + 1) * kTickUs);
+}
+
+void TimingWheel::link(Timer* timer)
+{
+  int64_t tick = std::max(tickCeil(timer->expiration()), currentTick_);
+  int64_t delta = tick - currentTick_;
+  Timer** slot = NULL;
+  if (delta < kLevel0Slots)
+  {
+    slot = &slots_[tick & (kLevel0Slots - 1)];
+  }
+  else
+  {
+    const int kMaxBits = kLevel0Bits + (kLevels - 1) * kLevelBits;
+    if (delta >= (int64_t(1) << kMaxBits))
+    {
+      // Out of range, waits in the furthest slot.
+      tick = currentTick_ + (int64_t(1) << kMaxBits) - 1;
+      delta = tick - currentTick_;
+    }
+    for (int level = 1; level < kLevels; ++level)
+    {
+      int shift = kLevel0Bits + (level - 1) * kLevelBits;
+      if (delta < (int64_t(1) << (shift + kLevelBits)))
+      {
+        slot = &slots_[kLevel0Slots + (level - 1) * kLevelSlots
+                       + ((tick >> shift) & (kLevelSlots - 1))];
+        break;
+      }
+    }
+  }
+  assert(slot);
+  timer->wheelPrev_ = nullptr;
+  timer->wheelNext_ = *slot;
+  if (*slot)
+  {
+    (*slot)->wheelPrev_ = timer;
+  }
+  *slot = timer;
+  timer->wheelSlot_ = slot;
+  ++levelSizes_[levelOf(slot)];
+}
+
+void TimingWheel::unlink(Timer* timer)
+{
+  assert(timer->wheelSlot_);
+  if (timer->wheelPrev_)
+  {
+    timer->wheelPrev_->wheelNext_ = timer->wheelNext_;
+  }
+  else
+  {
+    *timer->wheelSlot_ = timer->wheelNext_;
+  }
+  if (timer->wheelNext_)
+  {
+    timer->wheelNext_->wheelPrev_ = timer->wheelPrev_;
+  }
+  --levelSizes_[levelOf(timer->wheelSlot_)];
+  timer->wheelPrev_ = nullptr;
+  timer->wheelNext_ = nullptr;
+  timer->wheelSlot_ = nullptr;
+}
+
+void TimingWheel::cascade(int level, int index)
+{
+  Timer** slot = &slots_[kLevel0Slots + (level - 1) * kLevelSlots + index];
+  Timer* timer = *slot;
+  while (timer)
+  {
+    Timer* next = timer->wheelNext_;
+    unlink(timer);
+    link(timer);
+    timer = next;
+  }
+}
+
+int TimingWheel::levelOf(Timer** slot) const
+{
+  int index = static_cast<int>(slot - slots_);
+  return index < kLevel0Slots ? 0 : 1 + (index - kLevel0Slots) / kLevelSlots;
+}
@@ -0,0 +1,84 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef VAR_NET_TIMINGWHEEL_H
+#define VAR_NET_TIMINGWHEEL_H
+
+#include "base/noncopyable.h"
+#include "base/Timestamp.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace var
+{
+namespace net
+{
+
+class Timer;
+
+///
+/// Hierarchical timing wheel of 1ms ticks, a TimerQueue backend.
+///
+/// Level 0 has a slot per tick for the next 256 ticks, levels 1-3 have
+/// 64 slots each covering 2^8, 2^14 and 2^20 ticks, about 18 hours in
+/// total. Timers further away wait in the last slot and are placed again
+/// when it's cascaded. Insert and remove are O(1), timers run at the tick
+/// following their expiration, never early.
+///
+/// Timers are linked intrusively, the wheel doesn't own them.
+/// Not thread safe, used in the loop thread only.
+///
+class TimingWheel : noncopyable
+{
+ public:
+  typedef std::pair<Timestamp, Timer*> Entry;
+
+  explicit TimingWheel(Timestamp now);
+
+  void insert(Timer* timer);
+  /// Removes the timer if it's still in the wheel, the sequence tells
+  /// apart a deleted timer whose address is reused.
+  bool remove(Timer* timer, int64_t sequence);
+  /// Moves the timers which expire by now into expired.
+  void getExpired(Timestamp now, std::vector<Entry>* expired);
+  /// Moves all the timers into timers.
+  void takeAll(std::vector<Timer*>* timers);
+
+  /// The next time the wheel has to be looked at, invalid if it's empty.
+  /// Either the earliest tick with timers within the next 256 ticks or
+  /// the next cascade.
+  Timestamp nextTick() const;
+  /// The tick a timer of the expiration would run at.
+  static Timestamp tickOf(Timestamp expiration);
+
+  size_t size() const { return timers_.size(); }
+
+ private:
+  static const int kLevels = 4;
+  static const int kLevel0Bits = 8;
+  static const int kLevelBits = 6;
+  static const int kLevel0Slots = 1 << kLevel0Bits;
+  static const int kLevelSlots = 1 << kLevelBits;
+  static const int kNumSlots = kLevel0Slots + (kLevels - 1) * kLevelSlots;
+
+  void link(Timer* timer);
+  void unlink(Timer* timer);
+  void cascade(int level, int index);
+  int levelOf(Timer** slot) const;
+
+  // Ticks before currentTick_ have been run.
+  int64_t currentTick_;
+  Timer* slots_[kNumSlots];
+  int levelSizes_[kLevels];
+  // Timers in the wheel by sequence, for remove() by TimerId.
+  std::unordered_map<int64_t, Timer*> timers_;
+};
+
+}  // namespace net
+}  // namespace var
+
+#endif  // VAR_NET_TIMINGWHEEL_H
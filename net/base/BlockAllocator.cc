@@ -0,0 +1,342 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include "BlockAllocator.h"
+
+#include "Mutex.h"
+#include "MpscQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include <assert.h>
+#include <stdlib.h>
+
+using namespace var;
+
+const size_t BlockAllocator::kMaxSize;
+
+namespace
+{
+
+// 64 bytes, then four classes per power of two up to kMaxSize.
+const int kMinShift = 6;
+const int kNumClasses = 41;
+const uint32_t kLargeClass = kNumClasses;
+// Per class, fewer blocks of the large classes.
+const size_t kMaxCachedBytes = 256 * 1024;
+const size_t kMaxCachedBlocks = 256;
+
+// Whether the observer has been told about the block.
+const uint32_t kCountedLive = 1;
+const uint32_t kCountedFree = 2;
+
+struct ThreadCache;
+
+struct Header
+{
+  union
+  {
+    // NULL if the block is not to be cached.
+    ThreadCache* owner;
+    size_t largeSize;
+  };
+  uint32_t sizeClass;
+  uint32_t flags;
+};
+static_assert(sizeof(Header) == 16, "keeps blocks 16-byte aligned");
+
+// Lives in the block while it's free.
+struct FreeNode : MpscQueue::Node
+{
+  FreeNode* nextFree;
+};
+
+struct ThreadCache
+{
+  ThreadCache()
+  {
+    std::fill(lists, lists + kNumClasses, nullptr);
+    std::fill(counts, counts + kNumClasses, 0);
+  }
+
+  FreeNode* lists[kNumClasses];
+  size_t counts[kNumClasses];
+  // Blocks freed by other threads.
+  MpscQueue returned;
+};
+
+std::atomic<BlockAllocatorObserver*> g_observer(nullptr);
+
+// Never destroyed, threads may exit after the static destructors ran.
+MutexLock& orphansMutex()
+{
+  static MutexLock* mutex = new MutexLock;
+  return *mutex;
+}
+
+std::vector<ThreadCache*>& orphans()
+{
+  static std::vector<ThreadCache*>* caches = new std::vector<ThreadCache*>;
+  return *caches;
+}
+
+thread_local ThreadCache* t_cache = nullptr;
+thread_local bool t_exited = false;
+
+void releaseCache();
+
+struct CacheReleaser
+{
+  ~CacheReleaser() { releaseCache(); }
+};
+
+thread_local CacheReleaser t_releaser;
+
+int sizeClassOf(size_t size)
+{
+  if (size <= (size_t(1) << kMinShift))
+  {
+    return 0;
+  }
+  // 2^shift < size <= 2^(shift+1), in quarters of 2^shift.
+  int shift = 63 - __builtin_clzll(size - 1);
+  size_t quarter = (size - 1 - (size_t(1) << shift)) >> (shift - 2);
+  return (shift - kMinShift) * 4 + static_cast<int>(quarter) + 1;
+}
+
+size_t classSize(uint32_t sizeClass)
+{
+  if (sizeClass == 0)
+  {
+    return size_t(1) << kMinShift;
+  }
+  int shift = kMinShift + static_cast<int>(sizeClass - 1) / 4;
+  size_t quarters = (sizeClass - 1) % 4 + 1;
+  return (size_t(1) << shift) + quarters * (size_t(1) << (shift - 2));
+}
+
+size_t maxCached(uint32_t sizeClass)
+{
+  return std::max<size_t>(4, std::min(kMaxCachedBlocks, kMaxCachedBytes / classSize(sizeClass)));
+}
+
+Header* headerOf(void* p)
+{
+  return static_cast<Header*>(p) - 1;
+}
+
+void* dataOf(Header* header)
+{
+  return header + 1;
+}
+
+ThreadCache* threadCache()
+{
+  if (t_cache || t_exited)
+  {
+    return t_cache;
+  }
+  (void)&t_releaser;
+  {
+    MutexLockGuard lock(orphansMutex());
+    if (!orphans().empty())
+    {
+      t_cache = orphans().back();
+      orphans().pop_back();
+    }
+  }
+  if (!t_cache)
+  {
+    t_cache = new ThreadCache;
+  }
+  return t_cache;
+}
+
+void freeBlock(Header* header)
+{
+  if (header->flags & kCountedFree)
+  {
+    BlockAllocatorObserver* observer = g_observer.load(std::memory_order_acquire);
+    if (observer)
+    {
+      observer->onFree(-1, -static_cast<int64_t>(classSize(header->sizeClass)));
+    }
+  }
+  ::free(header);
+}
+
+void pushFree(ThreadCache* cache, Header* header)
+{
+  uint32_t sizeClass = header->sizeClass;
+  if (cache->counts[sizeClass] >= maxCached(sizeClass))
+  {
+    freeBlock(header);
+    return;
+  }
+  FreeNode* node = new (dataOf(header)) FreeNode;
+  node->nextFree = cache->lists[sizeClass];
+  cache->lists[sizeClass] = node;
+  ++cache->counts[sizeClass];
+}
+
+void drainReturned(ThreadCache* cache)
+{
+  while (MpscQueue::Node* node = cache->returned.pop())
+  {
+    pushFree(cache, headerOf(static_cast<FreeNode*>(node)));
+  }
+}
+
+void releaseCache()
+{
+  ThreadCache* cache = t_cache;
+  t_exited = true;
+  if (!cache)
+  {
+    return;
+  }
+  drainReturned(cache);
+  for (int i = 0; i < kNumClasses; ++i)
+  {
+    while (FreeNode* node = cache->lists[i])
+    {
+      cache->lists[i] = node->nextFree;
+      freeBlock(headerOf(node));
+    }
+    cache->counts[i] = 0;
+  }
+  t_cache = nullptr;
+  // Its blocks still out come back to its return queue.
+  MutexLockGuard lock(orphansMutex());
+  orphans().push_back(cache);
+}
+
+}  // namespace
+
+void* BlockAllocator::allocate(size_t size)
+{
+  Header* header = nullptr;
+  uint32_t sizeClass = kLargeClass;
+  ThreadCache* cache = nullptr;
+  if (size <= kMaxSize)
+  {
+    sizeClass = static_cast<uint32_t>(sizeClassOf(size));
+    cache = threadCache();
+  }
+  if (cache)
+  {
+    if (!cache->lists[sizeClass])
+    {
+      drainReturned(cache);
+    }
+    FreeNode* node = cache->lists[sizeClass];
+    if (node)
+    {
+      cache->lists[sizeClass] = node->nextFree;
+      --cache->counts[sizeClass];
+      node->~FreeNode();
+      header = headerOf(node);
+    }
+  }
+  BlockAllocatorObserver* observer = g_observer.load(std::memory_order_acquire);
+  const size_t bytes = sizeClass == kLargeClass ? size : classSize(sizeClass);
+  if (header)
+  {
+    if ((header->flags & kCountedFree) && observer)
+    {
+      observer->onFree(-1, -static_cast<int64_t>(bytes));
+    }
+  }
+  else
+  {
+    header = static_cast<Header*>(::malloc(sizeof(Header) + bytes));
+    if (!header)
+    {
+      throw std::bad_alloc();
+    }
+    if (sizeClass == kLargeClass)
+    {
+      header->largeSize = size;
+    }
+    else
+    {
+      header->owner = cache;
+    }
+    header->sizeClass = sizeClass;
+  }
+  header->flags = 0;
+  if (observer)
+  {
+    header->flags = kCountedLive;
+    observer->onLive(1, static_cast<int64_t>(bytes));
+  }
+  return dataOf(header);
+}
+
+void BlockAllocator::deallocate(void* p)
+{
+  if (!p)
+  {
+    return;
+  }
+  Header* header = headerOf(p);
+  BlockAllocatorObserver* observer = g_observer.load(std::memory_order_acquire);
+  if (header->sizeClass == kLargeClass)
+  {
+    if ((header->flags & kCountedLive) && observer)
+    {
+      observer->onLive(-1, -static_cast<int64_t>(header->largeSize));
+    }
+    ::free(header);
+    return;
+  }
+  const int64_t bytes = static_cast<int64_t>(classSize(header->sizeClass));
+  if ((header->flags & kCountedLive) && observer)
+  {
+    observer->onLive(-1, -bytes);
+  }
+  header->flags = 0;
+  if (!header->owner)
+  {
+    ::free(header);
+    return;
+  }
+  if (observer)
+  {
+    header->flags = kCountedFree;
+    observer->onFree(1, bytes);
+  }
+  ThreadCache* cache = t_cache;
+  if (header->owner == cache)
+  {
+    pushFree(cache, header);
+  }
+  else
+  {
+    header->owner->returned.push(new (p) FreeNode);
+  }
+}
+
+size_t BlockAllocator::roundUp(size_t size)
+{
+  return size <= kMaxSize ? classSize(static_cast<uint32_t>(sizeClassOf(size))) : size;
+}
+
+void BlockAllocator::setObserver(BlockAllocatorObserver* observer)
+{
+  g_observer.store(observer, std::memory_order_release);
+}
+
+size_t BlockAllocator::cachedBlocks()
+{
+  ThreadCache* cache = t_cache;
+  size_t blocks = 0;
+  for (int i = 0; cache && i < kNumClasses; ++i)
+  {
+    blocks += cache->counts[i];
+  }
+  return blocks;
+}
@@ -0,0 +1,90 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef VAR_BASE_BLOCKALLOCATOR_H
+#define VAR_BASE_BLOCKALLOCATOR_H
+
+#include "noncopyable.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace var
+{
+
+///
+/// Told about the blocks of BlockAllocator, in whatever thread moves them.
+/// Blocks that were handed out or cached before it was installed are not
+/// counted when they come back, so the counts never go negative.
+///
+class BlockAllocatorObserver
+{
+ public:
+  virtual ~BlockAllocatorObserver() {}
+
+  /// Blocks handed out (delta > 0) or given back (delta < 0),
+  /// bytes changes along with delta.
+  virtual void onLive(int delta, int64_t bytes) = 0;
+  /// Blocks cached for reuse (delta > 0) or taken out of the caches.
+  virtual void onFree(int delta, int64_t bytes) = 0;
+};
+
+///
+/// Size-classed allocator for buffer storage and connection objects.
+///
+/// Sizes up to kMaxSize are rounded up to one of four classes per power of
+/// two and served from free lists of the calling thread, which is the loop
+/// thread for what a loop allocates; larger sizes go to malloc.
+/// A block freed in another thread is pushed onto the return queue of the
+/// thread it came from, which takes it back when a free list runs empty.
+/// The caches of exited threads are adopted by new threads.
+///
+class BlockAllocator : noncopyable
+{
+ public:
+  static const size_t kMaxSize = 65536;
+
+  static void* allocate(size_t size);
+  static void deallocate(void* p);
+
+  /// What allocate(size) really gives.
+  static size_t roundUp(size_t size);
+
+  /// The observer is not owned and must live until the process exits.
+  /// Install it at startup, NULL to stop observing.
+  static void setObserver(BlockAllocatorObserver* observer);
+
+  /// Blocks in the free lists of the calling thread.
+  static size_t cachedBlocks();
+};
+
+///
+/// Standard allocator on BlockAllocator, for containers and
+/// std::allocate_shared().
+///
+template <typename T>
+class PoolAllocator
+{
+ public:
+  typedef T value_type;
+
+  PoolAllocator() noexcept {}
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+  T* allocate(size_t n)
+  { return static_cast<T*>(BlockAllocator::allocate(n * sizeof(T))); }
+
+  void deallocate(T* p, size_t) noexcept
+  { BlockAllocator::deallocate(p); }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
+
+}  // namespace var
+
+#endif  // VAR_BASE_BLOCKALLOCATOR_H
@@ -0,0 +1,327 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include "ContentionProfiler.h"
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+using namespace var;
+
+namespace
+{
+
+const int kMaxStackDepth = 32;
+// Bounds the memory used by a long profiling on a busy process.
+const size_t kMaxStacks = 8192;
+// Samples a thread keeps before merging them into the profile.
+const int kMaxThreadSamples = 64;
+
+struct StackHash
+{
+  size_t operator()(const std::vector<void*>& stack) const
+  {
+    size_t h = 0;
+    for (size_t i = 0; i < stack.size(); ++i)
+    {
+      h = h * 31 + reinterpret_cast<uintptr_t>(stack[i]);
+    }
+    return h;
+  }
+};
+
+struct ContentionStat
+{
+  int64_t waitNs;
+  int64_t count;
+};
+
+typedef std::unordered_map<std::vector<void*>, ContentionStat, StackHash> ContentionMap;
+
+struct Sample
+{
+  int64_t waitNs;
+  int depth;
+  void* frames[kMaxStackDepth];
+};
+
+struct ThreadSamples
+{
+  ThreadSamples()
+    : size(0),
+      discarded(0),
+      pendingStartNs(0)
+  {
+    pthread_mutex_init(&mutex, NULL);
+  }
+
+  ~ThreadSamples()
+  {
+    pthread_mutex_destroy(&mutex);
+  }
+
+  // Guards size, discarded and samples. Only dump() and start() contend
+  // with the owner thread.
+  pthread_mutex_t mutex;
+  int size;
+  int64_t discarded;
+  Sample samples[kMaxThreadSamples];
+  // Filled by beginSample(), touched by the owner thread only.
+  Sample pending;
+  int64_t pendingStartNs;
+};
+
+// NOT a MutexLock, which would record itself.
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+ContentionMap* g_contentions = NULL;
+// Never destroyed, threads may exit after the static destructors ran.
+std::vector<ThreadSamples*>* g_threads = NULL;
+std::atomic<int64_t> g_minWaitNs(0);
+std::atomic<int> g_samplingPeriod(1);
+int64_t g_discarded = 0;
+int64_t g_startNs = 0;
+
+thread_local ThreadSamples* t_samples = NULL;
+thread_local bool t_exited = false;
+thread_local unsigned t_contended = 0;
+
+// Requires g_mutex and samples->mutex.
+void mergeSamples(ThreadSamples* samples)
+{
+  for (int i = 0; i < samples->size; ++i)
+  {
+    const Sample& sample = samples->samples[i];
+    std::vector<void*> stack(sample.frames, sample.frames + sample.depth);
+    ContentionMap::iterator it = g_contentions->find(stack);
+    if (it != g_contentions->end())
+    {
+      it->second.waitNs += sample.waitNs;
+      ++it->second.count;
+    }
+    else if (g_contentions->size() < kMaxStacks)
+    {
+      ContentionStat stat = { sample.waitNs, 1 };
+      g_contentions->insert(std::make_pair(std::move(stack), stat));
+    }
+    else
+    {
+      ++g_discarded;
+    }
+  }
+  g_discarded += samples->discarded;
+  samples->size = 0;
+  samples->discarded = 0;
+}
+
+void flushSamples(ThreadSamples* samples)
+{
+  pthread_mutex_lock(&g_mutex);
+  pthread_mutex_lock(&samples->mutex);
+  mergeSamples(samples);
+  pthread_mutex_unlock(&samples->mutex);
+  pthread_mutex_unlock(&g_mutex);
+}
+
+void releaseSamples();
+
+struct SamplesReleaser
+{
+  ~SamplesReleaser() { releaseSamples(); }
+};
+
+thread_local SamplesReleaser t_releaser;
+
+ThreadSamples* threadSamples()
+{
+  if (t_samples || t_exited)
+  {
+    return t_samples;
+  }
+  (void)&t_releaser;
+  ThreadSamples* samples = new ThreadSamples;
+  pthread_mutex_lock(&g_mutex);
+  g_threads->push_back(samples);
+  pthread_mutex_unlock(&g_mutex);
+  t_samples = samples;
+  return t_samples;
+}
+
+void releaseSamples()
+{
+  ThreadSamples* samples = t_samples;
+  t_exited = true;
+  if (!samples)
+  {
+    return;
+  }
+  pthread_mutex_lock(&g_mutex);
+  pthread_mutex_lock(&samples->mutex);
+  mergeSamples(samples);
+  pthread_mutex_unlock(&samples->mutex);
+  g_threads->erase(std::find(g_threads->begin(), g_threads->end(), samples));
+  pthread_mutex_unlock(&g_mutex);
+  t_samples = NULL;
+  delete samples;
+}
+
+}  // namespace
+
+std::atomic<bool> ContentionProfiler::running_(false);
+
+bool ContentionProfiler::start(int64_t minWaitNs, int samplingPeriod)
+{
+  pthread_mutex_lock(&g_mutex);
+  if (running_.load(std::memory_order_relaxed))
+  {
+    pthread_mutex_unlock(&g_mutex);
+    return false;
+  }
+  if (!g_contentions)
+  {
+    g_contentions = new ContentionMap;
+    g_threads = new std::vector<ThreadSamples*>;
+    // backtrace() loads libgcc on first use, do it out of any lock() path.
+    void* frames[1];
+    ::backtrace(frames, 1);
+  }
+  g_contentions->clear();
+  for (size_t i = 0; i < g_threads->size(); ++i)
+  {
+    ThreadSamples* samples = (*g_threads)[i];
+    pthread_mutex_lock(&samples->mutex);
+    samples->size = 0;
+    samples->discarded = 0;
+    pthread_mutex_unlock(&samples->mutex);
+  }
+  g_minWaitNs.store(minWaitNs, std::memory_order_relaxed);
+  g_samplingPeriod.store(samplingPeriod > 1 ? samplingPeriod : 1,
+                         std::memory_order_relaxed);
+  g_discarded = 0;
+  g_startNs = nowNs();
+  running_.store(true, std::memory_order_release);
+  pthread_mutex_unlock(&g_mutex);
+  return true;
+}
+
+void ContentionProfiler::stop()
+{
+  running_.store(false, std::memory_order_release);
+}
+
+bool ContentionProfiler::beginSample()
+{
+  const unsigned period = g_samplingPeriod.load(std::memory_order_relaxed);
+  if (++t_contended % period != 0)
+  {
+    return false;
+  }
+  ThreadSamples* samples = threadSamples();
+  if (!samples)
+  {
+    return false;
+  }
+  // Makes room while no lock is being acquired yet.
+  pthread_mutex_lock(&samples->mutex);
+  const bool full = samples->size == kMaxThreadSamples;
+  pthread_mutex_unlock(&samples->mutex);
+  if (full)
+  {
+    flushSamples(samples);
+  }
+  void* frames[kMaxStackDepth + 1];
+  // Skip beginSample() itself, the caller is MutexLock::lock().
+  const int depth = ::backtrace(frames, kMaxStackDepth + 1);
+  if (depth <= 1)
+  {
+    return false;
+  }
+  samples->pending.depth = depth - 1;
+  std::copy(frames + 1, frames + depth, samples->pending.frames);
+  samples->pendingStartNs = nowNs();
+  return true;
+}
+
+void ContentionProfiler::endSample()
+{
+  ThreadSamples* samples = t_samples;
+  const int64_t waitNs = nowNs() - samples->pendingStartNs;
+  if (waitNs < g_minWaitNs.load(std::memory_order_relaxed) || !running())
+  {
+    return;
+  }
+  samples->pending.waitNs = waitNs;
+  pthread_mutex_lock(&samples->mutex);
+  if (samples->size < kMaxThreadSamples)
+  {
+    samples->samples[samples->size++] = samples->pending;
+  }
+  else
+  {
+    ++samples->discarded;
+  }
+  pthread_mutex_unlock(&samples->mutex);
+}
+
+void ContentionProfiler::dump(string* out)
+{
+  char buf[64];
+  out->append("--- contention\n");
+  // Wait times are recorded in nanoseconds.
+  out->append("cycles/second=1000000000\n");
+  pthread_mutex_lock(&g_mutex);
+  if (g_threads)
+  {
+    for (size_t i = 0; i < g_threads->size(); ++i)
+    {
+      ThreadSamples* samples = (*g_threads)[i];
+      pthread_mutex_lock(&samples->mutex);
+      mergeSamples(samples);
+      pthread_mutex_unlock(&samples->mutex);
+    }
+  }
+  snprintf(buf, sizeof buf, "sampling period=%d\n",
+           g_samplingPeriod.load(std::memory_order_relaxed));
+  out->append(buf);
+  snprintf(buf, sizeof buf, "ms since reset=%lld\n",
+           static_cast<long long>((nowNs() - g_startNs) / 1000000));
+  out->append(buf);
+  snprintf(buf, sizeof buf, "discarded samples=%lld\n",
+           static_cast<long long>(g_discarded));
+  out->append(buf);
+  if (g_contentions)
+  {
+    for (ContentionMap::const_iterator it = g_contentions->begin();
+         it != g_contentions->end(); ++it)
+    {
+      snprintf(buf, sizeof buf, "%lld %lld @",
+               static_cast<long long>(it->second.waitNs),
+               static_cast<long long>(it->second.count));
+      out->append(buf);
+      for (size_t i = 0; i < it->first.size(); ++i)
+      {
+        snprintf(buf, sizeof buf, " %p", it->first[i]);
+        out->append(buf);
+      }
+      out->push_back('\n');
+    }
+  }
+  pthread_mutex_unlock(&g_mutex);
+
+  // pprof takes the remaining lines as the memory map.
+  FILE* fp = ::fopen("/proc/self/maps", "r");
+  if (fp)
+  {
+    char line[4096];
+    size_t n = 0;
+    while ((n = ::fread(line, 1, sizeof line, fp)) > 0)
+    {
+      out->append(line, n);
+    }
+    ::fclose(fp);
+  }
+}
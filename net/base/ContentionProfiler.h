@@ -0,0 +1,65 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef VAR_BASE_CONTENTIONPROFILER_H
+#define VAR_BASE_CONTENTIONPROFILER_H
+
+#include "noncopyable.h"
+#include "Types.h"
+
+#include <atomic>
+#include <time.h>
+
+namespace var
+{
+
+///
+/// Collects call stacks of threads waiting on a contended MutexLock and
+/// aggregates the wait time per stack, dumped as a pprof contention profile.
+///
+/// Nothing is collected until start(), an uncontended MutexLock::lock()
+/// costs one pthread_mutex_trylock() either way.
+///
+/// Only one in samplingPeriod contended locks of a thread is sampled. The
+/// stack is captured before blocking and the sample goes to a buffer of the
+/// waiting thread, so the lock being acquired is never held while walking
+/// the stack or updating the shared profile.
+///
+class ContentionProfiler : noncopyable
+{
+ public:
+  /// Starts collecting one in samplingPeriod waits not shorter than
+  /// minWaitNs, drops samples of the previous profiling.
+  /// Returns false if a profiling is already running.
+  static bool start(int64_t minWaitNs = 0, int samplingPeriod = 1);
+  static void stop();
+
+  static bool running()
+  {
+    return running_.load(std::memory_order_relaxed);
+  }
+
+  /// Appends the samples in pprof contention format, followed by
+  /// /proc/self/maps for symbolization.
+  static void dump(string* out);
+
+  /// internal, called by MutexLock before blocking on a contended lock.
+  /// Returns true if the wait is sampled, endSample() must follow.
+  static bool beginSample();
+  /// internal, called by MutexLock once the sampled lock is acquired.
+  static void endSample();
+
+  static int64_t nowNs()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+ private:
+  static std::atomic<bool> running_;
+};
+
+}  // namespace var
+
+#endif  // VAR_BASE_CONTENTIONPROFILER_H
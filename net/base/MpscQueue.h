@@ -0,0 +1,91 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef VAR_BASE_MPSCQUEUE_H
+#define VAR_BASE_MPSCQUEUE_H
+
+#include "noncopyable.h"
+
+#include <atomic>
+
+namespace var
+{
+
+///
+/// Intrusive lock-free multi-producer single-consumer queue (D. Vyukov's).
+/// Callers derive their nodes from MpscQueue::Node and own them: push()
+/// hands a node to the queue, pop() hands it back.
+///
+/// push() is wait-free and safe from any thread, pop() must be called
+/// by one consumer at a time.
+///
+class MpscQueue : noncopyable
+{
+ public:
+  struct Node
+  {
+    std::atomic<Node*> next{nullptr};
+  };
+
+  MpscQueue()
+    : head_(&stub_),
+      tail_(&stub_)
+  {
+  }
+
+  void push(Node* node)
+  {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    // Until this store the consumer sees the queue end at prev.
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /// Returns NULL if the queue is empty, or its first node is still
+  /// being pushed. Also when the node before the stub put back by an
+  /// earlier pop() is, so NULL does not tell the queue is empty: callers
+  /// count what they push and retry while the count says more to come.
+  Node* pop()
+  {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_)
+    {
+      if (next == nullptr)
+      {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr)
+    {
+      tail_ = next;
+      return tail;
+    }
+    if (tail != head_.load(std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+    // tail is the last node, put the stub behind it to take it out.
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr)
+    {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+ private:
+  // Producers only touch head_, keep it off the consumer's cache line.
+  alignas(64) std::atomic<Node*> head_;
+  alignas(64) Node* tail_;
+  Node stub_;
+};
+
+}  // namespace var
+
+#endif  // VAR_BASE_MPSCQUEUE_H
@@ -6,6 +6,7 @@
 #ifndef VAR_BASE_MUTEX_H
 #define VAR_BASE_MUTEX_H
 
+#include "ContentionProfiler.h"
 #include "CurrentThread.h"
 #include "noncopyable.h"
 #include <assert.h>
@@ -148,7 +149,10 @@ class CAPABILITY("mutex") MutexLock : noncopyable
 
   void lock() ACQUIRE()
   {
-    MCHECK(pthread_mutex_lock(&mutex_));
+    if (pthread_mutex_trylock(&mutex_) != 0)
+    {
+      lockContended();
+    }
     assignHolder();
   }
 
@@ -184,6 +188,20 @@ class CAPABILITY("mutex") MutexLock : noncopyable
     MutexLock& owner_;
   };
 
+  // Slow path of lock(), samples the wait when contention profiling is on.
+  void lockContended()
+  {
+    if (ContentionProfiler::running() && ContentionProfiler::beginSample())
+    {
+      MCHECK(pthread_mutex_lock(&mutex_));
+      ContentionProfiler::endSample();
+    }
+    else
+    {
+      MCHECK(pthread_mutex_lock(&mutex_));
+    }
+  }
+
   void unassignHolder()
   {
     holder_ = 0;
@@ -0,0 +1,149 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include "ThreadPool.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+using namespace var;
+
+ThreadPool::ThreadPool(const string& nameArg)
+  : mutex_(),
+    notEmpty_(mutex_),
+    notFull_(mutex_),
+    name_(nameArg),
+    maxQueueSize_(0),
+    running_(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+  if (running_)
+  {
+    stop();
+  }
+}
+
+void ThreadPool::start(int numThreads)
+{
+  assert(threads_.empty());
+  running_ = true;
+  threads_.reserve(numThreads);
+  for (int i = 0; i < numThreads; ++i)
+  {
+    char id[32];
+    snprintf(id, sizeof id, "%d", i+1);
+    threads_.emplace_back(new var::Thread(
+          std::bind(&ThreadPool::runInThread, this), name_+id));
+    threads_[i]->start();
+  }
+  if (numThreads == 0 && threadInitCallback_)
+  {
+    threadInitCallback_();
+  }
+}
+
+void ThreadPool::stop()
+{
+  {
+  MutexLockGuard lock(mutex_);
+  running_ = false;
+  notEmpty_.notifyAll();
+  notFull_.notifyAll();
+  }
+  for (auto& thr : threads_)
+  {
+    thr->join();
+  }
+}
+
+size_t ThreadPool::queueSize() const
+{
+  MutexLockGuard lock(mutex_);
+  return queue_.size();
+}
+
+void ThreadPool::run(Task task)
+{
+  if (threads_.empty())
+  {
+    task();
+  }
+  else
+  {
+    MutexLockGuard lock(mutex_);
+    while (isFull() && running_)
+    {
+      notFull_.wait();
+    }
+    if (!running_) return;
+    assert(!isFull());
+
+    queue_.push_back(std::move(task));
+    notEmpty_.notify();
+  }
+}
+
+bool ThreadPool::tryRun(Task task)
+{
+  if (threads_.empty())
+  {
+    task();
+    return true;
+  }
+  MutexLockGuard lock(mutex_);
+  if (!running_ || isFull())
+  {
+    return false;
+  }
+  queue_.push_back(std::move(task));
+  notEmpty_.notify();
+  return true;
+}
+
+ThreadPool::Task ThreadPool::take()
+{
+  MutexLockGuard lock(mutex_);
+  // always use a while-loop, due to spurious wakeup
+  while (queue_.empty() && running_)
+  {
+    notEmpty_.wait();
+  }
+  Task task;
+  if (!queue_.empty())
+  {
+    task = queue_.front();
+    queue_.pop_front();
+    if (maxQueueSize_ > 0)
+    {
+      notFull_.notify();
+    }
+  }
+  return task;
+}
+
+bool ThreadPool::isFull() const
+{
+  mutex_.assertLocked();
+  return maxQueueSize_ > 0 && queue_.size() >= maxQueueSize_;
+}
+
+void ThreadPool::runInThread()
+{
+  if (threadInitCallback_)
+  {
+    threadInitCallback_();
+  }
+  while (true)
+  {
+    Task task(take());
+    if (!task)
+    {
+      // Stopped and drained.
+      break;
+    }
+    task();
+  }
+}
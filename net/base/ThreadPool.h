@@ -0,0 +1,68 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef VAR_BASE_THREADPOOL_H
+#define VAR_BASE_THREADPOOL_H
+
+#include "Condition.h"
+#include "Mutex.h"
+#include "Thread.h"
+#include "Types.h"
+
+#include <deque>
+#include <vector>
+
+namespace var
+{
+
+///
+/// Fixed number of threads running tasks from a queue, for work that
+/// blocks and must stay off the loop threads.
+///
+class ThreadPool : noncopyable
+{
+ public:
+  typedef std::function<void ()> Task;
+
+  explicit ThreadPool(const string& nameArg = string("ThreadPool"));
+  ~ThreadPool();
+
+  /// Must be called before start(), 0 for an unbounded queue.
+  void setMaxQueueSize(size_t maxSize) { maxQueueSize_ = maxSize; }
+  void setThreadInitCallback(const Task& cb)
+  { threadInitCallback_ = cb; }
+
+  void start(int numThreads);
+  /// Runs the tasks left in the queue before joining the threads.
+  void stop();
+
+  const string& name() const
+  { return name_; }
+
+  size_t queueSize() const;
+
+  /// Blocks while the queue is full, runs task in the calling thread
+  /// if the pool has no threads.
+  void run(Task task);
+  /// Returns false rather than block when the queue is full.
+  bool tryRun(Task task);
+
+ private:
+  bool isFull() const REQUIRES(mutex_);
+  void runInThread();
+  Task take();
+
+  mutable MutexLock mutex_;
+  Condition notEmpty_ GUARDED_BY(mutex_);
+  Condition notFull_ GUARDED_BY(mutex_);
+  string name_;
+  Task threadInitCallback_;
+  std::vector<std::unique_ptr<var::Thread>> threads_;
+  std::deque<Task> queue_ GUARDED_BY(mutex_);
+  size_t maxQueueSize_;
+  bool running_;
+};
+
+}  // namespace var
+
+#endif  // VAR_BASE_THREADPOOL_H
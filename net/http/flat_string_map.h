@@ -0,0 +1,140 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_FLAT_STRING_MAP_H
+#define VAR_HTTP_FLAT_STRING_MAP_H
+
+#include "base/StringPiece.h"
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace var {
+namespace net {
+
+struct CaseSensitiveEqual {
+    bool operator()(const StringPiece& s1, const StringPiece& s2) const {
+        return s1.size() == s2.size() &&
+            memcmp(s1.data(), s2.data(), s1.size()) == 0;
+    }
+};
+
+struct CaseInsensitiveEqual {
+    bool operator()(const StringPiece& s1, const StringPiece& s2) const {
+        return s1.size() == s2.size() &&
+            strncasecmp(s1.data(), s2.data(), s1.size()) == 0;
+    }
+};
+
+// Map of strings for the few headers and queries of a http message, the
+// entries are kept in insertion order in a vector and looked up linearly.
+// clear() keeps the entries with their strings, the next message parsed
+// into the same HttpHeader refills them without allocating.
+template <typename KeyEqual>
+class FlatStringMap {
+public:
+    typedef std::pair<std::string, std::string> value_type;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    FlatStringMap() : _size(0) {}
+
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.begin() + _size; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    // Returns pointer to the value of `key', NULL on not found.
+    const std::string* seek(const StringPiece& key) const {
+        for(size_t i = 0; i < _size; ++i) {
+            if(KeyEqual()(_entries[i].first, key)) {
+                return &_entries[i].second;
+            }
+        }
+        return NULL;
+    }
+
+    // Returns the value of `key', added empty if not found.
+    std::string& operator[](const StringPiece& key) {
+        std::string* value = const_cast<std::string*>(seek(key));
+        if(value) {
+            return *value;
+        }
+        if(_size == _entries.size()) {
+            _entries.emplace_back();
+        }
+        value_type& entry = _entries[_size++];
+        entry.first.assign(key.data(), key.size());
+        return entry.second;
+    }
+
+    // Returns 1 on removed, 0 otherwise.
+    size_t erase(const StringPiece& key) {
+        for(size_t i = 0; i < _size; ++i) {
+            if(KeyEqual()(_entries[i].first, key)) {
+                std::rotate(_entries.begin() + i, _entries.begin() + i + 1,
+                            _entries.begin() + _size);
+                --_size;
+                Release(&_entries[_size]);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    void clear() {
+        // Headers of some message may have been many or long.
+        static const size_t kMaxKeptEntries = 32;
+        if(_entries.size() > kMaxKeptEntries) {
+            _entries.resize(kMaxKeptEntries);
+        }
+        _size = std::min(_size, _entries.size());
+        for(size_t i = 0; i < _size; ++i) {
+            Release(&_entries[i]);
+        }
+        _size = 0;
+    }
+
+    void swap(FlatStringMap& rhs) {
+        _entries.swap(rhs._entries);
+        std::swap(_size, rhs._size);
+    }
+
+private:
+    static void Release(value_type* entry) {
+        static const size_t kMaxKeptCapacity = 4096;
+        if(entry->first.capacity() > kMaxKeptCapacity) {
+            std::string().swap(entry->first);
+        }
+        if(entry->second.capacity() > kMaxKeptCapacity) {
+            std::string().swap(entry->second);
+        }
+        entry->first.clear();
+        entry->second.clear();
+    }
+
+    // [0, _size) are in the map, the rest are kept for reuse.
+    std::vector<value_type> _entries;
+    size_t _size;
+};
+
+} // end namespace net
+} // end namespace var
+
+#endif
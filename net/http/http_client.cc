@@ -0,0 +1,405 @@
+#include "http_client.h"
+#include "http_server.h"
+#include "EventLoop.h"
+#include "base/CountDownLatch.h"
+#include <algorithm>
+#include <errno.h>
+
+namespace var {
+namespace net {
+
+HttpClientOptions::HttpClientOptions()
+    : max_connections_per_host(4)
+    , max_pipeline_depth(1)
+    , timeout(3)
+    , idle_timeout(30) {
+}
+
+struct HttpClient::Call {
+    Call()
+        : head(false)
+        , idempotent(true)
+        , retried(false)
+        , finished(false)
+        , has_timer(false)
+        , pool(NULL)
+        , connection(NULL) {}
+
+    std::string request;
+    bool head;
+    bool idempotent;
+    bool retried;
+    bool finished;
+    bool has_timer;
+    TimerId timer;
+    ResponseCallback done;
+    HostPool* pool;
+    // Where it's sent, NULL while waiting.
+    Connection* connection;
+};
+
+struct HttpClient::Connection {
+    explicit Connection(HostPool* p) : pool(p), closing(false) {}
+
+    HostPool* pool;
+    std::unique_ptr<TcpClient> client;
+    // Null until connected.
+    TcpConnectionPtr conn;
+    // Sent, in the order the responses come.
+    std::deque<CallPtr> in_flight;
+    HttpResponse response;
+    Timestamp idle_since;
+    bool closing;
+};
+
+struct HttpClient::HostPool {
+    explicit HostPool(const InetAddress& server_addr) : addr(server_addr) {}
+
+    InetAddress addr;
+    std::deque<CallPtr> waiting;
+    std::vector<ConnectionPtr> connections;
+};
+
+HttpClient::HttpClient(EventLoop* loop, const std::string& name,
+                       const HttpClientOptions& options)
+    : _loop(loop)
+    , _name(name)
+    , _options(options) {
+    if(_options.idle_timeout > 0) {
+        _idle_timer = _loop->runEvery(std::min(_options.idle_timeout, 1.0),
+                                      std::bind(&HttpClient::CloseIdleConnections, this));
+    }
+}
+
+HttpClient::~HttpClient() {
+    if(_loop->isInLoopThread()) {
+        ShutdownInLoop();
+        return;
+    }
+    CountDownLatch latch(1);
+    _loop->runInLoop([this, &latch]() {
+        ShutdownInLoop();
+        latch.countDown();
+    });
+    latch.wait();
+}
+
+void HttpClient::ShutdownInLoop() {
+    if(_options.idle_timeout > 0) {
+        _loop->cancel(_idle_timer);
+    }
+    std::vector<CallPtr> calls;
+    std::map<std::string, std::unique_ptr<HostPool>> pools;
+    pools.swap(_pools);
+    for(auto& kv : pools) {
+        HostPool* pool = kv.second.get();
+        calls.insert(calls.end(), pool->waiting.begin(), pool->waiting.end());
+        for(const ConnectionPtr& connection : pool->connections) {
+            calls.insert(calls.end(), connection->in_flight.begin(),
+                         connection->in_flight.end());
+            const TcpConnectionPtr& conn = connection->conn;
+            if(conn) {
+                // Closed right away rather than queued, the loop may be
+                // about to quit.
+                conn->setConnectionCallback(defaultConnectionCallback);
+                conn->setMessageCallback(defaultMessageCallback);
+                conn->connectDestroyed();
+                connection->conn.reset();
+            }
+        }
+    }
+    pools.clear();
+    for(const CallPtr& call : calls) {
+        Finish(call, ECANCELED, NULL);
+    }
+}
+
+void HttpClient::DoAsync(const InetAddress& server_addr, HttpRequest* request,
+                         const ResponseCallback& done) {
+    HttpHeader& header = request->header();
+    const bool add_host = !header.GetHeader("Host") && header.url().host().empty();
+    if(add_host) {
+        header.SetHeader("Host", server_addr.toIpPort());
+    }
+    CallPtr call(new Call);
+    call->request = HttpServer::MakeHttpRequestStr(&header, &request->body());
+    if(add_host) {
+        header.RemoveHeader("Host");
+    }
+    call->head = header.method() == HTTP_METHOD_HEAD;
+    // rfc7231#section-4.2.2
+    call->idempotent = header.method() != HTTP_METHOD_POST &&
+                       header.method() != HTTP_METHOD_PATCH;
+    call->done = done;
+    _loop->runInLoop(std::bind(&HttpClient::DoInLoop, this, server_addr, call));
+}
+
+int HttpClient::Do(const InetAddress& server_addr, HttpRequest* request,
+                   HttpResponse* response) {
+    assert(!_loop->isInLoopThread());
+    CountDownLatch latch(1);
+    int rc = 0;
+    DoAsync(server_addr, request, [&](int error, HttpResponse* received) {
+        rc = error;
+        if(received) {
+            response->header().Swap(received->header());
+            response->body().swap(received->body());
+        }
+        latch.countDown();
+    });
+    latch.wait();
+    return rc;
+}
+
+void HttpClient::DoInLoop(const InetAddress& server_addr, const CallPtr& call) {
+    _loop->assertInLoopThread();
+    std::unique_ptr<HostPool>& pool = _pools[server_addr.toIpPort()];
+    if(!pool) {
+        pool.reset(new HostPool(server_addr));
+    }
+    call->pool = pool.get();
+    if(_options.timeout > 0) {
+        call->timer = _loop->runAfter(_options.timeout, std::bind(&HttpClient::OnTimeout,
+                                      this, std::weak_ptr<Call>(call)));
+        call->has_timer = true;
+    }
+    pool->waiting.push_back(call);
+    Dispatch(pool.get());
+}
+
+void HttpClient::Dispatch(HostPool* pool) {
+    const size_t max_depth = std::max(_options.max_pipeline_depth, 1);
+    while(!pool->waiting.empty()) {
+        CallPtr call = pool->waiting.front();
+        Connection* target = NULL;
+        size_t connecting = 0;
+        for(const ConnectionPtr& connection : pool->connections) {
+            if(!connection->conn) {
+                ++connecting;
+                continue;
+            }
+            const size_t depth = connection->in_flight.size();
+            if(connection->closing || depth >= max_depth) {
+                continue;
+            }
+            if(depth == 0) {
+                target = connection.get();
+                break;
+            }
+            // Nothing is pipelined with a request that's not idempotent.
+            if(call->idempotent && connection->in_flight.front()->idempotent &&
+                    (!target || depth < target->in_flight.size())) {
+                target = connection.get();
+            }
+        }
+        if(!target || !target->in_flight.empty()) {
+            // All busy, one more is opened for the requests to come.
+            if(connecting == 0 && pool->connections.size() <
+                    static_cast<size_t>(_options.max_connections_per_host)) {
+                OpenConnection(pool);
+            }
+            if(!target) {
+                return;
+            }
+        }
+        pool->waiting.pop_front();
+        call->connection = target;
+        target->in_flight.push_back(call);
+        target->conn->send(call->request);
+    }
+}
+
+void HttpClient::OpenConnection(HostPool* pool) {
+    ConnectionPtr connection(new Connection(pool));
+    connection->response.set_stop_at_message_end(true);
+    connection->client.reset(new TcpClient(_loop, pool->addr, _name));
+    connection->client->setConnectionCallback(
+        std::bind(&HttpClient::OnConnection, this, connection.get(), _1));
+    connection->client->setMessageCallback(
+        std::bind(&HttpClient::OnMessage, this, connection.get(), _1, _2, _3));
+    pool->connections.push_back(connection);
+    connection->client->connect();
+}
+
+void HttpClient::CloseConnection(Connection* connection) {
+    if(connection->closing) {
+        return;
+    }
+    connection->closing = true;
+    if(connection->conn) {
+        // The requests left are dealt with in OnDisconnected().
+        connection->conn->forceClose();
+    }
+    else {
+        RemoveConnection(connection);
+    }
+}
+
+void HttpClient::OnConnection(Connection* connection, const TcpConnectionPtr& conn) {
+    if(conn->connected()) {
+        connection->conn = conn;
+        // Requests are written whole, pipelined ones must not wait for
+        // the ACK of the one before.
+        conn->setTcpNoDelay(true);
+        connection->idle_since = Timestamp::now();
+        Dispatch(connection->pool);
+    }
+    else {
+        OnDisconnected(connection);
+    }
+}
+
+void HttpClient::OnMessage(Connection* connection, const TcpConnectionPtr& conn,
+                           Buffer* buf, Timestamp) {
+    HttpResponse& response = connection->response;
+    while(buf->readableBytes() > 0 && !connection->closing) {
+        if(connection->in_flight.empty()) {
+            LOG_WARN << "Unexpected " << buf->readableBytes() << " bytes from "
+                     << conn->peerAddress().toIpPort();
+            buf->retrieveAll();
+            CloseConnection(connection);
+            break;
+        }
+        if(response.stage() == HTTP_ON_MESSAGE_BEGIN) {
+            response.set_response_to_head(connection->in_flight.front()->head);
+        }
+        // The parser stops at the end of a response.
+        const ssize_t rc = response.ParseFromBytes(buf->peek(), buf->readableBytes());
+        if(rc < 0 || static_cast<size_t>(rc) > buf->readableBytes()) {
+            LOG_ERROR << "Fail to parse the response from " << conn->peerAddress().toIpPort();
+            buf->retrieveAll();
+            CallPtr call = connection->in_flight.front();
+            connection->in_flight.pop_front();
+            Finish(call, EPROTO, NULL);
+            CloseConnection(connection);
+            break;
+        }
+        buf->retrieve(rc);
+        if(!response.Completed()) {
+            break;
+        }
+        CallPtr call = connection->in_flight.front();
+        connection->in_flight.pop_front();
+        const bool keep_alive = http_should_keep_alive(&response.parser());
+        Finish(call, 0, &response);
+        response.Reset();
+        if(!keep_alive) {
+            CloseConnection(connection);
+            break;
+        }
+    }
+    if(connection->in_flight.empty()) {
+        connection->idle_since = Timestamp::now();
+    }
+    Dispatch(connection->pool);
+}
+
+void HttpClient::OnDisconnected(Connection* connection) {
+    HttpResponse& response = connection->response;
+    std::deque<CallPtr> in_flight;
+    in_flight.swap(connection->in_flight);
+    // Bodies without a length end with the connection.
+    if(!in_flight.empty() && response.stage() >= HTTP_ON_HEADERS_COMPLETE &&
+            response.ParseFromBytes(NULL, 0) == 0 && response.Completed()) {
+        Finish(in_flight.front(), 0, &response);
+        in_flight.pop_front();
+        response.Reset();
+    }
+    const bool partial = response.stage() != HTTP_ON_MESSAGE_BEGIN;
+    HostPool* pool = connection->pool;
+    connection->conn.reset();
+    RemoveConnection(connection);
+    // Those not answered at all are sent once more on another connection,
+    // the server may have closed an idle one as they went out. Pushed to
+    // the front in reverse to keep their order.
+    for(auto it = in_flight.rbegin(); it != in_flight.rend(); ++it) {
+        CallPtr call = *it;
+        if(call->finished) {
+            continue;
+        }
+        call->connection = NULL;
+        const bool answered = partial && call == in_flight.front();
+        if(call->idempotent && !call->retried && !answered) {
+            call->retried = true;
+            pool->waiting.push_front(call);
+        }
+        else {
+            Finish(call, ECONNRESET, NULL);
+        }
+    }
+    Dispatch(pool);
+}
+
+void HttpClient::RemoveConnection(Connection* connection) {
+    std::vector<ConnectionPtr>& connections = connection->pool->connections;
+    for(size_t i = 0; i < connections.size(); ++i) {
+        if(connections[i].get() == connection) {
+            ConnectionPtr removed = connections[i];
+            connections.erase(connections.begin() + i);
+            // Its TcpClient is still in the callback running.
+            _loop->queueInLoop([removed]() {});
+            return;
+        }
+    }
+}
+
+void HttpClient::OnTimeout(const std::weak_ptr<Call>& weak_call) {
+    CallPtr call = weak_call.lock();
+    if(!call || call->finished) {
+        return;
+    }
+    call->has_timer = false;
+    Connection* connection = call->connection;
+    if(!connection) {
+        // Unfinished calls without a connection wait in the pool, checked
+        // rather than erasing end() should that ever break.
+        std::deque<CallPtr>& waiting = call->pool->waiting;
+        auto it = std::find(waiting.begin(), waiting.end(), call);
+        if(it != waiting.end()) {
+            waiting.erase(it);
+        }
+        Finish(call, ETIMEDOUT, NULL);
+        return;
+    }
+    Finish(call, ETIMEDOUT, NULL);
+    // Its response may still come and be taken for the next one's.
+    CloseConnection(connection);
+}
+
+void HttpClient::CloseIdleConnections() {
+    const Timestamp now = Timestamp::now();
+    for(auto& kv : _pools) {
+        HostPool* pool = kv.second.get();
+        // Copied, closing may drop them from the pool.
+        std::vector<ConnectionPtr> connections(pool->connections);
+        for(const ConnectionPtr& connection : connections) {
+            if(!connection->conn) {
+                // Connecting with nothing to send, e.g. retrying a server
+                // that's down.
+                if(pool->waiting.empty()) {
+                    CloseConnection(connection.get());
+                }
+            }
+            else if(connection->in_flight.empty() &&
+                    timeDifference(now, connection->idle_since) >= _options.idle_timeout) {
+                CloseConnection(connection.get());
+            }
+        }
+    }
+}
+
+void HttpClient::Finish(const CallPtr& call, int error, HttpResponse* response) {
+    if(call->finished) {
+        return;
+    }
+    call->finished = true;
+    call->connection = NULL;
+    if(call->has_timer) {
+        _loop->cancel(call->timer);
+        call->has_timer = false;
+    }
+    call->done(error, response);
+}
+
+} // end namespace net
+} // end namespace var
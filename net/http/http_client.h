@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_CLIENT_H
+#define VAR_HTTP_CLIENT_H
+
+#include "http_context.h"
+#include "tcp/TcpClient.h"
+#include "TimerId.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace var {
+namespace net {
+
+// How HttpClient keeps connections and waits for responses.
+struct HttpClientOptions {
+    HttpClientOptions();
+
+    // Connections opened to each server at most, the requests they can't
+    // take wait in a queue of the server.
+    int max_connections_per_host;
+    // Requests sent on a connection before the response of the first one
+    // comes, 1 sends them one at a time. Only idempotent requests are
+    // pipelined, the others go alone on an idle connection.
+    int max_pipeline_depth;
+    // Seconds from DoAsync() to the response, connecting and waiting for
+    // a connection included. <= 0 waits forever.
+    double timeout;
+    // Seconds an idle connection is kept open.
+    double idle_timeout;
+};
+
+// Asynchronous http/1.1 client keeping a pool of keep-alive connections
+// to each server it talks to. Connections and callbacks are in the loop
+// given, requests may be sent from any thread.
+class HttpClient : noncopyable {
+public:
+    // Called in the loop thread with 0 and the response, only valid in
+    // the call, or with an errno and NULL:
+    //  ETIMEDOUT   no response within HttpClientOptions::timeout,
+    //  ECONNRESET  the connection closed before the whole response came,
+    //  EPROTO      the response could not be parsed,
+    //  ECANCELED   the client is destroyed.
+    typedef std::function<void(int error, HttpResponse* response)> ResponseCallback;
+
+    HttpClient(EventLoop* loop, const std::string& name,
+               const HttpClientOptions& options = HttpClientOptions());
+    // Closes the connections and fails the requests left with ECANCELED.
+    // Waits for the loop to do it unless called in the loop thread.
+    ~HttpClient();
+
+    // Sends `request' to `server_addr', `done' is called with the response.
+    // The request is serialized before this returns, Host is the address
+    // of the server unless set in the header or url.
+    void DoAsync(const InetAddress& server_addr, HttpRequest* request,
+                 const ResponseCallback& done);
+
+    // Sends `request' and waits for the response, which is swapped into
+    // `response'. Returns 0 or the error given to ResponseCallback.
+    // Never call it in the loop thread.
+    int Do(const InetAddress& server_addr, HttpRequest* request,
+           HttpResponse* response);
+
+    EventLoop* loop() const { return _loop; }
+
+private:
+    struct Call;
+    struct Connection;
+    struct HostPool;
+    typedef std::shared_ptr<Call> CallPtr;
+    typedef std::shared_ptr<Connection> ConnectionPtr;
+
+    void ShutdownInLoop();
+    void DoInLoop(const InetAddress& server_addr, const CallPtr& call);
+    // Sends the waiting requests of pool on its connections, opening
+    // more if they are busy.
+    void Dispatch(HostPool* pool);
+    void OpenConnection(HostPool* pool);
+    void CloseConnection(Connection* connection);
+    void OnConnection(Connection* connection, const TcpConnectionPtr& conn);
+    void OnMessage(Connection* connection, const TcpConnectionPtr& conn,
+                   Buffer* buf, Timestamp time);
+    void OnDisconnected(Connection* connection);
+    // Drops connection from its pool, it's deleted after the callback
+    // running goes.
+    void RemoveConnection(Connection* connection);
+    void OnTimeout(const std::weak_ptr<Call>& weak_call);
+    void CloseIdleConnections();
+    void Finish(const CallPtr& call, int error, HttpResponse* response);
+
+    EventLoop* _loop;
+    const std::string _name;
+    const HttpClientOptions _options;
+    TimerId _idle_timer;
+    // By "ip:port" of the servers.
+    std::map<std::string, std::unique_ptr<HostPool>> _pools;
+};
+
+} // end namespace net
+} // end namespace var
+
+#endif // VAR_HTTP_CLIENT_H
@@ -0,0 +1,166 @@
+#include "http_compress.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <zlib.h>
+
+namespace var {
+namespace net {
+
+const char* HttpCompressTypeName(HttpCompressType type) {
+    switch(type) {
+    case HTTP_COMPRESS_GZIP:
+        return "gzip";
+    case HTTP_COMPRESS_DEFLATE:
+        return "deflate";
+    default:
+        return NULL;
+    }
+}
+
+static bool IsSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static bool EqualsIgnoreCase(const char* begin, const char* end, const char* str) {
+    const size_t len = strlen(str);
+    return static_cast<size_t>(end - begin) == len && strncasecmp(begin, str, len) == 0;
+}
+
+// q of "coding;q=0.5", 1 when not given.
+static double ParseQuality(const char* params, const char* end) {
+    for(const char* p = params; p < end; ++p) {
+        if((*p == 'q' || *p == 'Q') && p + 1 < end && p[1] == '=') {
+            return strtod(p + 2, NULL);
+        }
+    }
+    return 1;
+}
+
+HttpCompressType NegotiateHttpCompressType(const std::string* accept_encoding) {
+    if(!accept_encoding) {
+        return HTTP_COMPRESS_NONE;
+    }
+    // -1 for codings not listed.
+    double gzip = -1;
+    double deflate = -1;
+    double any = -1;
+    const char* p = accept_encoding->c_str();
+    const char* const end = p + accept_encoding->size();
+    while(p < end) {
+        const char* item_end = static_cast<const char*>(memchr(p, ',', end - p));
+        if(!item_end) {
+            item_end = end;
+        }
+        const char* params = static_cast<const char*>(memchr(p, ';', item_end - p));
+        const char* name_end = params ? params : item_end;
+        while(p < name_end && IsSpace(*p)) {
+            ++p;
+        }
+        while(name_end > p && IsSpace(name_end[-1])) {
+            --name_end;
+        }
+        const double q = params ? ParseQuality(params, item_end) : 1;
+        if(EqualsIgnoreCase(p, name_end, "gzip") || EqualsIgnoreCase(p, name_end, "x-gzip")) {
+            gzip = q;
+        }
+        else if(EqualsIgnoreCase(p, name_end, "deflate")) {
+            deflate = q;
+        }
+        else if(EqualsIgnoreCase(p, name_end, "*")) {
+            any = q;
+        }
+        p = item_end + 1;
+    }
+    if(gzip > 0 || (gzip < 0 && any > 0)) {
+        return HTTP_COMPRESS_GZIP;
+    }
+    if(deflate > 0 || (deflate < 0 && any > 0)) {
+        return HTTP_COMPRESS_DEFLATE;
+    }
+    return HTTP_COMPRESS_NONE;
+}
+
+bool IsCompressibleContentType(const std::string& content_type) {
+    const char* type = content_type.c_str();
+    if(strncasecmp(type, "text/", 5) == 0) {
+        return true;
+    }
+    const char* subtype = strchr(type, '/');
+    if(!subtype) {
+        return false;
+    }
+    ++subtype;
+    size_t len = strcspn(subtype, "; ");
+    static const char* const kSubtypes[] = {
+        "javascript", "json", "xml", "svg+xml", "x-javascript"
+    };
+    for(size_t i = 0; i < sizeof(kSubtypes) / sizeof(kSubtypes[0]); ++i) {
+        if(EqualsIgnoreCase(subtype, subtype + len, kSubtypes[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// windowBits of zlib for the coding.
+static int WindowBits(HttpCompressType type) {
+    return type == HTTP_COMPRESS_GZIP ? 15 + 16 : 15;
+}
+
+bool HttpCompress(HttpCompressType type, const char* data, size_t size,
+                  int level, Buffer* out) {
+    if(type == HTTP_COMPRESS_NONE) {
+        return false;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(deflateInit2(&stream, level, Z_DEFLATED, WindowBits(type),
+                    8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    // One deflate() call into room for the worst case.
+    const size_t bound = deflateBound(&stream, size);
+    out->ensureWritableBytes(bound);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef*>(out->beginWrite());
+    stream.avail_out = static_cast<uInt>(bound);
+    const int rc = deflate(&stream, Z_FINISH);
+    const size_t written = bound - stream.avail_out;
+    deflateEnd(&stream);
+    if(rc != Z_STREAM_END) {
+        return false;
+    }
+    out->hasWritten(written);
+    return true;
+}
+
+bool HttpDecompress(HttpCompressType type, const char* data, size_t size,
+                    Buffer* out) {
+    if(type == HTTP_COMPRESS_NONE) {
+        return false;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(inflateInit2(&stream, WindowBits(type)) != Z_OK) {
+        return false;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    int rc = Z_OK;
+    while(rc == Z_OK) {
+        out->ensureWritableBytes(std::max<size_t>(size * 2, 4096));
+        const size_t room = out->writableBytes();
+        stream.next_out = reinterpret_cast<Bytef*>(out->beginWrite());
+        stream.avail_out = static_cast<uInt>(room);
+        rc = inflate(&stream, Z_NO_FLUSH);
+        out->hasWritten(room - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return rc == Z_STREAM_END;
+}
+
+} // end namespace net
+} // end namespace var
@@ -0,0 +1,57 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_COMPRESS_H
+#define VAR_HTTP_COMPRESS_H
+
+#include "Buffer.h"
+#include <string>
+
+namespace var {
+namespace net {
+
+// Content codings of http bodies.
+enum HttpCompressType {
+    HTTP_COMPRESS_NONE,
+    HTTP_COMPRESS_GZIP,
+    HTTP_COMPRESS_DEFLATE       // The zlib format, see rfc7230#section-4.2.2
+};
+
+// "gzip", "deflate", NULL for HTTP_COMPRESS_NONE.
+const char* HttpCompressTypeName(HttpCompressType type);
+
+// The coding to send a body in to a client whose Accept-Encoding is
+// `accept_encoding', gzip over deflate. Codings with q=0 are refused.
+// NULL and codings other than those give HTTP_COMPRESS_NONE.
+HttpCompressType NegotiateHttpCompressType(const std::string* accept_encoding);
+
+// True for textual types, which are worth compressing.
+bool IsCompressibleContentType(const std::string& content_type);
+
+// Appends `data' compressed at `level' of zlib to `out'.
+// Returns true on success.
+bool HttpCompress(HttpCompressType type, const char* data, size_t size,
+                  int level, Buffer* out);
+
+// Appends `data' decompressed to `out'. Returns true on success.
+bool HttpDecompress(HttpCompressType type, const char* data, size_t size,
+                    Buffer* out);
+
+} // end namespace net
+} // end namespace var
+
+#endif
@@ -28,12 +28,36 @@ typedef HttpMessage HttpResponse;
 
 class HttpContext : public HttpMessage {
 public:
-    inline HttpContext() : _has_resolved(false) {}
+    inline HttpContext() : _has_resolved(false), _response_pending(false) {}
     inline void SetStageToResolved() { _has_resolved = true; }
     inline bool GetResolvedStage() { return _has_resolved; }
 
+    // Readies the context for the next request of the connection,
+    // a pending response stays pending.
+    inline void Reset() {
+        HttpMessage::Reset();
+        _has_resolved = false;
+    }
+
+    // A response of the connection is still being made in a worker thread
+    // or streamed by `attachment', the requests after it wait in the input
+    // buffer so that responses go out in order.
+    inline void SetResponsePending(const std::weak_ptr<ProgressiveAttachment>& attachment =
+                                   std::weak_ptr<ProgressiveAttachment>()) {
+        _response_pending = true;
+        _attachment = attachment;
+    }
+    inline void ClearResponsePending() {
+        _response_pending = false;
+        _attachment.reset();
+    }
+    inline bool response_pending() const { return _response_pending; }
+    inline std::shared_ptr<ProgressiveAttachment> attachment() const { return _attachment.lock(); }
+
 private:
     bool _has_resolved;
+    bool _response_pending;
+    std::weak_ptr<ProgressiveAttachment> _attachment;
 };
 
 }   // end namespace net
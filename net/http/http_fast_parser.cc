@@ -0,0 +1,257 @@
+#include "http_fast_parser.h"
+#include <algorithm>
+#include <string.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace var {
+namespace net {
+
+namespace {
+
+// Bytes ending a url: CTLs, SP and DEL, all others are taken by http_parser.
+inline bool IsUrlStop(unsigned char c) {
+    return c <= ' ' || c == 0x7f;
+}
+
+// Bytes ending a header value: CTLs but HT, and DEL.
+inline bool IsValueStop(unsigned char c) {
+    return (c < ' ' && c != '\t') || c == 0x7f;
+}
+
+// tchar of rfc7230, same as the tokens of http_parser.
+struct TokenTable {
+    TokenTable() {
+        memset(token, 0, sizeof(token));
+        for(int c = '0'; c <= '9'; ++c) {
+            token[c] = true;
+        }
+        for(int c = 'a'; c <= 'z'; ++c) {
+            token[c] = true;
+            token[c - 'a' + 'A'] = true;
+        }
+        for(const char* p = "!#$%&'*+-.^_`|~"; *p; ++p) {
+            token[(unsigned char)*p] = true;
+        }
+    }
+    bool token[256];
+};
+
+const TokenTable g_token_table;
+
+#if defined(__x86_64__)
+// Ranges of bytes _mm_cmpestri stops at, in pairs of [low, high].
+alignas(16) const char kUrlStopRanges[16] = "\x00 \x7f\x7f";
+const int kUrlStopRangesSize = 4;
+alignas(16) const char kValueStopRanges[16] = "\x00\x08\x0a\x1f\x7f\x7f";
+const int kValueStopRangesSize = 6;
+
+__attribute__((target("sse4.2")))
+const char* FindStopSse42(const char* p, const char* end,
+                          const char* ranges, int ranges_size) {
+    const __m128i r = _mm_load_si128((const __m128i*)ranges);
+    while(end - p >= 16) {
+        const __m128i b = _mm_loadu_si128((const __m128i*)p);
+        const int i = _mm_cmpestri(r, ranges_size, b, 16,
+                                   _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                                   _SIDD_LEAST_SIGNIFICANT);
+        if(i != 16) {
+            return p + i;
+        }
+        p += 16;
+    }
+    return p;
+}
+
+// Called by the static initializers, before the cpu model is set up.
+bool HasSse42() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+const bool g_has_sse42 = HasSse42();
+#endif
+
+// Returns the first url stop in [p, end), or end.
+inline const char* FindUrlStop(const char* p, const char* end) {
+#if defined(__x86_64__)
+    if(g_has_sse42) {
+        p = FindStopSse42(p, end, kUrlStopRanges, kUrlStopRangesSize);
+    }
+#endif
+    while(p != end && !IsUrlStop(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the first value stop in [p, end), or end.
+inline const char* FindValueStop(const char* p, const char* end) {
+#if defined(__x86_64__)
+    if(g_has_sse42) {
+        p = FindStopSse42(p, end, kValueStopRanges, kValueStopRangesSize);
+    }
+#endif
+    while(p != end && !IsValueStop(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Exact, upper case methods only as http_parser.
+bool ParseMethod(const char* p, size_t n, HttpMethod* method) {
+    switch(n) {
+    case 3:
+        if(memcmp(p, "GET", 3) == 0) {
+            *method = HTTP_METHOD_GET;
+            return true;
+        }
+        if(memcmp(p, "PUT", 3) == 0) {
+            *method = HTTP_METHOD_PUT;
+            return true;
+        }
+        return false;
+    case 4:
+        if(memcmp(p, "POST", 4) == 0) {
+            *method = HTTP_METHOD_POST;
+            return true;
+        }
+        if(memcmp(p, "HEAD", 4) == 0) {
+            *method = HTTP_METHOD_HEAD;
+            return true;
+        }
+        return false;
+    case 5:
+        if(memcmp(p, "PATCH", 5) == 0) {
+            *method = HTTP_METHOD_PATCH;
+            return true;
+        }
+        return false;
+    case 6:
+        if(memcmp(p, "DELETE", 6) == 0) {
+            *method = HTTP_METHOD_DELETE;
+            return true;
+        }
+        return false;
+    case 7:
+        if(memcmp(p, "OPTIONS", 7) == 0) {
+            *method = HTTP_METHOD_OPTIONS;
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+ssize_t ParseHttpRequestFast(const char* data, size_t length,
+                             HttpFastRequest* request) {
+    const char* p = data;
+    const char* const end = data + length;
+
+    // Method.
+    const char* const method = p;
+    while(p != end && *p != ' ') {
+        if(!g_token_table.token[(unsigned char)*p]) {
+            return -1;
+        }
+        ++p;
+    }
+    if(p == end) {
+        return 0;
+    }
+    if(!ParseMethod(method, p - method, &request->method)) {
+        return -1;
+    }
+    ++p;
+
+    // Url.
+    if(p == end) {
+        return 0;
+    }
+    if(*p != '/') {
+        return -1;
+    }
+    const char* const url = p;
+    p = FindUrlStop(p, end);
+    if(p == end) {
+        return 0;
+    }
+    if(*p != ' ') {
+        return -1;
+    }
+    request->url.set(url, static_cast<int>(p - url));
+    ++p;
+
+    // Version.
+    static const char kVersion[] = "HTTP/1.";
+    static const size_t kVersionLength = sizeof(kVersion) - 1;
+    if(static_cast<size_t>(end - p) < kVersionLength + 3) {
+        return memcmp(p, kVersion, std::min<size_t>(end - p, kVersionLength)) == 0 ? 0 : -1;
+    }
+    if(memcmp(p, kVersion, kVersionLength) != 0) {
+        return -1;
+    }
+    p += kVersionLength;
+    if(*p < '0' || *p > '9' || p[1] != '\r' || p[2] != '\n') {
+        return -1;
+    }
+    request->minor_version = *p - '0';
+    p += 3;
+
+    // Headers.
+    request->num_headers = 0;
+    while(true) {
+        if(p == end) {
+            return 0;
+        }
+        if(*p == '\r') {
+            if(p + 1 == end) {
+                return 0;
+            }
+            if(p[1] != '\n') {
+                return -1;
+            }
+            return p + 2 - data;
+        }
+        if(request->num_headers == HttpFastRequest::kMaxHeaders) {
+            return -1;
+        }
+        // Also rejects the SP/HT of a folded value.
+        const char* const name = p;
+        while(p != end && *p != ':') {
+            if(!g_token_table.token[(unsigned char)*p]) {
+                return -1;
+            }
+            ++p;
+        }
+        if(p == end) {
+            return 0;
+        }
+        if(p == name) {
+            return -1;
+        }
+        HttpFastHeader& header = request->headers[request->num_headers++];
+        header.name.set(name, static_cast<int>(p - name));
+        ++p;
+        while(p != end && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+        const char* const value = p;
+        p = FindValueStop(p, end);
+        if(p == end || p + 1 == end) {
+            return 0;
+        }
+        if(p[0] != '\r' || p[1] != '\n') {
+            return -1;
+        }
+        header.value.set(value, static_cast<int>(p - value));
+        p += 2;
+    }
+}
+
+} // end namespace net
+} // end namespace var
@@ -0,0 +1,60 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_FAST_PARSER_H
+#define VAR_HTTP_FAST_PARSER_H
+
+#include "http_method.h"
+#include "base/StringPiece.h"
+#include <sys/types.h>
+
+namespace var {
+namespace net {
+
+struct HttpFastHeader {
+    StringPiece name;
+    StringPiece value;
+};
+
+// A request line and headers scanned in one go, all the pieces point
+// into the scanned bytes.
+struct HttpFastRequest {
+    static const size_t kMaxHeaders = 64;
+
+    HttpMethod method;
+    StringPiece url;
+    int minor_version;
+    HttpFastHeader headers[kMaxHeaders];
+    size_t num_headers;
+};
+
+// Scans the request line and the headers of the request at the start of
+// [data, data + length), looking for the delimiters 16 bytes at a time
+// with SSE4.2 when the cpu has it.
+// Returns the length up to and including the empty line ending the
+// headers, 0 if they are not all there yet, -1 if the request is not one
+// the fast path takes: malformed, a method other than GET/HEAD/POST/PUT/
+// DELETE/OPTIONS/PATCH, not HTTP/1.x, a url not starting with '/', lines
+// not ended by CRLF, folded values or more than kMaxHeaders headers.
+// http_parser is left with those and says what is wrong.
+ssize_t ParseHttpRequestFast(const char* data, size_t length,
+                             HttpFastRequest* request);
+
+} // end namespace net
+} // end namespace var
+
+#endif
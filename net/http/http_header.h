@@ -21,41 +21,14 @@
 #include "http_url.h"
 #include "http_status_code.h"
 #include "http_method.h"
+#include "flat_string_map.h"
 
 namespace var {
 namespace net {
 
-struct HeaderStringHash : public std::hash<std::string> {
-    std::size_t operator()(const std::string& s) const {
-        std::size_t result = 0;
-        for(std::string::const_iterator i = s.begin(); i != s.end(); ++i) {
-            result = result * 101 + std::tolower(*i);
-        }
-        return result;
-    }
-    std::size_t operator()(const char* s) const {
-        std::size_t result = 0;
-        for(; *s; ++s) {
-            result = result * 101 + std::tolower(*s);
-        }
-        return result;
-    }
-};
-
-struct HeaderStringEqual : public std::equal_to<std::string> {
-    bool operator()(const std::string& s1, const std::string& s2) const {
-        return s1.size() == s2.size() &&
-            strcasecmp(s1.c_str(), s2.c_str()) == 0;
-    }
-    bool operator()(const std::string& s1, const char* s2) const {
-        return strcasecmp(s1.c_str(), s2) == 0;
-    }
-};
-
 class HttpHeader {
 public:
-    typedef std::unordered_map<std::string, std::string, 
-    HeaderStringHash, HeaderStringEqual> HeaderMap;
+    typedef FlatStringMap<CaseInsensitiveEqual> HeaderMap;
     typedef HeaderMap::const_iterator HeaderIterator;
 
     HttpHeader();
@@ -92,8 +65,8 @@ public:
     // point to the same value.
     // Return pointer to the value, NULL on not found.
     // NOTE: Not work for "Content-Type", call content_type() instead.
-    const std::string* GetHeader(const char* key) const;
-    const std::string* GetHeader(const std::string& key) const { return GetHeader(key.c_str()); }
+    // The pointer is invalidated by adding or removing headers.
+    const std::string* GetHeader(const StringPiece& key) const { return _headers.seek(key); }
 
     // Set value of a header.
     // NOTE: Not work for "Content-Type", call set_content_type() instead.
@@ -102,8 +75,7 @@ public:
     }
 
     // Remove a header.
-    void RemoveHeader(const char* key) { _headers.erase(key); }
-    void RemoveHeader(const std::string& key) { _headers.erase(key); }
+    void RemoveHeader(const StringPiece& key) { _headers.erase(key); }
 
     // Append value to a header. If the header already exists, separate
     // old value and new value with comma(,) according to:
@@ -111,6 +83,7 @@ public:
     void AppendHeader(const std::string& key, const std::string& value);
 
     // Get header iterators which are invaildated after calling AppendHeader().
+    // Headers are iterated in the order they were added.
     HeaderIterator HeaderBegin() const { return _headers.begin(); }
     HeaderIterator HeaderEnd() const { return _headers.end(); }
 
@@ -155,7 +128,7 @@ public:
 private:
 friend class HttpMessage;
 
-    std::string& GetOrAddHeader(const std::string& key) {
+    std::string& GetOrAddHeader(const StringPiece& key) {
         return _headers[key];
     }
 
@@ -170,14 +143,6 @@ friend class HttpMessage;
 
 const HttpHeader& DefaultHttpHeader();
 
-inline const std::string* HttpHeader::GetHeader(const char* key) const {
-    HeaderIterator it = _headers.find(key);
-    if(it == HeaderEnd()) {
-        return NULL;
-    }
-    return &it->second;
-}
-
 } // end namespace net
 } // end namespace var
 
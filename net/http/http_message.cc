@@ -1,4 +1,7 @@
 #include "http_message.h"
+#include "http_fast_parser.h"
+#include <strings.h>
+#include <unistd.h>
 
 using namespace var;
 using namespace var::net;
@@ -73,31 +76,38 @@ int HttpMessage::on_header_value(http_parser* parser,
 
 int HttpMessage::on_headers_complete(http_parser* parser) {
     HttpMessage* http_message = (HttpMessage*)parser->data;
-    http_message->_stage = HTTP_ON_HEADERS_COMPLETE;
-    // Resolved and set content-type.
-    const std::string* content_type = http_message->header().GetHeader("content-type");
-    if(content_type) {
-        http_message->header().set_content_type(*content_type);
-        http_message->header().RemoveHeader("content-type");
-    }
     if(parser->http_major > 1) {
         parser->http_major = 1;
     }
-    http_message->header().set_version(parser->http_major, parser->http_minor);
+    const int rc = http_message->OnHeadersComplete(
+        parser->http_major, parser->http_minor, parser->status_code,
+        static_cast<HttpMethod>(parser->method), parser->type == HTTP_REQUEST);
+    // 1 tells http_parser there's no body.
+    return rc == 0 && http_message->_response_to_head ? 1 : rc;
+}
+
+int HttpMessage::OnHeadersComplete(int major, int minor, int status_code,
+                                   HttpMethod method, bool is_request) {
+    _stage = HTTP_ON_HEADERS_COMPLETE;
+    // Resolved and set content-type.
+    const std::string* content_type = header().GetHeader("content-type");
+    if(content_type) {
+        header().set_content_type(*content_type);
+        header().RemoveHeader("content-type");
+    }
+    header().set_version(major, minor);
     // Only for response
     // http_parser may set status_code to 0 when the field is not needed,
     // e.g. in a request. In principle status_code is undefined in a request,
     // but to be consistent and not surprise users, we set it to OK as well.
-    http_message->header().set_status_code(
-        !parser->status_code ? HTTP_STATUS_OK : parser->status_code);
+    header().set_status_code(!status_code ? HTTP_STATUS_OK : status_code);
     
     // Only for request
     // method is 0(which is DELETE) for response as well. Since users are
     // unlikely to check method of a response, we don't do anything.
-    http_message->header().set_method(static_cast<HttpMethod>(parser->method));
+    header().set_method(method);
     // Resolved the http url here.
-    if(parser->type == HTTP_REQUEST &&
-            http_message->header().url().ResolvedHttpURL(http_message->_url) != 0) {
+    if(is_request && header().url().ResolvedHttpURL(_url) != 0) {
         return -1;
     }
     // rfc2616-sec5.2
@@ -107,13 +117,16 @@ int HttpMessage::on_headers_complete(http_parser* parser) {
     // Host header field, the host is determined by the Host header field value.
     // 3. If the host as determined by rule 1 or 2 is not a valid host on the
     // server, the responce MUST be a 400 error messsage.
-    HttpUrl& url = http_message->header().url();
+    HttpUrl& url = header().url();
     if(url.host().empty()) {
-        const std::string* host_header = http_message->header().GetHeader("host");
+        const std::string* host_header = header().GetHeader("host");
         if(host_header) {
             url.ResolvedHttpHostAndPort(*host_header);
         }
     }
+    if(_headers_callback) {
+        _headers_callback(this);
+    }
     return 0;
 }
 
@@ -124,16 +137,27 @@ int HttpMessage::on_body(http_parser* parser,
 
 int HttpMessage::on_message_complete(http_parser* parser) {
     HttpMessage* http_message = (HttpMessage*)parser->data;
-    if(http_message->_stage != HTTP_ON_MESSAGE_COMPLETE) {
-        http_message->_stage = HTTP_ON_MESSAGE_COMPLETE;
+    http_message->OnMessageComplete();
+    if(http_message->_stop_at_message_end) {
+        http_parser_pause(parser, 1);
     }
     return 0;
 }
 
+void HttpMessage::OnMessageComplete() {
+    _stage = HTTP_ON_MESSAGE_COMPLETE;
+    if(_reader) {
+        _reader->OnEndOfMessage(true);
+    }
+}
+
 int HttpMessage::OnBody(const char* data, size_t size) {
     if(_stage != HTTP_ON_BODY) {
         _stage = HTTP_ON_BODY;
     }
+    if(_reader) {
+        return _reader->OnReadOnePart(data, size);
+    }
     _body.append(data, size);
     return 0; 
 }
@@ -151,6 +175,8 @@ const http_parser_settings g_parser_settings = {
 
 HttpMessage::HttpMessage() 
     : _stage(HTTP_ON_MESSAGE_BEGIN)
+    , _stop_at_message_end(false)
+    , _response_to_head(false)
     , _parsed_length(0)
     , _cur_value(NULL) {
     http_parser_init(&_parser, HTTP_BOTH);
@@ -160,6 +186,98 @@ HttpMessage::HttpMessage()
 HttpMessage::~HttpMessage() {
 }
 
+void HttpMessage::Reset() {
+    // Bodies of uploads may have grown it a lot.
+    static const size_t kMaxKeptBodyCapacity = 64 * 1024;
+    _stage = HTTP_ON_MESSAGE_BEGIN;
+    _header.Clear();
+    _url.clear();
+    _body.retrieveAll();
+    if(_body.internalCapacity() > kMaxKeptBodyCapacity) {
+        _body.shrink(0);
+    }
+    _body_file.clear();
+    _reader.reset();
+    _attachment.reset();
+    _received_time = Timestamp();
+    http_parser_init(&_parser, HTTP_BOTH);
+    _parser.data = this;
+    _parsed_length = 0;
+    _cur_header.clear();
+    _cur_value = NULL;
+}
+
+void HttpMessage::ReadProgressivelyBy(ProgressiveReader* reader) {
+    _reader.reset(reader);
+}
+
+std::shared_ptr<ProgressiveAttachment> HttpMessage::CreateProgressiveAttachment() {
+    if(!_attachment) {
+        _attachment = std::make_shared<ProgressiveAttachment>();
+    }
+    return _attachment;
+}
+
+void HttpMessage::set_body_file(int fd, int64_t offset, size_t length) {
+    _body_file.clear();
+    _body_file.appendFile(fd, offset, length, [fd]() { ::close(fd); });
+}
+
+static bool IsHeaderName(const StringPiece& name, const char* lower_name, size_t length) {
+    return static_cast<size_t>(name.size()) == length &&
+           strncasecmp(name.data(), lower_name, length) == 0;
+}
+
+ssize_t HttpMessage::ParseFast(const char* data, const size_t length) {
+    HttpFastRequest request;
+    const ssize_t header_length = ParseHttpRequestFast(data, length, &request);
+    if(header_length <= 0 || header_length > BRPC_HTTP_MAX_HEADER_SIZE) {
+        return 0;
+    }
+    // Only bodies delimited by a single Content-Length, all in `data'.
+    size_t content_length = 0;
+    bool has_content_length = false;
+    for(size_t i = 0; i < request.num_headers; ++i) {
+        const HttpFastHeader& h = request.headers[i];
+        if(IsHeaderName(h.name, "content-length", 14)) {
+            if(has_content_length || h.value.empty() || h.value.size() > 18) {
+                return 0;
+            }
+            has_content_length = true;
+            for(const char* p = h.value.begin(); p != h.value.end(); ++p) {
+                if(*p < '0' || *p > '9') {
+                    return 0;
+                }
+                content_length = content_length * 10 + (*p - '0');
+            }
+        } else if(IsHeaderName(h.name, "transfer-encoding", 17) ||
+                  IsHeaderName(h.name, "upgrade", 7)) {
+            return 0;
+        }
+    }
+    if(content_length > length - header_length) {
+        return 0;
+    }
+
+    _url.assign(request.url.data(), request.url.size());
+    for(size_t i = 0; i < request.num_headers; ++i) {
+        const HttpFastHeader& h = request.headers[i];
+        std::string& value = _header.GetOrAddHeader(h.name);
+        if(!value.empty()) {
+            value.push_back(',');
+        }
+        value.append(h.value.data(), h.value.size());
+    }
+    if(OnHeadersComplete(1, request.minor_version, 0, request.method, true) != 0) {
+        return -1;
+    }
+    if(content_length > 0 && OnBody(data + header_length, content_length) != 0) {
+        return -1;
+    }
+    OnMessageComplete();
+    return header_length + content_length;
+}
+
 ssize_t HttpMessage::ParseFromBytes(const char* data, const size_t length) {
     if(Completed()) {
         if(length == 0) {
@@ -167,9 +285,24 @@ ssize_t HttpMessage::ParseFromBytes(const char* data, const size_t length) {
         }
         return -1;
     }
+    // Whole requests in `data' skip http_parser, which takes over whatever
+    // the fast path leaves alone.
+    if(_stop_at_message_end && _stage == HTTP_ON_MESSAGE_BEGIN &&
+            _parsed_length == 0) {
+        const ssize_t nprocessed = ParseFast(data, length);
+        if(nprocessed != 0) {
+            if(nprocessed > 0) {
+                _parsed_length += nprocessed;
+            }
+            return nprocessed;
+        }
+    }
     const ssize_t nprocessed = 
         http_parser_execute(&_parser, &g_parser_settings, data, length);
-    if(_parser.http_errno != 0) {
+    if(_parser.http_errno == HPE_PAUSED) {
+        http_parser_pause(&_parser, 0);
+    }
+    else if(_parser.http_errno != 0) {
         return -1;
     }
     _parsed_length += length;
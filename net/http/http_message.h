@@ -21,6 +21,12 @@
 #include "http_header.h"
 #include "http_parser.h"
 #include "Buffer.h"
+#include "IOBuf.h"
+#include "progressive_reader.h"
+#include "progressive_attachment.h"
+#include "base/Timestamp.h"
+#include <functional>
+#include <memory>
 
 namespace var {
 namespace net {
@@ -38,6 +44,8 @@ enum HttpParserStage {
 
 class HttpMessage {
 public:
+    typedef std::function<void(HttpMessage*)> HeadersCallback;
+
     HttpMessage();
     ~HttpMessage();
 
@@ -45,6 +53,11 @@ public:
     // Returns bytes parsed, -1 on failure.
     ssize_t ParseFromBytes(const char* data, const size_t length);
 
+    // Readies the message for parsing the next one in place. The storage,
+    // the headers callback, set_stop_at_message_end() and
+    // set_response_to_head() are kept.
+    void Reset();
+
     void set_body(const Buffer& body) { _body = std::move(body); }
     void set_body(const std::string& str) { 
         _body.retrieveAll();
@@ -56,6 +69,44 @@ public:
     const Buffer &body() const { return _body; }
     Buffer &body() { return _body; }
 
+    // Sends `length' bytes of the file `fd' from `offset' on as the body
+    // instead of body(), with sendfile(2) rather than reading them in.
+    // Takes `fd' over, it's closed when the bytes are sent.
+    void set_body_file(int fd, int64_t offset, size_t length);
+    // Sends `body' instead of body(), sharing its blocks rather than copying
+    // them, for a body kept to answer many requests. Sent like a file body.
+    void set_body(const IOBuf& body) { _body_file = body; }
+    const IOBuf& body_file() const { return _body_file; }
+    IOBuf& body_file() { return _body_file; }
+    bool has_body_file() const { return !_body_file.empty(); }
+
+    // Called by the parser once the headers are parsed, before any of the body.
+    void set_headers_callback(const HeadersCallback& cb) { _headers_callback = cb; }
+
+    // Has ParseFromBytes() stop at the end of the message instead of going
+    // on with what follows, so pipelined messages are parsed one by one.
+    void set_stop_at_message_end(bool stop) { _stop_at_message_end = stop; }
+
+    // Has the parser take the message as the response to a HEAD request,
+    // which ends with the headers whatever Content-Length says.
+    void set_response_to_head(bool head) { _response_to_head = head; }
+
+    // Has the body parsed from now on given to `reader' rather than
+    // stored in body(). Takes `reader' over, copies of the message share it.
+    void ReadProgressivelyBy(ProgressiveReader* reader);
+    ProgressiveReader* progressive_reader() const { return _reader.get(); }
+
+    // Has the response body written by the returned attachment after the
+    // headers are sent, see ProgressiveAttachment. Set the headers first,
+    // body() if any is sent as the first chunk.
+    std::shared_ptr<ProgressiveAttachment> CreateProgressiveAttachment();
+    const std::shared_ptr<ProgressiveAttachment>& progressive_attachment() const
+    { return _attachment; }
+
+    // When the last bytes of the message were read, set by HttpServer.
+    void set_received_time(Timestamp time) { _received_time = time; }
+    Timestamp received_time() const { return _received_time; }
+
     bool Completed() const { return _stage == HTTP_ON_MESSAGE_COMPLETE; }
     HttpParserStage stage() const { return _stage; }
 
@@ -79,10 +130,26 @@ protected:
     int OnBody(const char* data, size_t size);
 
 private:
+    // Shared by http_parser and the fast path of requests.
+    int OnHeadersComplete(int major, int minor, int status_code,
+                          HttpMethod method, bool is_request);
+    void OnMessageComplete();
+    // Parses the complete request at the start of `data' without
+    // http_parser. Returns bytes parsed, 0 when it's left to http_parser,
+    // -1 on failure.
+    ssize_t ParseFast(const char* data, const size_t length);
+
     HttpParserStage _stage;
     HttpHeader _header;
     std::string _url;
     Buffer _body;
+    IOBuf _body_file;
+    HeadersCallback _headers_callback;
+    std::shared_ptr<ProgressiveReader> _reader;
+    std::shared_ptr<ProgressiveAttachment> _attachment;
+    Timestamp _received_time;
+    bool _stop_at_message_end;
+    bool _response_to_head;
     struct http_parser _parser;
     size_t _parsed_length;
     std::string _cur_header;
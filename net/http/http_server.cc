@@ -1,9 +1,81 @@
 #include "http_server.h"
+#include "EventLoop.h"
 #include <ostream>
 
 namespace var {
 namespace net {
 
+namespace {
+
+// Collects the status line and the headers in a stack buffer and appends
+// them to the IOBuf in large pieces, with no ostream on the way.
+class HeaderWriter {
+public:
+    explicit HeaderWriter(IOBuf* out) : _out(out), _len(0) {}
+    ~HeaderWriter() { Flush(); }
+
+    void Append(const char* data, size_t len) {
+        if(_len + len > sizeof(_buf)) {
+            Flush();
+            if(len > sizeof(_buf)) {
+                _out->append(data, len);
+                return;
+            }
+        }
+        memcpy(_buf + _len, data, len);
+        _len += len;
+    }
+    // String literals, without strlen().
+    template <size_t N>
+    void Append(const char (&str)[N]) { Append(str, N - 1); }
+    void Append(const std::string& str) { Append(str.data(), str.size()); }
+    void Append(char c) { Append(&c, 1); }
+    void AppendCStr(const char* str) {
+        if(str) {
+            Append(str, strlen(str));
+        }
+    }
+    void AppendInt(int64_t value) {
+        char buf[24];
+        char* end = buf + sizeof(buf);
+        char* p = end;
+        uint64_t v = value < 0 ? 0 - static_cast<uint64_t>(value) : value;
+        do {
+            *--p = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while(v != 0);
+        if(value < 0) {
+            *--p = '-';
+        }
+        Append(p, end - p);
+    }
+    void AppendHeader(const std::string& name, const std::string& value) {
+        Append(name);
+        Append(": ");
+        Append(value);
+        Append("\r\n");
+    }
+    void Flush() {
+        if(_len > 0) {
+            _out->append(_buf, _len);
+            _len = 0;
+        }
+    }
+
+private:
+    IOBuf* _out;
+    size_t _len;
+    char _buf[1024];
+};
+
+} // namespace
+
+HttpCompressOptions::HttpCompressOptions()
+    : min_size(1024)
+    , worker_min_size(64 * 1024)
+    , level(6) {
+}
+
 void defaultHttpCallback(HttpRequest* request, HttpResponse* response) {
     response->header().set_status_code(HTTP_STATUS_OK);
     response->header().SetHeader("Connection", "keep-alive");
@@ -14,32 +86,56 @@ HttpServer::HttpServer(EventLoop* loop,
                        const std::string& name)
     : _verbose(false)
     , _server(loop, addr, name)
-    , _http_callback(defaultHttpCallback) {
+    , _http_callback(defaultHttpCallback)
+    , _streaming_high_water_mark(4 * 1024 * 1024)
+    , _worker_pool(nullptr)
+    , _compress(false) {
     _server.setConnectionCallback(std::bind(&HttpServer::OnConnection, this, _1));
     _server.setMessageCallback(std::bind(&HttpServer::OnMessage, this, _1, _2, _3));
-    SetVerbose();
+}
+
+HttpContext* HttpServer::NewConnContext() {
+    HttpContext* http_context = new HttpContext;
+    http_context->set_stop_at_message_end(true);
+    if(_header_callback) {
+        HeaderCallback cb = _header_callback;
+        http_context->set_headers_callback([cb](HttpMessage* request) { cb(request); });
+    }
+    return http_context;
 }
 
 void HttpServer::ResetConnContext(const TcpConnectionPtr& conn) {
-    if(!conn) {
+    HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
+    if(!http_context) {
         return;
     }
-    HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
-    if(http_context) {
-        delete http_context;
-        http_context = nullptr;
+    ProgressiveReader* reader = http_context->progressive_reader();
+    if(reader && !http_context->Completed()) {
+        reader->OnEndOfMessage(false);
+    }
+    if(conn->connected()) {
+        // Reused for the next request of the connection.
+        http_context->Reset();
+        return;
+    }
+    std::shared_ptr<ProgressiveAttachment> attachment = http_context->attachment();
+    if(attachment) {
+        attachment->OnConnectionClosed();
     }
+    delete http_context;
     conn->setContext(nullptr);
 }
 
 void HttpServer::OnConnection(const TcpConnectionPtr& conn) {
     if(conn->connected()) {
         conn->setContext(nullptr);
+        // Responses are written whole, and pipelined ones may take more
+        // than one writev(2), which must not wait for the delayed ACK.
+        conn->setTcpNoDelay(true);
     }
     else {
         ResetConnContext(conn);
     }
-    conn->setContext(nullptr);
     LOG_TRACE << conn->localAddress().toIpPort() << " -> "
               << conn->peerAddress().toIpPort() << " is "
               << (conn->connected() ? "UP" : "DOWN");
@@ -48,82 +144,220 @@ void HttpServer::OnConnection(const TcpConnectionPtr& conn) {
 void HttpServer::OnMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp time) {
     HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
     if(!http_context) {
-        http_context = new HttpContext;
+        http_context = NewConnContext();
         conn->setContext(http_context);
     }
-    // Resolved all buf's data.
-    size_t rc = http_context->ParseFromBytes(buf->peek(), buf->readableBytes());
-    // Http header has already resolved data success, 
-    // continue parse http body.
-    if(http_context->GetResolvedStage()) {
-        if(rc >= 0) {
-            buf->retrieve(rc);
-            if(http_context->Completed()) {
-                // !Drop it! Already return the message before, do not return again.
-                // Used of big file trans.
-                OnHttpMessage(conn, static_cast<HttpMessage*>(http_context));
-                ResetConnContext(conn);
-                return;
-            }
-        }
-        else {
-            // Failed to parse the body, Since header were parsed successfully.
+    // Responses of the requests parsed here, pipelined ones go out in a
+    // single send.
+    IOBuf out;
+    bool close_connection = false;
+    // Requests after a pending response are parsed once it's sent,
+    // see OnWorkerDone() and OnResponseDone().
+    while(buf->readableBytes() > 0 && !http_context->response_pending() && !close_connection) {
+        // The parser stops at the end of a message.
+        ssize_t rc = http_context->ParseFromBytes(buf->peek(), buf->readableBytes());
+        if(rc < 0 || static_cast<size_t>(rc) > buf->readableBytes()) {
+            // Failed to parse the body if the header were parsed successfully.
+            LOG_ERROR << (http_context->GetResolvedStage() ? 
+                          "Http body parsed error" : "Http message parsed error");
             ResetConnContext(conn);
             buf->retrieveAll();
-            LOG_ERROR << "Http body parsed error";
-            return;
+            break;
         }
-    }
-    else if(rc >= 0) {
         // In HTTP protocol parsing, even if the source does not contain 
         // a complete HTTP message, it will still be consumed by the http parser 
         // to avoid repeated parsing in the next time.
-        if(buf->readableBytes() >= rc) {
-            buf->retrieve(rc);
-        }
-        else {
-            // Failed to parse the whole message.
-            ResetConnContext(conn);
-            buf->retrieveAll();
-            LOG_ERROR << "Http message parsed error";
-            return;
+        buf->retrieve(rc);
+        if(!http_context->Completed()) {
+            if(http_context->stage() >= HTTP_ON_HEADERS_COMPLETE) {
+                // Continue parse http body next time.
+                http_context->SetStageToResolved();
+            }
+            // Not enough data to parse, just return and wait next process.
+            break;
         }
-        if(http_context->Completed()) {
-            OnHttpMessage(conn, static_cast<HttpMessage*>(http_context));
-            ResetConnContext(conn);
-            return;
+        http_context->set_received_time(time);
+        close_connection = OnHttpMessage(conn, http_context, &out);
+        ResetConnContext(conn);
+    }
+    if(!out.empty()) {
+        conn->send(std::move(out));
+    }
+    if(close_connection) {
+        conn->shutdown();
+    }
+}
+
+bool HttpServer::OnHttpMessage(const TcpConnectionPtr& conn, HttpMessage* http_message, IOBuf* out) {
+    if(IsVerbose()) {
+        OnVerboseHttpMessage(&http_message->header(), &http_message->body(), conn, true);
+    }
+    HttpDispatch dispatch = HTTP_DISPATCH_IN_LOOP;
+    if(_worker_pool && _dispatch_callback) {
+        dispatch = _dispatch_callback(http_message);
+    }
+    if(dispatch == HTTP_DISPATCH_IN_WORKER) {
+        // The context is reset for the next request, the worker gets a copy.
+        std::shared_ptr<HttpMessage> request(new HttpMessage(*http_message));
+        std::weak_ptr<TcpConnection> weak_conn(conn);
+        HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
+        http_context->SetResponsePending();
+        if(_worker_pool->tryRun(std::bind(&HttpServer::RunInWorker, this, weak_conn, request))) {
+            return false;
         }
-        else if(http_context->stage() >= HTTP_ON_HEADERS_COMPLETE) {
-            // // Returned content contains the complete header but does not 
-            // // include any content, which can be parsed in advance. 
-            // OnHttpMessage(conn, static_cast<HttpMessage*>(http_context));
-            http_context->SetStageToResolved();
-            return;
+        http_context->ClearResponsePending();
+        LOG_WARN << "Worker pool " << _worker_pool->name() << " is stopped or full";
+        if(_reject_callback) {
+            _reject_callback(http_message);
         }
-        else {
-            // Not enough data to parse, just return and wait next process.
-            return;
+        dispatch = HTTP_DISPATCH_REJECT;
+    }
+    HttpMessage response;
+    if(dispatch == HTTP_DISPATCH_REJECT) {
+        response.header().set_status_code(HTTP_STATUS_SERVICE_UNAVAILABLE);
+        response.header().set_content_type("text/plain");
+        response.set_body("Server is busy, try again later\n");
+    }
+    else {
+        _http_callback(http_message, &response);
+        if(OffloadCompression(conn, http_message, &response)) {
+            return false;
         }
     }
+    return SendResponse(conn, http_message, &response, out);
+}
+
+void HttpServer::RunInWorker(const std::weak_ptr<TcpConnection>& weak_conn,
+                             const std::shared_ptr<HttpMessage>& request) {
+    std::shared_ptr<HttpMessage> response(new HttpMessage);
+    _http_callback(request.get(), response.get());
+    CompressInWorker(weak_conn, request, response);
 }
 
-void HttpServer::OnHttpMessage(const TcpConnectionPtr& conn, HttpMessage* http_message) {
-    HttpHeader* resquest_header = &http_message->header();
-    Buffer* request_content = &http_message->body();
-    std::string remote_side = conn->peerAddress().toIpPort();
-    if(_verbose) {
-        OnVerboseHttpMessage(resquest_header, request_content, remote_side, true);
+void HttpServer::CompressInWorker(const std::weak_ptr<TcpConnection>& weak_conn,
+                                  const std::shared_ptr<HttpMessage>& request,
+                                  const std::shared_ptr<HttpMessage>& response) {
+    CompressResponse(request.get(), response.get());
+    TcpConnectionPtr conn = weak_conn.lock();
+    if(conn) {
+        // Queued even in the loop thread, the context of the request may
+        // not be reset yet.
+        conn->getLoop()->queueInLoop(std::bind(&HttpServer::OnWorkerDone, this,
+                                             weak_conn, request, response));
     }
-    HttpMessage response;
-    _http_callback(http_message, &response);
-    
-    HttpHeader* response_header = &response.header();
-    Buffer* response_content = &response.body();
-    response_header->set_version(resquest_header->major_version(), resquest_header->minor_version());
+}
+
+bool HttpServer::OffloadCompression(const TcpConnectionPtr& conn, HttpMessage* request,
+                                    HttpMessage* response) {
+    if(!_worker_pool || response->body().readableBytes() < _compress_options.worker_min_size ||
+            CompressTypeOf(request, response) == HTTP_COMPRESS_NONE) {
+        return false;
+    }
+    // Both outlive the context, which is reset for the next request.
+    std::shared_ptr<HttpMessage> request_copy(new HttpMessage(*request));
+    std::shared_ptr<HttpMessage> response_copy(new HttpMessage);
+    response_copy->header().Swap(response->header());
+    response_copy->body().swap(response->body());
+    HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
+    http_context->SetResponsePending();
+    if(_worker_pool->tryRun(std::bind(&HttpServer::CompressInWorker, this,
+                                      std::weak_ptr<TcpConnection>(conn),
+                                      request_copy, response_copy))) {
+        return true;
+    }
+    http_context->ClearResponsePending();
+    response->header().Swap(response_copy->header());
+    response->body().swap(response_copy->body());
+    return false;
+}
+
+bool HttpServer::IsCompressible(HttpMessage* request, HttpMessage* response) const {
+    const HttpHeader& header = response->header();
+    if(!_compress || header.status_code() != HTTP_STATUS_OK ||
+            request->header().method() == HTTP_METHOD_HEAD ||
+            response->progressive_attachment() || response->has_body_file() ||
+            response->body().readableBytes() < _compress_options.min_size ||
+            header.GetHeader("Content-Encoding")) {
+        return false;
+    }
+    // A strong ETag names these very bytes, recoding them would send two
+    // representations under one tag.
+    const std::string* etag = header.GetHeader("ETag");
+    if(etag && etag->compare(0, 2, "W/") != 0) {
+        return false;
+    }
+    // SendResponse() falls back to the type of the request.
+    return IsCompressibleContentType(header.content_type().empty() ?
+        request->header().content_type() : header.content_type());
+}
+
+HttpCompressType HttpServer::CompressTypeOf(HttpMessage* request, HttpMessage* response) const {
+    if(!IsCompressible(request, response)) {
+        return HTTP_COMPRESS_NONE;
+    }
+    return NegotiateHttpCompressType(request->header().GetHeader("Accept-Encoding"));
+}
+
+void HttpServer::CompressResponse(HttpMessage* request, HttpMessage* response) const {
+    if(!IsCompressible(request, response)) {
+        return;
+    }
+    // Caches keep the codings apart.
+    if(!response->header().GetHeader("Vary")) {
+        response->header().SetHeader("Vary", "Accept-Encoding");
+    }
+    const HttpCompressType type =
+        NegotiateHttpCompressType(request->header().GetHeader("Accept-Encoding"));
+    if(type == HTTP_COMPRESS_NONE) {
+        return;
+    }
+    Buffer& body = response->body();
+    Buffer compressed(0);
+    if(!HttpCompress(type, body.peek(), body.readableBytes(),
+                     _compress_options.level, &compressed)) {
+        LOG_WARN << "Fail to compress a body of " << body.readableBytes() << " bytes";
+        return;
+    }
+    body.swap(compressed);
+    response->header().SetHeader("Content-Encoding", HttpCompressTypeName(type));
+}
+
+void HttpServer::OnWorkerDone(const std::weak_ptr<TcpConnection>& weak_conn,
+                              const std::shared_ptr<HttpMessage>& request,
+                              const std::shared_ptr<HttpMessage>& response) {
+    TcpConnectionPtr conn = weak_conn.lock();
+    if(!conn || !conn->connected()) {
+        return;
+    }
+    HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
+    if(http_context) {
+        http_context->ClearResponsePending();
+    }
+    IOBuf out;
+    const bool close_connection = SendResponse(conn, request.get(), response.get(), &out);
+    if(!out.empty()) {
+        conn->send(std::move(out));
+    }
+    if(close_connection) {
+        conn->shutdown();
+        return;
+    }
+    // Requests that came while the worker was busy.
+    OnMessage(conn, conn->inputBuffer(), Timestamp::now());
+}
+
+bool HttpServer::SendResponse(const TcpConnectionPtr& conn, HttpMessage* request,
+                              HttpMessage* response, IOBuf* out) {
+    // Those made in a worker are compressed there.
+    CompressResponse(request, response);
+    HttpHeader* request_header = &request->header();
+    HttpHeader* response_header = &response->header();
+    Buffer* response_content = &response->body();
+    response_header->set_version(request_header->major_version(), request_header->minor_version());
     const std::string* content_type = &response_header->content_type();
     if(content_type->empty()) {
         // Use request's content type if response's is not set.
-        content_type = &resquest_header->content_type();
+        content_type = &request_header->content_type();
         response_header->set_content_type(*content_type);
     }
     // In HTTP 0.9, the server always closes the connection after sending the
@@ -141,10 +375,10 @@ void HttpServer::OnHttpMessage(const TcpConnectionPtr& conn, HttpMessage* http_m
     // after receiving the response.
     const std::string* response_conn = response_header->GetHeader("Connection");
     if(!response_conn || strcasecmp(response_conn->c_str(), "close") != 0) {
-        const std::string* request_conn = resquest_header->GetHeader("Connection");
+        const std::string* request_conn = request_header->GetHeader("Connection");
         // Before Http 1.1.
-        if((resquest_header->major_version() * 10000 + 
-            resquest_header->minor_version() * 10000) <= 10000) {
+        if((request_header->major_version() * 10000 + 
+            request_header->minor_version() * 10000) <= 10000) {
             if(request_conn && strcasecmp(request_conn->c_str(), "keep-alive") == 0) {
                 response_header->SetHeader("Connection", "keep-alive");
             }
@@ -156,20 +390,73 @@ void HttpServer::OnHttpMessage(const TcpConnectionPtr& conn, HttpMessage* http_m
         }
     }
 
-    std::string response_str = MakeHttpReponseStr(response_header, response_content);
-    conn->send(response_str);
+    // Logged first, sending takes the content over.
+    if(IsVerbose()) {
+        OnVerboseHttpMessage(response_header, response_content, conn, false);
+    }
+    IOBuf body;
+    const std::shared_ptr<ProgressiveAttachment>& attachment = response->progressive_attachment();
+    if(attachment) {
+        // The body goes in chunks, body() first.
+        response_header->SetHeader("Transfer-Encoding", "chunked");
+        MakeHttpResponse(response_header, nullptr, out);
+        const bool is_head_req = request_header->method() == HTTP_METHOD_HEAD;
+        if(!is_head_req) {
+            body.append(std::move(*response_content));
+            ProgressiveAttachment::AppendChunk(&body, out);
+        }
+        // Ahead of what the attachment writes.
+        conn->send(std::move(*out));
+        out->clear();
+        response_conn = response_header->GetHeader("Connection");
+        const bool close_connection = response_conn && strcasecmp(response_conn->c_str(), "close") == 0;
+        static_cast<HttpContext*>(conn->getMutableContext())->SetResponsePending(attachment);
+        attachment->Bind(conn, _streaming_high_water_mark,
+                         std::bind(&HttpServer::OnResponseDone, this,
+                                   std::weak_ptr<TcpConnection>(conn), close_connection),
+                         is_head_req);
+        return false;
+    }
+    if(response->has_body_file()) {
+        body.swap(response->body_file());
+        response_header->SetHeader("Accept-Ranges", "bytes");
+        const std::string* range = request_header->GetHeader("Range");
+        if(range && response_header->status_code() == HTTP_STATUS_OK) {
+            ApplyRange(*range, response_header, &body);
+        }
+    }
+    else {
+        body.append(std::move(*response_content));
+    }
+    // Has MakeHttpResponse() leave the body of HEAD out.
+    response_header->set_method(request_header->method());
+    MakeHttpResponse(response_header, &body, out);
     response_conn = response_header->GetHeader("Connection");
-    if(response_conn && strcasecmp(response_conn->c_str(), "close") == 0) {
-        conn->shutdown();
+    return response_conn && strcasecmp(response_conn->c_str(), "close") == 0;
+}
+
+void HttpServer::OnResponseDone(const std::weak_ptr<TcpConnection>& weak_conn, bool close_connection) {
+    TcpConnectionPtr conn = weak_conn.lock();
+    if(!conn || !conn->connected()) {
+        return;
     }
-    if(_verbose) {
-        OnVerboseHttpMessage(response_header, response_content, remote_side, false);
+    conn->setHighWaterMarkCallback(HighWaterMarkCallback(), 64 * 1024 * 1024);
+    conn->setWriteCompleteCallback(WriteCompleteCallback());
+    HttpContext* http_context = static_cast<HttpContext*>(conn->getMutableContext());
+    if(http_context) {
+        http_context->ClearResponsePending();
+    }
+    if(close_connection) {
+        conn->shutdown();
+        return;
     }
+    // Requests that came while streaming.
+    OnMessage(conn, conn->inputBuffer(), Timestamp::now());
 }
 
 void HttpServer::OnVerboseHttpMessage(HttpHeader* header, 
                                       Buffer* content, 
-                                      std::string remote_side, 
+                                      const TcpConnectionPtr& conn, 
                                       bool request_or_response) {
     std::string verbose_str;
     std::string request_or_response_str;
@@ -182,7 +469,7 @@ void HttpServer::OnVerboseHttpMessage(HttpHeader* header,
         verbose_str = std::string("[ HTTP RESPONSE @");
         request_or_response_str = MakeHttpReponseStr(header, content);
     }
-    verbose_str.append(remote_side);
+    verbose_str.append(conn->peerAddress().toIpPort());
     verbose_str.append(" ]");
     buf.append(request_or_response_str);
 
@@ -231,7 +518,7 @@ std::string HttpServer::MakeHttpRequestStr(HttpHeader* header, Buffer* content)
     }
     if(!header->GetHeader("Host")) {
         os << "Host: ";
-        if(url.host().empty()) {
+        if(!url.host().empty()) {
             os << url.host();
             if(url.port() >= 0) {
                 os << ':' << url.port();
@@ -271,12 +558,81 @@ std::string HttpServer::MakeHttpRequestStr(HttpHeader* header, Buffer* content)
     return buf.retrieveAllAsString();
 }
 
+void HttpServer::ApplyRange(const std::string& range, HttpHeader* header, IOBuf* body) {
+    // Only a single range, others are ignored and the whole body is sent
+    // as RFC 7233 allows.
+    if(range.compare(0, 6, "bytes=") != 0 || range.find(',') != std::string::npos) {
+        return;
+    }
+    const int64_t size = static_cast<int64_t>(body->size());
+    const char* spec = range.c_str() + 6;
+    const char* dash = strchr(spec, '-');
+    if(!dash) {
+        return;
+    }
+    char* end = nullptr;
+    int64_t first = 0;
+    int64_t last = size - 1;
+    if(dash == spec) {
+        // "bytes=-500" is the last 500 bytes.
+        int64_t suffix = strtoll(dash + 1, &end, 10);
+        if(end == dash + 1 || *end != '\0' || suffix < 0) {
+            return;
+        }
+        first = suffix == 0 ? size : std::max<int64_t>(0, size - suffix);
+    }
+    else {
+        first = strtoll(spec, &end, 10);
+        if(end != dash || first < 0) {
+            return;
+        }
+        if(dash[1] != '\0') {
+            last = strtoll(dash + 1, &end, 10);
+            if(*end != '\0' || last < first) {
+                return;
+            }
+            last = std::min(last, size - 1);
+        }
+    }
+    if(first >= size) {
+        header->set_status_code(HTTP_STATUS_REQUEST_RANGE_NOT_SATISFIABLE);
+        header->SetHeader("Content-Range", "bytes */" + std::to_string(size));
+        body->clear();
+        return;
+    }
+    body->pop_front(first);
+    IOBuf part;
+    body->cutn(&part, last - first + 1);
+    body->swap(part);
+    header->set_status_code(HTTP_STATUS_PARTIAL_CONTENT);
+    header->SetHeader("Content-Range", "bytes " + std::to_string(first) + "-" +
+                      std::to_string(last) + "/" + std::to_string(size));
+}
+
 std::string HttpServer::MakeHttpReponseStr(HttpHeader* header, Buffer* content) {
-    BufferStream os;
-    os << "HTTP/" << header->major_version() << '.'
-       << header->minor_version() << ' '
-       << header->status_code() << ' '
-       << header->reason_phrase() << "\r\n";
+    IOBuf result;
+    if(content) {
+        IOBuf body;
+        body.append(content->peek(), content->readableBytes());
+        MakeHttpResponse(header, &body, &result);
+    }
+    else {
+        MakeHttpResponse(header, nullptr, &result);
+    }
+    return result.toString();
+}
+
+void HttpServer::MakeHttpResponse(HttpHeader* header, IOBuf* content, IOBuf* out) {
+    HeaderWriter writer(out);
+    writer.Append("HTTP/");
+    writer.AppendInt(header->major_version());
+    writer.Append('.');
+    writer.AppendInt(header->minor_version());
+    writer.Append(' ');
+    writer.AppendInt(header->status_code());
+    writer.Append(' ');
+    writer.AppendCStr(header->reason_phrase());
+    writer.Append("\r\n");
     bool is_invaild_content = header->status_code() < HTTP_STATUS_OK ||
                               header->status_code() == HTTP_STATUS_NO_CONTENT;
     // Just request http header not contains http body.
@@ -300,7 +656,9 @@ std::string HttpServer::MakeHttpReponseStr(HttpHeader* header, Buffer* content)
                 if(!content_length && !transfer_encoding) {
                     // Prioritize "Content-Length" set by user.
                     // If "Content-Length" is not set, set it to the length of content.
-                    os << "Content-Length: " << content->readableBytes() << "\r\n";
+                    writer.Append("Content-Length: ");
+                    writer.AppendInt(content->size());
+                    writer.Append("\r\n");
                 }
             }
             else {
@@ -311,26 +669,26 @@ std::string HttpServer::MakeHttpReponseStr(HttpHeader* header, Buffer* content)
                     // Never use "Content-Length" set by user.
                     // Always set Content-Length size lighttpd requires 
                     // the header set to 0 for empty content.
-                    os << "Content-Length: " << content->readableBytes() << "\r\n";
+                    writer.Append("Content-Length: ");
+                    writer.AppendInt(content->size());
+                    writer.Append("\r\n");
                 }
             }
         }
     }
     if(!is_invaild_content && !header->content_type().empty()) {
-        os << "Content-Type: " << header->content_type() << "\r\n";
+        writer.AppendHeader("Content-Type", header->content_type());
     }
     for(HttpHeader::HeaderIterator it = header->HeaderBegin(); 
         it != header->HeaderEnd(); ++it) {
-        os << it->first << ": " << it->second << "\r\n";
+        writer.AppendHeader(it->first, it->second);
     }
-    os << "\r\n";
-    
-    Buffer result;
-    os.moveTo(result);
+    writer.Append("\r\n");
+    writer.Flush();
+    // Small bodies are copied behind the headers, larger ones taken over.
     if(!is_invaild_content && !is_head_req && content) {
-        result.append(*content);
+        out->append(std::move(*content));
     }
-    return result.retrieveAllAsString();
 }
 
 void HttpServer::FillUnresolvedPath(std::string* unresolved_path,
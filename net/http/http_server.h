@@ -19,42 +19,139 @@
 #define VAR_HTTP_SERVER_H
 
 #include "http_context.h"
+#include "http_compress.h"
 #include "tcp/TcpServer.h"
 #include "base/Logging.h"
 #include "base/StringSplitter.h"
+#include "base/ThreadPool.h"
 
 namespace var {
 namespace net {
 
+// Where HttpServer runs the HttpCallback of a request.
+enum HttpDispatch {
+    HTTP_DISPATCH_IN_LOOP,      // In the io loop of the connection.
+    HTTP_DISPATCH_IN_WORKER,    // In the worker pool.
+    HTTP_DISPATCH_REJECT        // Not at all, answered with 503.
+};
+
+// How HttpServer compresses responses, see HttpServer::EnableCompression().
+struct HttpCompressOptions {
+    HttpCompressOptions();
+
+    // Bodies shorter than this are sent as they are.
+    size_t min_size;
+    // Bodies made in an io loop from this size on are compressed in the
+    // worker pool when there's one, see HttpServer::SetWorkerPool().
+    size_t worker_min_size;
+    // Level of zlib, 1 is the fastest and 9 the smallest.
+    int level;
+};
+
 class HttpServer : noncopyable {
 public:
     typedef std::function<void(HttpRequest*, HttpResponse*)> HttpCallback;
+    typedef std::function<void(HttpRequest*)> HeaderCallback;
+    typedef std::function<HttpDispatch(HttpRequest*)> DispatchCallback;
+    typedef std::function<void(HttpRequest*)> RejectCallback;
     explicit HttpServer(EventLoop* loop, 
                         const InetAddress& addr, 
                         const std::string& name);
 
     void Start() { _server.start(); }
-    void SetVerbose() { _verbose = false; }
+    // Number of io loops besides the loop of the server, call it before Start().
+    void SetThreadNum(int num_threads) { _server.setThreadNum(num_threads); }
+    void SetThreadInitCallback(const TcpServer::ThreadInitCallback& cb)
+    { _server.setThreadInitCallback(cb); }
+    TcpServer& tcp_server() { return _server; }
+    // Logs every request and response at INFO level. They are only
+    // serialized for it while INFO is logged.
+    void SetVerbose(bool verbose = true) { _verbose = verbose; }
     void SetHttpCallback(const HttpCallback& cb) { _http_callback = cb; }
+    // Called in the loop thread once the headers of a request are parsed,
+    // it may have the body read by HttpRequest::ReadProgressivelyBy().
+    void SetHeaderCallback(const HeaderCallback& cb) { _header_callback = cb; }
+    // Writes to a ProgressiveAttachment are refused while the output queued
+    // on its connection is over `mark' bytes.
+    void SetStreamingHighWaterMark(size_t mark) { _streaming_high_water_mark = mark; }
+    // Has `cb' decide in the loop thread where each complete request is
+    // handled. The HttpCallback of requests sent to `pool' runs there on a
+    // copy of the request, the requests after it on the same connection
+    // wait until its response is sent. `pool' is not owned and must
+    // outlive the server. `reject_cb' is called in the loop thread on a
+    // request `cb' sent to the pool when the pool can't take it, which
+    // is answered with 503 then.
+    void SetWorkerPool(ThreadPool* pool, const DispatchCallback& cb,
+                       const RejectCallback& reject_cb = RejectCallback()) {
+        _worker_pool = pool;
+        _dispatch_callback = cb;
+        _reject_callback = reject_cb;
+    }
+
+    // Sends the bodies of textual 200 responses in the gzip or deflate
+    // coding the client accepts. Bodies in a coding already, tagged by a
+    // strong ETag, streamed by a ProgressiveAttachment or from a file are
+    // left alone.
+    void EnableCompression(const HttpCompressOptions& options = HttpCompressOptions()) {
+        _compress = true;
+        _compress_options = options;
+    }
 
     static std::string MakeHttpRequestStr(HttpHeader* header, Buffer* content);
     static std::string MakeHttpReponseStr(HttpHeader* header, Buffer* content);
+    // Appends the response to out, the blocks of content are moved over
+    // rather than copied and content is left empty.
+    static void MakeHttpResponse(HttpHeader* header, IOBuf* content, IOBuf* out);
+    // Cuts body down to a "Range: bytes=..." request of a single range,
+    // with the 206 or 416 status and the Content-Range header.
+    static void ApplyRange(const std::string& range, HttpHeader* header, IOBuf* body);
 
     static void FillUnresolvedPath(std::string* unresolved_path,
                                    const std::string& url_path,
                                    StringSplitter& splitter);
 
 private:
+    HttpContext* NewConnContext();
     void ResetConnContext(const TcpConnectionPtr& conn);
     void OnConnection(const TcpConnectionPtr& conn);
     void OnMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp time);
-    void OnHttpMessage(const TcpConnectionPtr& conn, HttpMessage* http_message);
-    void OnVerboseHttpMessage(HttpHeader* header, Buffer* content, std::string remote_side, bool request_or_response);
+    // These append the response to out, returning true if the connection
+    // is to be closed after it.
+    bool OnHttpMessage(const TcpConnectionPtr& conn, HttpMessage* http_message, IOBuf* out);
+    void RunInWorker(const std::weak_ptr<TcpConnection>& weak_conn,
+                     const std::shared_ptr<HttpMessage>& request);
+    // Compresses the body of response if it's to be, then has it sent.
+    void CompressInWorker(const std::weak_ptr<TcpConnection>& weak_conn,
+                          const std::shared_ptr<HttpMessage>& request,
+                          const std::shared_ptr<HttpMessage>& response);
+    // Hands a large body made in the loop to CompressInWorker(), returns
+    // false if it's compressed in the loop as usual.
+    bool OffloadCompression(const TcpConnectionPtr& conn, HttpMessage* request,
+                            HttpMessage* response);
+    bool IsCompressible(HttpMessage* request, HttpMessage* response) const;
+    HttpCompressType CompressTypeOf(HttpMessage* request, HttpMessage* response) const;
+    void CompressResponse(HttpMessage* request, HttpMessage* response) const;
+    void OnWorkerDone(const std::weak_ptr<TcpConnection>& weak_conn,
+                      const std::shared_ptr<HttpMessage>& request,
+                      const std::shared_ptr<HttpMessage>& response);
+    bool SendResponse(const TcpConnectionPtr& conn, HttpMessage* request,
+                      HttpMessage* response, IOBuf* out);
+    void OnResponseDone(const std::weak_ptr<TcpConnection>& weak_conn, bool close_connection);
+    bool IsVerbose() const { return _verbose && Logger::logLevel() <= Logger::INFO; }
+    void OnVerboseHttpMessage(HttpHeader* header, Buffer* content, 
+                              const TcpConnectionPtr& conn, bool request_or_response);
 
 private:
     bool _verbose;
     TcpServer _server;
     HttpCallback _http_callback;
+    HeaderCallback _header_callback;
+    size_t _streaming_high_water_mark;
+    ThreadPool* _worker_pool;
+    DispatchCallback _dispatch_callback;
+    RejectCallback _reject_callback;
+    bool _compress;
+    HttpCompressOptions _compress_options;
 };
 
 } // end namespace net
@@ -36,68 +36,33 @@ void HttpUrl::Swap(HttpUrl& rhs) {
     std::swap(_path, rhs._path);
     std::swap(_user_info, rhs._user_info);
     std::swap(_query, rhs._query);
-    std::swap(_query_map, rhs._query_map);
+    _query_map.swap(rhs._query_map);
     std::swap(_fragment, rhs._fragment);
 }
 
-static std::string RemoveAmpersand(const std::string& query) {
-    std::string result;  
-    bool lastWasAmpersand = false; 
-    for (char c : query) {  
-        if (c == '&' && !lastWasAmpersand) {  
-            result += c;  
-            lastWasAmpersand = true;  
-        } else if (c != '&') {  
-            result += c;  
-            lastWasAmpersand = false;  
-        }  
-    }  
-    return result; 
-}
-
+// Splits views of the key/value pairs out of `query_str', empty params
+// and params without a key are skipped.
 static void ParseQueries(HttpUrl::QueryMap& query_map, const std::string& query_str) {
     query_map.clear();
-    if(query_str.empty()) {
-        return;
-    }
-    std::string query = RemoveAmpersand(query_str);
-
-    std::string param, key, value;
-    size_t start = 0;
-    size_t end = 0;
-    while((end = query.find('&',start)) != std::string::npos) {
-        param = query.substr(start, end - start);
-        size_t pos = param.find('=');
-        key = param.substr(0, pos);
-        // no key
-        if(key.empty()) {
-            start = end + 1;
-            continue;
-        }
-        if(pos == std::string::npos) {
-            value = "";
-        }
-        else {
-            value = param.substr(pos + 1);
-        }
-        query_map[key] = value;
-        start = end + 1;
-    }
-    // last one param
-    if(start < query.size()) {
-        param = query.substr(start);
-        size_t pos = param.find('=');
-        key = param.substr(0, pos);
-        if(key.empty()) {
-            return;
-        }
-        if(pos == std::string::npos) {
-            value = "";
+    const char* p = query_str.data();
+    const char* const end = p + query_str.size();
+    while(p < end) {
+        const char* param_end = static_cast<const char*>(memchr(p, '&', end - p));
+        if(!param_end) {
+            param_end = end;
         }
-        else {
-            value = param.substr(pos + 1);
+        const char* eq = static_cast<const char*>(memchr(p, '=', param_end - p));
+        const char* key_end = eq ? eq : param_end;
+        if(key_end != p) {
+            std::string& value = query_map[StringPiece(p, static_cast<int>(key_end - p))];
+            if(eq) {
+                value.assign(eq + 1, param_end - eq - 1);
+            }
+            else {
+                value.clear();
+            }
         }
-        query_map[key] = value;
+        p = param_end + 1;
     }
 }
 
@@ -413,13 +378,7 @@ void HttpUrl::PrintWithoutHost(std::ostream& os) const {
 
     if(_initialized_query_map && _query_was_modified) {
         bool is_first = true;
-        for(QueryIterator it = QueryEnd(); it != QueryEnd(); ++it) {
-            // // test
-            // size_t bucket = _query_map.bucket_count();
-            // std::string test = it->first;
-            // URLStringHash hasher;
-            // size_t hash = hasher.operator()(test);
-            // size_t index = hash % bucket; 
+        for(QueryIterator it = QueryBegin(); it != QueryEnd(); ++it) {
             if(is_first) {
                 is_first = false;
                 os << '?';
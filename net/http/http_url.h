@@ -20,7 +20,7 @@
 
 #include <string>
 #include <ostream>
-#include <unordered_map>
+#include "flat_string_map.h"
 
 namespace var {
 namespace net {
@@ -44,25 +44,9 @@ namespace net {
 //                                                             |
 //                                               interpretable as extension
 
-struct URLStringHash : public std::hash<std::string> {
-    std::size_t operator()(const std::string& s) const {
-        std::size_t result = 0;
-        for (std::string::const_iterator i = s.begin(); i != s.end(); ++i) {
-            result = result * 101 + *i;
-        }
-        return result;        
-    }
-};
-
-struct URLStringEqual : public std::equal_to<std::string> {  
-    bool operator()(const std::string& lhs, const std::string& rhs) const {  
-        return  lhs == rhs;
-    }  
-}; 
-
 class HttpUrl {
 public:
-    typedef std::unordered_map<std::string, std::string, URLStringHash, URLStringEqual> QueryMap;
+    typedef FlatStringMap<CaseSensitiveEqual> QueryMap;
     typedef QueryMap::const_iterator QueryIterator;
 
     // You can copy a URL.
@@ -119,9 +103,10 @@ public:
     void set_fragment(const std::string& fragment) { _fragment = fragment; }
     void set_query(const std::string& query) { _query = query; }
 
-    // Get the value of a case-sensitive key. 
+    // Get the value of a case-sensitive key. The queries are split out of
+    // query() on the first call, a later key overriding an earlier one.
     // Returns pointer to the value, NULL when the key does not exist.
-    const std::string* GetQuery(const std::string& key) const;
+    const std::string* GetQuery(const StringPiece& key) const;
 
     // Add key/value pair. Override existing value.
     // change the modified flag to update the output query string.
@@ -129,7 +114,7 @@ public:
 
     // Remove value associated with 'key'.
     // Returns 1 on removed, 0 otherwise.
-    size_t RemoveQuery(const std::string& key);
+    size_t RemoveQuery(const StringPiece& key);
 
     // Get query iterators which are invailded after calling SetQuery
     // or SetHttpURL().
@@ -174,12 +159,8 @@ private:
 // Returns 0 on success, -1 otherwise.
 int ParseURL(const char* url, std::string* scheme, std::string* host, int* port);
 
-inline const std::string* HttpUrl::GetQuery(const std::string& key) const {
-    QueryIterator it = get_query_map().find(key);
-    if(it == QueryEnd()) {
-        return nullptr;
-    }
-    return &it->second;
+inline const std::string* HttpUrl::GetQuery(const StringPiece& key) const {
+    return get_query_map().seek(key);
 }
 
 inline void HttpUrl::SetQuery(const std::string& key, const std::string& value) {
@@ -187,7 +168,7 @@ inline void HttpUrl::SetQuery(const std::string& key, const std::string& value)
     _query_was_modified = true;
 }
 
-inline size_t HttpUrl::RemoveQuery(const std::string& key) {
+inline size_t HttpUrl::RemoveQuery(const StringPiece& key) {
     if(get_query_map().erase(key)) {
         _query_was_modified = true;
         return 1;
@@ -0,0 +1,233 @@
+#include "progressive_attachment.h"
+#include "tcp/TcpConnection.h"
+#include "EventLoop.h"
+#include <errno.h>
+#include <stdio.h>
+
+namespace var {
+namespace net {
+
+static const size_t kDefaultHighWaterMark = 4 * 1024 * 1024;
+static const char kLastChunk[] = "0\r\n\r\n";
+
+ProgressiveAttachment::ProgressiveAttachment()
+    : _loop(nullptr)
+    , _high_water_mark(kDefaultHighWaterMark)
+    , _bound(false)
+    , _discard(false)
+    , _closed(false)
+    , _broken(false)
+    , _flush_queued(false)
+    , _overcrowded(false) {
+}
+
+ProgressiveAttachment::~ProgressiveAttachment() {
+    Close();
+}
+
+void ProgressiveAttachment::AppendChunk(IOBuf* data, IOBuf* out) {
+    if(data->empty()) {
+        return;
+    }
+    char size[32];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", data->size());
+    out->append(size, n);
+    out->append(std::move(*data));
+    out->append("\r\n", 2);
+}
+
+int ProgressiveAttachment::Write(const char* data, size_t length) {
+    IOBuf buf;
+    buf.append(data, length);
+    return Write(std::move(buf));
+}
+
+int ProgressiveAttachment::Write(IOBuf&& data) {
+    MutexLockGuard lock(_mutex);
+    if(_closed) {
+        errno = EPIPE;
+        return -1;
+    }
+    if(_broken) {
+        errno = ECONNRESET;
+        return -1;
+    }
+    if(data.empty() || _discard) {
+        data.clear();
+        return 0;
+    }
+    // The pending bytes count too, the loop may not have flushed them yet.
+    // The high water mark callback is queued, in the loop the output of the
+    // connection is looked at directly.
+    size_t queued = _pending.size();
+    if(_bound && _loop->isInLoopThread()) {
+        TcpConnectionPtr conn = _conn.lock();
+        if(conn) {
+            queued += conn->outputBytes();
+        }
+    }
+    if(_overcrowded.load(std::memory_order_relaxed) || queued >= _high_water_mark) {
+        _overcrowded.store(true, std::memory_order_relaxed);
+        errno = EAGAIN;
+        return -1;
+    }
+    AppendChunk(&data, &_pending);
+    if(!_bound) {
+        return 0;
+    }
+    if(_loop->isInLoopThread()) {
+        SendPendingLocked();
+    }
+    else if(!_flush_queued) {
+        _flush_queued = true;
+        _loop->queueInLoop(std::bind(&ProgressiveAttachment::Flush, shared_from_this()));
+    }
+    return 0;
+}
+
+void ProgressiveAttachment::set_writable_callback(const WritableCallback& cb) {
+    MutexLockGuard lock(_mutex);
+    _writable_callback = cb;
+}
+
+void ProgressiveAttachment::Close() {
+    std::function<void()> on_closed;
+    {
+        MutexLockGuard lock(_mutex);
+        if(_closed) {
+            return;
+        }
+        _closed = true;
+        _writable_callback = WritableCallback();
+        if(!_discard && !_broken) {
+            _pending.append(kLastChunk, sizeof(kLastChunk) - 1);
+        }
+        if(!_bound) {
+            // Bind() sends it.
+            return;
+        }
+        if(!_loop->isInLoopThread()) {
+            // Not through Flush(), it may be the destructor that closes.
+            std::weak_ptr<TcpConnection> weak_conn = _conn;
+            IOBuf last;
+            last.swap(_pending);
+            std::function<void()> closed = _on_closed;
+            _loop->queueInLoop([weak_conn, last, closed]() mutable {
+                TcpConnectionPtr conn = weak_conn.lock();
+                if(conn && !last.empty()) {
+                    conn->send(std::move(last));
+                }
+                if(closed) {
+                    closed();
+                }
+            });
+            return;
+        }
+        SendPendingLocked();
+        on_closed.swap(_on_closed);
+    }
+    if(on_closed) {
+        // Not from inside the writer, it may be HttpServer in the middle of a message.
+        _loop->queueInLoop(on_closed);
+    }
+}
+
+void ProgressiveAttachment::Bind(const TcpConnectionPtr& conn, size_t high_water_mark,
+                                 const std::function<void()>& on_closed, bool discard) {
+    conn->getLoop()->assertInLoopThread();
+    std::function<void()> closed;
+    {
+        MutexLockGuard lock(_mutex);
+        _conn = conn;
+        _loop = conn->getLoop();
+        _high_water_mark = high_water_mark;
+        _discard = discard;
+        _bound = true;
+        if(discard) {
+            _pending.clear();
+        }
+        else {
+            std::weak_ptr<ProgressiveAttachment> self(shared_from_this());
+            conn->setHighWaterMarkCallback([self](const TcpConnectionPtr&, size_t) {
+                std::shared_ptr<ProgressiveAttachment> attachment = self.lock();
+                if(attachment) {
+                    attachment->OnHighWaterMark();
+                }
+            }, high_water_mark);
+            conn->setWriteCompleteCallback([self](const TcpConnectionPtr&) {
+                std::shared_ptr<ProgressiveAttachment> attachment = self.lock();
+                if(attachment) {
+                    attachment->OnWriteComplete();
+                }
+            });
+            SendPendingLocked();
+        }
+        if(_closed) {
+            closed = on_closed;
+        }
+        else {
+            _on_closed = on_closed;
+        }
+    }
+    if(closed) {
+        _loop->queueInLoop(closed);
+        return;
+    }
+    if(!_overcrowded.load(std::memory_order_relaxed)) {
+        RunWritableCallback();
+    }
+}
+
+void ProgressiveAttachment::OnConnectionClosed() {
+    {
+        MutexLockGuard lock(_mutex);
+        _broken = true;
+        _pending.clear();
+        _on_closed = std::function<void()>();
+    }
+    _overcrowded.store(false, std::memory_order_relaxed);
+    RunWritableCallback();
+}
+
+void ProgressiveAttachment::Flush() {
+    MutexLockGuard lock(_mutex);
+    _flush_queued = false;
+    SendPendingLocked();
+}
+
+void ProgressiveAttachment::SendPendingLocked() {
+    if(_pending.empty()) {
+        return;
+    }
+    TcpConnectionPtr conn = _conn.lock();
+    if(conn) {
+        conn->send(std::move(_pending));
+    }
+    _pending.clear();
+}
+
+void ProgressiveAttachment::OnHighWaterMark() {
+    _overcrowded.store(true, std::memory_order_relaxed);
+}
+
+void ProgressiveAttachment::OnWriteComplete() {
+    // Written out, no matter whether it was refused by the pending bytes
+    // or the connection's.
+    if(_overcrowded.exchange(false, std::memory_order_relaxed)) {
+        RunWritableCallback();
+    }
+}
+
+void ProgressiveAttachment::RunWritableCallback() {
+    WritableCallback cb;
+    {
+        MutexLockGuard lock(_mutex);
+        cb = _writable_callback;
+    }
+    if(cb) {
+        cb();
+    }
+}
+
+} // end namespace net
+} // end namespace var
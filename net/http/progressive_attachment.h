@@ -0,0 +1,102 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_PROGRESSIVE_ATTACHMENT_H
+#define VAR_HTTP_PROGRESSIVE_ATTACHMENT_H
+
+#include "IOBuf.h"
+#include "Callbacks.h"
+#include "base/Mutex.h"
+#include <atomic>
+#include <memory>
+
+namespace var {
+namespace net {
+
+class EventLoop;
+
+// Body of a http response written part by part after the headers were sent,
+// with "Transfer-Encoding: chunked". Created by the handler with
+// HttpMessage::CreateProgressiveAttachment() and kept as long as there is
+// more to write, from any thread. The last chunk is sent by Close() or
+// when the last reference goes.
+//
+// Writes are refused while the output queued on the connection is over the
+// high water mark of HttpServer, the writable callback tells when to go on.
+class ProgressiveAttachment : noncopyable,
+                              public std::enable_shared_from_this<ProgressiveAttachment> {
+public:
+    typedef std::function<void()> WritableCallback;
+
+    ProgressiveAttachment();
+    ~ProgressiveAttachment();
+
+    // Sends data as one chunk, empty data is ignored.
+    // Returns 0 on success, -1 otherwise with errno set to EAGAIN if
+    // overcrowded (nothing is taken, retry in the writable callback),
+    // ECONNRESET if the connection is closed or EPIPE after Close().
+    int Write(const char* data, size_t length);
+    int Write(IOBuf&& data);
+
+    bool overcrowded() const { return _overcrowded.load(std::memory_order_relaxed); }
+
+    // Called in the loop thread once the headers are sent, whenever the
+    // queued output drains after Write() was refused, and when the
+    // connection closes (Write() fails from then on).
+    void set_writable_callback(const WritableCallback& cb);
+
+    // Sends the last chunk, later writes fail.
+    void Close();
+
+    // Called by HttpServer in the loop thread after sending the headers.
+    // What was written before goes out now. `on_closed' is run in the loop
+    // thread after the last chunk was queued on the connection. Writes are
+    // dropped with `discard', as for HEAD requests.
+    void Bind(const TcpConnectionPtr& conn, size_t high_water_mark,
+              const std::function<void()>& on_closed, bool discard);
+    // Called by HttpServer in the loop thread when the connection closes.
+    void OnConnectionClosed();
+
+    // Appends data to out as a chunk and leaves data empty.
+    static void AppendChunk(IOBuf* data, IOBuf* out);
+
+private:
+    void Flush();
+    void SendPendingLocked();
+    void OnHighWaterMark();
+    void OnWriteComplete();
+    void RunWritableCallback();
+
+    mutable MutexLock _mutex;
+    std::weak_ptr<TcpConnection> _conn;
+    EventLoop* _loop;
+    IOBuf _pending;
+    size_t _high_water_mark;
+    bool _bound;
+    bool _discard;
+    bool _closed;
+    bool _broken;
+    bool _flush_queued;
+    std::atomic<bool> _overcrowded;
+    WritableCallback _writable_callback;
+    std::function<void()> _on_closed;
+};
+
+} // end namespace net
+} // end namespace var
+
+#endif // VAR_HTTP_PROGRESSIVE_ATTACHMENT_H
@@ -0,0 +1,47 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_PROGRESSIVE_READER_H
+#define VAR_HTTP_PROGRESSIVE_READER_H
+
+#include <stddef.h>
+
+namespace var {
+namespace net {
+
+// Reads the body of a http message part by part as http_parser produces
+// them, rather than having the whole body stored in HttpMessage::body().
+// Installed by HttpMessage::ReadProgressivelyBy() once the headers are
+// parsed, see HttpServer::SetHeaderCallback(). Called in the loop thread
+// of the connection.
+class ProgressiveReader {
+public:
+    virtual ~ProgressiveReader() {}
+
+    // Called on each part of the body. Returns 0 to go on, otherwise the
+    // message is dropped as one that fails to parse.
+    virtual int OnReadOnePart(const char* data, size_t length) = 0;
+
+    // Called once, `ok' is true after the last part and false if HttpServer
+    // dropped the message before it completed.
+    virtual void OnEndOfMessage(bool ok) = 0;
+};
+
+} // end namespace net
+} // end namespace var
+
+#endif // VAR_HTTP_PROGRESSIVE_READER_H
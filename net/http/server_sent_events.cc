@@ -0,0 +1,62 @@
+#include "server_sent_events.h"
+
+namespace var {
+namespace net {
+
+std::shared_ptr<ProgressiveAttachment> StartEventStream(HttpMessage* response) {
+    response->header().set_content_type("text/event-stream");
+    response->header().SetHeader("Cache-Control", "no-cache");
+    std::string comment;
+    AppendServerSentComment("stream", &comment);
+    response->set_body(comment);
+    return response->CreateProgressiveAttachment();
+}
+
+// Appends the lines of `value' as `name' fields. CR, LF and CRLF all end a
+// line of the stream, so each of them starts another field.
+static void AppendFields(const char* name, const StringPiece& value, std::string* out) {
+    const char* p = value.data();
+    const char* const end = p + value.size();
+    while(true) {
+        const char* line_end = p;
+        while(line_end != end && *line_end != '\n' && *line_end != '\r') {
+            ++line_end;
+        }
+        out->append(name);
+        if(line_end != p) {
+            out->append(": ", 2);
+            out->append(p, line_end - p);
+        }
+        out->push_back('\n');
+        if(line_end == end) {
+            return;
+        }
+        p = line_end + 1;
+        if(*line_end == '\r' && p != end && *p == '\n') {
+            ++p;
+        }
+        // A trailing line break ends the last line rather than adding
+        // an empty one.
+        if(p == end) {
+            return;
+        }
+    }
+}
+
+void AppendServerSentEvent(const StringPiece& event, const StringPiece& data,
+                           std::string* out) {
+    if(!event.empty()) {
+        AppendFields("event", event, out);
+    }
+    AppendFields("data", data, out);
+    out->push_back('\n');
+}
+
+void AppendServerSentComment(const StringPiece& comment, std::string* out) {
+    out->push_back(':');
+    out->append(comment.data(), comment.size());
+    out->append("\n\n", 2);
+}
+
+} // end namespace net
+} // end namespace var
@@ -0,0 +1,50 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef VAR_HTTP_SERVER_SENT_EVENTS_H
+#define VAR_HTTP_SERVER_SENT_EVENTS_H
+
+#include "http_message.h"
+#include "progressive_attachment.h"
+#include "base/StringPiece.h"
+#include <memory>
+#include <string>
+
+namespace var {
+namespace net {
+
+// Makes `response' an event stream of Server-Sent Events, the
+// text/event-stream EventSource of browsers reads, and returns the
+// attachment the events are written to, see ProgressiveAttachment.
+// A comment is sent as the first chunk so that the browser opens the
+// stream at once.
+std::shared_ptr<ProgressiveAttachment> StartEventStream(HttpMessage* response);
+
+// Appends an event named `event' carrying `data' to `out', each line of
+// `data' in a field of its own. EventSource takes unnamed events as
+// "message".
+void AppendServerSentEvent(const StringPiece& event, const StringPiece& data,
+                           std::string* out);
+
+// Appends a comment, which EventSource ignores. Written now and then to
+// find the closed streams.
+void AppendServerSentComment(const StringPiece& comment, std::string* out);
+
+} // end namespace net
+} // end namespace var
+
+#endif
@@ -9,14 +9,28 @@
 #include "Poller.h"
 #include "PollPoller.h"
 #include "EpollPoller.h"
+#include "UringPoller.h"
 
+#include "base/Logging.h"
+
+#include <memory>
 #include <stdlib.h>
 
 using namespace var::net;
 
 Poller* Poller::newDefaultPoller(EventLoop* loop)
 {
-  if (::getenv("VAR_USE_POLL"))
+  if (::getenv("VAR_USE_IO_URING"))
+  {
+    std::unique_ptr<UringPoller> poller(new UringPoller(loop));
+    if (poller->supported())
+    {
+      return poller.release();
+    }
+    LOG_WARN << "io_uring is not supported, falls back to epoll";
+    return new EPollPoller(loop);
+  }
+  else if (::getenv("VAR_USE_POLL"))
   {
     return new PollPoller(loop);
   }
@@ -0,0 +1,603 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include "UringPoller.h"
+
+#include "base/Logging.h"
+#include "Buffer.h"
+#include "Channel.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace var;
+using namespace var::net;
+
+namespace
+{
+const int kNew = -1;
+const int kAdded = 1;
+
+const unsigned kQueueEntries = 256;
+const unsigned kCompletionEntries = 4096;
+
+// Provided buffers of the multishot receives.
+const uint16_t kBufferGroup = 0;
+const unsigned kNumBuffers = 128;  // power of 2
+const unsigned kBufferSize = 16 * 1024;
+
+// user_data of the requests: sequence | fd | operation.
+const int kOperationBits = 4;
+const int kFdBits = 24;
+
+int uringSetup(unsigned entries, struct io_uring_params* params)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned toSubmit, unsigned minComplete,
+               unsigned flags, const void* arg, size_t argSize)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                    minComplete, flags, arg, argSize));
+}
+
+int uringRegister(int fd, unsigned opcode, const void* arg, unsigned numArgs)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, numArgs));
+}
+
+int fdOf(uint64_t data)
+{
+  return static_cast<int>((data >> kOperationBits) & ((1 << kFdBits) - 1));
+}
+
+uint64_t seqOf(uint64_t data)
+{
+  return data >> (kOperationBits + kFdBits);
+}
+
+int operationOf(uint64_t data)
+{
+  return static_cast<int>(data & ((1 << kOperationBits) - 1));
+}
+
+}  // namespace
+
+UringPoller::UringPoller(EventLoop* loop)
+  : Poller(loop),
+    ringfd_(-1),
+    features_(0),
+    sqRing_(MAP_FAILED),
+    sqRingSize_(0),
+    sqHead_(NULL),
+    sqTail_(NULL),
+    sqMask_(0),
+    sqEntries_(0),
+    sqLocalTail_(0),
+    sqes_(static_cast<struct io_uring_sqe*>(MAP_FAILED)),
+    cqRing_(MAP_FAILED),
+    cqRingSize_(0),
+    cqHead_(NULL),
+    cqTail_(NULL),
+    cqMask_(0),
+    cqes_(NULL),
+    receiveSupported_(true),
+    bufRing_(NULL),
+    buffers_(NULL),
+    bufTail_(0)
+{
+  if (!setup() && ringfd_ >= 0)
+  {
+    ::close(ringfd_);
+    ringfd_ = -1;
+  }
+}
+
+UringPoller::~UringPoller()
+{
+  if (ringfd_ >= 0)
+  {
+    ::close(ringfd_);
+  }
+  if (sqes_ != MAP_FAILED)
+  {
+    ::munmap(sqes_, sqEntries_ * sizeof(struct io_uring_sqe));
+  }
+  if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+  {
+    ::munmap(cqRing_, cqRingSize_);
+  }
+  if (sqRing_ != MAP_FAILED)
+  {
+    ::munmap(sqRing_, sqRingSize_);
+  }
+  if (bufRing_)
+  {
+    ::munmap(bufRing_, kNumBuffers * sizeof(struct io_uring_buf));
+    ::munmap(buffers_, kNumBuffers * kBufferSize);
+  }
+}
+
+bool UringPoller::setup()
+{
+  struct io_uring_params params;
+  memZero(&params, sizeof params);
+  // Completions are only posted in our io_uring_enter(2), which
+  // saves the interrupts of task work.
+  params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP |
+                 IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+  params.cq_entries = kCompletionEntries;
+  ringfd_ = uringSetup(kQueueEntries, &params);
+  if (ringfd_ < 0 && errno == EINVAL)
+  {
+    // Before Linux 6.1
+    memZero(&params, sizeof params);
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = kCompletionEntries;
+    ringfd_ = uringSetup(kQueueEntries, &params);
+  }
+  if (ringfd_ < 0)
+  {
+    LOG_SYSERR << "io_uring_setup";
+    return false;
+  }
+  features_ = params.features;
+  // Linux 5.11
+  if (!(features_ & IORING_FEAT_EXT_ARG) || !(features_ & IORING_FEAT_NODROP))
+  {
+    LOG_ERROR << "io_uring lacks features " << features_;
+    return false;
+  }
+
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (features_ & IORING_FEAT_SINGLE_MMAP)
+  {
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  }
+  sqRing_ = ::mmap(NULL, sqRingSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+  if (sqRing_ == MAP_FAILED)
+  {
+    LOG_SYSERR << "mmap io_uring";
+    return false;
+  }
+  if (features_ & IORING_FEAT_SINGLE_MMAP)
+  {
+    cqRing_ = sqRing_;
+  }
+  else
+  {
+    cqRing_ = ::mmap(NULL, cqRingSize_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+    if (cqRing_ == MAP_FAILED)
+    {
+      LOG_SYSERR << "mmap io_uring";
+      return false;
+    }
+  }
+  sqEntries_ = params.sq_entries;
+  void* sqes = ::mmap(NULL, sqEntries_ * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+  {
+    LOG_SYSERR << "mmap io_uring";
+    return false;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  char* sq = static_cast<char*>(sqRing_);
+  sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sqLocalTail_ = *sqTail_;
+  // Entries are submitted in order, the index array is the identity.
+  unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  for (unsigned i = 0; i < sqEntries_; ++i)
+  {
+    array[i] = i;
+  }
+  char* cq = static_cast<char*>(cqRing_);
+  cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+  return true;
+}
+
+bool UringPoller::setupBufferRing()
+{
+  if (bufRing_)
+  {
+    return true;
+  }
+  void* ring = ::mmap(NULL, kNumBuffers * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  void* buffers = ::mmap(NULL, kNumBuffers * kBufferSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  struct io_uring_buf_reg reg;
+  memZero(&reg, sizeof reg);
+  reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+  reg.ring_entries = kNumBuffers;
+  reg.bgid = kBufferGroup;
+  // Linux 5.19
+  if (ring == MAP_FAILED || buffers == MAP_FAILED
+      || uringRegister(ringfd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+  {
+    LOG_SYSERR << "UringPoller can't receive, polls instead";
+    if (ring != MAP_FAILED)
+    {
+      ::munmap(ring, kNumBuffers * sizeof(struct io_uring_buf));
+    }
+    if (buffers != MAP_FAILED)
+    {
+      ::munmap(buffers, kNumBuffers * kBufferSize);
+    }
+    receiveSupported_ = false;
+    return false;
+  }
+  bufRing_ = static_cast<struct io_uring_buf_ring*>(ring);
+  buffers_ = static_cast<char*>(buffers);
+  for (unsigned bid = 0; bid < kNumBuffers; ++bid)
+  {
+    recycleBuffer(static_cast<uint16_t>(bid));
+  }
+  __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+  return true;
+}
+
+Timestamp UringPoller::poll(int timeoutMs, ChannelList* activeChannels)
+{
+  LOG_TRACE << "fd total count " << channels_.size();
+  // The channels handled since the last poll are armed again, they
+  // complete at once if they are still ready.
+  for (int fd : rearms_)
+  {
+    slots_[fd].rearm = false;
+    if (slots_[fd].channel)
+    {
+      arm(fd);
+    }
+  }
+  rearms_.clear();
+
+  bool wait = ready_.empty()
+      && *cqHead_ == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  submitAndWait(timeoutMs, wait);
+  Timestamp now(Timestamp::now());
+
+  unsigned head = *cqHead_;
+  const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head)
+  {
+    handleCompletion(&cqes_[head & cqMask_]);
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+  if (bufRing_)
+  {
+    __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+  }
+
+  for (int fd : ready_)
+  {
+    Channel* channel = slots_[fd].channel;
+    if (channel && channel->receiving() && channel->isReading() && channel->hasReceived())
+    {
+      addEvents(fd, POLLIN);
+    }
+  }
+  ready_.clear();
+
+  if (!actives_.empty())
+  {
+    LOG_TRACE << actives_.size() << " events happened";
+  }
+  for (int fd : actives_)
+  {
+    Slot& slot = slots_[fd];
+    slot.channel->set_revents(slot.revents);
+    slot.revents = 0;
+    activeChannels->push_back(slot.channel);
+    queueRearm(fd);
+  }
+  actives_.clear();
+  return now;
+}
+
+void UringPoller::submitAndWait(int timeoutMs, bool wait)
+{
+  __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+  const unsigned toSubmit = sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+  struct __kernel_timespec ts;
+  struct io_uring_getevents_arg arg;
+  memZero(&arg, sizeof arg);
+  unsigned minComplete = 0;
+  if (wait && timeoutMs != 0)
+  {
+    minComplete = 1;
+    if (timeoutMs > 0)
+    {
+      ts.tv_sec = timeoutMs / 1000;
+      ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000 * 1000;
+      arg.ts = reinterpret_cast<uint64_t>(&ts);
+    }
+  }
+  // Also runs the deferred task work that posts the completions.
+  int ret = uringEnter(ringfd_, toSubmit, minComplete,
+                       IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof arg);
+  if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY)
+  {
+    LOG_SYSERR << "UringPoller::poll()";
+  }
+}
+
+struct io_uring_sqe* UringPoller::getSqe()
+{
+  if (sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_)
+  {
+    // Full, submits without waiting.
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+    if (uringEnter(ringfd_, sqEntries_, 0, 0, NULL, 0) < 0)
+    {
+      LOG_SYSFATAL << "UringPoller::getSqe";
+    }
+  }
+  struct io_uring_sqe* sqe = &sqes_[sqLocalTail_ & sqMask_];
+  ++sqLocalTail_;
+  memZero(sqe, sizeof *sqe);
+  return sqe;
+}
+
+uint64_t UringPoller::nextData(int fd, Operation op)
+{
+  uint64_t seq = ++slots_[fd].seq;
+  return (seq << (kOperationBits + kFdBits))
+      | (static_cast<uint64_t>(fd) << kOperationBits)
+      | op;
+}
+
+void UringPoller::cancel(uint8_t opcode, uint64_t data)
+{
+  struct io_uring_sqe* sqe = getSqe();
+  sqe->opcode = opcode;
+  sqe->fd = -1;
+  sqe->addr = data;
+  sqe->user_data = kIgnore;
+  // Linux 5.17
+  if (features_ & IORING_FEAT_CQE_SKIP)
+  {
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  }
+}
+
+void UringPoller::arm(int fd)
+{
+  Slot& slot = slots_[fd];
+  Channel* channel = slot.channel;
+  int events = channel->events();
+  const bool receive = channel->receiving() && (events & POLLIN);
+  if (channel->receiving())
+  {
+    events &= ~(POLLIN | POLLPRI);
+  }
+
+  if (slot.pollData && slot.pollEvents != events)
+  {
+    cancel(IORING_OP_POLL_REMOVE, slot.pollData);
+    slot.pollData = 0;
+  }
+  if (!slot.pollData && events)
+  {
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = events;
+    sqe->user_data = slot.pollData = nextData(fd, kPoll);
+    slot.pollEvents = events;
+  }
+
+  // Data that arrives before the cancellation is still received.
+  if (slot.recvData && !receive)
+  {
+    cancel(IORING_OP_ASYNC_CANCEL, slot.recvData);
+    slot.recvData = 0;
+  }
+  if (!slot.recvData && receive && !channel->receiveEnded())
+  {
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = slot.recvData = nextData(fd, kRecv);
+  }
+  if (receive && channel->hasReceived())
+  {
+    ready_.push_back(fd);
+  }
+}
+
+void UringPoller::handleCompletion(const struct io_uring_cqe* cqe)
+{
+  const uint64_t data = cqe->user_data;
+  const int op = operationOf(data);
+  if (op == kIgnore)
+  {
+    // A cancellation, fails if the request completed already.
+    if (cqe->res < 0 && cqe->res != -ENOENT && cqe->res != -EALREADY)
+    {
+      LOG_WARN << "UringPoller cancel: " << strerror_tl(-cqe->res);
+    }
+    return;
+  }
+  const int fd = fdOf(data);
+  assert(static_cast<size_t>(fd) < slots_.size());
+  Slot& slot = slots_[fd];
+  const bool owned = slot.channel && seqOf(data) >= slot.firstSeq;
+  if (op == kRecv)
+  {
+    handleRecv(fd, owned, data, cqe->res, cqe->flags);
+  }
+  else if (owned && slot.pollData == data)
+  {
+    slot.pollData = 0;
+    if (cqe->res >= 0)
+    {
+      addEvents(fd, cqe->res);
+    }
+    else
+    {
+      errno = -cqe->res;
+      LOG_SYSERR << "UringPoller poll fd=" << fd;
+      queueRearm(fd);
+    }
+  }
+}
+
+void UringPoller::handleRecv(int fd, bool owned, uint64_t data, int res, uint32_t flags)
+{
+  Slot& slot = slots_[fd];
+  if (flags & IORING_CQE_F_BUFFER)
+  {
+    uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    if (owned && res > 0)
+    {
+      slot.channel->receiveBuffer()->append(buffers_ + bid * kBufferSize, res);
+      slot.channel->addReceived(res);
+    }
+    recycleBuffer(bid);
+  }
+  if (!owned)
+  {
+    return;
+  }
+  Channel* channel = slot.channel;
+  if (!(flags & IORING_CQE_F_MORE))
+  {
+    if (slot.recvData == data)
+    {
+      slot.recvData = 0;
+      // Armed again after the read callback, e.g. on ENOBUFS.
+      queueRearm(fd);
+    }
+    if (res == -EINVAL && receiveSupported_)
+    {
+      // Multishot receives came in Linux 6.0.
+      LOG_WARN << "UringPoller can't receive, polls instead";
+      receiveSupported_ = false;
+      channel->set_receiving(false);
+      return;
+    }
+    if (res == 0)
+    {
+      channel->endReceive(0);
+    }
+    else if (res < 0 && res != -ENOBUFS && res != -ECANCELED)
+    {
+      channel->endReceive(-res);
+    }
+  }
+  if (channel->receiving() && channel->isReading() && channel->hasReceived())
+  {
+    addEvents(fd, POLLIN);
+  }
+}
+
+void UringPoller::recycleBuffer(uint16_t bid)
+{
+  // Not bufRing_->bufs, whose flexible array is misplaced in C++.
+  struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(bufRing_)
+                             + (bufTail_ & (kNumBuffers - 1));
+  buf->addr = reinterpret_cast<uint64_t>(buffers_ + bid * kBufferSize);
+  buf->len = kBufferSize;
+  buf->bid = bid;
+  ++bufTail_;
+}
+
+void UringPoller::addEvents(int fd, int events)
+{
+  Slot& slot = slots_[fd];
+  if (slot.revents == 0)
+  {
+    actives_.push_back(fd);
+  }
+  slot.revents |= events;
+}
+
+void UringPoller::queueRearm(int fd)
+{
+  if (!slots_[fd].rearm)
+  {
+    slots_[fd].rearm = true;
+    rearms_.push_back(fd);
+  }
+}
+
+void UringPoller::updateChannel(Channel* channel)
+{
+  Poller::assertInLoopThread();
+  const int fd = channel->fd();
+  LOG_TRACE << "fd = " << fd
+    << " events = " << channel->events() << " index = " << channel->index();
+  if (channel->index() == kNew)
+  {
+    assert(channels_.find(fd) == channels_.end());
+    assert(fd < (1 << kFdBits));
+    channels_[fd] = channel;
+    if (static_cast<size_t>(fd) >= slots_.size())
+    {
+      slots_.resize(fd + 1);
+    }
+    Slot& slot = slots_[fd];
+    assert(slot.channel == NULL);
+    slot.channel = channel;
+    slot.firstSeq = slot.seq + 1;
+    channel->set_index(kAdded);
+    channel->set_receiving(channel->receiveBuffer() != NULL
+                           && receiveSupported_ && setupBufferRing());
+  }
+  else
+  {
+    assert(channels_.find(fd) != channels_.end());
+    assert(channels_[fd] == channel);
+    assert(channel->index() == kAdded);
+  }
+  arm(fd);
+}
+
+void UringPoller::removeChannel(Channel* channel)
+{
+  Poller::assertInLoopThread();
+  const int fd = channel->fd();
+  LOG_TRACE << "fd = " << fd;
+  assert(channels_.find(fd) != channels_.end());
+  assert(channels_[fd] == channel);
+  assert(channel->isNoneEvent());
+  assert(channel->index() == kAdded);
+  size_t n = channels_.erase(fd);
+  (void)n;
+  assert(n == 1);
+
+  Slot& slot = slots_[fd];
+  if (slot.pollData)
+  {
+    cancel(IORING_OP_POLL_REMOVE, slot.pollData);
+  }
+  if (slot.recvData)
+  {
+    cancel(IORING_OP_ASYNC_CANCEL, slot.recvData);
+  }
+  slot.channel = NULL;
+  slot.pollData = 0;
+  slot.recvData = 0;
+  slot.revents = 0;
+  channel->set_index(kNew);
+}
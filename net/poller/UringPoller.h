@@ -0,0 +1,119 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef VAR_NET_POLLER_URINGPOLLER_H
+#define VAR_NET_POLLER_URINGPOLLER_H
+
+#include "Poller.h"
+
+#include <stdint.h>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace var
+{
+namespace net
+{
+
+///
+/// IO Multiplexing with io_uring(7).
+///
+/// Arms a one-shot IORING_OP_POLL_ADD for each channel and re-arms it
+/// after the channel was handled, batched into the io_uring_enter(2)
+/// that waits for the next events. That keeps the level-triggered
+/// semantics of epoll, which multishot poll doesn't have.
+///
+/// Channels with Channel::receiveInto() get a multishot IORING_OP_RECV
+/// on a ring of provided buffers instead of a poll for POLLIN, which
+/// saves the read(2) per message.
+///
+class UringPoller : public Poller
+{
+ public:
+  UringPoller(EventLoop* loop);
+  ~UringPoller() override;
+
+  /// False if the kernel lacks io_uring or the features it needs.
+  bool supported() const { return ringfd_ >= 0; }
+
+  Timestamp poll(int timeoutMs, ChannelList* activeChannels) override;
+  void updateChannel(Channel* channel) override;
+  void removeChannel(Channel* channel) override;
+
+ private:
+  enum Operation { kIgnore, kPoll, kRecv };
+
+  struct Slot
+  {
+    Slot()
+      : channel(NULL), seq(0), firstSeq(0), pollData(0), pollEvents(0),
+        recvData(0), revents(0), rearm(false)
+    {
+    }
+
+    Channel* channel;
+    // Completions of requests before firstSeq are for a former channel
+    // of the fd.
+    uint64_t seq;
+    uint64_t firstSeq;
+    // user_data of the armed requests, 0 if none.
+    uint64_t pollData;
+    int pollEvents;
+    uint64_t recvData;
+    // Collected in one poll().
+    int revents;
+    bool rearm;
+  };
+
+  bool setup();
+  bool setupBufferRing();
+  void arm(int fd);
+  uint64_t nextData(int fd, Operation op);
+  void cancel(uint8_t opcode, uint64_t data);
+  struct io_uring_sqe* getSqe();
+  void submitAndWait(int timeoutMs, bool wait);
+  void handleCompletion(const struct io_uring_cqe* cqe);
+  void handleRecv(int fd, bool owned, uint64_t data, int res, uint32_t flags);
+  void recycleBuffer(uint16_t bid);
+  void addEvents(int fd, int events);
+  void queueRearm(int fd);
+
+  int ringfd_;
+  uint32_t features_;
+  // Submission queue
+  void* sqRing_;
+  size_t sqRingSize_;
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned sqMask_;
+  unsigned sqEntries_;
+  unsigned sqLocalTail_;
+  struct io_uring_sqe* sqes_;
+  // Completion queue
+  void* cqRing_;
+  size_t cqRingSize_;
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned cqMask_;
+  struct io_uring_cqe* cqes_;
+  // Provided buffers, set up by the first channel receiving.
+  bool receiveSupported_;
+  struct io_uring_buf_ring* bufRing_;
+  char* buffers_;
+  uint16_t bufTail_;
+
+  std::vector<Slot> slots_;
+  std::vector<int> rearms_;
+  std::vector<int> actives_;
+  // Receiving channels with data left after their read callback.
+  std::vector<int> ready_;
+};
+
+}  // namespace net
+}  // namespace var
+#endif  // VAR_NET_POLLER_URINGPOLLER_H
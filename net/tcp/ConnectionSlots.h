@@ -0,0 +1,106 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef VAR_NET_TCP_CONNECTIONSLOTS_H
+#define VAR_NET_TCP_CONNECTIONSLOTS_H
+
+#include "base/noncopyable.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+namespace var
+{
+namespace net
+{
+
+///
+/// Connections in a flat vector, indexed by the low 32 bits of their
+/// ids. The high 32 bits are the sequence number of the connection,
+/// which makes ids of reused slots different.
+///
+/// ConnPtr is a shared pointer to a class with uint64_t id() const,
+/// usually TcpConnectionPtr. Not thread safe.
+template <typename ConnPtr>
+class ConnectionSlots : noncopyable
+{
+ public:
+  ConnectionSlots() : nextSeq_(1) {}
+
+  /// Reserves a slot, returns the id for the connection put in it.
+  uint64_t allocate()
+  {
+    uint32_t slot = 0;
+    if (!freeSlots_.empty())
+    {
+      slot = freeSlots_.back();
+      freeSlots_.pop_back();
+    }
+    else
+    {
+      slot = static_cast<uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+    return (static_cast<uint64_t>(nextSeq_++) << 32) | slot;
+  }
+
+  void put(const ConnPtr& conn)
+  {
+    const uint32_t slot = static_cast<uint32_t>(conn->id());
+    assert(slot < slots_.size() && !slots_[slot]);
+    slots_[slot] = conn;
+  }
+
+  /// Returns the connection of id, or null if it's gone, even if
+  /// another connection took its slot.
+  ConnPtr find(uint64_t id) const
+  {
+    const uint32_t slot = static_cast<uint32_t>(id);
+    if (slot >= slots_.size() || !slots_[slot] || slots_[slot]->id() != id)
+    {
+      return ConnPtr();
+    }
+    return slots_[slot];
+  }
+
+  /// Returns false if conn is not in its slot.
+  bool release(const ConnPtr& conn)
+  {
+    const uint32_t slot = static_cast<uint32_t>(conn->id());
+    if (slot >= slots_.size() || slots_[slot] != conn)
+    {
+      return false;
+    }
+    slots_[slot].reset();
+    freeSlots_.push_back(slot);
+    return true;
+  }
+
+  /// Takes all connections out.
+  void releaseAll(std::vector<ConnPtr>* conns)
+  {
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+      if (slots_[i])
+      {
+        conns->push_back(std::move(slots_[i]));
+      }
+    }
+    slots_.clear();
+    freeSlots_.clear();
+  }
+
+  /// Number of slots in use.
+  size_t size() const { return slots_.size() - freeSlots_.size(); }
+
+ private:
+  std::vector<ConnPtr> slots_;
+  std::vector<uint32_t> freeSlots_;
+  uint32_t nextSeq_;
+};
+
+}  // namespace net
+}  // namespace var
+
+#endif  // VAR_NET_TCP_CONNECTIONSLOTS_H
@@ -16,6 +16,7 @@
 #include "SocketsOps.h"
 
 #include <errno.h>
+#include <stdio.h>
 
 using namespace var;
 using namespace var::net;
@@ -41,14 +42,44 @@ TcpConnection::TcpConnection(EventLoop* loop,
                              const InetAddress& localAddr,
                              const InetAddress& peerAddr)
   : loop_(CHECK_NOTNULL(loop)),
+    id_(0),
     name_(nameArg),
     state_(kConnecting),
     reading_(true),
+    receiveInPoller_(false),
+    edgeTriggered_(false),
     socket_(new Socket(sockfd)),
     channel_(new Channel(loop, sockfd)),
     localAddr_(localAddr),
     peerAddr_(peerAddr),
     highWaterMark_(64*1024*1024)
+{
+  init(sockfd);
+}
+
+TcpConnection::TcpConnection(EventLoop* loop,
+                             uint64_t id,
+                             const std::shared_ptr<const string>& namePrefix,
+                             int sockfd,
+                             const InetAddress& localAddr,
+                             const InetAddress& peerAddr)
+  : loop_(CHECK_NOTNULL(loop)),
+    id_(id),
+    namePrefix_(namePrefix),
+    state_(kConnecting),
+    reading_(true),
+    receiveInPoller_(false),
+    edgeTriggered_(false),
+    socket_(new Socket(sockfd)),
+    channel_(new Channel(loop, sockfd)),
+    localAddr_(localAddr),
+    peerAddr_(peerAddr),
+    highWaterMark_(64*1024*1024)
+{
+  init(sockfd);
+}
+
+void TcpConnection::init(int sockfd)
 {
   channel_->setReadCallback(
       std::bind(&TcpConnection::handleRead, this, _1));
@@ -58,17 +89,26 @@ TcpConnection::TcpConnection(EventLoop* loop,
       std::bind(&TcpConnection::handleClose, this));
   channel_->setErrorCallback(
       std::bind(&TcpConnection::handleError, this));
-  LOG_DEBUG << "TcpConnection::ctor[" <<  name_ << "] at " << this
+  LOG_DEBUG << "TcpConnection::ctor[" <<  name() << "] at " << this
             << " fd=" << sockfd;
   socket_->setKeepAlive(true);
+  loop_->addConnection();
+}
+
+void TcpConnection::buildName() const
+{
+  char buf[32];
+  snprintf(buf, sizeof buf, "%u", static_cast<unsigned>(id_ >> 32));
+  name_ = *namePrefix_ + buf;
 }
 
 TcpConnection::~TcpConnection()
 {
-  LOG_DEBUG << "TcpConnection::dtor[" <<  name_ << "] at " << this
+  LOG_DEBUG << "TcpConnection::dtor[" <<  name() << "] at " << this
             << " fd=" << channel_->fd()
             << " state=" << stateToString();
   assert(state_ == kDisconnected);
+  loop_->removeConnection();
 }
 
 bool TcpConnection::getTcpInfo(struct tcp_info* tcpi) const
@@ -114,7 +154,6 @@ void TcpConnection::send(const StringPiece& message)
   }
 }
 
-// FIXME efficiency!!!
 void TcpConnection::send(Buffer* buf)
 {
   if (state_ == kConnected)
@@ -126,12 +165,28 @@ void TcpConnection::send(Buffer* buf)
     }
     else
     {
-      void (TcpConnection::*fp)(const StringPiece& message) = &TcpConnection::sendInLoop;
-      loop_->runInLoop(
-          std::bind(fp,
-                    this,     // FIXME
-                    buf->retrieveAllAsString()));
-                    //std::forward<string>(message)));
+      IOBuf message;
+      message.append(std::move(*buf));
+      send(std::move(message));
+    }
+  }
+}
+
+void TcpConnection::send(IOBuf&& message)
+{
+  if (state_ == kConnected)
+  {
+    if (loop_->isInLoopThread())
+    {
+      sendInLoop(&message);
+    }
+    else
+    {
+      // Copies of an IOBuf share its blocks.
+      TcpConnectionPtr guard(shared_from_this());
+      IOBuf queued;
+      queued.swap(message);
+      loop_->runInLoop([guard, queued]() mutable { guard->sendInLoop(&queued); });
     }
   }
 }
@@ -153,7 +208,7 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
     return;
   }
   // if no thing in output queue, try writing directly
-  if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0)
+  if (!channel_->isWriting() && outputBuffer_.empty())
   {
     nwrote = sockets::write(channel_->fd(), data, len);
     if (nwrote >= 0)
@@ -181,7 +236,7 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
   assert(remaining <= len);
   if (!faultError && remaining > 0)
   {
-    size_t oldLen = outputBuffer_.readableBytes();
+    size_t oldLen = outputBuffer_.size();
     if (oldLen + remaining >= highWaterMark_
         && oldLen < highWaterMark_
         && highWaterMarkCallback_)
@@ -196,6 +251,54 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
   }
 }
 
+void TcpConnection::sendInLoop(IOBuf* message)
+{
+  loop_->assertInLoopThread();
+  bool faultError = false;
+  if (state_ == kDisconnected)
+  {
+    LOG_WARN << "disconnected, give up writing";
+    return;
+  }
+  // if no thing in output queue, try writing directly
+  if (!channel_->isWriting() && outputBuffer_.empty())
+  {
+    ssize_t nwrote = message->cutIntoFd(channel_->fd());
+    if (nwrote >= 0)
+    {
+      if (message->empty() && writeCompleteCallback_)
+      {
+        loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+      }
+    }
+    else if (errno != EWOULDBLOCK)
+    {
+      LOG_SYSERR << "TcpConnection::sendInLoop";
+      if (errno == EPIPE || errno == ECONNRESET)
+      {
+        faultError = true;
+      }
+    }
+  }
+
+  if (!faultError && !message->empty())
+  {
+    size_t oldLen = outputBuffer_.size();
+    size_t remaining = message->size();
+    if (oldLen + remaining >= highWaterMark_
+        && oldLen < highWaterMark_
+        && highWaterMarkCallback_)
+    {
+      loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
+    }
+    outputBuffer_.append(std::move(*message));
+    if (!channel_->isWriting())
+    {
+      channel_->enableWriting();
+    }
+  }
+}
+
 void TcpConnection::shutdown()
 {
   // FIXME: use compare and swap
@@ -331,6 +434,11 @@ void TcpConnection::connectEstablished()
   assert(state_ == kConnecting);
   setState(kConnected);
   channel_->tie(shared_from_this());
+  if (receiveInPoller_)
+  {
+    channel_->receiveInto(&inputBuffer_);
+  }
+  channel_->setEdgeTriggered(edgeTriggered_);
   channel_->enableReading();
 
   connectionCallback_(shared_from_this());
@@ -339,7 +447,8 @@ void TcpConnection::connectEstablished()
 void TcpConnection::connectDestroyed()
 {
   loop_->assertInLoopThread();
-  if (state_ == kConnected)
+  // Shut down for writing but still reading when the server goes.
+  if (state_ == kConnected || state_ == kDisconnecting)
   {
     setState(kDisconnected);
     channel_->disableAll();
@@ -352,8 +461,15 @@ void TcpConnection::connectDestroyed()
 void TcpConnection::handleRead(Timestamp receiveTime)
 {
   loop_->assertInLoopThread();
+  if (edgeTriggered_ && !channel_->receiving())
+  {
+    handleReadEdgeTriggered(receiveTime);
+    return;
+  }
   int savedErrno = 0;
-  ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+  ssize_t n = channel_->receiving()
+      ? channel_->takeReceived(&savedErrno)  // already in inputBuffer_
+      : inputBuffer_.readFd(channel_->fd(), &savedErrno);
   if (n > 0)
   {
     messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
@@ -362,11 +478,72 @@ void TcpConnection::handleRead(Timestamp receiveTime)
   {
     handleClose();
   }
+  else if (channel_->receiving() && savedErrno == EAGAIN)
+  {
+    // Nothing received yet.
+  }
   else
   {
     errno = savedErrno;
     LOG_SYSERR << "TcpConnection::handleRead";
     handleError();
+    // The Poller stopped receiving on the error, nothing more comes.
+    if (channel_->receiving())
+    {
+      handleClose();
+    }
+  }
+}
+
+void TcpConnection::handleReadEdgeTriggered(Timestamp receiveTime)
+{
+  loop_->assertInLoopThread();
+  if (state_ == kDisconnected || !channel_->isReading())
+  {
+    return;
+  }
+  // No more event comes before EAGAIN, but a fast sender could keep
+  // us here forever, so the rest waits behind the other channels.
+  // Each read is handed over at once, while it's still in the cache.
+  int savedErrno = 0;
+  ssize_t n = 0;
+  int reads = 0;
+  while (reads < kEdgeTriggeredReadBudget
+         && (n = inputBuffer_.readFd(channel_->fd(), &savedErrno)) > 0)
+  {
+    ++reads;
+    messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+    if (!channel_->isReading())
+    {
+      // Stopped or closed by the callback.
+      return;
+    }
+    if (channel_->isWriting())
+    {
+      handleWrite();
+      if (state_ == kDisconnected)
+      {
+        // Closed by a failed write.
+        return;
+      }
+    }
+  }
+  if (reads == kEdgeTriggeredReadBudget)
+  {
+    loop_->queueInLoop(std::bind(&TcpConnection::handleReadEdgeTriggered,
+                                 shared_from_this(), receiveTime));
+  }
+  else if (n == 0)
+  {
+    handleClose();
+  }
+  else if (savedErrno != EAGAIN && savedErrno != EWOULDBLOCK)
+  {
+    errno = savedErrno;
+    LOG_SYSERR << "TcpConnection::handleRead";
+    handleError();
+    // No other edge comes for a broken connection.
+    handleClose();
   }
 }
 
@@ -375,13 +552,12 @@ void TcpConnection::handleWrite()
   loop_->assertInLoopThread();
   if (channel_->isWriting())
   {
-    ssize_t n = sockets::write(channel_->fd(),
-                               outputBuffer_.peek(),
-                               outputBuffer_.readableBytes());
+    // Writes until a short write, so the kernel buffer is full
+    // when some is left, as edge-triggered mode needs it to be.
+    ssize_t n = outputBuffer_.cutIntoFd(channel_->fd());
     if (n > 0)
     {
-      outputBuffer_.retrieve(n);
-      if (outputBuffer_.readableBytes() == 0)
+      if (outputBuffer_.empty())
       {
         channel_->disableWriting();
         if (writeCompleteCallback_)
@@ -394,7 +570,13 @@ void TcpConnection::handleWrite()
         }
       }
     }
-    else
+    else if (errno == EIO)
+    {
+      // A queued file ended early, the peer can't get what it expects.
+      LOG_SYSERR << "TcpConnection::handleWrite";
+      handleClose();
+    }
+    else if (errno != EAGAIN && errno != EWOULDBLOCK)
     {
       LOG_SYSERR << "TcpConnection::handleWrite";
       // if (state_ == kDisconnecting)
@@ -428,7 +610,7 @@ void TcpConnection::handleClose()
 void TcpConnection::handleError()
 {
   int err = sockets::getSocketError(channel_->fd());
-  LOG_ERROR << "TcpConnection::handleError [" << name_
+  LOG_ERROR << "TcpConnection::handleError [" << name()
             << "] - SO_ERROR = " << err << " " << strerror_tl(err);
 }
 
@@ -16,9 +16,11 @@
 #include "base/Types.h"
 #include "Callbacks.h"
 #include "Buffer.h"
+#include "IOBuf.h"
 #include "InetAddress.h"
 
 #include <memory>
+#include <mutex>
 #include <any>
 // #include <boost/any.hpp>
 
@@ -50,10 +52,27 @@ class TcpConnection : noncopyable,
                 int sockfd,
                 const InetAddress& localAddr,
                 const InetAddress& peerAddr);
+  /// The name is namePrefix followed by the high 32 bits of id,
+  /// built on the first call of name().
+  TcpConnection(EventLoop* loop,
+                uint64_t id,
+                const std::shared_ptr<const string>& namePrefix,
+                int sockfd,
+                const InetAddress& localAddr,
+                const InetAddress& peerAddr);
   ~TcpConnection();
 
   EventLoop* getLoop() const { return loop_; }
-  const string& name() const { return name_; }
+  /// Unique in the TcpServer, 0 for TcpClient connections.
+  uint64_t id() const { return id_; }
+  const string& name() const
+  {
+    if (namePrefix_)
+    {
+      std::call_once(nameOnce_, &TcpConnection::buildName, this);
+    }
+    return name_;
+  }
   const InetAddress& localAddress() const { return localAddr_; }
   const InetAddress& peerAddress() const { return peerAddr_; }
   bool connected() const { return state_ == kConnected; }
@@ -68,6 +87,8 @@ class TcpConnection : noncopyable,
   void send(const StringPiece& message);
   // void send(Buffer&& message); // C++11
   void send(Buffer* message);  // this one will swap data
+  /// Queues the blocks of message without copying them.
+  void send(IOBuf&& message);
   void shutdown(); // NOT thread safe, no simultaneous calling
   // void shutdownAndForceCloseAfter(double seconds); // NOT thread safe, no simultaneous calling
   void forceClose();
@@ -77,6 +98,14 @@ class TcpConnection : noncopyable,
   void startRead();
   void stopRead();
   bool isReading() const { return reading_; }; // NOT thread safe, may race with start/stopReadInLoop
+  /// Lets a completion based Poller (VAR_USE_IO_URING) receive into the
+  /// input buffer itself, which saves a read(2) per message.
+  /// Ignored by the other pollers. Must be called before connectEstablished().
+  void setReceiveInPoller(bool on) { receiveInPoller_ = on; }
+  /// Registers the socket edge-triggered with EPollPoller and drains it
+  /// on each event, which saves an epoll_wait(2) per 64 KiB for fast
+  /// senders. Must be called before connectEstablished().
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
 
   void setContext(void* context)
   { context_ = context; }
@@ -103,8 +132,11 @@ class TcpConnection : noncopyable,
   Buffer* inputBuffer()
   { return &inputBuffer_; }
 
-  Buffer* outputBuffer()
-  { return &outputBuffer_; }
+  /// Bytes queued but not yet written to the socket, in the loop thread.
+  /// Replaces the Buffer* outputBuffer() of old, the output is an IOBuf
+  /// chain now and can't be peeked or retrieved in place.
+  size_t outputBytes() const
+  { return outputBuffer_.size(); }
 
   /// Internal use only.
   void setCloseCallback(const CloseCallback& cb)
@@ -117,13 +149,18 @@ class TcpConnection : noncopyable,
 
  private:
   enum StateE { kDisconnected, kConnecting, kConnected, kDisconnecting };
+  // Reads in a row on an edge-triggered event before the other
+  // channels of the loop get their turn.
+  static const int kEdgeTriggeredReadBudget = 16;
   void handleRead(Timestamp receiveTime);
+  void handleReadEdgeTriggered(Timestamp receiveTime);
   void handleWrite();
   void handleClose();
   void handleError();
   // void sendInLoop(string&& message);
   void sendInLoop(const StringPiece& message);
   void sendInLoop(const void* message, size_t len);
+  void sendInLoop(IOBuf* message);
   void shutdownInLoop();
   // void shutdownAndForceCloseInLoop(double seconds);
   void forceCloseInLoop();
@@ -131,11 +168,18 @@ class TcpConnection : noncopyable,
   const char* stateToString() const;
   void startReadInLoop();
   void stopReadInLoop();
+  void init(int sockfd);
+  void buildName() const;
 
   EventLoop* loop_;
-  const string name_;
+  const uint64_t id_;
+  const std::shared_ptr<const string> namePrefix_;
+  mutable std::once_flag nameOnce_;
+  mutable string name_;
   StateE state_;  // FIXME: use atomic variable
   bool reading_;
+  bool receiveInPoller_;
+  bool edgeTriggered_;
   // we don't expose those classes to client.
   std::unique_ptr<Socket> socket_;
   std::unique_ptr<Channel> channel_;
@@ -148,7 +192,7 @@ class TcpConnection : noncopyable,
   CloseCallback closeCallback_;
   size_t highWaterMark_;
   Buffer inputBuffer_;
-  Buffer outputBuffer_; // FIXME: use list<Buffer> as output buffer.
+  IOBuf outputBuffer_;
   void* context_;
   // FIXME: creationTime_, lastReceiveTime_
   //        bytesReceived_, bytesSent_
@@ -8,32 +8,51 @@
 
 #include "tcp/TcpServer.h"
 
+#include "base/CountDownLatch.h"
 #include "base/Logging.h"
 #include "Acceptor.h"
 #include "EventLoop.h"
 #include "EventLoopThreadPool.h"
 #include "SocketsOps.h"
 
-#include <stdio.h>  // snprintf
-
 using namespace var;
 using namespace var::net;
 
+namespace
+{
+
+// Bounds the time a loop spends accepting before serving its
+// connections again.
+const int kDefaultMaxAcceptsPerRead = 64;
+
+}  // namespace
+
 TcpServer::TcpServer(EventLoop* loop,
                      const InetAddress& listenAddr,
                      const string& nameArg,
                      Option option)
   : loop_(CHECK_NOTNULL(loop)),
+    listenAddr_(listenAddr),
+    option_(option),
     ipPort_(listenAddr.toIpPort()),
     name_(nameArg),
-    acceptor_(new Acceptor(loop, listenAddr, option == kReusePort)),
     threadPool_(new EventLoopThreadPool(loop, name_)),
     connectionCallback_(defaultConnectionCallback),
     messageCallback_(defaultMessageCallback),
-    nextConnId_(1)
+    maxAcceptsPerRead_(kDefaultMaxAcceptsPerRead),
+    receiveInPoller_(false),
+    edgeTriggered_(false),
+    connNamePrefix_(std::make_shared<const string>(name_ + "-" + ipPort_ + "#"))
 {
-  acceptor_->setNewConnectionCallback(
-      std::bind(&TcpServer::newConnection, this, _1, _2));
+  // With kReusePortPerLoop, the listening sockets are created in start()
+  // when the io loops are known.
+  if (option_ != kReusePortPerLoop)
+  {
+    acceptor_.reset(new Acceptor(loop, listenAddr, option == kReusePort));
+    acceptor_->setMaxAcceptsPerRead(maxAcceptsPerRead_);
+    acceptor_->setNewConnectionCallback(
+        std::bind(&TcpServer::newConnection, this, _1, _2));
+  }
 }
 
 TcpServer::~TcpServer()
@@ -41,13 +60,31 @@ TcpServer::~TcpServer()
   loop_->assertInLoopThread();
   LOG_TRACE << "TcpServer::~TcpServer [" << name_ << "] destructing";
 
-  for (auto& item : connections_)
+  // Acceptors and connections of the io loops must be destroyed in them,
+  // wait for that before the loops are gone with threadPool_.
+  std::vector<TcpConnectionPtr> conns;
+  connections_.releaseAll(&conns);
+  CountDownLatch destroyed(static_cast<int>(conns.size()));
+  for (auto& conn : conns)
   {
-    TcpConnectionPtr conn(item.second);
-    item.second.reset();
-    conn->getLoop()->runInLoop(
-      std::bind(&TcpConnection::connectDestroyed, conn));
+    conn->getLoop()->runInLoop([conn, &destroyed]()
+    {
+      conn->connectDestroyed();
+      destroyed.countDown();
+    });
   }
+  destroyed.wait();
+
+  CountDownLatch latch(static_cast<int>(loopAcceptors_.size()));
+  for (auto& la : loopAcceptors_)
+  {
+    la->loop->runInLoop([this, &la, &latch]()
+    {
+      stopLoopAcceptor(get_pointer(la));
+      latch.countDown();
+    });
+  }
+  latch.wait();
 }
 
 void TcpServer::setThreadNum(int numThreads)
@@ -56,12 +93,42 @@ void TcpServer::setThreadNum(int numThreads)
   threadPool_->setThreadNum(numThreads);
 }
 
+void TcpServer::setMaxAcceptsPerRead(int n)
+{
+  assert(started_.get() == 0);
+  maxAcceptsPerRead_ = n;
+  if (acceptor_)
+  {
+    acceptor_->setMaxAcceptsPerRead(n);
+  }
+}
+
 void TcpServer::start()
 {
   if (started_.getAndSet(1) == 0)
   {
     threadPool_->start(threadInitCallback_);
 
+    if (option_ == kReusePortPerLoop)
+    {
+      std::vector<EventLoop*> loops = threadPool_->getAllLoops();
+      for (size_t i = 0; i < loops.size(); ++i)
+      {
+        std::unique_ptr<LoopAcceptor> la(new LoopAcceptor);
+        la->loop = loops[i];
+        la->acceptor.reset(new Acceptor(loops[i], listenAddr_, true));
+        la->acceptor->setMaxAcceptsPerRead(maxAcceptsPerRead_);
+        la->acceptor->setNewConnectionCallback(
+            std::bind(&TcpServer::newLoopConnection, this, get_pointer(la), _1, _2));
+        la->connNamePrefix = std::make_shared<const string>(
+            *connNamePrefix_ + std::to_string(i) + ".");
+        loops[i]->runInLoop(
+            std::bind(&Acceptor::listen, get_pointer(la->acceptor)));
+        loopAcceptors_.push_back(std::move(la));
+      }
+      return;
+    }
+
     assert(!acceptor_->listening());
     loop_->runInLoop(
         std::bind(&Acceptor::listen, get_pointer(acceptor_)));
@@ -72,26 +139,26 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
 {
   loop_->assertInLoopThread();
   EventLoop* ioLoop = threadPool_->getNextLoop();
-  char buf[64];
-  snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), nextConnId_);
-  ++nextConnId_;
-  string connName = name_ + buf;
-
-  LOG_INFO << "TcpServer::newConnection [" << name_
-           << "] - new connection [" << connName
-           << "] from " << peerAddr.toIpPort();
   InetAddress localAddr(sockets::getLocalAddr(sockfd));
   // FIXME poll with zero timeout to double confirm the new connection
-  // FIXME use make_shared if necessary
-  TcpConnectionPtr conn(new TcpConnection(ioLoop,
-                                          connName,
-                                          sockfd,
-                                          localAddr,
-                                          peerAddr));
-  connections_[connName] = conn;
+  // Freed in ioLoop, back to the BlockAllocator cache of this loop.
+  TcpConnectionPtr conn(std::allocate_shared<TcpConnection>(PoolAllocator<TcpConnection>(),
+                                                            ioLoop,
+                                                            connections_.allocate(),
+                                                            connNamePrefix_,
+                                                            sockfd,
+                                                            localAddr,
+                                                            peerAddr));
+  // The name is only built if it's logged.
+  LOG_DEBUG << "TcpServer::newConnection [" << name_
+            << "] - new connection [" << conn->name()
+            << "] from " << peerAddr.toIpPort();
+  connections_.put(conn);
   conn->setConnectionCallback(connectionCallback_);
   conn->setMessageCallback(messageCallback_);
   conn->setWriteCompleteCallback(writeCompleteCallback_);
+  conn->setReceiveInPoller(receiveInPoller_);
+  conn->setEdgeTriggered(edgeTriggered_);
   conn->setCloseCallback(
       std::bind(&TcpServer::removeConnection, this, _1)); // FIXME: unsafe
   ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
@@ -106,13 +173,62 @@ void TcpServer::removeConnection(const TcpConnectionPtr& conn)
 void TcpServer::removeConnectionInLoop(const TcpConnectionPtr& conn)
 {
   loop_->assertInLoopThread();
-  LOG_INFO << "TcpServer::removeConnectionInLoop [" << name_
-           << "] - connection " << conn->name();
-  size_t n = connections_.erase(conn->name());
-  (void)n;
-  assert(n == 1);
+  LOG_DEBUG << "TcpServer::removeConnectionInLoop [" << name_
+            << "] - connection " << conn->name();
+  bool released = connections_.release(conn);
+  (void)released;
+  assert(released);
   EventLoop* ioLoop = conn->getLoop();
   ioLoop->queueInLoop(
       std::bind(&TcpConnection::connectDestroyed, conn));
 }
 
+
+void TcpServer::newLoopConnection(LoopAcceptor* la, int sockfd, const InetAddress& peerAddr)
+{
+  la->loop->assertInLoopThread();
+  InetAddress localAddr(sockets::getLocalAddr(sockfd));
+  TcpConnectionPtr conn(std::allocate_shared<TcpConnection>(PoolAllocator<TcpConnection>(),
+                                                            la->loop,
+                                                            la->connections.allocate(),
+                                                            la->connNamePrefix,
+                                                            sockfd,
+                                                            localAddr,
+                                                            peerAddr));
+  LOG_DEBUG << "TcpServer::newLoopConnection [" << name_
+            << "] - new connection [" << conn->name()
+            << "] from " << peerAddr.toIpPort();
+  la->connections.put(conn);
+  conn->setConnectionCallback(connectionCallback_);
+  conn->setMessageCallback(messageCallback_);
+  conn->setWriteCompleteCallback(writeCompleteCallback_);
+  conn->setReceiveInPoller(receiveInPoller_);
+  conn->setEdgeTriggered(edgeTriggered_);
+  conn->setCloseCallback(
+      std::bind(&TcpServer::removeLoopConnection, this, la, _1));
+  conn->connectEstablished();
+}
+
+void TcpServer::removeLoopConnection(LoopAcceptor* la, const TcpConnectionPtr& conn)
+{
+  la->loop->assertInLoopThread();
+  LOG_DEBUG << "TcpServer::removeLoopConnection [" << name_
+            << "] - connection " << conn->name();
+  bool released = la->connections.release(conn);
+  (void)released;
+  assert(released);
+  la->loop->queueInLoop(
+      std::bind(&TcpConnection::connectDestroyed, conn));
+}
+
+void TcpServer::stopLoopAcceptor(LoopAcceptor* la)
+{
+  la->loop->assertInLoopThread();
+  la->acceptor.reset();
+  std::vector<TcpConnectionPtr> conns;
+  la->connections.releaseAll(&conns);
+  for (auto& conn : conns)
+  {
+    conn->connectDestroyed();
+  }
+}
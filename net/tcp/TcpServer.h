@@ -13,9 +13,11 @@
 
 #include "base/Atomic.h"
 #include "base/Types.h"
+#include "tcp/ConnectionSlots.h"
 #include "tcp/TcpConnection.h"
 
 #include <map>
+#include <vector>
 
 namespace var
 {
@@ -38,6 +40,11 @@ class TcpServer : noncopyable
   {
     kNoReusePort,
     kReusePort,
+    /// Every io loop listens on its own SO_REUSEPORT socket, accepts in
+    /// batches and owns the connections it accepted, so the base loop
+    /// is out of the connection setup path. The kernel spreads incoming
+    /// connections over the loops.
+    kReusePortPerLoop,
   };
 
   //TcpServer(EventLoop* loop, const InetAddress& listenAddr);
@@ -53,15 +60,28 @@ class TcpServer : noncopyable
 
   /// Set the number of threads for handling input.
   ///
-  /// Always accepts new connection in loop's thread.
+  /// Accepts new connection in loop's thread, or in every io loop
+  /// with kReusePortPerLoop.
   /// Must be called before @c start
   /// @param numThreads
   /// - 0 means all I/O in loop's thread, no thread will created.
   ///   this is the default value.
   /// - 1 means all I/O in another thread.
   /// - N means a thread pool with N threads, new connections
-  ///   are assigned on a round-robin basis.
+  ///   are assigned by threadPool()->setLoadBalancing(), on a
+  ///   round-robin basis by default. With kReusePortPerLoop the
+  ///   kernel spreads them instead.
   void setThreadNum(int numThreads);
+  /// Accepts up to n pending connections on each readable event of
+  /// the listening socket, 64 by default.
+  /// Must be called before @c start
+  void setMaxAcceptsPerRead(int n);
+  /// See TcpConnection::setReceiveInPoller(), off by default.
+  /// Must be called before @c start
+  void setReceiveInPoller(bool on) { receiveInPoller_ = on; }
+  /// See TcpConnection::setEdgeTriggered(), off by default.
+  /// Must be called before @c start
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
   void setThreadInitCallback(const ThreadInitCallback& cb)
   { threadInitCallback_ = cb; }
   /// valid after calling start()
@@ -97,9 +117,24 @@ class TcpServer : noncopyable
   /// Not thread safe, but in loop
   void removeConnectionInLoop(const TcpConnectionPtr& conn);
 
-  typedef std::map<string, TcpConnectionPtr> ConnectionMap;
+  /// Acceptor and connections of an io loop with kReusePortPerLoop,
+  /// only touched in that loop.
+  struct LoopAcceptor
+  {
+    EventLoop* loop;
+    std::unique_ptr<Acceptor> acceptor;
+    std::shared_ptr<const string> connNamePrefix;
+    ConnectionSlots<TcpConnectionPtr> connections;
+  };
+
+  /// In the io loop of la.
+  void newLoopConnection(LoopAcceptor* la, int sockfd, const InetAddress& peerAddr);
+  void removeLoopConnection(LoopAcceptor* la, const TcpConnectionPtr& conn);
+  void stopLoopAcceptor(LoopAcceptor* la);
 
   EventLoop* loop_;  // the acceptor loop
+  const InetAddress listenAddr_;
+  const Option option_;
   const string ipPort_;
   const string name_;
   std::unique_ptr<Acceptor> acceptor_; // avoid revealing Acceptor
@@ -109,9 +144,13 @@ class TcpServer : noncopyable
   WriteCompleteCallback writeCompleteCallback_;
   ThreadInitCallback threadInitCallback_;
   AtomicInt32 started_;
+  int maxAcceptsPerRead_;
+  bool receiveInPoller_;
+  bool edgeTriggered_;
   // always in loop thread
-  int nextConnId_;
-  ConnectionMap connections_;
+  std::shared_ptr<const string> connNamePrefix_;
+  ConnectionSlots<TcpConnectionPtr> connections_;
+  std::vector<std::unique_ptr<LoopAcceptor>> loopAcceptors_;
 };
 
 }  // namespace net
@@ -0,0 +1,150 @@
+#include "base/BlockAllocator.h"
+#include "base/Thread.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using var::BlockAllocator;
+using var::BlockAllocatorObserver;
+using var::PoolAllocator;
+
+namespace
+{
+
+class CountingObserver : public BlockAllocatorObserver
+{
+ public:
+  CountingObserver() : live(0), liveBytes(0), free(0), freeBytes(0) {}
+
+  void onLive(int delta, int64_t bytes) override
+  {
+    live += delta;
+    liveBytes += bytes;
+  }
+
+  void onFree(int delta, int64_t bytes) override
+  {
+    free += delta;
+    freeBytes += bytes;
+  }
+
+  std::atomic<int> live;
+  std::atomic<int64_t> liveBytes;
+  std::atomic<int> free;
+  std::atomic<int64_t> freeBytes;
+};
+
+}  // namespace
+
+TEST(BlockAllocator, size_classes)
+{
+  EXPECT_EQ(BlockAllocator::roundUp(1), 64);
+  EXPECT_EQ(BlockAllocator::roundUp(64), 64);
+  EXPECT_EQ(BlockAllocator::roundUp(65), 80);
+  EXPECT_EQ(BlockAllocator::roundUp(1032), 1280);
+  EXPECT_EQ(BlockAllocator::roundUp(8192), 8192);
+  EXPECT_EQ(BlockAllocator::roundUp(8193), 10240);
+  EXPECT_EQ(BlockAllocator::roundUp(BlockAllocator::kMaxSize), BlockAllocator::kMaxSize);
+  EXPECT_EQ(BlockAllocator::roundUp(BlockAllocator::kMaxSize + 1), BlockAllocator::kMaxSize + 1);
+}
+
+TEST(BlockAllocator, reuse)
+{
+  void* p = BlockAllocator::allocate(1000);
+  size_t cached = BlockAllocator::cachedBlocks();
+  BlockAllocator::deallocate(p);
+  EXPECT_EQ(BlockAllocator::cachedBlocks(), cached + 1);
+  // Same class, same block.
+  EXPECT_EQ(BlockAllocator::allocate(900), p);
+  EXPECT_EQ(BlockAllocator::cachedBlocks(), cached);
+  BlockAllocator::deallocate(p);
+
+  void* large = BlockAllocator::allocate(BlockAllocator::kMaxSize + 1);
+  BlockAllocator::deallocate(large);
+  EXPECT_EQ(BlockAllocator::cachedBlocks(), cached + 1);
+
+  std::vector<int, PoolAllocator<int> > ints(1000, 1);
+  ints.resize(100000, 2);
+  EXPECT_EQ(ints[999], 1);
+  EXPECT_EQ(ints[99999], 2);
+}
+
+TEST(BlockAllocator, cross_thread_return)
+{
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; ++i)
+  {
+    blocks.push_back(BlockAllocator::allocate(2000));
+  }
+  size_t cached = BlockAllocator::cachedBlocks();
+  var::Thread thread([&blocks]()
+  {
+    for (void* p : blocks)
+    {
+      BlockAllocator::deallocate(p);
+    }
+    EXPECT_EQ(BlockAllocator::cachedBlocks(), 0);
+  });
+  thread.start();
+  thread.join();
+  EXPECT_EQ(BlockAllocator::cachedBlocks(), cached);
+  // Taken back from the return queue when the free list runs empty.
+  std::vector<void*> again;
+  for (int i = 0; i < 10; ++i)
+  {
+    again.push_back(BlockAllocator::allocate(2000));
+  }
+  std::sort(blocks.begin(), blocks.end());
+  std::sort(again.begin(), again.end());
+  EXPECT_EQ(again, blocks);
+  for (void* p : again)
+  {
+    BlockAllocator::deallocate(p);
+  }
+}
+
+TEST(BlockAllocator, thread_exit)
+{
+  void* p = NULL;
+  var::Thread thread([&p]() { p = BlockAllocator::allocate(3000); });
+  thread.start();
+  thread.join();
+  // To the return queue of the exited thread, adopted by the next one.
+  BlockAllocator::deallocate(p);
+  void* again = NULL;
+  var::Thread next([&again]() { again = BlockAllocator::allocate(3000); BlockAllocator::deallocate(again); });
+  next.start();
+  next.join();
+  EXPECT_EQ(again, p);
+}
+
+TEST(BlockAllocator, observer)
+{
+  void* before = BlockAllocator::allocate(100);
+  static CountingObserver observer;
+  BlockAllocator::setObserver(&observer);
+  void* p = BlockAllocator::allocate(100);
+  void* large = BlockAllocator::allocate(BlockAllocator::kMaxSize * 2);
+  EXPECT_EQ(observer.live, 2);
+  EXPECT_EQ(observer.liveBytes, BlockAllocator::roundUp(100) + BlockAllocator::kMaxSize * 2);
+  BlockAllocator::deallocate(large);
+  BlockAllocator::deallocate(p);
+  EXPECT_EQ(observer.live, 0);
+  EXPECT_EQ(observer.free, 1);
+  EXPECT_EQ(observer.freeBytes, BlockAllocator::roundUp(100));
+  // Handed out before, not counted.
+  BlockAllocator::deallocate(before);
+  EXPECT_EQ(observer.live, 0);
+  EXPECT_EQ(observer.free, 2);
+  p = BlockAllocator::allocate(100);
+  before = BlockAllocator::allocate(100);
+  EXPECT_EQ(observer.live, 2);
+  EXPECT_EQ(observer.free, 0);
+  EXPECT_EQ(observer.freeBytes, 0);
+  BlockAllocator::setObserver(NULL);
+  BlockAllocator::deallocate(p);
+  BlockAllocator::deallocate(before);
+}
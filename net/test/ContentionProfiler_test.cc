@@ -0,0 +1,123 @@
+#include "base/ContentionProfiler.h"
+#include "base/Mutex.h"
+#include "base/Thread.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <unistd.h>
+
+using var::ContentionProfiler;
+using var::MutexLock;
+using var::MutexLockGuard;
+using var::string;
+
+TEST(ContentionProfiler, test_not_running)
+{
+  MutexLock mutex;
+  {
+    MutexLockGuard lock(mutex);
+  }
+  EXPECT_FALSE(ContentionProfiler::running());
+}
+
+TEST(ContentionProfiler, test_record_contention)
+{
+  MutexLock mutex;
+  ASSERT_TRUE(ContentionProfiler::start());
+  EXPECT_FALSE(ContentionProfiler::start());
+  EXPECT_TRUE(ContentionProfiler::running());
+
+  mutex.lock();
+  var::Thread thread([&mutex]
+  {
+    // Blocks until the main thread unlocks.
+    MutexLockGuard lock(mutex);
+  });
+  thread.start();
+  ::usleep(100 * 1000);
+  mutex.unlock();
+  thread.join();
+  ContentionProfiler::stop();
+  EXPECT_FALSE(ContentionProfiler::running());
+
+  string profile;
+  ContentionProfiler::dump(&profile);
+  EXPECT_EQ(profile.find("--- contention\n"), 0);
+  EXPECT_NE(profile.find("cycles/second=1000000000\n"), string::npos);
+  // One stack waited for about 100ms.
+  size_t pos = profile.find(" 1 @ 0x");
+  ASSERT_NE(pos, string::npos);
+  size_t begin = profile.rfind('\n', pos) + 1;
+  long long waitNs = atoll(profile.c_str() + begin);
+  EXPECT_GE(waitNs, 50 * 1000 * 1000);
+}
+
+TEST(ContentionProfiler, test_min_wait)
+{
+  MutexLock mutex;
+  // No wait of the test lasts a second.
+  ASSERT_TRUE(ContentionProfiler::start(1000 * 1000 * 1000));
+
+  mutex.lock();
+  var::Thread thread([&mutex]
+  {
+    MutexLockGuard lock(mutex);
+  });
+  thread.start();
+  ::usleep(100 * 1000);
+  mutex.unlock();
+  thread.join();
+  ContentionProfiler::stop();
+
+  string profile;
+  ContentionProfiler::dump(&profile);
+  EXPECT_EQ(profile.find(" @ 0x"), string::npos);
+}
+
+TEST(ContentionProfiler, test_sampling_period)
+{
+  const int kRounds = 4;
+  MutexLock mutex;
+  ASSERT_TRUE(ContentionProfiler::start(0, 2));
+
+  std::atomic<int> round(0);
+  std::atomic<int> released(0);
+  var::Thread thread([&]
+  {
+    for (int i = 0; i < kRounds; ++i)
+    {
+      while (round.load() <= i)
+      {
+        ::usleep(1000);
+      }
+      {
+        // Blocks until the main thread unlocks.
+        MutexLockGuard lock(mutex);
+      }
+      released.store(i + 1);
+    }
+  });
+  thread.start();
+  for (int i = 0; i < kRounds; ++i)
+  {
+    // The worker is gone, so this lock is not contended.
+    mutex.lock();
+    round.store(i + 1);
+    ::usleep(20 * 1000);
+    mutex.unlock();
+    while (released.load() <= i)
+    {
+      ::usleep(1000);
+    }
+  }
+  thread.join();
+  ContentionProfiler::stop();
+
+  string profile;
+  ContentionProfiler::dump(&profile);
+  EXPECT_NE(profile.find("sampling period=2\n"), string::npos);
+  // Every other of the four waits, all from the same stack.
+  size_t pos = profile.find(" 2 @ 0x");
+  ASSERT_NE(pos, string::npos);
+  EXPECT_EQ(profile.find(" @ 0x", pos + 3), string::npos);
+}
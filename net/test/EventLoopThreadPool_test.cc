@@ -1,5 +1,6 @@
 #include "EventLoopThreadPool.h"
 #include "EventLoop.h"
+#include "base/CountDownLatch.h"
 #include "base/Thread.h"
 
 #include <gtest/gtest.h>
@@ -65,4 +66,67 @@ TEST(EventLoopThreadPool, create_event_loop_thread_pools)
   }
 
   loop.loop();
-}
\ No newline at end of file
+}
+
+TEST(EventLoopThreadPool, load_balancing)
+{
+  EventLoop loop;
+  EventLoopThreadPool model(&loop, "balance");
+  model.setThreadNum(3);
+  model.start();
+  std::vector<EventLoop*> loops = model.getAllLoops();
+
+  model.setLoadBalancing(EventLoopThreadPool::kLeastConnections);
+  loops[0]->addConnection();
+  loops[0]->addConnection();
+  loops[1]->addConnection();
+  ASSERT_EQ(loops[2], model.getNextLoop());
+  ASSERT_EQ(loops[2], model.getNextLoop());
+  loops[2]->addConnection();
+  loops[2]->addConnection();
+  loops[2]->addConnection();
+  ASSERT_EQ(loops[1], model.getNextLoop());
+
+  // All idle, so the connection count decides.
+  model.setLoadBalancing(EventLoopThreadPool::kLeastBusy);
+  ASSERT_EQ(loops[1], model.getNextLoop());
+
+  // Any two of the loops hold a less loaded one.
+  model.setLoadBalancing(EventLoopThreadPool::kPowerOfTwoChoices);
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_NE(loops[2], model.getNextLoop());
+  }
+
+  loops[0]->removeConnection();
+  loops[0]->removeConnection();
+  loops[1]->removeConnection();
+  loops[2]->removeConnection();
+  loops[2]->removeConnection();
+  loops[2]->removeConnection();
+}
+
+TEST(EventLoopThreadPool, idle_loop_busy_ratio_decays)
+{
+  EventLoop loop;
+  EventLoopThreadPool model(&loop, "decay");
+  model.setThreadNum(1);
+  model.start();
+  EventLoop* ioLoop = model.getNextLoop();
+
+  CountDownLatch done(1);
+  ioLoop->runInLoop([&done]()
+  {
+    ::usleep(300 * 1000);
+    done.countDown();
+  });
+  done.wait();
+  // Published as the iteration ends, shortly after the countdown.
+  ::usleep(10 * 1000);
+  double busy = ioLoop->busyRatio();
+  ASSERT_GT(busy, 0.5);
+
+  // No iteration ends while the loop waits in poll.
+  ::usleep(900 * 1000);
+  ASSERT_LT(ioLoop->busyRatio(), busy / 2);
+}
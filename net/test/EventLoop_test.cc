@@ -1,8 +1,12 @@
 #include "EventLoop.h"
+#include "EventLoopThread.h"
 #include "base/Thread.h"
 
 #include <gtest/gtest.h>
 #include <assert.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -29,6 +33,41 @@ void threadFunc()
   loop.loop();
 }
 
+// Runs ahead of one_thread_most_has_one_eventloop, which ends the process.
+TEST(EventLoop, queue_in_loop_from_many_threads)
+{
+  EventLoopThread thread;
+  EventLoop* loop = thread.startLoop();
+  const int kProducers = 4;
+  const int kFunctors = 20000;
+  for (int round = 0; round < 20; ++round)
+  {
+    std::atomic<int> count(0);
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i)
+    {
+      producers.emplace_back([&]()
+      {
+        for (int j = 0; j < kFunctors; ++j)
+        {
+          loop->queueInLoop([&count]() { ++count; });
+        }
+      });
+    }
+    for (auto& t : producers)
+    {
+      t.join();
+    }
+    // Nothing else is queued, all of them run on the wakeups they made.
+    for (int i = 0; i < 200 && count != kProducers * kFunctors; ++i)
+    {
+      usleep(10 * 1000);
+    }
+    ASSERT_EQ(kProducers * kFunctors, count) << "round " << round;
+    ASSERT_EQ(0u, loop->queueSize());
+  }
+}
+
 TEST(EventLoop, one_thread_most_has_one_eventloop)
 {
   printf("main(): pid = %d, tid = %d\n", getpid(), CurrentThread::tid());
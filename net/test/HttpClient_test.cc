@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include "http/http_client.h"
+#include "http/http_server.h"
+#include "base/CountDownLatch.h"
+#include "EventLoop.h"
+#include "EventLoopThread.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+using namespace var;
+using namespace var::net;
+
+namespace {
+
+void SetRequest(HttpRequest* request, HttpMethod method, const std::string& path) {
+    request->Reset();
+    request->header().set_method(method);
+    request->header().url().set_path(path);
+}
+
+int Listen(const InetAddress& addr) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    ::bind(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+    ::listen(fd, 16);
+    return fd;
+}
+
+// Reads until a request header ends, returns how many ended in the read
+// or 0 once the peer closed.
+int ReadRequests(int fd) {
+    std::string received;
+    char buf[65536];
+    while(true) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if(n <= 0) {
+            return 0;
+        }
+        received.append(buf, n);
+        int count = 0;
+        for(size_t pos = received.find("\r\n\r\n"); pos != std::string::npos;
+            pos = received.find("\r\n\r\n", pos + 4)) {
+            ++count;
+        }
+        if(count > 0) {
+            return count;
+        }
+    }
+}
+
+const std::string kOkResponse = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+
+} // namespace
+
+TEST(HttpClientTest, round_trip)
+{
+    EventLoop loop;
+    InetAddress addr(2014, true);
+    HttpServer server(&loop, addr, "httpserver");
+    std::string host;
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        const std::string& path = request->header().url().path();
+        if(path == "/a") {
+            host = *request->header().GetHeader("Host");
+        }
+        if(path == "/missing") {
+            response->header().set_status_code(HTTP_STATUS_NOT_FOUND);
+        }
+        else if(path == "/echo") {
+            response->set_body(request->body());
+        }
+        else if(path == "/big") {
+            response->set_body(std::string(1024 * 1024, 'x'));
+        }
+        else {
+            response->set_body(path.substr(1) + "-done");
+        }
+    });
+    server.Start();
+
+    EventLoopThread client_thread;
+    EventLoop* client_loop = client_thread.startLoop();
+    int rc[6];
+    HttpResponse responses[6];
+    std::atomic<int> pipelined_ok(0);
+    std::thread caller([&]() {
+        HttpClientOptions options;
+        options.max_connections_per_host = 2;
+        options.max_pipeline_depth = 8;
+        HttpClient client(client_loop, "httpclient", options);
+        HttpRequest request;
+        SetRequest(&request, HTTP_METHOD_GET, "/a");
+        rc[0] = client.Do(addr, &request, &responses[0]);
+        SetRequest(&request, HTTP_METHOD_POST, "/echo");
+        request.set_body("hello");
+        rc[1] = client.Do(addr, &request, &responses[1]);
+        // No body, though Content-Length says there is.
+        SetRequest(&request, HTTP_METHOD_HEAD, "/a");
+        rc[2] = client.Do(addr, &request, &responses[2]);
+        SetRequest(&request, HTTP_METHOD_GET, "/b");
+        rc[3] = client.Do(addr, &request, &responses[3]);
+        SetRequest(&request, HTTP_METHOD_GET, "/missing");
+        rc[4] = client.Do(addr, &request, &responses[4]);
+        SetRequest(&request, HTTP_METHOD_GET, "/big");
+        rc[5] = client.Do(addr, &request, &responses[5]);
+
+        CountDownLatch latch(100);
+        for(int i = 0; i < 100; ++i) {
+            const std::string path = "/p" + std::to_string(i);
+            SetRequest(&request, HTTP_METHOD_GET, path);
+            client.DoAsync(addr, &request, [&, path](int error, HttpResponse* response) {
+                if(error == 0 && response->body().toStringPiece() == path.substr(1) + "-done") {
+                    ++pipelined_ok;
+                }
+                latch.countDown();
+            });
+        }
+        latch.wait();
+        loop.quit();
+    });
+    loop.loop();
+    caller.join();
+
+    for(int i = 0; i < 6; ++i) {
+        ASSERT_EQ(0, rc[i]) << i;
+    }
+    ASSERT_EQ("127.0.0.1:2014", host);
+    ASSERT_EQ("a-done", responses[0].body().toStringPiece().as_string());
+    ASSERT_EQ("hello", responses[1].body().toStringPiece().as_string());
+    ASSERT_EQ(0u, responses[2].body().readableBytes());
+    ASSERT_EQ("b-done", responses[3].body().toStringPiece().as_string());
+    ASSERT_EQ(HTTP_STATUS_NOT_FOUND, responses[4].header().status_code());
+    ASSERT_EQ(1024u * 1024, responses[5].body().readableBytes());
+    ASSERT_EQ(100, pipelined_ok);
+}
+
+TEST(HttpClientTest, keep_alive_and_pipelining)
+{
+    InetAddress addr(2015, true);
+    int listen_fd = Listen(addr);
+    int accepted = 0;
+    int max_per_read = 0;
+    std::thread server([&]() {
+        int fd = ::accept(listen_fd, NULL, NULL);
+        ++accepted;
+        // Answers the requests of a read in one write.
+        for(int answered = 0; answered < 32; ) {
+            const int count = ReadRequests(fd);
+            if(count == 0) {
+                break;
+            }
+            max_per_read = std::max(max_per_read, count);
+            std::string responses;
+            for(int i = 0; i < count; ++i) {
+                responses += kOkResponse;
+            }
+            ::write(fd, responses.data(), responses.size());
+            answered += count;
+        }
+        // Nothing more is opened.
+        struct timeval tv = { 0, 200 * 1000 };
+        ::setsockopt(listen_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        int more = ::accept(listen_fd, NULL, NULL);
+        if(more >= 0) {
+            ++accepted;
+            ::close(more);
+        }
+        ::close(fd);
+    });
+
+    EventLoopThread client_thread;
+    std::atomic<int> ok(0);
+    {
+        HttpClientOptions options;
+        options.max_connections_per_host = 1;
+        options.max_pipeline_depth = 8;
+        HttpClient client(client_thread.startLoop(), "httpclient", options);
+        CountDownLatch latch(32);
+        for(int i = 0; i < 32; ++i) {
+            HttpRequest request;
+            SetRequest(&request, HTTP_METHOD_GET, "/x");
+            client.DoAsync(addr, &request, [&](int error, HttpResponse* response) {
+                if(error == 0 && response->body().toStringPiece() == "ok") {
+                    ++ok;
+                }
+                latch.countDown();
+            });
+        }
+        latch.wait();
+        server.join();
+    }
+    ::close(listen_fd);
+
+    ASSERT_EQ(32, ok);
+    ASSERT_EQ(1, accepted);
+    ASSERT_GT(max_per_read, 1);
+}
+
+TEST(HttpClientTest, retry_and_timeout)
+{
+    InetAddress addr(2016, true);
+    int listen_fd = Listen(addr);
+    std::thread server([&]() {
+        // Closed as if it were idle too long, the request is sent again.
+        int fd = ::accept(listen_fd, NULL, NULL);
+        ReadRequests(fd);
+        ::close(fd);
+        fd = ::accept(listen_fd, NULL, NULL);
+        ReadRequests(fd);
+        ::write(fd, kOkResponse.data(), kOkResponse.size());
+        // A POST isn't.
+        ReadRequests(fd);
+        ::close(fd);
+        // Never answered.
+        fd = ::accept(listen_fd, NULL, NULL);
+        ReadRequests(fd);
+        ReadRequests(fd);
+        ::close(fd);
+    });
+
+    EventLoopThread client_thread;
+    int rc[3];
+    int64_t timeout_us = 0;
+    {
+        HttpClientOptions options;
+        options.timeout = 0.3;
+        HttpClient client(client_thread.startLoop(), "httpclient", options);
+        HttpResponse response;
+        HttpRequest request;
+        SetRequest(&request, HTTP_METHOD_GET, "/a");
+        rc[0] = client.Do(addr, &request, &response);
+        SetRequest(&request, HTTP_METHOD_POST, "/b");
+        request.set_body("x");
+        rc[1] = client.Do(addr, &request, &response);
+        SetRequest(&request, HTTP_METHOD_GET, "/c");
+        Timestamp start = Timestamp::now();
+        rc[2] = client.Do(addr, &request, &response);
+        timeout_us = Timestamp::now().microSecondsSinceEpoch() - start.microSecondsSinceEpoch();
+    }
+    server.join();
+    ::close(listen_fd);
+
+    ASSERT_EQ(0, rc[0]);
+    ASSERT_EQ(ECONNRESET, rc[1]);
+    ASSERT_EQ(ETIMEDOUT, rc[2]);
+    ASSERT_GE(timeout_us, 250 * 1000);
+    ASSERT_LT(timeout_us, 1000 * 1000);
+}
@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
 #include "http/http_server.h"
+#include "http/server_sent_events.h"
 #include "tcp/TcpClient.h"
 #include "EventLoop.h"
 #include "EventLoopThread.h"
+#include "base/CountDownLatch.h"
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
 
 using namespace var;
 using namespace var::net;
@@ -186,42 +192,42 @@ TEST(HttpServerTest, serialize_http_request)
     Buffer content;
     content.append("data");
     std::string request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nHost: 127.0.0.1:1234\r\nFoo: Bar\r\nAccept: */*\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nFoo: Bar\r\nHost: 127.0.0.1:1234\r\nAccept: */*\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
 
     // user-set content-length is ignored.
     header.SetHeader("Content-Length", "100");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nHost: 127.0.0.1:1234\r\nFoo: Bar\r\nAccept: */*\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nFoo: Bar\r\nHost: 127.0.0.1:1234\r\nAccept: */*\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
 
     // user-host overwrites passed-in remote_side
     header.SetHeader("Host", "MyHost: 4321");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nHost: MyHost: 4321\r\nFoo: Bar\r\nAccept: */*\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nFoo: Bar\r\nHost: MyHost: 4321\r\nAccept: */*\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
 
     // user-set accept
     header.SetHeader("accePT"/*intended uppercase*/, "blahblah");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\naccePT: blahblah\r\nHost: MyHost: 4321\r\nFoo: Bar\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nFoo: Bar\r\nHost: MyHost: 4321\r\naccePT: blahblah\r\nUser-Agent: var/1.0 curl/7.0\r\n\r\ndata", request);
 
     // user-set UA
     header.SetHeader("user-AGENT", "myUA");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nHost: MyHost: 4321\r\nFoo: Bar\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nFoo: Bar\r\nHost: MyHost: 4321\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\n\r\ndata", request);
 
     // user-set Authorization
     header.SetHeader("authorization", "myAuthString");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nauthorization: myAuthString\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nHost: MyHost: 4321\r\nFoo: Bar\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nContent-Length: 4\r\nFoo: Bar\r\nHost: MyHost: 4321\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nauthorization: myAuthString\r\n\r\ndata", request);
 
     header.SetHeader("Transfer-Encoding", "chunked");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nauthorization: myAuthString\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nHost: MyHost: 4321\r\nFoo: Bar\r\n\r\ndata", request);
+    ASSERT_EQ("POST / HTTP/1.1\r\nFoo: Bar\r\nHost: MyHost: 4321\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nauthorization: myAuthString\r\nTransfer-Encoding: chunked\r\n\r\ndata", request);
 
     // GET does not serialize content and user-set content-length is ignored.
     header.set_method(HTTP_METHOD_GET);
     header.SetHeader("Content-Length", "100");
     request = HttpServer::MakeHttpRequestStr(&header, &content);
-    ASSERT_EQ("GET / HTTP/1.1\r\nauthorization: myAuthString\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nHost: MyHost: 4321\r\nFoo: Bar\r\n\r\n", request);
+    ASSERT_EQ("GET / HTTP/1.1\r\nFoo: Bar\r\nHost: MyHost: 4321\r\naccePT: blahblah\r\nuser-AGENT: myUA\r\nauthorization: myAuthString\r\n\r\n", request);
 }
 
 TEST(HttpServerTest, serialize_http_response) 
@@ -237,11 +243,11 @@ TEST(HttpServerTest, serialize_http_response)
     // NULL content
     header.SetHeader("Content-Length", "100");
     response = HttpServer::MakeHttpReponseStr(&header, nullptr);
-    ASSERT_EQ("HTTP/1.1 200 OK\r\nContent-Length: 100\r\nFoo: Bar\r\n\r\n", response);
+    ASSERT_EQ("HTTP/1.1 200 OK\r\nFoo: Bar\r\nContent-Length: 100\r\n\r\n", response);
 
     header.SetHeader("Transfer-Encoding", "chunked");
     response = HttpServer::MakeHttpReponseStr(&header, nullptr);
-    ASSERT_EQ("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nFoo: Bar\r\n\r\n", response);
+    ASSERT_EQ("HTTP/1.1 200 OK\r\nFoo: Bar\r\nTransfer-Encoding: chunked\r\n\r\n", response);
     header.RemoveHeader("Transfer-Encoding");
 
     // User-set content-length is ignored.
@@ -254,7 +260,7 @@ TEST(HttpServerTest, serialize_http_response)
     header.SetHeader("Content-Length", "100");
     header.SetHeader("Transfer-Encoding", "chunked");
     response = HttpServer::MakeHttpReponseStr(&header, nullptr);
-    ASSERT_EQ("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nFoo: Bar\r\n\r\n", response);
+    ASSERT_EQ("HTTP/1.1 200 OK\r\nFoo: Bar\r\nTransfer-Encoding: chunked\r\n\r\n", response);
     header.RemoveHeader("Transfer-Encoding");
 
     // User-set content-length and transfer-encoding is ignored when status code is 204 or 1xx.
@@ -285,7 +291,7 @@ TEST(HttpServerTest, serialize_http_response)
     content.retrieveAll();
     header.SetHeader("Content-Length", "100");
     response = HttpServer::MakeHttpReponseStr(&header, &content);
-    ASSERT_EQ("HTTP/1.1 200 OK\r\nContent-Length: 100\r\nFoo: Bar\r\n\r\n", response);
+    ASSERT_EQ("HTTP/1.1 200 OK\r\nFoo: Bar\r\nContent-Length: 100\r\n\r\n", response);
 }
 
 TEST(HttpServerTest, resolved_url_path)
@@ -299,4 +305,608 @@ TEST(HttpServerTest, resolved_url_path)
     ++splitter;
     HttpServer::FillUnresolvedPath(&unresolved_path, url, splitter);
     ASSERT_EQ(unresolved_path, "bthread_count");
-}
\ No newline at end of file
+}
+
+TEST(HttpServerTest, range_request)
+{
+    HttpHeader header;
+    IOBuf body;
+    body.append("0123456789", 10);
+    HttpServer::ApplyRange("bytes=2-5", &header, &body);
+    ASSERT_EQ(HTTP_STATUS_PARTIAL_CONTENT, header.status_code());
+    ASSERT_EQ("bytes 2-5/10", *header.GetHeader("Content-Range"));
+    ASSERT_EQ("2345", body.toString());
+
+    // Open-ended and suffix ranges.
+    header.set_status_code(HTTP_STATUS_OK);
+    body.clear();
+    body.append("0123456789", 10);
+    HttpServer::ApplyRange("bytes=7-", &header, &body);
+    ASSERT_EQ("bytes 7-9/10", *header.GetHeader("Content-Range"));
+    ASSERT_EQ("789", body.toString());
+
+    header.set_status_code(HTTP_STATUS_OK);
+    body.clear();
+    body.append("0123456789", 10);
+    HttpServer::ApplyRange("bytes=-3", &header, &body);
+    ASSERT_EQ("bytes 7-9/10", *header.GetHeader("Content-Range"));
+    ASSERT_EQ("789", body.toString());
+
+    // The last byte is clamped to the size.
+    header.set_status_code(HTTP_STATUS_OK);
+    body.clear();
+    body.append("0123456789", 10);
+    HttpServer::ApplyRange("bytes=8-100", &header, &body);
+    ASSERT_EQ("bytes 8-9/10", *header.GetHeader("Content-Range"));
+    ASSERT_EQ("89", body.toString());
+
+    // Unsatisfiable.
+    header.set_status_code(HTTP_STATUS_OK);
+    body.clear();
+    body.append("0123456789", 10);
+    HttpServer::ApplyRange("bytes=10-", &header, &body);
+    ASSERT_EQ(HTTP_STATUS_REQUEST_RANGE_NOT_SATISFIABLE, header.status_code());
+    ASSERT_EQ("bytes */10", *header.GetHeader("Content-Range"));
+    ASSERT_TRUE(body.empty());
+
+    // Multiple or malformed ranges are ignored, the whole body is sent.
+    const char* ignored[] = { "bytes=0-1,4-5", "bytes=5-2", "items=0-1", "bytes=a-b", "bytes=-" };
+    for (const char* range : ignored) {
+        HttpHeader whole;
+        body.clear();
+        body.append("0123456789", 10);
+        HttpServer::ApplyRange(range, &whole, &body);
+        ASSERT_EQ(HTTP_STATUS_OK, whole.status_code()) << range;
+        ASSERT_EQ(nullptr, whole.GetHeader("Content-Range")) << range;
+        ASSERT_EQ(10u, body.size()) << range;
+    }
+}
+
+TEST(HttpServerTest, serialize_file_response)
+{
+    char path[] = "/tmp/http_server_test_XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::unlink(path);
+    ASSERT_EQ(10, ::write(fd, "0123456789", 10));
+
+    HttpMessage message;
+    message.set_body_file(fd, 0, 10);
+    ASSERT_TRUE(message.has_body_file());
+    HttpHeader header;
+    IOBuf body;
+    body.swap(message.body_file());
+    HttpServer::ApplyRange("bytes=-4", &header, &body);
+    IOBuf out;
+    HttpServer::MakeHttpResponse(&header, &body, &out);
+    ASSERT_EQ("HTTP/1.1 206 Partial Content\r\nContent-Length: 4\r\n"
+              "Content-Range: bytes 6-9/10\r\n\r\n6789", out.toString());
+}
+
+TEST(HttpServerTest, serialize_shared_body)
+{
+    static const char kBody[] = "0123456789";
+    int released = 0;
+    IOBuf kept;
+    kept.appendUserData(kBody, 10, [&released]() { ++released; });
+    {
+        HttpMessage first;
+        HttpMessage second;
+        first.set_body(kept);
+        second.set_body(kept);
+        kept.clear();
+        for(HttpMessage* message : { &first, &second }) {
+            ASSERT_TRUE(message->has_body_file());
+            HttpHeader header;
+            IOBuf body(message->body_file());
+            IOBuf out;
+            HttpServer::MakeHttpResponse(&header, &body, &out);
+            ASSERT_EQ("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n0123456789",
+                      out.toString());
+        }
+        // The messages still share the bytes.
+        ASSERT_EQ(0, released);
+    }
+    ASSERT_EQ(1, released);
+}
+
+TEST(HttpServerTest, serialize_large_header)
+{
+    // Longer than what the header writer collects at once.
+    const std::string cookie(3000, 'c');
+    HttpHeader header;
+    header.set_status_code(599);
+    header.SetHeader("Set-Cookie", cookie);
+    IOBuf body;
+    body.append(std::string(2000, 'b'));
+    IOBuf out;
+    HttpServer::MakeHttpResponse(&header, &body, &out);
+    ASSERT_EQ("HTTP/1.1 599 \r\nContent-Length: 2000\r\nSet-Cookie: " + cookie +
+              "\r\n\r\n" + std::string(2000, 'b'), out.toString());
+    ASSERT_TRUE(body.empty());
+}
+
+
+namespace {
+
+class CountingReader : public ProgressiveReader {
+public:
+    CountingReader(size_t* bytes, int* ended) : _bytes(bytes), _ended(ended) {}
+    int OnReadOnePart(const char* data, size_t length) override {
+        *_bytes += length;
+        return 0;
+    }
+    void OnEndOfMessage(bool ok) override {
+        *_ended = ok ? 1 : -1;
+    }
+private:
+    size_t* _bytes;
+    int* _ended;
+};
+
+std::string ReadUntil(int fd, const std::string& end) {
+    std::string received;
+    char buf[65536];
+    while(received.size() < end.size() ||
+          received.compare(received.size() - end.size(), end.size(), end) != 0) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if(n <= 0) {
+            break;
+        }
+        received.append(buf, n);
+    }
+    return received;
+}
+
+} // namespace
+
+TEST(HttpServerTest, streaming_body)
+{
+    EventLoop loop;
+    InetAddress addr(2010, true);
+    HttpServer server(&loop, addr, "httpserver");
+    server.SetStreamingHighWaterMark(256 * 1024);
+
+    size_t read_bytes = 0;
+    int read_ended = 0;
+    server.SetHeaderCallback([&](HttpRequest* request) {
+        if(request->header().url().path() == "/upload") {
+            request->ReadProgressivelyBy(new CountingReader(&read_bytes, &read_ended));
+        }
+    });
+    const size_t kStreamBytes = 8 * 1024 * 1024;
+    const std::string block(64 * 1024, 'x');
+    std::shared_ptr<ProgressiveAttachment> streaming;
+    size_t written = 0;
+    int refused = 0;
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        const std::string& path = request->header().url().path();
+        if(path == "/upload") {
+            response->set_body(std::to_string(request->body().readableBytes()) + " " +
+                               std::to_string(read_bytes));
+        }
+        else if(path == "/stream") {
+            response->set_body("head");
+            streaming = response->CreateProgressiveAttachment();
+            std::weak_ptr<ProgressiveAttachment> weak(streaming);
+            streaming->set_writable_callback([&, weak]() {
+                std::shared_ptr<ProgressiveAttachment> attachment = weak.lock();
+                while(written < kStreamBytes) {
+                    if(attachment->Write(block.data(), block.size()) != 0) {
+                        ++refused;
+                        return;
+                    }
+                    written += block.size();
+                }
+                attachment->Close();
+            });
+        }
+        else {
+            response->set_body("after");
+        }
+    });
+    server.Start();
+
+    std::string upload_response;
+    std::string stream_response;
+    std::thread client([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        // Chunked upload, read part by part.
+        std::string upload = "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                             "5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+        ::write(fd, upload.data(), upload.size());
+        upload_response = ReadUntil(fd, "0 11");
+        // The request after the streamed response waits for it.
+        std::string requests = "GET /stream HTTP/1.1\r\n\r\nGET /after HTTP/1.1\r\n\r\n";
+        ::write(fd, requests.data(), requests.size());
+        // Fills the high water mark while nothing is read.
+        usleep(200 * 1000);
+        stream_response = ReadUntil(fd, "after");
+        ::close(fd);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+
+    ASSERT_NE(std::string::npos, upload_response.find("HTTP/1.1 200 OK"));
+    ASSERT_EQ(1, read_ended);
+    ASSERT_EQ(kStreamBytes, written);
+    ASSERT_GT(refused, 0);
+    const std::string last_chunk = "\r\n0\r\n\r\n";
+    size_t end = stream_response.find(last_chunk + "HTTP/1.1 200 OK");
+    ASSERT_NE(std::string::npos, end);
+    HttpMessage message;
+    ASSERT_GT(message.ParseFromBytes(stream_response.data(), end + last_chunk.size()), 0);
+    ASSERT_TRUE(message.Completed());
+    ASSERT_EQ("chunked", *message.header().GetHeader("Transfer-Encoding"));
+    Buffer& body = message.body();
+    ASSERT_EQ(kStreamBytes + 4, body.readableBytes());
+    ASSERT_EQ("head", std::string(body.peek(), 4));
+    ASSERT_EQ(std::string::npos, std::string(body.peek() + 4, kStreamBytes).find_first_not_of('x'));
+}
+
+TEST(HttpServerTest, worker_dispatch)
+{
+    EventLoop loop;
+    InetAddress addr(2011, true);
+    HttpServer server(&loop, addr, "httpserver");
+    server.SetThreadNum(2);
+    ThreadPool pool("http_worker");
+    pool.start(1);
+    server.SetWorkerPool(&pool, [](HttpRequest* request) {
+        const std::string& path = request->header().url().path();
+        if(path == "/slow") {
+            return HTTP_DISPATCH_IN_WORKER;
+        }
+        return path == "/busy" ? HTTP_DISPATCH_REJECT : HTTP_DISPATCH_IN_LOOP;
+    });
+    // The slow request is held until the fast one is answered.
+    CountDownLatch fast_answered(1);
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        const std::string& path = request->header().url().path();
+        if(path == "/slow") {
+            fast_answered.wait();
+        }
+        response->set_body(path.substr(1) + "-done");
+    });
+    server.Start();
+
+    std::string slow_response;
+    std::string fast_response;
+    std::string busy_response;
+    std::thread client([&]() {
+        int slow_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(slow_fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        // The pipelined request is answered after the slow one.
+        std::string requests = "GET /slow HTTP/1.1\r\n\r\nGET /next HTTP/1.1\r\n\r\n";
+        ::write(slow_fd, requests.data(), requests.size());
+        usleep(50 * 1000);
+
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        // A fast request stuck behind the slow one fails the read.
+        struct timeval timeout = { 5, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string request = "GET /fast HTTP/1.1\r\n\r\n";
+        ::write(fd, request.data(), request.size());
+        fast_response = ReadUntil(fd, "fast-done");
+        fast_answered.countDown();
+        request = "GET /busy HTTP/1.1\r\n\r\n";
+        ::write(fd, request.data(), request.size());
+        busy_response = ReadUntil(fd, "later\n");
+        ::close(fd);
+
+        slow_response = ReadUntil(slow_fd, "next-done");
+        ::close(slow_fd);
+        // Lets the io loops see the connections closed.
+        usleep(100 * 1000);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+    pool.stop();
+
+    // Answered while the slow request was still blocked in the worker.
+    ASSERT_NE(std::string::npos, fast_response.find("fast-done"));
+    ASSERT_NE(std::string::npos, busy_response.find("HTTP/1.1 503"));
+    size_t slow = slow_response.find("slow-done");
+    ASSERT_NE(std::string::npos, slow);
+    ASSERT_LT(slow, slow_response.find("next-done"));
+}
+
+TEST(HttpServerTest, worker_pool_full)
+{
+    EventLoop loop;
+    InetAddress addr(2021, true);
+    HttpServer server(&loop, addr, "httpserver");
+    ThreadPool pool("http_worker");
+    pool.setMaxQueueSize(1);
+    pool.start(1);
+    int rejected = 0;
+    server.SetWorkerPool(&pool, [](HttpRequest*) {
+        return HTTP_DISPATCH_IN_WORKER;
+    }, [&](HttpRequest* request) {
+        ASSERT_EQ("/third", request->header().url().path());
+        ++rejected;
+    });
+    CountDownLatch release(1);
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        release.wait();
+        response->set_body("done");
+    });
+    server.Start();
+
+    std::string responses[3];
+    std::thread client([&]() {
+        // One running, one queued, the third does not fit.
+        const char* paths[] = { "/first", "/second", "/third" };
+        int fds[3];
+        for(int i = 0; i < 3; ++i) {
+            fds[i] = ::socket(AF_INET, SOCK_STREAM, 0);
+            ::connect(fds[i], addr.getSockAddr(), sizeof(struct sockaddr_in));
+            std::string request = std::string("GET ") + paths[i] + " HTTP/1.1\r\n\r\n";
+            ::write(fds[i], request.data(), request.size());
+            usleep(50 * 1000);
+        }
+        responses[2] = ReadUntil(fds[2], "later\n");
+        release.countDown();
+        responses[0] = ReadUntil(fds[0], "done");
+        responses[1] = ReadUntil(fds[1], "done");
+        for(int i = 0; i < 3; ++i) {
+            ::close(fds[i]);
+        }
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+    pool.stop();
+
+    ASSERT_NE(std::string::npos, responses[2].find("HTTP/1.1 503"));
+    ASSERT_EQ(1, rejected);
+    ASSERT_NE(std::string::npos, responses[0].find("HTTP/1.1 200 OK"));
+    ASSERT_NE(std::string::npos, responses[1].find("HTTP/1.1 200 OK"));
+}
+
+TEST(HttpServerTest, pipelined_requests)
+{
+    EventLoop loop;
+    InetAddress addr(2012, true);
+    HttpServer server(&loop, addr, "httpserver");
+    int handled = 0;
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        ++handled;
+        response->set_body(request->header().url().path().substr(1) + "-done;");
+    });
+    server.Start();
+
+    std::string received;
+    std::thread client([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        // All complete requests of a read are answered, the partial one
+        // after the rest of it comes.
+        std::string requests = "GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\n\r\nGET /c HTTP/1.1\r\nHo";
+        ::write(fd, requests.data(), requests.size());
+        received = ReadUntil(fd, "b-done;");
+        requests = "st: x\r\n\r\nGET /d HTTP/1.1\r\nConnection: close\r\n\r\nGET /e HTTP/1.1\r\n\r\n";
+        ::write(fd, requests.data(), requests.size());
+        // Closed after d.
+        received += ReadUntil(fd, "\n\n\n");
+        ::close(fd);
+        usleep(100 * 1000);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+
+    ASSERT_EQ(4, handled);
+    size_t a = received.find("a-done;");
+    size_t b = received.find("b-done;");
+    size_t c = received.find("c-done;");
+    size_t d = received.find("d-done;");
+    ASSERT_NE(std::string::npos, d);
+    ASSERT_TRUE(a < b && b < c && c < d);
+    ASSERT_EQ(std::string::npos, received.find("e-done;"));
+    ASSERT_NE(std::string::npos, received.find("Connection: close"));
+}
+
+namespace {
+
+// Reads the response of a request at a time from a connection.
+class ResponseReader {
+public:
+    explicit ResponseReader(int fd) : _fd(fd) {}
+
+    // Returns false if the connection closed before a whole response.
+    bool Read(bool head, std::string* header, std::string* body) {
+        size_t header_end = std::string::npos;
+        while((header_end = _received.find("\r\n\r\n")) == std::string::npos) {
+            if(!Fill()) {
+                return false;
+            }
+        }
+        header->assign(_received, 0, header_end + 4);
+        size_t length = 0;
+        const size_t pos = header->find("Content-Length: ");
+        if(!head && pos != std::string::npos) {
+            length = atoi(header->c_str() + pos + 16);
+        }
+        while(_received.size() < header->size() + length) {
+            if(!Fill()) {
+                return false;
+            }
+        }
+        body->assign(_received, header->size(), length);
+        _received.erase(0, header->size() + length);
+        return true;
+    }
+
+private:
+    bool Fill() {
+        char buf[65536];
+        ssize_t n = ::read(_fd, buf, sizeof(buf));
+        if(n <= 0) {
+            return false;
+        }
+        _received.append(buf, n);
+        return true;
+    }
+
+    int _fd;
+    std::string _received;
+};
+
+std::string Decompress(HttpCompressType type, const std::string& data) {
+    Buffer out;
+    if(!HttpDecompress(type, data.data(), data.size(), &out)) {
+        return "<bad body>";
+    }
+    return out.retrieveAllAsString();
+}
+
+} // namespace
+
+TEST(HttpServerTest, compressed_response)
+{
+    EventLoop loop;
+    InetAddress addr(2013, true);
+    HttpServer server(&loop, addr, "httpserver");
+    ThreadPool pool("http_worker");
+    pool.start(1);
+    server.SetWorkerPool(&pool, [](HttpRequest*) {
+        return HTTP_DISPATCH_IN_LOOP;
+    });
+    server.EnableCompression();
+    std::string big;
+    while(big.size() < 256 * 1024) {
+        big.append("line " + std::to_string(big.size()) + "\n");
+    }
+    const std::string mid = big.substr(0, 4096);
+    const std::string small = big.substr(0, 100);
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        const std::string& path = request->header().url().path();
+        response->header().set_content_type(path == "/png" ? "image/png" : "text/plain");
+        if(path == "/big") {
+            response->set_body(big);
+        }
+        else if(path == "/small") {
+            response->set_body(small);
+        }
+        else {
+            response->set_body(mid);
+        }
+    });
+    server.Start();
+
+    std::vector<std::string> headers(8);
+    std::vector<std::string> bodies(8);
+    bool read_all = true;
+    std::thread client([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        // The big one is compressed in the worker, the next waits for it.
+        std::string requests =
+            "GET /mid HTTP/1.1\r\nAccept-Encoding: gzip, deflate\r\n\r\n"
+            "GET /mid HTTP/1.1\r\nAccept-Encoding: deflate\r\n\r\n"
+            "GET /mid HTTP/1.1\r\n\r\n"
+            "GET /small HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+            "GET /png HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+            "HEAD /mid HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+            "GET /big HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+            "GET /mid HTTP/1.1\r\nAccept-Encoding: identity\r\n\r\n";
+        ::write(fd, requests.data(), requests.size());
+        ResponseReader reader(fd);
+        for(size_t i = 0; i < headers.size(); ++i) {
+            read_all = read_all && reader.Read(i == 5, &headers[i], &bodies[i]);
+        }
+        ::close(fd);
+        usleep(100 * 1000);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+    pool.stop();
+
+    ASSERT_TRUE(read_all);
+    ASSERT_NE(std::string::npos, headers[0].find("Content-Encoding: gzip"));
+    ASSERT_NE(std::string::npos, headers[0].find("Vary: Accept-Encoding"));
+    ASSERT_EQ(mid, Decompress(HTTP_COMPRESS_GZIP, bodies[0]));
+    ASSERT_NE(std::string::npos, headers[1].find("Content-Encoding: deflate"));
+    ASSERT_EQ(mid, Decompress(HTTP_COMPRESS_DEFLATE, bodies[1]));
+    // Compressible, but not accepted.
+    ASSERT_EQ(std::string::npos, headers[2].find("Content-Encoding"));
+    ASSERT_NE(std::string::npos, headers[2].find("Vary: Accept-Encoding"));
+    ASSERT_EQ(mid, bodies[2]);
+    // Too small, not textual, HEAD.
+    for(int i = 3; i <= 5; ++i) {
+        ASSERT_EQ(std::string::npos, headers[i].find("Content-Encoding")) << i;
+    }
+    ASSERT_EQ(small, bodies[3]);
+    ASSERT_EQ(mid, bodies[4]);
+    ASSERT_NE(std::string::npos, headers[6].find("Content-Encoding: gzip"));
+    ASSERT_EQ(big, Decompress(HTTP_COMPRESS_GZIP, bodies[6]));
+    ASSERT_EQ(std::string::npos, headers[7].find("Content-Encoding"));
+    ASSERT_EQ(mid, bodies[7]);
+}
+
+TEST(HttpServerTest, server_sent_events)
+{
+    std::string events;
+    AppendServerSentEvent("", "hello", &events);
+    ASSERT_EQ("data: hello\n\n", events);
+    events.clear();
+    // Each line in a field, CR and CRLF end lines as LF does.
+    AppendServerSentEvent("log", "a\nb\r\nc\rd\n", &events);
+    ASSERT_EQ("event: log\ndata: a\ndata: b\ndata: c\ndata: d\n\n", events);
+    events.clear();
+    AppendServerSentEvent("log", "a\n\nb", &events);
+    ASSERT_EQ("event: log\ndata: a\ndata\ndata: b\n\n", events);
+    events.clear();
+    AppendServerSentComment("", &events);
+    ASSERT_EQ(":\n\n", events);
+
+    EventLoop loop;
+    InetAddress addr(2017, true);
+    HttpServer server(&loop, addr, "httpserver");
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        std::shared_ptr<ProgressiveAttachment> stream = StartEventStream(response);
+        std::string events;
+        AppendServerSentEvent("series", "{\"x\":1}", &events);
+        stream->Write(events.data(), events.size());
+        // Written from another thread once the headers may be out.
+        std::thread([stream]() {
+            std::string events;
+            AppendServerSentEvent("delta", "[2]", &events);
+            stream->Write(events.data(), events.size());
+            stream->Close();
+        }).detach();
+    });
+    server.Start();
+
+    std::string response;
+    std::thread client([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        std::string request = "GET /events HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n";
+        ::write(fd, request.data(), request.size());
+        response = ReadUntil(fd, "\r\n0\r\n\r\n");
+        ::close(fd);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+
+    HttpMessage message;
+    ASSERT_GT(message.ParseFromBytes(response.data(), response.size()), 0);
+    ASSERT_TRUE(message.Completed());
+    ASSERT_EQ("text/event-stream", message.header().content_type());
+    ASSERT_EQ("no-cache", *message.header().GetHeader("Cache-Control"));
+    // Never compressed, the events go out as written.
+    ASSERT_EQ(nullptr, message.header().GetHeader("Content-Encoding"));
+    Buffer& body = message.body();
+    ASSERT_EQ(":stream\n\n"
+              "event: series\ndata: {\"x\":1}\n\n"
+              "event: delta\ndata: [2]\n\n",
+              std::string(body.peek(), body.readableBytes()));
+}
@@ -0,0 +1,230 @@
+#include "IOBuf.h"
+#include "Buffer.h"
+#include "base/BlockAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using var::string;
+using var::BlockAllocator;
+using var::net::Buffer;
+using var::net::IOBuf;
+
+TEST(IOBuf, test_iobuf_append_pop)
+{
+  IOBuf buf;
+  EXPECT_TRUE(buf.empty());
+  EXPECT_EQ(buf.numBlocks(), 0);
+
+  string str;
+  for (size_t i = 0; i < IOBuf::kBlockSize * 2 + 100; ++i)
+  {
+    str.push_back(static_cast<char>('a' + i % 26));
+  }
+  buf.append(str.data(), 100);
+  buf.append(str.data() + 100, str.size() - 100);
+  EXPECT_EQ(buf.size(), str.size());
+  // Small appends fill the last block.
+  EXPECT_EQ(buf.numBlocks(), 3);
+  EXPECT_EQ(buf.toString(), str);
+
+  buf.pop_front(IOBuf::kBlockSize + 10);
+  EXPECT_EQ(buf.size(), str.size() - IOBuf::kBlockSize - 10);
+  EXPECT_EQ(buf.numBlocks(), 2);
+  EXPECT_EQ(buf.toString(), str.substr(IOBuf::kBlockSize + 10));
+
+  char part[20];
+  EXPECT_EQ(buf.copyTo(part, sizeof part, IOBuf::kBlockSize - 20), sizeof part);
+  EXPECT_EQ(string(part, sizeof part), str.substr(2 * IOBuf::kBlockSize - 10, sizeof part));
+
+  buf.clear();
+  EXPECT_TRUE(buf.empty());
+  EXPECT_EQ(buf.numBlocks(), 0);
+}
+
+TEST(IOBuf, test_iobuf_share_cut)
+{
+  IOBuf buf;
+  buf.append(string(100, 'x'));
+  IOBuf copy(buf);
+  // The block is shared, so appending doesn't write into it.
+  buf.append(string(100, 'y'));
+  EXPECT_EQ(buf.numBlocks(), 2);
+  EXPECT_EQ(copy.toString(), string(100, 'x'));
+  EXPECT_EQ(buf.toString(), string(100, 'x') + string(100, 'y'));
+
+  IOBuf head;
+  EXPECT_EQ(buf.cutn(&head, 150), 150);
+  EXPECT_EQ(head.toString(), string(100, 'x') + string(50, 'y'));
+  EXPECT_EQ(buf.toString(), string(50, 'y'));
+  // Contiguous parts of a block are merged.
+  EXPECT_EQ(buf.cutn(&head, 100), 50);
+  EXPECT_EQ(head.numBlocks(), 2);
+  EXPECT_TRUE(buf.empty());
+
+  IOBuf all;
+  all.append(head);
+  all.append(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(all.toString(), string(100, 'x') + string(100, 'y') + string(100, 'x'));
+}
+
+TEST(IOBuf, test_iobuf_user_data)
+{
+  int deleted = 0;
+  string* data = new string(4096, 'z');
+  {
+    IOBuf buf;
+    buf.appendUserData(data->data(), data->size(),
+                       [&deleted, data]() { ++deleted; delete data; });
+    IOBuf copy(buf);
+    buf.clear();
+    EXPECT_EQ(deleted, 0);
+    copy.pop_front(4000);
+    EXPECT_EQ(copy.toString(), string(96, 'z'));
+  }
+  EXPECT_EQ(deleted, 1);
+
+  IOBuf buf;
+  buf.append(string(IOBuf::kMinTakeSize, 'l'));
+  buf.append(string(IOBuf::kMinTakeSize, 'm'));
+  // Taken over, each string is a block.
+  EXPECT_EQ(buf.numBlocks(), 2);
+  EXPECT_EQ(buf.toString(), string(IOBuf::kMinTakeSize, 'l') + string(IOBuf::kMinTakeSize, 'm'));
+
+  Buffer body;
+  body.append(string(4096, 'b'));
+  body.retrieve(96);
+  buf.clear();
+  buf.append(std::move(body));
+  EXPECT_EQ(body.readableBytes(), 0);
+  EXPECT_EQ(buf.toString(), string(4000, 'b'));
+}
+
+TEST(IOBuf, test_iobuf_pool)
+{
+  const string data(IOBuf::kBlockSize * 4, 'p');
+  {
+    IOBuf buf;
+    buf.append(data);
+  }
+  size_t cached = BlockAllocator::cachedBlocks();
+  EXPECT_GE(cached, 4);
+  // The block header takes some of kBlockSize.
+  IOBuf buf;
+  buf.append(data.data(), IOBuf::kBlockSize);
+  EXPECT_EQ(buf.numBlocks(), 2);
+  EXPECT_EQ(BlockAllocator::cachedBlocks(), cached - 2);
+}
+
+TEST(IOBuf, test_iobuf_cut_into_fd)
+{
+  int fds[2];
+  ASSERT_EQ(::pipe2(fds, O_NONBLOCK), 0);
+  IOBuf buf;
+  string expected;
+  for (int i = 0; i < 100; ++i)
+  {
+    // Many small blocks, more than one writev(2) takes.
+    string block(1000, static_cast<char>('0' + i % 10));
+    buf.append(string(block));
+    IOBuf shared;
+    shared.append(block);
+    buf.append(shared);
+    expected += block + block;
+  }
+  EXPECT_GE(buf.numBlocks(), 100);
+  ssize_t n = buf.cutIntoFd(fds[1]);
+  ASSERT_GT(n, 0);
+  EXPECT_EQ(static_cast<size_t>(n) + buf.size(), expected.size());
+
+  string received;
+  char tmp[65536];
+  while (received.size() < expected.size())
+  {
+    ssize_t nr = ::read(fds[0], tmp, sizeof tmp);
+    if (nr > 0)
+    {
+      received.append(tmp, nr);
+    }
+    if (!buf.empty())
+    {
+      ASSERT_GE(buf.cutIntoFd(fds[1]), 0);
+    }
+  }
+  EXPECT_TRUE(buf.empty());
+  EXPECT_EQ(received, expected);
+
+  // Nothing fits in a full pipe.
+  buf.append(string(1 << 20, 'f'));
+  ASSERT_GT(buf.cutIntoFd(fds[1]), 0);
+  EXPECT_EQ(buf.cutIntoFd(fds[1]), -1);
+  EXPECT_EQ(errno, EAGAIN);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(IOBuf, test_iobuf_file)
+{
+  char path[] = "/tmp/iobuf_test_XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ::unlink(path);
+  string content;
+  for (int i = 0; i < (1 << 20); ++i)
+  {
+    content.push_back(static_cast<char>('a' + i % 26));
+  }
+  ASSERT_EQ(::write(fd, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+
+  int released = 0;
+  string expected = "head" + content.substr(100, 500000) + "tail";
+  {
+    IOBuf buf;
+    buf.append("head", 4);
+    buf.appendFile(fd, 100, 500000, [&released]() { ++released; });
+    buf.append("tail", 4);
+    EXPECT_EQ(buf.size(), expected.size());
+    EXPECT_EQ(buf.toString(), expected);
+
+    IOBuf part;
+    buf.cutn(&part, 10);
+    EXPECT_EQ(part.toString(), expected.substr(0, 10));
+    part.clear();
+    EXPECT_EQ(released, 0);
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+    string received = expected.substr(0, 10);
+    char tmp[65536];
+    while (received.size() < expected.size())
+    {
+      if (!buf.empty())
+      {
+        ssize_t n = buf.cutIntoFd(fds[1]);
+        ASSERT_TRUE(n > 0 || errno == EAGAIN);
+      }
+      ssize_t nr = ::read(fds[0], tmp, sizeof tmp);
+      if (nr > 0)
+      {
+        received.append(tmp, nr);
+      }
+    }
+    EXPECT_TRUE(buf.empty());
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(released, 1);
+
+    // A file shorter than what was queued.
+    buf.appendFile(fd, content.size() - 10, 20, std::function<void()>());
+    EXPECT_EQ(buf.cutIntoFd(fds[1]), 10);
+    EXPECT_EQ(buf.cutIntoFd(fds[1]), -1);
+    EXPECT_EQ(errno, EIO);
+    ::close(fds[0]);
+    ::close(fds[1]);
+  }
+  ::close(fd);
+}
@@ -1,9 +1,22 @@
+#include "base/CountDownLatch.h"
 #include "base/Logging.h"
+#include "base/Mutex.h"
 #include "EventLoop.h"
 #include "EventLoopThread.h"
+#include "EventLoopThreadPool.h"
+#include "tcp/ConnectionSlots.h"
 #include "tcp/TcpServer.h"
+#include "poller/UringPoller.h"
 
 #include <gtest/gtest.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
 
 using namespace var;
 using namespace var::net;
@@ -48,4 +61,444 @@ TEST(TcpServer, echo_test)
     TestEchoServer server(&loop, listenAddr);
     server.start();
     loop.loop();
-}
\ No newline at end of file
+}
+// Echoes 4 MiB through the server, more than the provided buffers of
+// UringPoller hold, then closes the connection.
+void expectEcho(EventLoop* loop, TcpServer* server, const InetAddress& listenAddr)
+{
+  int closed = 0;
+  server->setConnectionCallback([&](const TcpConnectionPtr& conn)
+  {
+    if (conn->disconnected())
+    {
+      ++closed;
+    }
+  });
+  server->setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+  {
+    conn->send(buf);
+  });
+  server->start();
+
+  const size_t kTotal = 4 * 1024 * 1024;
+  string message;
+  for (size_t i = 0; i < kTotal; ++i)
+  {
+    message.push_back(static_cast<char>(i % 251));
+  }
+  string echoed;
+  ssize_t last = -1;
+  std::thread client([&]()
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ::connect(fd, listenAddr.getSockAddr(), sizeof(struct sockaddr_in));
+    std::thread writer([&]()
+    {
+      size_t sent = 0;
+      ssize_t n = 0;
+      while (sent < kTotal && (n = ::write(fd, message.data() + sent, kTotal - sent)) > 0)
+      {
+        sent += n;
+      }
+    });
+    char buf[65536];
+    while (echoed.size() < kTotal && (last = ::read(fd, buf, sizeof buf)) > 0)
+    {
+      echoed.append(buf, last);
+    }
+    writer.join();
+    // The server sees the EOF and closes.
+    ::shutdown(fd, SHUT_WR);
+    last = ::read(fd, buf, sizeof buf);
+    ::close(fd);
+    loop->quit();
+  });
+  loop->loop();
+  client.join();
+  EXPECT_TRUE(echoed == message);
+  EXPECT_EQ(0, last);
+  EXPECT_EQ(1, closed);
+}
+
+TEST(TcpServer, receive_in_poller)
+{
+  // Falls back to epoll without io_uring, the test still passes.
+  ::setenv("VAR_USE_IO_URING", "1", 1);
+  EventLoop loop;
+  ::unsetenv("VAR_USE_IO_URING");
+  InetAddress listenAddr(2008, true);
+  TcpServer server(&loop, listenAddr, "ReceiveInPoller");
+  server.setReceiveInPoller(true);
+  expectEcho(&loop, &server, listenAddr);
+}
+
+// The peer resets the connection while the server is in the message
+// callback with more data queued, so the next read fails, and the server
+// closes the connection. With `closeOnRead' that read closes it at once,
+// before the functors queued by the callback run.
+void expectReset(EventLoop* loop, TcpServer* server, const InetAddress& listenAddr,
+                 bool closeOnRead = false)
+{
+  int closed = 0;
+  int closedAfterCallback = -1;
+  size_t received = 0;
+  server->setConnectionCallback([&](const TcpConnectionPtr& conn)
+  {
+    if (conn->disconnected())
+    {
+      ++closed;
+      loop->quit();
+    }
+  });
+  server->setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+  {
+    if (received == 0)
+    {
+      usleep(200 * 1000);
+      loop->queueInLoop([&]() { closedAfterCallback = closed; });
+    }
+    received += buf->readableBytes();
+    buf->retrieveAll();
+  });
+  server->start();
+  // Fails the test rather than hanging it.
+  loop->runAfter(5.0, [loop]() { loop->quit(); });
+
+  std::thread client([&]()
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ::connect(fd, listenAddr.getSockAddr(), sizeof(struct sockaddr_in));
+    ::write(fd, "hello", 5);
+    usleep(50 * 1000);
+    ::write(fd, "world", 5);
+    struct linger lingering = { 1, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &lingering, sizeof lingering);
+    ::close(fd);
+  });
+  loop->loop();
+  client.join();
+  // The reset may drop the second write.
+  EXPECT_GE(received, 5u);
+  EXPECT_EQ(1, closed);
+  if (closeOnRead)
+  {
+    EXPECT_EQ(1, closedAfterCallback);
+  }
+}
+
+TEST(TcpServer, receive_in_poller_reset)
+{
+  ::setenv("VAR_USE_IO_URING", "1", 1);
+  EventLoop loop;
+  ::unsetenv("VAR_USE_IO_URING");
+  if (!UringPoller(&loop).supported())
+  {
+    GTEST_SKIP() << "io_uring is not supported";
+  }
+  InetAddress listenAddr(2018, true);
+  TcpServer server(&loop, listenAddr, "ReceiveInPollerReset");
+  server.setReceiveInPoller(true);
+  expectReset(&loop, &server, listenAddr);
+}
+
+TEST(TcpServer, edge_triggered)
+{
+  EventLoop loop;
+  InetAddress listenAddr(2009, true);
+  TcpServer server(&loop, listenAddr, "EdgeTriggered");
+  server.setEdgeTriggered(true);
+  expectEcho(&loop, &server, listenAddr);
+}
+
+TEST(TcpServer, edge_triggered_reset)
+{
+  EventLoop loop;
+  InetAddress listenAddr(2019, true);
+  TcpServer server(&loop, listenAddr, "EdgeTriggeredReset");
+  server.setEdgeTriggered(true);
+  // No further edge is needed to find the reset.
+  expectReset(&loop, &server, listenAddr, true);
+}
+
+TEST(TcpServer, edge_triggered_read_budget)
+{
+  EventLoop loop;
+  InetAddress listenAddr(2020, true);
+  TcpServer server(&loop, listenAddr, "EdgeTriggeredReadBudget");
+  server.setEdgeTriggered(true);
+  const size_t kTotal = 4 * 1024 * 1024;
+  size_t received = 0;
+  int messages = 0;
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+  {
+    received += buf->readableBytes();
+    buf->retrieveAll();
+    ++messages;
+    // A slow reader, the socket is full at each read and one edge
+    // brings more than the budget of reads.
+    usleep(1000);
+    if (received == kTotal)
+    {
+      loop.quit();
+    }
+  });
+  server.start();
+  // Fails the test rather than hanging it.
+  loop.runAfter(10.0, [&loop]() { loop.quit(); });
+
+  const string message(kTotal, 'x');
+  std::thread client([&]()
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ::connect(fd, listenAddr.getSockAddr(), sizeof(struct sockaddr_in));
+    size_t sent = 0;
+    ssize_t n = 0;
+    while (sent < kTotal && (n = ::write(fd, message.data() + sent, kTotal - sent)) > 0)
+    {
+      sent += n;
+    }
+    // Nothing more is sent, what is left after the budget comes with
+    // no further edge.
+    usleep(200 * 1000);
+    ::close(fd);
+  });
+  loop.loop();
+  client.join();
+  EXPECT_EQ(kTotal, received);
+  EXPECT_GT(messages, 16);
+}
+
+TEST(TcpServer, edge_triggered_write_error)
+{
+  EventLoop loop;
+  InetAddress listenAddr(2023, true);
+  TcpServer server(&loop, listenAddr, "EdgeTriggeredWriteError");
+  server.setEdgeTriggered(true);
+  int closed = 0;
+  int messagesAfterClose = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn)
+  {
+    if (conn->disconnected())
+    {
+      ++closed;
+      loop.runAfter(0.2, [&loop]() { loop.quit(); });
+    }
+  });
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+  {
+    buf->retrieveAll();
+    if (!conn->connected())
+    {
+      ++messagesAfterClose;
+      return;
+    }
+    if (closed > 0)
+    {
+      return;
+    }
+    // The rest of the burst is in the socket by now.
+    usleep(50 * 1000);
+    // More than the peer takes, then the file is cut short, so the
+    // write in the read loop fails with EIO and closes the connection.
+    char path[] = "/tmp/tcpserver_test_XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::unlink(path);
+    const size_t kFileSize = 16 * 1024 * 1024;
+    ASSERT_EQ(0, ::ftruncate(fd, kFileSize));
+    IOBuf file;
+    file.appendFile(fd, 0, kFileSize, [fd]() { ::close(fd); });
+    conn->send(std::move(file));
+    ASSERT_EQ(0, ::ftruncate(fd, 0));
+  });
+  server.start();
+  // Fails the test rather than hanging it.
+  loop.runAfter(5.0, [&loop]() { loop.quit(); });
+
+  std::thread client([&]()
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ::connect(fd, listenAddr.getSockAddr(), sizeof(struct sockaddr_in));
+    // Takes several reads, nothing of the file is read.
+    const string burst(512 * 1024, 'x');
+    ::write(fd, burst.data(), burst.size());
+    usleep(100 * 1000);
+    struct linger lingering = { 1, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &lingering, sizeof lingering);
+    ::close(fd);
+  });
+  loop.loop();
+  client.join();
+  EXPECT_EQ(1, closed);
+  EXPECT_EQ(0, messagesAfterClose);
+}
+
+namespace
+{
+
+struct FakeConnection
+{
+  explicit FakeConnection(uint64_t id) : id_(id) {}
+  uint64_t id() const { return id_; }
+  uint64_t id_;
+};
+
+typedef std::shared_ptr<FakeConnection> FakeConnectionPtr;
+
+FakeConnectionPtr putNew(ConnectionSlots<FakeConnectionPtr>* slots)
+{
+  FakeConnectionPtr conn(new FakeConnection(slots->allocate()));
+  slots->put(conn);
+  return conn;
+}
+
+}  // namespace
+
+TEST(TcpServer, connection_slots)
+{
+  ConnectionSlots<FakeConnectionPtr> slots;
+  FakeConnectionPtr a = putNew(&slots);
+  FakeConnectionPtr b = putNew(&slots);
+  EXPECT_EQ(0u, static_cast<uint32_t>(a->id()));
+  EXPECT_EQ(1u, static_cast<uint32_t>(b->id()));
+  EXPECT_EQ(2u, slots.size());
+  EXPECT_EQ(a, slots.find(a->id()));
+
+  EXPECT_TRUE(slots.release(a));
+  EXPECT_FALSE(slots.release(a));
+  EXPECT_FALSE(slots.find(a->id()));
+
+  // The slot of a is reused under a new sequence.
+  FakeConnectionPtr c = putNew(&slots);
+  EXPECT_EQ(0u, static_cast<uint32_t>(c->id()));
+  EXPECT_NE(a->id(), c->id());
+  EXPECT_EQ(c, slots.find(c->id()));
+  // A stale id or connection doesn't reach the new one.
+  EXPECT_FALSE(slots.find(a->id()));
+  EXPECT_FALSE(slots.release(a));
+  EXPECT_EQ(c, slots.find(c->id()));
+  EXPECT_FALSE(slots.find(uint64_t(7) << 32 | 5));
+
+  std::vector<FakeConnectionPtr> conns;
+  slots.releaseAll(&conns);
+  EXPECT_EQ(2u, conns.size());
+  EXPECT_EQ(0u, slots.size());
+  EXPECT_FALSE(slots.find(b->id()));
+}
+
+// Connects kConnections clients before the loop runs, returns the
+// number of loop iterations the server took to accept them.
+int64_t acceptBacklog(uint16_t port, int maxAcceptsPerRead)
+{
+  const int kConnections = 50;
+  EventLoop loop;
+  InetAddress listenAddr(port, true);
+  TcpServer server(&loop, listenAddr, "AcceptBacklog");
+  server.setMaxAcceptsPerRead(maxAcceptsPerRead);
+  std::set<int64_t> iterations;
+  int connected = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn)
+  {
+    if (conn->connected())
+    {
+      iterations.insert(loop.iteration());
+      if (++connected == kConnections)
+      {
+        loop.quit();
+      }
+    }
+  });
+  // Listens at once in the loop thread.
+  server.start();
+  std::vector<int> fds;
+  for (int i = 0; i < kConnections; ++i)
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    // Completed by the kernel, waits in the backlog.
+    EXPECT_EQ(0, ::connect(fd, listenAddr.getSockAddr(), sizeof(struct sockaddr_in)));
+    fds.push_back(fd);
+  }
+  // Fails the test rather than hanging it.
+  loop.runAfter(5.0, [&loop]() { loop.quit(); });
+  loop.loop();
+  for (int fd : fds)
+  {
+    ::close(fd);
+  }
+  EXPECT_EQ(kConnections, connected);
+  return static_cast<int64_t>(iterations.size());
+}
+
+TEST(TcpServer, batched_accept)
+{
+  // The whole backlog in one wakeup.
+  EXPECT_EQ(1, acceptBacklog(2030, 64));
+  // At most 8 a wakeup.
+  EXPECT_LE(7, acceptBacklog(2031, 8));
+}
+
+TEST(TcpServer, reuse_port_per_loop)
+{
+  const int kThreads = 3;
+  // Enough for the kernel to hand each acceptor some.
+  const int kConnections = 60;
+  EventLoop loop;
+  InetAddress listenAddr(2032, true);
+  std::unique_ptr<TcpServer> server(
+      new TcpServer(&loop, listenAddr, "ReusePortPerLoop", TcpServer::kReusePortPerLoop));
+  server->setThreadNum(kThreads);
+  MutexLock mutex;
+  std::set<EventLoop*> loops;
+  std::atomic<int> connected(0);
+  std::atomic<int> disconnected(0);
+  server->setConnectionCallback([&](const TcpConnectionPtr& conn)
+  {
+    if (conn->connected())
+    {
+      conn->getLoop()->assertInLoopThread();
+      MutexLockGuard lock(mutex);
+      loops.insert(conn->getLoop());
+      ++connected;
+    }
+    else
+    {
+      ++disconnected;
+    }
+  });
+  server->start();
+  // The acceptors listen in their loops, after this they all do.
+  std::vector<EventLoop*> ioLoops = server->threadPool()->getAllLoops();
+  ASSERT_EQ(kThreads, static_cast<int>(ioLoops.size()));
+  CountDownLatch listening(kThreads);
+  for (EventLoop* ioLoop : ioLoops)
+  {
+    ioLoop->runInLoop([&listening]() { listening.countDown(); });
+  }
+  listening.wait();
+
+  std::vector<int> fds;
+  for (int i = 0; i < kConnections; ++i)
+  {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(0, ::connect(fd, listenAddr.getSockAddr(), sizeof(struct sockaddr_in)));
+    fds.push_back(fd);
+  }
+  for (int i = 0; i < 500 && connected < kConnections; ++i)
+  {
+    usleep(10 * 1000);
+  }
+  EXPECT_EQ(kConnections, connected.load());
+  {
+    MutexLockGuard lock(mutex);
+    EXPECT_EQ(kThreads, static_cast<int>(loops.size()));
+    EXPECT_EQ(0u, loops.count(&loop));
+  }
+
+  // Returns once every loop has destroyed its acceptor and connections.
+  server.reset();
+  EXPECT_EQ(kConnections, disconnected.load());
+  for (int fd : fds)
+  {
+    ::close(fd);
+  }
+}
@@ -0,0 +1,52 @@
+#include "base/ThreadPool.h"
+#include "base/CountDownLatch.h"
+#include "base/CurrentThread.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <unistd.h>
+
+using namespace var;
+
+TEST(ThreadPool, run_and_drain)
+{
+  ThreadPool pool("test_pool");
+  pool.start(4);
+  std::atomic<int> count(0);
+  for (int i = 0; i < 1000; ++i)
+  {
+    pool.run([&count]() { ++count; });
+  }
+  // Tasks left in the queue still run.
+  pool.stop();
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(ThreadPool, no_threads)
+{
+  ThreadPool pool;
+  pool.start(0);
+  int tid = 0;
+  EXPECT_TRUE(pool.tryRun([&tid]() { tid = CurrentThread::tid(); }));
+  EXPECT_EQ(tid, CurrentThread::tid());
+}
+
+TEST(ThreadPool, try_run_when_full)
+{
+  ThreadPool pool("test_pool");
+  pool.setMaxQueueSize(2);
+  pool.start(1);
+  CountDownLatch started(1);
+  CountDownLatch blocked(1);
+  EXPECT_TRUE(pool.tryRun([&]() { started.countDown(); blocked.wait(); }));
+  started.wait();
+  std::atomic<int> count(0);
+  EXPECT_TRUE(pool.tryRun([&count]() { ++count; }));
+  EXPECT_TRUE(pool.tryRun([&count]() { ++count; }));
+  EXPECT_FALSE(pool.tryRun([&count]() { ++count; }));
+  EXPECT_EQ(pool.queueSize(), 2);
+  blocked.countDown();
+  pool.stop();
+  EXPECT_EQ(count, 2);
+  EXPECT_FALSE(pool.tryRun([&count]() { ++count; }));
+}
@@ -1,11 +1,15 @@
 #include "EventLoop.h"
 #include "EventLoopThread.h"
+#include "Timer.h"
+#include "TimingWheel.h"
 #include "base/Thread.h"
 
 #include <gtest/gtest.h>
 #include <stdio.h>
 #include <unistd.h>
 
+#include <random>
+
 using namespace var;
 using namespace var::net;
 
@@ -65,3 +69,77 @@ TEST(TimerQueue, run_in_loop)
     print("thread loop exits");
   }
 }
+
+TEST(TimerQueue, timing_wheel)
+{
+  EventLoop loop;
+  Timestamp start(Timestamp::now());
+  std::vector<int> fired;
+  auto fire = [&](int delayMs)
+  {
+    // Never early.
+    EXPECT_GE(timeDifference(Timestamp::now(), start) * 1000, delayMs);
+    fired.push_back(delayMs);
+  };
+  // Moved into the wheel.
+  loop.runAfter(0.03, std::bind(fire, 30));
+  loop.setTimerBackend(EventLoop::kTimingWheel);
+  loop.runAfter(0.01, std::bind(fire, 10));
+  // Beyond level 0 of the wheel.
+  loop.runAfter(0.3, std::bind(fire, 300));
+  TimerId canceled = loop.runAfter(0.02, std::bind(fire, 20));
+  loop.cancel(canceled);
+  int repeats = 0;
+  TimerId every;
+  every = loop.runEvery(0.05, [&]()
+  {
+    if (++repeats == 3)
+    {
+      loop.cancel(every);
+    }
+  });
+  loop.runAfter(0.4, [&]() { loop.quit(); });
+  loop.loop();
+
+  EXPECT_EQ((std::vector<int>{ 10, 30, 300 }), fired);
+  EXPECT_EQ(3, repeats);
+}
+
+TEST(TimerQueue, timing_wheel_cascade)
+{
+  // Up to 2 days, beyond the range of the wheel.
+  const int64_t kMaxDelayUs = 2 * 86400 * 1000000L;
+  std::mt19937_64 rng(1);
+  Timestamp now(Timestamp::now());
+  TimingWheel wheel(now);
+  std::vector<std::unique_ptr<Timer>> timers;
+  for (int i = 0; i < 2000; ++i)
+  {
+    Timestamp when(now.microSecondsSinceEpoch() + static_cast<int64_t>(rng() % kMaxDelayUs));
+    timers.emplace_back(new Timer(TimerCallback(), when, 0.0));
+    wheel.insert(timers.back().get());
+  }
+  ASSERT_TRUE(wheel.remove(timers[0].get(), timers[0]->sequence()));
+  ASSERT_FALSE(wheel.remove(timers[0].get(), timers[0]->sequence()));
+
+  size_t expired = 0;
+  while (wheel.size() > 0)
+  {
+    Timestamp last = now;
+    now = Timestamp(now.microSecondsSinceEpoch() + static_cast<int64_t>(rng() % 600000000));
+    std::vector<TimingWheel::Entry> entries;
+    wheel.getExpired(now, &entries);
+    for (const TimingWheel::Entry& entry : entries)
+    {
+      // Runs at the first look after its tick.
+      ASSERT_LE(TimingWheel::tickOf(entry.first).microSecondsSinceEpoch(),
+                now.microSecondsSinceEpoch());
+      ASSERT_GT(TimingWheel::tickOf(entry.first).microSecondsSinceEpoch(),
+                last.microSecondsSinceEpoch());
+    }
+    expired += entries.size();
+    ASSERT_LE(now.microSecondsSinceEpoch(),
+              Timestamp::now().microSecondsSinceEpoch() + 3 * kMaxDelayUs);
+  }
+  ASSERT_EQ(timers.size() - 1, expired);
+}
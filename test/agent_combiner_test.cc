@@ -16,8 +16,13 @@
 // under the License.
 
 #include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sstream>
 #include <thread>
 #include "metric/detail/combiner.h"
+#include "net/base/ContentionProfiler.h"
+#include "net/base/CountDownLatch.h"
 
 using namespace var;
 using namespace var::detail;
@@ -103,4 +108,57 @@ TEST(AgentCombinerTest, combine_and_merge)
     EXPECT_EQ(combiner.combine_agents(), 2 * loop);
     EXPECT_EQ(combiner.reset_all_agents(), 2  * loop);
     EXPECT_EQ(combiner.combine_agents(), 0);
-}
\ No newline at end of file
+}
+namespace {
+
+struct Samples {
+    int64_t count;
+};
+
+struct AddSamples {
+    void operator()(Samples& lhs, const Samples& rhs) const {
+        lhs.count += rhs.count;
+    }
+};
+
+typedef AgentCombiner<Samples, Samples, AddSamples> SamplesCombiner;
+
+// Holds the lock of the combiner for 100ms.
+struct HoldCombiner {
+    void operator()(GlobalValue<SamplesCombiner>& global_value, Samples&) const {
+        global_value.lock();
+        held->countDown();
+        usleep(100 * 1000);
+        global_value.unlock();
+    }
+    CountDownLatch* held;
+};
+
+} // namespace
+
+TEST(AgentCombinerTest, contention_profiled)
+{
+    SamplesCombiner combiner;
+    ASSERT_TRUE(ContentionProfiler::start());
+    CountDownLatch held(1);
+    std::thread holder([&](){
+        combiner.get_or_create_tls_agent()->merge_global(HoldCombiner{&held});
+    });
+    held.wait();
+    combiner.combine_agents();
+    holder.join();
+    ContentionProfiler::stop();
+
+    std::string profile;
+    ContentionProfiler::dump(&profile);
+    std::istringstream lines(profile);
+    std::string line;
+    int64_t max_wait_ns = 0;
+    while(std::getline(lines, line)) {
+        if(line.find(" @ ") != std::string::npos) {
+            max_wait_ns = std::max<int64_t>(max_wait_ns, atoll(line.c_str()));
+        }
+    }
+    // combine_agents() waited for the holder.
+    ASSERT_GE(max_wait_ns, 50 * 1000 * 1000);
+}
@@ -0,0 +1,46 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 16:20:05 CST 2026.
+
+#include <gtest/gtest.h>
+#include "metric/allocator_status.h"
+#include "net/Buffer.h"
+
+namespace {
+
+TEST(AllocatorStatusTest, expose)
+{
+    var::EnableAllocatorMetrics("allocator_status_test");
+    const int64_t live = std::stoll(
+        var::Variable::describe_exposed("allocator_status_test_live_blocks"));
+    {
+        var::net::Buffer buf;
+        buf.append(std::string(100000, 'x'));
+        ASSERT_EQ(std::to_string(live + 1),
+                  var::Variable::describe_exposed("allocator_status_test_live_blocks"));
+    }
+    ASSERT_EQ(std::to_string(live),
+              var::Variable::describe_exposed("allocator_status_test_live_blocks"));
+    // The initial storage of the Buffer is cached, not freed.
+    ASSERT_LE(1, std::stoll(
+        var::Variable::describe_exposed("allocator_status_test_free_blocks")));
+    ASSERT_LE(1024, std::stoll(
+        var::Variable::describe_exposed("allocator_status_test_free_bytes")));
+}
+
+}  // namespace
@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+#include "metric/variable.h"
+#include "net/base/Thread.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+
+using namespace var;
+
+namespace {
+
+bool Exposed(const std::string& name) {
+    return !Variable::describe_exposed(name).empty();
+}
+
+// Polls for up to 5 seconds, the threads are sampled once a second.
+template <typename Pred>
+bool WaitFor(Pred pred) {
+    for(int i = 0; i < 500; ++i) {
+        if(pred()) {
+            return true;
+        }
+        usleep(10 * 1000);
+    }
+    return false;
+}
+
+double CpuUsage(const std::string& label) {
+    return atof(Variable::describe_exposed("thread_" + label + "_cpu_usage").c_str());
+}
+
+} // namespace
+
+TEST(DefaultVariablesTest, thread_stats)
+{
+    std::atomic<bool> stop(false);
+    auto spin = [&stop]() {
+        while(!stop.load(std::memory_order_relaxed)) {
+        }
+    };
+    Thread first(spin, "stat_spinner");
+    first.start();
+    ASSERT_TRUE(WaitFor([]() { return Exposed("thread_stat_spinner_cpu_usage"); }));
+
+    // Named like an exposed thread, the second is suffixed with its tid
+    // while the first keeps its variables.
+    Thread second(spin, "stat_spinner");
+    second.start();
+    const std::string second_label = "stat_spinner_" + std::to_string(second.tid());
+    ASSERT_TRUE(WaitFor([&]() { return Exposed("thread_" + second_label + "_cpu_usage"); }));
+    ASSERT_TRUE(Exposed("thread_stat_spinner_cpu_usage"));
+    ASSERT_FALSE(Exposed("thread_stat_spinner_" + std::to_string(first.tid()) + "_cpu_usage"));
+
+    ASSERT_TRUE(WaitFor([&]() {
+        return CpuUsage("stat_spinner") > 0 && CpuUsage(second_label) > 0;
+    }));
+    ASSERT_TRUE(Exposed("thread_stat_spinner_context_switches_voluntary_second"));
+    ASSERT_TRUE(Exposed("thread_stat_spinner_last_cpu"));
+
+    stop = true;
+    first.join();
+    second.join();
+    // Exited threads are hidden.
+    ASSERT_TRUE(WaitFor([&]() {
+        return !Exposed("thread_stat_spinner_cpu_usage") &&
+               !Exposed("thread_" + second_label + "_cpu_usage");
+    }));
+}
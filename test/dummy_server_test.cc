@@ -32,7 +32,10 @@ void memory_growth_leak_check(int size) {
 
 TEST(DummyServerTest, StartDummyServer) {
     net::InetAddress addr(8511);
-    StartDummyServerAt(addr.port());
+    ServerOptions options;
+    options.num_threads = 2;
+    options.num_workers = 2;
+    StartDummyServerAt(addr.port(), options);
 
     var::Maxer<int> maxer("FpgaMax");
     var::Miner<int> miner("FpgaMin");
@@ -0,0 +1,137 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+#include "net/http/http_compress.h"
+#include "net/http/http_server.h"
+#include "net/EventLoop.h"
+#include "metric/builtin/get_js_service.h"
+#include "metric/builtin/jquery_min_js.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+
+using namespace var;
+using namespace var::net;
+
+TEST(HttpCompressTest, negotiate)
+{
+    ASSERT_EQ(HTTP_COMPRESS_NONE, NegotiateHttpCompressType(NULL));
+    std::string accept;
+    ASSERT_EQ(HTTP_COMPRESS_NONE, NegotiateHttpCompressType(&accept));
+    accept = "gzip, deflate, br";
+    ASSERT_EQ(HTTP_COMPRESS_GZIP, NegotiateHttpCompressType(&accept));
+    accept = "deflate";
+    ASSERT_EQ(HTTP_COMPRESS_DEFLATE, NegotiateHttpCompressType(&accept));
+    accept = "GZIP;q=0.5";
+    ASSERT_EQ(HTTP_COMPRESS_GZIP, NegotiateHttpCompressType(&accept));
+    accept = "gzip;q=0, deflate";
+    ASSERT_EQ(HTTP_COMPRESS_DEFLATE, NegotiateHttpCompressType(&accept));
+    accept = "*";
+    ASSERT_EQ(HTTP_COMPRESS_GZIP, NegotiateHttpCompressType(&accept));
+    accept = "gzip;q=0, *;q=1";
+    ASSERT_EQ(HTTP_COMPRESS_DEFLATE, NegotiateHttpCompressType(&accept));
+    accept = "identity, br";
+    ASSERT_EQ(HTTP_COMPRESS_NONE, NegotiateHttpCompressType(&accept));
+}
+
+TEST(HttpCompressTest, compressible_content_type)
+{
+    ASSERT_TRUE(IsCompressibleContentType("text/html"));
+    ASSERT_TRUE(IsCompressibleContentType("text/plain; charset=utf-8"));
+    ASSERT_TRUE(IsCompressibleContentType("application/javascript"));
+    ASSERT_TRUE(IsCompressibleContentType("application/json;charset=utf-8"));
+    ASSERT_TRUE(IsCompressibleContentType("image/svg+xml"));
+    ASSERT_FALSE(IsCompressibleContentType("image/png"));
+    ASSERT_FALSE(IsCompressibleContentType("application/octet-stream"));
+    ASSERT_FALSE(IsCompressibleContentType("application/jsonp"));
+    ASSERT_FALSE(IsCompressibleContentType(""));
+}
+
+TEST(HttpCompressTest, round_trip)
+{
+    std::string data;
+    for(int i = 0; i < 10000; ++i) {
+        data.append("var_count : ");
+        data.append(std::to_string(i));
+        data.push_back('\n');
+    }
+    const HttpCompressType types[] = { HTTP_COMPRESS_GZIP, HTTP_COMPRESS_DEFLATE };
+    for(HttpCompressType type : types) {
+        Buffer compressed;
+        compressed.append("x", 1);
+        ASSERT_TRUE(HttpCompress(type, data.data(), data.size(), 6, &compressed));
+        // Appended after what was there.
+        ASSERT_EQ('x', *compressed.peek());
+        compressed.retrieve(1);
+        ASSERT_LT(compressed.readableBytes(), data.size() / 4);
+        Buffer plain;
+        ASSERT_TRUE(HttpDecompress(type, compressed.peek(),
+                                   compressed.readableBytes(), &plain));
+        ASSERT_EQ(data, plain.retrieveAllAsString());
+    }
+    Buffer gzip;
+    ASSERT_TRUE(HttpCompress(HTTP_COMPRESS_GZIP, "", 0, 6, &gzip));
+    ASSERT_EQ(0x1f, (unsigned char)gzip.peek()[0]);
+    ASSERT_EQ(0x8b, (unsigned char)gzip.peek()[1]);
+    Buffer out;
+    ASSERT_FALSE(HttpDecompress(HTTP_COMPRESS_DEFLATE, gzip.peek(),
+                                gzip.readableBytes(), &out));
+    ASSERT_FALSE(HttpCompress(HTTP_COMPRESS_NONE, "a", 1, 6, &out));
+}
+
+TEST(HttpCompressTest, strong_etag_not_recoded)
+{
+    EventLoop loop;
+    InetAddress addr(2022, true);
+    HttpServer server(&loop, addr, "http_compress_test");
+    server.EnableCompression();
+    GetJsService js_service;
+    server.SetHttpCallback([&](HttpRequest* request, HttpResponse* response) {
+        js_service.jquery_min(request, response);
+    });
+    server.Start();
+
+    std::string received;
+    std::thread client([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+        // No gzip, so GetJsService sends the plain file under its ETag.
+        const std::string request = "GET /js/jquery_min HTTP/1.1\r\n"
+            "Accept-Encoding: deflate\r\nConnection: close\r\n\r\n";
+        ::write(fd, request.data(), request.size());
+        char buf[65536];
+        ssize_t n = 0;
+        while((n = ::read(fd, buf, sizeof(buf))) > 0) {
+            received.append(buf, n);
+        }
+        ::close(fd);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+
+    const size_t header_end = received.find("\r\n\r\n");
+    ASSERT_NE(std::string::npos, header_end);
+    const std::string header = received.substr(0, header_end);
+    ASSERT_NE(std::string::npos, header.find("HTTP/1.1 200 OK"));
+    ASSERT_NE(std::string::npos, header.find("ETag: \""));
+    ASSERT_EQ(std::string::npos, header.find("Content-Encoding"));
+    const Buffer& plain = jquery_min_js_buf();
+    ASSERT_EQ(std::string(plain.peek(), plain.readableBytes()),
+              received.substr(header_end + 4));
+}
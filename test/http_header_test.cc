@@ -68,4 +68,30 @@ TEST(HttpHeaderTest, http_header)
     ASSERT_EQ(HTTP_STATUS_GONE, header.status_code());
     ASSERT_STREQ(HttpReasonPhrase(header.status_code()),
                  header.reason_phrase());
-}
\ No newline at end of file
+}
+
+TEST(HttpHeaderTest, reuse_after_clear)
+{
+    HttpHeader header;
+    header.SetHeader("User-Agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36");
+    header.SetHeader("Host", "localhost:8511");
+    header.AppendHeader("accept", "text/html");
+    header.AppendHeader("Accept", "*/*");
+    ASSERT_EQ(3u, header.HeaderCount());
+    ASSERT_EQ("text/html,*/*", *header.GetHeader("ACCEPT"));
+    HttpHeader::HeaderIterator it = header.HeaderBegin();
+    ASSERT_EQ("User-Agent", it->first);
+    ASSERT_EQ("Host", (++it)->first);
+    ASSERT_EQ("accept", (++it)->first);
+    header.RemoveHeader("host");
+    ASSERT_EQ(2u, header.HeaderCount());
+    ASSERT_EQ("accept", (++header.HeaderBegin())->first);
+
+    // The strings of the last headers are refilled in place.
+    const char* agent = header.GetHeader("User-Agent")->data();
+    header.Clear();
+    ASSERT_EQ(0u, header.HeaderCount());
+    ASSERT_FALSE(header.GetHeader("User-Agent"));
+    header.SetHeader("Referer", "http://localhost:8511/vars/process_cpu_usage");
+    ASSERT_EQ(agent, header.GetHeader("Referer")->data());
+}
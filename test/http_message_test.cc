@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 #include "net/http/http_message.h"
+#include "net/http/http_fast_parser.h"
 
 using namespace var;
 using namespace var::net;
@@ -209,6 +210,150 @@ TEST(HttpMessageTest, one_more_request_line)
     ASSERT_TRUE(http_message.Completed());
 }
 
+TEST(HttpMessageTest, reset_for_next_message)
+{
+    const char* http_requests = 
+        "POST /upload?name=a HTTP/1.1\r\n"
+        "Content-Type: json\r\n"
+        "Content-Length: 4\r\n"
+        "Log-ID: 456\r\n"
+        "\r\n"
+        "body"
+        "GET /vars HTTP/1.0\r\n"
+        "\r\n"
+    ;
+    HttpMessage http_message;
+    http_message.set_stop_at_message_end(true);
+    const size_t total = strlen(http_requests);
+    ssize_t first = http_message.ParseFromBytes(http_requests, total);
+    ASSERT_GT(first, 0);
+    ASSERT_LT((size_t)first, total);
+    ASSERT_TRUE(http_message.Completed());
+    ASSERT_EQ("body", std::string(http_message.body().peek(), http_message.body().readableBytes()));
+
+    http_message.Reset();
+    ASSERT_FALSE(http_message.Completed());
+    ASSERT_EQ(0u, http_message.body().readableBytes());
+    ASSERT_EQ((ssize_t)(total - first), 
+              http_message.ParseFromBytes(http_requests + first, total - first));
+    ASSERT_TRUE(http_message.Completed());
+    const HttpHeader& header = http_message.header();
+    ASSERT_EQ(HTTP_METHOD_GET, header.method());
+    ASSERT_EQ("/vars", header.url().path());
+    ASSERT_EQ(0, header.minor_version());
+    ASSERT_TRUE(header.content_type().empty());
+    ASSERT_FALSE(header.GetHeader("Log-ID"));
+    ASSERT_EQ(0u, http_message.body().readableBytes());
+}
+
+// Requests the fast path takes must come out as from http_parser.
+static void ExpectSameAsHttpParser(const std::string& request) {
+    HttpMessage slow;
+    ASSERT_EQ((ssize_t)request.size(), slow.ParseFromBytes(request.data(), request.size()));
+    HttpMessage fast;
+    fast.set_stop_at_message_end(true);
+    ASSERT_EQ((ssize_t)request.size(), fast.ParseFromBytes(request.data(), request.size()));
+    ASSERT_TRUE(fast.Completed());
+    const HttpHeader& s = slow.header();
+    const HttpHeader& f = fast.header();
+    ASSERT_EQ(s.method(), f.method());
+    ASSERT_EQ(s.major_version(), f.major_version());
+    ASSERT_EQ(s.minor_version(), f.minor_version());
+    ASSERT_EQ(s.url().path(), f.url().path());
+    ASSERT_EQ(s.url().query(), f.url().query());
+    ASSERT_EQ(s.url().host(), f.url().host());
+    ASSERT_EQ(s.content_type(), f.content_type());
+    ASSERT_EQ(s.HeaderCount(), f.HeaderCount());
+    for(HttpHeader::HeaderIterator it = s.HeaderBegin(); it != s.HeaderEnd(); ++it) {
+        ASSERT_TRUE(f.GetHeader(it->first)) << it->first;
+        ASSERT_EQ(it->second, *f.GetHeader(it->first));
+    }
+    ASSERT_EQ(std::string(slow.body().peek(), slow.body().readableBytes()),
+              std::string(fast.body().peek(), fast.body().readableBytes()));
+}
+
+TEST(HttpMessageTest, fast_path)
+{
+    ExpectSameAsHttpParser(
+        "GET /vars/process_cpu_usage?series&dataonly HTTP/1.1\r\n"
+        "Host: localhost:8511\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36  \r\n"
+        "Accept: */*\r\n"
+        "Accept-Language:\ten-US,en;q=0.9\r\n"
+        "X-Empty:\r\n"
+        "Cookie: a=1\r\n"
+        "cookie: b=2\r\n"
+        "\r\n");
+    ExpectSameAsHttpParser(
+        "POST /upload?name=a HTTP/1.0\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 33\r\n"
+        "\r\n"
+        "{\"values\": [1, 2, 3], \"x\": \"\xe4\xbd\xa0\"}");
+
+    HttpFastRequest request;
+    const char* get = "GET /index.html?a=b HTTP/1.1\r\nHost: h\r\n\r\n";
+    ASSERT_EQ((ssize_t)strlen(get), ParseHttpRequestFast(get, strlen(get), &request));
+    ASSERT_EQ(HTTP_METHOD_GET, request.method);
+    ASSERT_EQ("/index.html?a=b", request.url.as_string());
+    ASSERT_EQ(1, request.minor_version);
+    ASSERT_EQ(1u, request.num_headers);
+    ASSERT_EQ("Host", request.headers[0].name.as_string());
+    ASSERT_EQ("h", request.headers[0].value.as_string());
+    // Every prefix waits for more.
+    for(size_t i = 0; i < strlen(get); ++i) {
+        ASSERT_EQ(0, ParseHttpRequestFast(get, i, &request)) << i;
+    }
+    // Past the first 16 bytes scanned at once.
+    const char* ctl = "GET / HTTP/1.1\r\nX-Long: 0123456789abcdefghij\x01klm\r\n\r\n";
+    ASSERT_EQ(-1, ParseHttpRequestFast(ctl, strlen(ctl), &request));
+    const char* folded = "GET / HTTP/1.1\r\nX-Folded: a\r\n b\r\n\r\n";
+    ASSERT_EQ(-1, ParseHttpRequestFast(folded, strlen(folded), &request));
+    const char* lf = "GET / HTTP/1.1\nHost: h\n\n";
+    ASSERT_EQ(-1, ParseHttpRequestFast(lf, strlen(lf), &request));
+    const char* lower = "get / HTTP/1.1\r\n\r\n";
+    ASSERT_EQ(-1, ParseHttpRequestFast(lower, strlen(lower), &request));
+}
+
+TEST(HttpMessageTest, fast_path_fallback)
+{
+    // Chunked, left to http_parser.
+    const char* chunked =
+        "POST /upload HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "4\r\nbody\r\n0\r\n\r\n";
+    HttpMessage chunked_message;
+    chunked_message.set_stop_at_message_end(true);
+    ASSERT_EQ((ssize_t)strlen(chunked),
+              chunked_message.ParseFromBytes(chunked, strlen(chunked)));
+    ASSERT_TRUE(chunked_message.Completed());
+    ASSERT_EQ("body", std::string(chunked_message.body().peek(),
+                                  chunked_message.body().readableBytes()));
+
+    // The body is not all there, http_parser goes on with the rest.
+    const char* partial =
+        "POST /upload HTTP/1.1\r\n"
+        "Content-Length: 8\r\n"
+        "\r\n"
+        "body";
+    HttpMessage partial_message;
+    partial_message.set_stop_at_message_end(true);
+    ASSERT_EQ((ssize_t)strlen(partial),
+              partial_message.ParseFromBytes(partial, strlen(partial)));
+    ASSERT_FALSE(partial_message.Completed());
+    ASSERT_EQ(4, partial_message.ParseFromBytes("more", 4));
+    ASSERT_TRUE(partial_message.Completed());
+    ASSERT_EQ("bodymore", std::string(partial_message.body().peek(),
+                                      partial_message.body().readableBytes()));
+
+    // Errors are still those of http_parser.
+    const char* bad = "GET / HTTP/1.1\r\nContent-Length: x\r\n\r\n";
+    HttpMessage bad_message;
+    bad_message.set_stop_at_message_end(true);
+    ASSERT_EQ(-1, bad_message.ParseFromBytes(bad, strlen(bad)));
+}
+
 TEST(HttpMessageTest, parse_from_iobuf) 
 {
     const size_t content_length = 8192;
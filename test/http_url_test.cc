@@ -329,14 +329,40 @@ TEST(HttpUrlTest, print_url)
     url.PrintWithoutHost(oss);
     ASSERT_EQ("/?d=c&a=b&e=f#frg1", oss.str());
 
-    // // range error
-    // url.SetQuery("e", "f2");
-    // url.SetQuery("f", "g");
-    // ASSERT_EQ((size_t)1, url.RemoveQuery("a"));
-    // oss.str("");
-    // url.Print(oss);
-    // ASSERT_EQ("http://a.b.c/?d=c&e=f2&f=g#frg1", oss.str());
-    // oss.str("");
-    // url.PrintWithoutHost(oss);
-    // ASSERT_EQ("/?d=c&e=f2&f=g#frg1", oss.str());
+    url.SetQuery("e", "f2");
+    url.SetQuery("f", "g");
+    ASSERT_EQ((size_t)1, url.RemoveQuery("a"));
+    oss.str("");
+    url.Print(oss);
+    ASSERT_EQ("http://a.b.c/?d=c&e=f2&f=g#frg1", oss.str());
+    oss.str("");
+    url.PrintWithoutHost(oss);
+    ASSERT_EQ("/?d=c&e=f2&f=g#frg1", oss.str());
+}
+
+TEST(HttpUrlTest, query_map)
+{
+    HttpUrl url;
+    ASSERT_EQ(0, url.ResolvedHttpURL("/vars?series&&=x&a=1&b=&a=2&c=3=4&"));
+    ASSERT_EQ(4u, url.QueryCount());
+    ASSERT_EQ("2", *url.GetQuery("a"));
+    ASSERT_EQ("", *url.GetQuery("b"));
+    ASSERT_EQ("3=4", *url.GetQuery("c"));
+    ASSERT_EQ("", *url.GetQuery("series"));
+    ASSERT_FALSE(url.GetQuery("A"));
+    // In the order they came.
+    HttpUrl::QueryIterator it = url.QueryBegin();
+    ASSERT_EQ("series", it->first);
+    ASSERT_EQ("a", (++it)->first);
+    ASSERT_EQ("b", (++it)->first);
+    ASSERT_EQ("c", (++it)->first);
+
+    // The entries are reused by the next url.
+    const std::string* a = url.GetQuery("a");
+    ASSERT_EQ(0, url.ResolvedHttpURL("/status?x=1&a=9"));
+    ASSERT_EQ(2u, url.QueryCount());
+    ASSERT_EQ("9", *url.GetQuery("a"));
+    ASSERT_EQ(a, url.GetQuery("a"));
+    url.Clear();
+    ASSERT_EQ(0u, url.QueryCount());
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+#include "metric/builtin/log_service.h"
+#include <stdint.h>
+
+using namespace var;
+
+TEST(LogServiceTest, list_logs_since_wrapped)
+{
+    std::vector<std::string> lines;
+    const uint64_t begin = LogFilter::list_logs_since(UINT64_MAX, &lines);
+    ASSERT_TRUE(lines.empty());
+
+    // More lines than kept, the first ones are dropped.
+    const size_t n = LogFilter::limit() + 10;
+    for(size_t i = 0; i < n; ++i) {
+        const std::string line = "line " + std::to_string(i) + "\n";
+        LogFilter::log_to_browser(line.data(), line.size());
+    }
+
+    // From before the oldest line kept, all of them.
+    uint64_t seq = LogFilter::list_logs_since(begin + 5, &lines);
+    ASSERT_EQ(begin + n, seq);
+    ASSERT_EQ(LogFilter::limit(), lines.size());
+    ASSERT_EQ("line 10\n", lines.front());
+    ASSERT_EQ("line " + std::to_string(n - 1) + "\n", lines.back());
+
+    // From within the lines kept, the rest of them.
+    lines.clear();
+    seq = LogFilter::list_logs_since(begin + n - 3, &lines);
+    ASSERT_EQ(begin + n, seq);
+    ASSERT_EQ(3u, lines.size());
+    ASSERT_EQ("line " + std::to_string(n - 3) + "\n", lines.front());
+
+    // Nothing new.
+    lines.clear();
+    ASSERT_EQ(seq, LogFilter::list_logs_since(seq, &lines));
+    ASSERT_TRUE(lines.empty());
+}
@@ -0,0 +1,72 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include <gtest/gtest.h>
+#include "metric/loop_status.h"
+#include "net/EventLoop.h"
+#include "net/base/CurrentThread.h"
+
+namespace {
+
+TEST(LoopStatusTest, expose)
+{
+    var::net::EventLoop loop;
+    var::net::EventLoopThreadPool pool(&loop, "loop_status_test");
+    pool.setThreadNum(2);
+    pool.start();
+    std::vector<var::net::EventLoop*> loops = pool.getAllLoops();
+    ASSERT_EQ(2u, loops.size());
+    {
+        var::LoopStatus status("loop_status_test", &pool);
+        loops[1]->addConnection();
+        ASSERT_EQ("0", var::Variable::describe_exposed("loop_status_test_loop0_connections"));
+        ASSERT_EQ("1", var::Variable::describe_exposed("loop_status_test_loop1_connections"));
+        ASSERT_EQ("0", var::Variable::describe_exposed("loop_status_test_loop1_busy_ratio"));
+        loops[1]->removeConnection();
+    }
+    ASSERT_EQ("", var::Variable::describe_exposed("loop_status_test_loop0_connections"));
+}
+
+TEST(LoopStatusTest, loop_metrics)
+{
+    var::net::EventLoop loop;
+    var::EnableLoopMetrics(&loop);
+    int functors = 0;
+    loop.runAfter(0.01, [&]() {
+        loop.queueInLoop([&]() { ++functors; });
+        loop.queueInLoop([&]() { ++functors; });
+    });
+    loop.runAfter(0.05, [&]() { loop.quit(); });
+    loop.loop();
+    ASSERT_EQ(2, functors);
+
+    const std::string prefix = var::CurrentThread::name();
+    ASSERT_EQ("2", var::Variable::describe_exposed(prefix + "_loop_timer_lateness_count"));
+    ASSERT_EQ("1", var::Variable::describe_exposed(prefix + "_loop_functors_count"));
+    // The timerfd was active in both iterations of the timers.
+    ASSERT_NE("0", var::Variable::describe_exposed(prefix + "_loop_events"));
+    ASSERT_NE("0", var::Variable::describe_exposed(prefix + "_loop_callback_count"));
+    ASSERT_NE(std::string::npos, var::Variable::describe_exposed(
+        prefix + "_loop_slowest_callbacks").find("us fd "));
+
+    loop.setObserver(nullptr);
+    ASSERT_EQ("", var::Variable::describe_exposed(prefix + "_loop_functors_count"));
+}
+
+} // namespace
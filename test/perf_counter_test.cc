@@ -0,0 +1,89 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include <gtest/gtest.h>
+#include "metric/perf_counter.h"
+#include <unistd.h>
+
+namespace {
+
+TEST(PerfCounterTest, thread_scope)
+{
+    var::PerfCounter counter(var::PERF_SCOPE_THREAD);
+    volatile int64_t sum = 0;
+    for(int i = 0; i < 1000000; ++i) {
+        sum += i;
+    }
+    if(!counter.available()) {
+        // Perf events are unavailable in this environment, everything
+        // should read as 0 and nothing is exposed.
+        for(int i = 0; i < var::PERF_EVENT_NUM; ++i) {
+            ASSERT_EQ(0, counter.get_value(static_cast<var::PerfEventType>(i)));
+        }
+        ASSERT_EQ(-1, counter.expose("perf_counter_test"));
+        return;
+    }
+    ASSERT_EQ(0, counter.expose("perf_counter_test"));
+    int64_t last[var::PERF_EVENT_NUM];
+    for(int i = 0; i < var::PERF_EVENT_NUM; ++i) {
+        last[i] = counter.get_value(static_cast<var::PerfEventType>(i));
+        ASSERT_LE(0, last[i]);
+    }
+    for(int i = 0; i < 1000000; ++i) {
+        sum += i;
+    }
+    for(int i = 0; i < var::PERF_EVENT_NUM; ++i) {
+        ASSERT_LE(last[i], counter.get_value(static_cast<var::PerfEventType>(i)));
+    }
+}
+
+TEST(PerfCounterTest, context_switches)
+{
+    var::PerfCounter counter(var::PERF_SCOPE_THREAD);
+    if(!counter.available(var::PERF_EVENT_CONTEXT_SWITCHES)) {
+        ASSERT_EQ(0, counter.get_value(var::PERF_EVENT_CONTEXT_SWITCHES));
+        return;
+    }
+    const int64_t before = counter.get_value(var::PERF_EVENT_CONTEXT_SWITCHES);
+    // Each sleep switches the thread out.
+    for(int i = 0; i < 5; ++i) {
+        usleep(1000);
+    }
+    ASSERT_LE(before + 5, counter.get_value(var::PERF_EVENT_CONTEXT_SWITCHES));
+}
+
+TEST(PerfCounterTest, perf_scope)
+{
+    var::PerfScopeRecorder recorder;
+    const bool available = var::detail::get_thread_perf_event_group()->available();
+    for(int i = 0; i < 10; ++i) {
+        var::PerfScope scope(&recorder);
+        volatile int64_t sum = 0;
+        for(int j = 0; j < 10000; ++j) {
+            sum += j;
+        }
+    }
+    for(int i = 0; i < var::PERF_EVENT_NUM; ++i) {
+        const var::LatencyRecorder& r =
+            recorder.recorder(static_cast<var::PerfEventType>(i));
+        ASSERT_EQ(available ? 10 : 0, r.count());
+    }
+}
+
+} // namespace
@@ -0,0 +1,136 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Date Mon Oct 19 10:12:36 CST 2026.
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "metric/builtin/pprof.h"
+#include "metric/util/symbolizer.h"
+
+namespace {
+
+__attribute__((noinline)) void profiled_function() {
+    asm volatile("");
+}
+
+std::string read_self_maps() {
+    std::ifstream ifs("/proc/self/maps");
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+std::string contention_profile(int64_t wait_ns, int64_t count) {
+    std::ostringstream oss;
+    // The caller frame is symbolized at pc - 1.
+    oss << "--- contention\ncycles/second=1000000000\n"
+        << wait_ns << ' ' << count << " @ 0x" << std::hex
+        << (uintptr_t)&profiled_function << " 0x"
+        << (uintptr_t)&profiled_function + 1 << '\n'
+        << read_self_maps();
+    return oss.str();
+}
+
+TEST(PprofTest, short_function_name)
+{
+    ASSERT_EQ("ns::f", var::ShortFunctionName("void ns::f<int>(int) const"));
+    ASSERT_EQ("ns::A::operator()", var::ShortFunctionName("ns::A::operator()(int&&)"));
+    ASSERT_EQ("ns::operator<<", var::ShortFunctionName(
+        "std::ostream& ns::operator<< <char>(std::ostream&, ns::A const&)"));
+    ASSERT_EQ("(anonymous namespace)::g", var::ShortFunctionName(
+        "(anonymous namespace)::g(std::vector<int, std::allocator<int> >)"));
+    ASSERT_EQ("ns::f", var::ShortFunctionName("ns::f() [clone .constprop.0]"));
+}
+
+TEST(PprofTest, symbolize)
+{
+    var::Symbolizer symbolizer(read_self_maps());
+    ASSERT_EQ("(anonymous namespace)::profiled_function",
+              symbolizer.Symbolize((uintptr_t)&profiled_function));
+    // Not mapped.
+    ASSERT_EQ(0u, symbolizer.Symbolize(1).find("0x"));
+}
+
+TEST(PprofTest, contention_profile)
+{
+    var::Profile profile;
+    std::string error;
+    ASSERT_EQ(0, profile.Parse(contention_profile(2000000000, 4), false, &error)) << error;
+    ASSERT_EQ("seconds", profile.unit());
+    ASSERT_DOUBLE_EQ(2, profile.total());
+
+    var::net::Buffer text;
+    profile.WriteText(&text);
+    const std::string text_str = text.retrieveAllAsString();
+    ASSERT_NE(std::string::npos, text_str.find("Total: 2.000 seconds")) << text_str;
+    ASSERT_NE(std::string::npos, text_str.find("profiled_function")) << text_str;
+
+    var::net::Buffer collapsed;
+    profile.WriteCollapsed(&collapsed);
+    ASSERT_EQ("(anonymous namespace)::profiled_function;"
+              "(anonymous namespace)::profiled_function 2.000\n",
+              collapsed.retrieveAllAsString());
+
+    var::net::Buffer dot;
+    profile.WriteDot("pprof_test", &dot);
+    ASSERT_EQ(0u, dot.retrieveAllAsString().find("digraph \"pprof_test; 2.000 seconds\""));
+
+    var::net::Buffer svg;
+    profile.WriteFlameGraph("pprof_test", 1200, &svg);
+    const std::string svg_str = svg.retrieveAllAsString();
+    ASSERT_EQ(0u, svg_str.find("<svg"));
+    ASSERT_NE(std::string::npos, svg_str.find("FlameGraph"));
+    ASSERT_NE(std::string::npos, svg_str.find("profiled_function"));
+
+    var::Profile count_profile;
+    ASSERT_EQ(0, count_profile.Parse(contention_profile(2000000000, 4), true, &error));
+    ASSERT_EQ("contentions", count_profile.unit());
+    ASSERT_DOUBLE_EQ(4, count_profile.total());
+
+    var::Profile base;
+    ASSERT_EQ(0, base.Parse(contention_profile(500000000, 1), false, &error));
+    profile.Subtract(base);
+    ASSERT_DOUBLE_EQ(1.5, profile.total());
+}
+
+TEST(PprofTest, cpu_profile)
+{
+    std::vector<uintptr_t> words = { 0, 3, 0, 10000, 0 };
+    words.push_back(7);
+    words.push_back(1);
+    words.push_back((uintptr_t)&profiled_function);
+    words.push_back(0);
+    words.push_back(1);
+    words.push_back(0);
+    std::string data((const char*)&words[0], words.size() * sizeof(uintptr_t));
+    data.append(read_self_maps());
+
+    var::Profile profile;
+    std::string error;
+    ASSERT_EQ(0, profile.Parse(data, false, &error)) << error;
+    ASSERT_EQ("samples", profile.unit());
+    ASSERT_DOUBLE_EQ(7, profile.total());
+
+    // Missing the end of samples.
+    data.resize(6 * sizeof(uintptr_t));
+    ASSERT_EQ(-1, profile.Parse(data, false, &error));
+    ASSERT_EQ(-1, profile.Parse("not a profile", false, &error));
+}
+
+} // namespace
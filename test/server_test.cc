@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+#include "metric/server.h"
+#include "net/base/CountDownLatch.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace var;
+
+namespace {
+
+const uint16_t kPort = 2033;
+
+// Sends a GET of `path' and reads the response till the server closes,
+// empty if nothing came back within `timeout_s'.
+std::string HttpGet(const std::string& path, int timeout_s) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    struct timeval tv = { timeout_s, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::string response;
+    // The server may not be listening yet.
+    for(int i = 0; i < 100; ++i) {
+        if(::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+            const std::string request = "GET " + path + " HTTP/1.1\r\n"
+                                        "Host: 127.0.0.1\r\n"
+                                        "Connection: close\r\n\r\n";
+            if(::write(fd, request.data(), request.size()) ==
+               static_cast<ssize_t>(request.size())) {
+                char buf[4096];
+                ssize_t n = 0;
+                while((n = ::read(fd, buf, sizeof(buf))) > 0) {
+                    response.append(buf, n);
+                }
+            }
+            break;
+        }
+        ::usleep(10 * 1000);
+    }
+    ::close(fd);
+    return response;
+}
+
+} // namespace
+
+TEST(ServerTest, vars_answer_while_blocking_method_runs)
+{
+    CountDownLatch running(1);
+    CountDownLatch release(1);
+    std::atomic<bool> slow_done(false);
+    Service* slow_service = new Service;
+    slow_service->set_blocking(true);
+    slow_service->AddMethod("wait", [&](net::HttpRequest*, net::HttpResponse*) {
+        running.countDown();
+        release.wait();
+        slow_done = true;
+    });
+
+    ServerOptions options;
+    options.num_threads = 1;
+    options.num_workers = 1;
+    Server* server = nullptr;
+    CountDownLatch started(1);
+    std::thread server_thread([&]() {
+        Server s(net::InetAddress(kPort), options);
+        s.AddBuiltinService("slow", slow_service);
+        server = &s;
+        started.countDown();
+        s.Start();
+    });
+    started.wait();
+
+    std::string slow_response;
+    std::thread slow_thread([&]() {
+        slow_response = HttpGet("/slow/wait", 10);
+    });
+    running.wait();
+
+    const auto begin = std::chrono::steady_clock::now();
+    const std::string vars = HttpGet("/vars", 2);
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_NE(std::string::npos, vars.find("dummy_server_slow_concurrency : 1"));
+    EXPECT_LT(elapsed, std::chrono::seconds(1));
+    EXPECT_FALSE(slow_done);
+
+    release.countDown();
+    slow_thread.join();
+    EXPECT_TRUE(slow_done);
+    EXPECT_NE(std::string::npos, slow_response.find("200 OK"));
+
+    server->Stop();
+    server_thread.join();
+    delete slow_service;
+}
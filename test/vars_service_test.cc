@@ -0,0 +1,112 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+#include "metric/builtin/vars_service.h"
+
+using namespace var;
+
+namespace {
+
+// A series in the shape Series::describe() writes, y = values[i].
+std::string MakeSeries(const std::vector<int>& values) {
+    std::string series = "{\"label\":\"trend\",\"data\":[";
+    for(size_t i = 0; i < values.size(); ++i) {
+        if(i) {
+            series.push_back(',');
+        }
+        series += '[' + std::to_string(i) + ',' + std::to_string(values[i]) + ']';
+    }
+    series += "]}";
+    return series;
+}
+
+SeriesValues Parse(const std::vector<int>& values) {
+    SeriesValues parsed;
+    ParseSeriesValues(MakeSeries(values), &parsed);
+    return parsed;
+}
+
+} // namespace
+
+TEST(VarsServiceTest, parse_series_values)
+{
+    SeriesValues values;
+    ParseSeriesValues("[" + MakeSeries({1, 2}) + "," + MakeSeries({3, 4}) + "]", &values);
+    ASSERT_EQ(2u, values.size());
+    ASSERT_EQ(std::vector<std::string>({"1", "2"}), values[0]);
+    ASSERT_EQ(std::vector<std::string>({"3", "4"}), values[1]);
+
+    values.clear();
+    ParseSeriesValues("{\"label\":\"trend\",\"data\":[[0,1],[1", &values);
+    ASSERT_TRUE(values.empty());
+}
+
+TEST(VarsServiceTest, diff_series_shift_by_one)
+{
+    std::string ops;
+    ASSERT_TRUE(DiffSeries(Parse({1, 2, 3, 4, 5}), Parse({2, 3, 4, 5, 6}), &ops));
+    ASSERT_EQ("[0,0,5,6]", ops);
+
+    // Only the second section of a trend moved on.
+    std::vector<int> from(174);
+    for(size_t i = 0; i < from.size(); ++i) {
+        from[i] = i;
+    }
+    std::vector<int> to(from);
+    to.erase(to.begin() + 114);
+    to.push_back(1000);
+    ops.clear();
+    ASSERT_TRUE(DiffSeries(Parse(from), Parse(to), &ops));
+    ASSERT_EQ("[0,114,60,1000]", ops);
+
+    ops.clear();
+    ASSERT_TRUE(DiffSeries(Parse(from), Parse(from), &ops));
+    ASSERT_EQ("", ops);
+}
+
+TEST(VarsServiceTest, diff_series_changed_section)
+{
+    std::string ops;
+    ASSERT_TRUE(DiffSeries(Parse({1, 2, 3}), Parse({1, 9, 3}), &ops));
+    ASSERT_EQ("[0,0,[1,9,3]]", ops);
+
+    // The minute section is rewritten, the second one moved on.
+    std::vector<int> from(174, 0);
+    std::vector<int> to(from);
+    to[60] = 7;
+    to[173] = 8;
+    ops.clear();
+    ASSERT_TRUE(DiffSeries(Parse(from), Parse(to), &ops));
+    std::string minute = "[0,54,[";
+    for(int i = 54; i < 114; ++i) {
+        minute += (i == 54 ? "" : ",") + std::to_string(to[i]);
+    }
+    minute += "]]";
+    ASSERT_EQ(minute + ",[0,114,60,8]", ops);
+}
+
+TEST(VarsServiceTest, diff_series_shape_changed)
+{
+    std::string ops;
+    ASSERT_FALSE(DiffSeries(SeriesValues(), Parse({1, 2}), &ops));
+    ASSERT_FALSE(DiffSeries(Parse({1, 2}), Parse({1, 2, 3}), &ops));
+    SeriesValues two_lines;
+    ParseSeriesValues("[" + MakeSeries({1, 2}) + "," + MakeSeries({3, 4}) + "]", &two_lines);
+    ASSERT_FALSE(DiffSeries(Parse({1, 2}), two_lines, &ops));
+    ASSERT_EQ("", ops);
+}